@@ -19,6 +19,7 @@
 #include <seiscomp3/gui/core/aboutwidget.h>
 #include <seiscomp3/gui/core/utils.h>
 #include <seiscomp3/logging/log.h>
+#include <seiscomp3/core/strings.h>
 #include <seiscomp3/communication/servicemessage.h>
 #include <seiscomp3/client/pluginregistry.h>
 #include <seiscomp3/datamodel/notifier.h>
@@ -256,6 +257,7 @@ Application::Application(int& argc, char **argv, int flags, Type type)
 	_guiGroup = "GUI";
 	_thread = NULL;
 	_startFullScreen = false;
+	_recordCacheEnabled = false;
 	_nonInteractive = false;
 	_filterCommands = true;
 	_mapsDesc.isMercatorProjected = false;
@@ -893,6 +895,22 @@ bool Application::initConfiguration() {
 	}
 	catch (...) {}
 
+	try { _recordCacheEnabled = configGetBool("recordstream.cache.enable"); }
+	catch (...) {}
+
+	_recordCacheParameters = "";
+	try {
+		_recordCacheParameters = "dir=" + Environment::Instance()->absolutePath(configGetString("recordstream.cache.directory"));
+	}
+	catch (...) {}
+
+	try {
+		int size = configGetInt("recordstream.cache.size");
+		if ( !_recordCacheParameters.empty() ) _recordCacheParameters += "&";
+		_recordCacheParameters += "size=" + Core::toString(size);
+	}
+	catch (...) {}
+
 	setOrganizationName(agencyID().c_str());
 	setApplicationName(name().c_str());
 
@@ -1596,6 +1614,39 @@ const std::string& Application::commandTarget() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string Application::cachedRecordStreamURL(const std::string &url) const {
+	if ( !_recordCacheEnabled || url.empty() ) return url;
+
+	std::string service = "file";
+	std::string source = url;
+	std::string type;
+
+	size_t pos = source.find("://");
+	if ( pos != std::string::npos ) {
+		service = source.substr(0, pos);
+		source.erase(0, pos+3);
+	}
+
+	if ( service == "cache" ) return url;
+
+	pos = source.find('#');
+	if ( pos != std::string::npos ) {
+		type = source.substr(pos);
+		source.erase(pos);
+	}
+
+	std::string cachedURL = "cache://" + service + "/" + source;
+	if ( !_recordCacheParameters.empty() )
+		cachedURL += "??" + _recordCacheParameters;
+
+	return cachedURL + type;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::sendCommand(Command command, const std::string& parameter) {
 	sendCommand(command, parameter, NULL);
@@ -162,6 +162,11 @@ class SC_GUI_API Application : public QApplication,
 
 		const std::string& commandTarget() const;
 
+		//! Returns a recordstream URL that reads through the local
+		//! waveform cache if recordstream.cache.enable is set. Otherwise
+		//! the URL is returned unchanged.
+		std::string cachedRecordStreamURL(const std::string &url) const;
+
 		void sendCommand(Command command, const std::string& parameter);
 		void sendCommand(Command command, const std::string& parameter, Core::BaseObject*);
 
@@ -267,6 +272,8 @@ class SC_GUI_API Application : public QApplication,
 		MapsDesc            _mapsDesc;
 		std::string         _guiGroup;
 		std::string         _commandTargetClient;
+		bool                _recordCacheEnabled;
+		std::string         _recordCacheParameters;
 
 		QWidget*            _mainWidget;
 		QSplashScreen*      _splash;
@@ -12,7 +12,9 @@
 
 
 
+#include <algorithm>
 #include <iostream>
+#include <cmath>
 using namespace std;
 
 #include "recordpolyline.h"
@@ -21,6 +23,226 @@ namespace {
 
 std::ostream &operator << (std::ostream &os, const Seiscomp::Core::Time &t);
 
+
+// Maps sample indices and values to pixel coordinates. The optional shift
+// is the fractional position of the first sample.
+struct Scale {
+	Scale(float dx_, int x0_, int baseline_, double yscl_, float amplOffset_,
+	      double shift_ = 0)
+	: dx(dx_), x0(x0_), baseline(baseline_), yscl(yscl_), amplOffset(amplOffset_),
+	  shift(shift_) {}
+
+	int x(int i) const { return int(i*dx + shift) - x0; }
+	int y(float v) const { return int(baseline-yscl*(v-amplOffset)); }
+
+	float  dx;
+	int    x0;
+	int    baseline;
+	double yscl;
+	float  amplOffset;
+	double shift;
+};
+
+
+// Appends points to a polygon and collapses all points of a pixel column
+// to its entry, minimum, maximum and exit value
+class ColumnWriter {
+	public:
+		ColumnWriter(QPolygon *poly, int x, int y)
+		: _poly(poly), _x_prev(x), _y_prev(y), _y_min(y), _y_max(y),
+		  _x_out(x), _y_out(y) {}
+
+		void add(int x_pos, int y_pos) {
+			if ( y_pos != _y_out ) {
+				// last output differs from the last sample?
+				if ( _x_out != _x_prev  ) {
+					_x_out = _x_prev;
+					_poly->append(QPoint(_x_out, _y_out));
+				}
+
+				// last output differs from the current draw position?
+				if ( _x_out != x_pos ) {
+					if ( _y_min != _y_out ) {
+						_y_out = _y_min;
+						_poly->append(QPoint(_x_out, _y_out));
+					}
+					if ( _y_max != _y_out ) {
+						_y_out = _y_max;
+						_poly->append(QPoint(_x_out, _y_out));
+					}
+					if ( _y_prev != _y_out ) {
+						_y_out = _y_prev;
+						_poly->append(QPoint(_x_out, _y_out));
+					}
+
+					_x_out = x_pos;
+
+					if ( y_pos != _y_out ) {
+						_y_out = y_pos;
+						_poly->append(QPoint(_x_out, y_pos));
+					}
+
+					_y_min = _y_max = _y_out;
+				}
+				else {
+					// update y min/max range
+					if ( y_pos < _y_min ) _y_min = y_pos;
+					else if ( y_pos > _y_max ) _y_max = y_pos;
+				}
+			}
+			else {
+				if ( _y_min != _y_out ) {
+					_y_out = _y_min;
+					_poly->append(QPoint(_x_out, _y_out));
+					_y_min = _y_out;
+				}
+				if ( _y_max != _y_out ) {
+					_y_out = _y_max;
+					_poly->append(QPoint(_x_out, _y_out));
+					_y_max = _y_out;
+				}
+				if ( _y_prev != _y_out ) {
+					_y_out = _y_min = _y_max = _y_prev;
+					_poly->append(QPoint(_x_out, _y_out));
+				}
+			}
+
+			_x_prev = x_pos;
+			_y_prev = y_pos;
+		}
+
+		void finish() {
+			if ( _x_out != _x_prev )
+				_poly->append(QPoint(_x_prev, _y_prev));
+		}
+
+		// Like finish but also emits the range of the last column which
+		// is otherwise only emitted when the next column starts
+		void flush() {
+			if ( _x_out != _x_prev ) {
+				_x_out = _x_prev;
+				_poly->append(QPoint(_x_out, _y_out));
+			}
+			if ( _y_min != _y_out ) {
+				_y_out = _y_min;
+				_poly->append(QPoint(_x_out, _y_out));
+			}
+			if ( _y_max != _y_out ) {
+				_y_out = _y_max;
+				_poly->append(QPoint(_x_out, _y_out));
+			}
+			if ( _y_prev != _y_out )
+				_poly->append(QPoint(_x_out, _y_prev));
+		}
+
+	private:
+		QPolygon *_poly;
+		int       _x_prev, _y_prev;
+		int       _y_min, _y_max;
+		int       _x_out, _y_out;
+};
+
+
+// Appends the samples 1 to nsamp-1 of f collapsed to pixel columns
+void appendSamples(QPolygon *poly, Scale scale, const float *f, int nsamp) {
+	ColumnWriter writer(poly, scale.x(0), scale.y(f[0]));
+
+	for ( int i = 1; i < nsamp; ++i )
+		writer.add(scale.x(i), scale.y(f[i]));
+
+	writer.finish();
+}
+
+
+// Random access to the samples of consecutive records by their index in
+// the series. Accesses are mostly ascending, therefore the record of the
+// last access is checked first.
+class RecordSamples {
+	public:
+		RecordSamples(const std::vector<Seiscomp::RecordCPtr> &records,
+		              const std::vector<int> &offsets)
+		: _records(records), _offsets(offsets), _k(0), _data(NULL) {}
+
+		float operator[](int i) const {
+			if ( _data == NULL || i < _offsets[_k] ||
+			     (_k+1 < _offsets.size() && i >= _offsets[_k+1]) ) {
+				if ( _data != NULL && _k+1 < _offsets.size() && i >= _offsets[_k+1] &&
+				     (_k+2 == _offsets.size() || i < _offsets[_k+2]) )
+					++_k;
+				else
+					_k = std::upper_bound(_offsets.begin(), _offsets.end(), i) - _offsets.begin() - 1;
+
+				_data = ((const Seiscomp::FloatArray*)_records[_k]->data())->typedData();
+			}
+
+			return _data[i - _offsets[_k]];
+		}
+
+	private:
+		const std::vector<Seiscomp::RecordCPtr> &_records;
+		const std::vector<int>                  &_offsets;
+		mutable size_t                           _k;
+		mutable const float                     *_data;
+};
+
+
+bool startsBefore(const Seiscomp::RecordCPtr &rec, const Seiscomp::Core::Time &t) {
+	return rec->startTime() < t;
+}
+
+
+// Same as appendSamples but reduces aligned buckets of up to the size of
+// the given pyramid level to their first, minimum, maximum and last value.
+// Draws the samples ofs to ofs+nsamp-1 of the series the pyramid was built
+// from.
+void appendBuckets(QPolygon *poly, Scale scale, const RecordSamples &f,
+                   int ofs, int nsamp, const Seiscomp::Gui::RecordPyramid *pyramid,
+                   int level) {
+	ColumnWriter writer(poly, scale.x(0), scale.y(f[ofs]));
+	int minSize = pyramid->bucketSize(0);
+	int i = 1;
+
+	while ( i < nsamp ) {
+		int x[4], y[4], n;
+
+		if ( (ofs + i) % minSize || i + minSize > nsamp ) {
+			// Samples outside of complete buckets
+			x[0] = scale.x(i);
+			y[0] = scale.y(f[ofs+i]);
+			n = 1;
+			++i;
+		}
+		else {
+			// Take the largest bucket that starts at the current sample
+			// and fits into the remaining samples
+			int l = level;
+			int size = pyramid->bucketSize(l);
+			while ( ((ofs + i) % size) || i + size > nsamp ) {
+				--l;
+				size >>= 1;
+			}
+
+			const float *bucket = pyramid->buckets(l) + 2*((ofs + i) / size);
+			x[0] = x[1] = x[2] = scale.x(i);
+			y[0] = scale.y(f[ofs+i]);
+			y[1] = scale.y(bucket[0]);
+			y[2] = scale.y(bucket[1]);
+			x[3] = scale.x(i+size-1);
+			y[3] = scale.y(f[ofs+i+size-1]);
+			n = 4;
+			i += size;
+		}
+
+		for ( int k = 0; k < n; ++k )
+			writer.add(x[k], y[k]);
+	}
+
+	// Buckets rarely return to the last output value which emits the
+	// range of a column before the next column starts
+	writer.flush();
+}
+
+
 /*
 static void optimize1(int &n, int *pt)
 {
@@ -169,81 +391,12 @@ void RecordPolyline::create(Record const *rec,
 	int x0 = 0;
 	float dx = pixelPerSecond / rec->samplingFrequency();
 
-	int x_prev = -x0;
-	int y_prev = int(_baseline-yscl*(f[0]-amplOffset));
-	int y_min = y_prev;
-	int y_max = y_prev;
-
-	int x_out = x_prev;
-	int y_out = y_prev;
+	Scale scale(dx, x0, _baseline, yscl, amplOffset);
 
-	poly->append(QPoint(x_prev, y_prev));
+	poly->append(QPoint(scale.x(0), scale.y(f[0])));
 
 	if ( optimization ) {
-		for (int i = 1; i<nsamp; i++) {
-			int x_pos = int(i*dx) - x0;
-			int y_pos = int(_baseline-yscl*(f[i]-amplOffset));
-
-			if ( y_pos != y_out ) {
-				// last output differs from the last sample?
-				if ( x_out != x_prev  ) {
-					x_out = x_prev;
-					poly->append(QPoint(x_out, y_out));
-				}
-
-				// last output differs from the current draw position?
-				if ( x_out != x_pos ) {
-					if ( y_min != y_out ) {
-						y_out = y_min;
-						poly->append(QPoint(x_out, y_out));
-					}
-					if ( y_max != y_out ) {
-						y_out = y_max;
-						poly->append(QPoint(x_out, y_out));
-					}
-					if ( y_prev != y_out ) {
-						y_out = y_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
-
-					x_out = x_pos;
-
-					if ( y_pos != y_out ) {
-						y_out = y_pos;
-						poly->append(QPoint(x_out, y_pos));
-					}
-
-					y_min = y_max = y_out;
-				}
-				else {
-					// update y min/max range
-					if ( y_pos < y_min ) y_min = y_pos;
-					else if ( y_pos > y_max ) y_max = y_pos;
-				}
-			}
-			else {
-				if ( y_min != y_out ) {
-					y_out = y_min;
-					poly->append(QPoint(x_out, y_out));
-					y_min = y_out;
-				}
-				if ( y_max != y_out ) {
-					y_out = y_max;
-					poly->append(QPoint(x_out, y_out));
-					y_max = y_out;
-				}
-				if ( y_prev != y_out ) {
-					y_out = y_min = y_max = y_prev;
-					poly->append(QPoint(x_out, y_out));
-				}
-			}
-
-			x_prev = x_pos;
-			y_prev = y_pos;
-		}
-
-		if ( x_out != x_prev )
-			poly->append(QPoint(x_prev, y_prev));
+		appendSamples(poly, scale, f, nsamp);
 	}
 	else {
 		for (int i = 1; i<nsamp; i++) {
@@ -304,6 +457,10 @@ void RecordPolyline::create(RecordSequence const *records,
 	int timingQualityRecordCount = 0;
 	if ( timingQuality ) *timingQuality = 0;
 
+	Run *run = NULL;
+	size_t runIndex = 0;
+	Span span;
+
 	for(; it != records->end(); ++it) {
 		const Record* rec = it->get();
 		const Record* lastRec = lastIt->get();
@@ -327,6 +484,7 @@ void RecordPolyline::create(RecordSequence const *records,
 		}
 
 		if ( diff > tolerance || poly == NULL ) {
+			drawSpan(poly, span, yscl, amplOffset);
 			push_back(QPolygon());
 			poly = &back();
 		}
@@ -337,82 +495,35 @@ void RecordPolyline::create(RecordSequence const *records,
 		int x0 = int(pixelPerSecond*double(/*referenceTime*/refTime-rec->startTime()));
 		float dx = pixelPerSecond / rec->samplingFrequency();
 
-		int x_prev = -x0;
-		int y_prev = int(_baseline-yscl*(f[0]-amplOffset));
-		int y_min = y_prev;
-		int y_max = y_prev;
+		// Each pixel column should cover at least two buckets to keep
+		// the error of assigning a bucket to the column of its first
+		// sample below one pixel
+		if ( optimization && dx > 0 && dx*2*RecordPyramid::MinBucketSize <= 1 ) {
+			// Consecutive records are drawn together from the pyramid of
+			// their run
+			run = findRun(rec, run, runIndex, tolerance);
+			int begin = run->offsets[runIndex];
+			if ( span.run != run || span.end != begin ) {
+				drawSpan(poly, span, yscl, amplOffset);
+				span.run = run;
+				span.begin = begin;
+				span.dx = dx;
+				span.x0 = pixelPerSecond*double(refTime-rec->startTime());
+			}
 
-		int x_out = x_prev;
-		int y_out = y_prev;
+			span.end = begin + nsamp;
+			lastIt = it;
+			continue;
+		}
 
-		poly->append(QPoint(x_prev, y_prev));
+		drawSpan(poly, span, yscl, amplOffset);
 
-		if ( optimization ) {
-			for (int i = 1; i<nsamp; i++) {
-				int x_pos = int(i*dx) - x0;
-				int y_pos = int(_baseline-yscl*(f[i]-amplOffset));
+		Scale scale(dx, x0, _baseline, yscl, amplOffset);
 
-				if ( y_pos != y_out ) {
-					// last output differs from the last sample?
-					if ( x_out != x_prev  ) {
-						x_out = x_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
+		poly->append(QPoint(scale.x(0), scale.y(f[0])));
 
-					// last output differs from the current draw position?
-					if ( x_out != x_pos ) {
-						if ( y_min != y_out ) {
-							y_out = y_min;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_max != y_out ) {
-							y_out = y_max;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_prev != y_out ) {
-							y_out = y_prev;
-							poly->append(QPoint(x_out, y_out));
-						}
-
-						x_out = x_pos;
-
-						if ( y_pos != y_out ) {
-							y_out = y_pos;
-							poly->append(QPoint(x_out, y_pos));
-						}
-
-						y_min = y_max = y_out;
-					}
-					else {
-						// update y min/max range
-						if ( y_pos < y_min ) y_min = y_pos;
-						else if ( y_pos > y_max ) y_max = y_pos;
-					}
-				}
-				else {
-					if ( y_min != y_out ) {
-						y_out = y_min;
-						poly->append(QPoint(x_out, y_out));
-						y_min = y_out;
-					}
-					if ( y_max != y_out ) {
-						y_out = y_max;
-						poly->append(QPoint(x_out, y_out));
-						y_max = y_out;
-					}
-					if ( y_prev != y_out ) {
-						y_out = y_min = y_max = y_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
-				}
-
-				x_prev = x_pos;
-				y_prev = y_pos;
-			}
-
-			if ( x_out != x_prev )
-				poly->append(QPoint(x_prev, y_prev));
-		}
+		if ( optimization )
+			appendSamples(poly, scale, f, nsamp);
 		else {
 			for (int i = 1; i<nsamp; i++) {
 				int x_pos = int(i*dx) - x0;
@@ -427,6 +538,8 @@ void RecordPolyline::create(RecordSequence const *records,
 		lastIt = it;
 	}
 
+	drawSpan(poly, span, yscl, amplOffset);
+
 	if ( !empty() ) {
 		if ( skipCount )
 			front().remove(0, skipCount);
@@ -439,6 +552,8 @@ void RecordPolyline::create(RecordSequence const *records,
 
 	_tx = _ty = 0;
 
+	pruneRuns(records);
+
 	if ( timingQuality ) {
 		if ( timingQualityRecordCount )
 			*timingQuality /= timingQualityRecordCount;
@@ -485,6 +600,10 @@ void RecordPolyline::create(RecordSequence const *records,
 	int timingQualityRecordCount = 0;
 	if ( timingQuality ) *timingQuality = 0;
 
+	Run *run = NULL;
+	size_t runIndex = 0;
+	Span span;
+
 	for( ; it != records->end(); ++it ) {
 		const Record* rec = it->get();
 		const Record* lastRec = lastIt->get();
@@ -516,6 +635,7 @@ void RecordPolyline::create(RecordSequence const *records,
 		}
 
 		if ( diff > tolerance || poly == NULL ) {
+			drawSpan(poly, span, yscl, amplOffset);
 			push_back(QPolygon());
 			poly = &back();
 		}
@@ -526,9 +646,11 @@ void RecordPolyline::create(RecordSequence const *records,
 		double startOfs = double(start-rec->startTime());
 		double endOfs = double(rec->endTime()-end);
 
+		int sampleOfs = 0;
+
 		// Cut front samples
 		if ( startOfs > 0 ) {
-			int sampleOfs = (int)(startOfs * rec->samplingFrequency());
+			sampleOfs = (int)(startOfs * rec->samplingFrequency());
 			if ( sampleOfs >= nsamp ) continue;
 			f += sampleOfs;
 			nsamp -= sampleOfs;
@@ -544,82 +666,35 @@ void RecordPolyline::create(RecordSequence const *records,
 		int x0 = int(pixelPerSecond*startOfs);
 		float dx = pixelPerSecond / rec->samplingFrequency();
 
-		int x_prev = -x0;
-		int y_prev = int(_baseline-yscl*(f[0]-amplOffset));
-		int y_min = y_prev;
-		int y_max = y_prev;
+		// Each pixel column should cover at least two buckets to keep
+		// the error of assigning a bucket to the column of its first
+		// sample below one pixel
+		if ( optimization && dx > 0 && dx*2*RecordPyramid::MinBucketSize <= 1 ) {
+			// Consecutive records are drawn together from the pyramid of
+			// their run
+			run = findRun(rec, run, runIndex, tolerance);
+			int begin = run->offsets[runIndex] + sampleOfs;
+			if ( span.run != run || span.end != begin ) {
+				drawSpan(poly, span, yscl, amplOffset);
+				span.run = run;
+				span.begin = begin;
+				span.dx = dx;
+				span.x0 = pixelPerSecond*startOfs;
+			}
 
-		int x_out = x_prev;
-		int y_out = y_prev;
+			span.end = begin + nsamp;
+			lastIt = it;
+			continue;
+		}
 
-		poly->append(QPoint(x_prev, y_prev));
+		drawSpan(poly, span, yscl, amplOffset);
 
-		if ( optimization ) {
-			for (int i = 1; i<nsamp; i++) {
-				int x_pos = int(i*dx) - x0;
-				int y_pos = int(_baseline-yscl*(f[i]-amplOffset));
+		Scale scale(dx, x0, _baseline, yscl, amplOffset);
 
-				if ( y_pos != y_out ) {
-					// last output differs from the last sample?
-					if ( x_out != x_prev  ) {
-						x_out = x_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
+		poly->append(QPoint(scale.x(0), scale.y(f[0])));
 
-					// last output differs from the current draw position?
-					if ( x_out != x_pos ) {
-						if ( y_min != y_out ) {
-							y_out = y_min;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_max != y_out ) {
-							y_out = y_max;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_prev != y_out ) {
-							y_out = y_prev;
-							poly->append(QPoint(x_out, y_out));
-						}
-
-						x_out = x_pos;
-
-						if ( y_pos != y_out ) {
-							y_out = y_pos;
-							poly->append(QPoint(x_out, y_pos));
-						}
-
-						y_min = y_max = y_out;
-					}
-					else {
-						// update y min/max range
-						if ( y_pos < y_min ) y_min = y_pos;
-						else if ( y_pos > y_max ) y_max = y_pos;
-					}
-				}
-				else {
-					if ( y_min != y_out ) {
-						y_out = y_min;
-						poly->append(QPoint(x_out, y_out));
-						y_min = y_out;
-					}
-					if ( y_max != y_out ) {
-						y_out = y_max;
-						poly->append(QPoint(x_out, y_out));
-						y_max = y_out;
-					}
-					if ( y_prev != y_out ) {
-						y_out = y_min = y_max = y_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
-				}
-
-				x_prev = x_pos;
-				y_prev = y_pos;
-			}
-
-			if ( x_out != x_prev )
-				poly->append(QPoint(x_prev, y_prev));
-		}
+		if ( optimization )
+			appendSamples(poly, scale, f, nsamp);
 		else {
 			for (int i = 1; i<nsamp; i++) {
 				int x_pos = int(i*dx) - x0;
@@ -634,6 +709,8 @@ void RecordPolyline::create(RecordSequence const *records,
 		lastIt = it;
 	}
 
+	drawSpan(poly, span, yscl, amplOffset);
+
 	if ( !empty() ) {
 		if ( skipCount )
 			front().remove(0, skipCount);
@@ -646,6 +723,8 @@ void RecordPolyline::create(RecordSequence const *records,
 
 	_tx = _ty = 0;
 
+	pruneRuns(records);
+
 	if ( timingQuality ) {
 		if ( timingQualityRecordCount )
 			*timingQuality /= timingQualityRecordCount;
@@ -883,6 +962,135 @@ void RecordPolyline::draw(QPainter& p, int yofs, int height, const QColor& gapCo
 	drawGaps(p, yofs, height, gapColor, overlapColor);
 }
 
+RecordPolyline::Run *RecordPolyline::findRun(const Record *rec, Run *run,
+                                              size_t &index, double tolerance) {
+	if ( run != NULL ) {
+		if ( index+1 < run->records.size() ) {
+			if ( run->records[index+1].get() == rec ) {
+				++index;
+				return run;
+			}
+		}
+		else if ( rec->samplingFrequency() == run->samplingFrequency ) {
+			// Records are only appended if they do not shift against the
+			// first record of the run, drift does not accumulate
+			Core::Time expected = run->startTime +
+				Core::TimeSpan(run->pyramid->sampleCount() / run->samplingFrequency);
+			if ( fabs(double(rec->startTime() - expected)) <= tolerance ) {
+				const FloatArray *arr = (const FloatArray*)rec->data();
+				run->records.push_back(rec);
+				run->offsets.push_back(run->pyramid->sampleCount());
+				run->pyramid->append(arr->typedData(), arr->size());
+				++index;
+				return run;
+			}
+		}
+	}
+
+	for ( Runs::iterator it = _runs.begin(); it != _runs.end(); ++it ) {
+		std::vector<RecordCPtr>::iterator rit =
+			std::lower_bound(it->records.begin(), it->records.end(),
+			                 rec->startTime(), startsBefore);
+
+		for ( ; rit != it->records.end() && (*rit)->startTime() == rec->startTime(); ++rit ) {
+			if ( rit->get() == rec ) {
+				index = rit - it->records.begin();
+				return &*it;
+			}
+		}
+	}
+
+	const FloatArray *arr = (const FloatArray*)rec->data();
+
+	_runs.push_back(Run());
+	run = &_runs.back();
+	run->records.push_back(rec);
+	run->offsets.push_back(0);
+	run->startTime = rec->startTime();
+	run->samplingFrequency = rec->samplingFrequency();
+	run->pyramid = new RecordPyramid(arr->typedData(), arr->size());
+	index = 0;
+
+	return run;
+}
+
+void RecordPolyline::drawSpan(QPolygon *poly, Span &span, double yscl, float amplOffset) {
+	if ( span.run == NULL ) return;
+
+	Scale scale(span.dx, 0, _baseline, yscl, amplOffset, -span.x0);
+	RecordSamples f(span.run->records, span.run->offsets);
+	const RecordPyramid *pyr = span.run->pyramid.get();
+
+	poly->append(QPoint(scale.x(0), scale.y(f[span.begin])));
+	appendBuckets(poly, scale, f, span.begin, span.end - span.begin,
+	              pyr, pyr->findLevel(0.5 / span.dx));
+
+	span.run = NULL;
+}
+
+void RecordPolyline::pruneRuns(RecordSequence const *records) {
+	if ( _runs.empty() ) return;
+
+	std::vector<const Record*> present;
+	present.reserve(records->size());
+	for ( RecordSequence::const_iterator it = records->begin();
+	      it != records->end(); ++it )
+		present.push_back(it->get());
+	std::sort(present.begin(), present.end());
+
+	for ( Runs::iterator it = _runs.begin(); it != _runs.end(); ) {
+		Run &run = *it;
+
+		// Keep the first block of records that are still present
+		size_t first = 0;
+		while ( first < run.records.size() &&
+		        !std::binary_search(present.begin(), present.end(), run.records[first].get()) )
+			++first;
+
+		size_t last = first;
+		while ( last < run.records.size() &&
+		        std::binary_search(present.begin(), present.end(), run.records[last].get()) )
+			++last;
+
+		if ( first == last ) {
+			it = _runs.erase(it);
+			continue;
+		}
+
+		int dropped = run.offsets[first];
+
+		if ( last < run.records.size() || dropped > run.pyramid->sampleCount() / 2 ) {
+			// A pyramid cannot be shortened, it is rebuilt from the
+			// remaining records. Records removed from the front, e.g. of
+			// a ring buffer, are only released once they make up half
+			// of the pyramid.
+			Run rebuilt;
+			rebuilt.startTime = run.records[first]->startTime();
+			rebuilt.samplingFrequency = run.samplingFrequency;
+			rebuilt.pyramid = new RecordPyramid;
+
+			for ( size_t i = first; i < last; ++i ) {
+				const FloatArray *arr = (const FloatArray*)run.records[i]->data();
+				rebuilt.records.push_back(run.records[i]);
+				rebuilt.offsets.push_back(rebuilt.pyramid->sampleCount());
+				rebuilt.pyramid->append(arr->typedData(), arr->size());
+			}
+
+			run.records.swap(rebuilt.records);
+			run.offsets.swap(rebuilt.offsets);
+			run.startTime = rebuilt.startTime;
+			run.pyramid = rebuilt.pyramid;
+		}
+		else if ( first > 0 ) {
+			// The offsets keep referring to the samples of the pyramid
+			run.records.erase(run.records.begin(), run.records.begin() + first);
+			run.offsets.erase(run.offsets.begin(), run.offsets.begin() + first);
+		}
+
+		++it;
+	}
+}
+
 int RecordPolyline::baseline() const {
 	return _baseline;
 }
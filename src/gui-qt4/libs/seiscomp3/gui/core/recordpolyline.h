@@ -15,6 +15,7 @@
 #ifndef _RECORDPOLYLINE_H_
 #define _RECORDPOLYLINE_H_
 
+#include <list>
 #include <vector>
 
 #include <QPen>
@@ -25,6 +26,7 @@
 #include <seiscomp3/core/record.h>
 #include <seiscomp3/core/typedarray.h>
 #include <seiscomp3/core/recordsequence.h>
+#include <seiscomp3/gui/core/recordpyramid.h>
 #endif
 #include <seiscomp3/gui/qt4.h>
 
@@ -82,9 +84,46 @@ class SC_GUI_API RecordPolyline : public std::vector<QPolygon>
 
 	int baseline() const;
 
+  private:
+	//! Consecutive records of a trace without gaps and the min/max
+	//! pyramid of all their samples
+	struct Run {
+		std::vector<RecordCPtr> records;
+		//! The index of the first sample of each record in the pyramid
+		std::vector<int>        offsets;
+		Core::Time              startTime;
+		double                  samplingFrequency;
+		RecordPyramidPtr        pyramid;
+	};
+
+	//! The samples [begin,end) of a run that are drawn together
+	struct Span {
+		Span() : run(NULL), begin(0), end(0), dx(0), x0(0) {}
+
+		const Run *run;
+		int        begin, end;
+		float      dx;
+		//! The negative pixel position of the first sample
+		double     x0;
+	};
+
+	typedef std::list<Run> Runs;
+
+	//! Returns the run of a record and sets index to its position in
+	//! the run. The record is appended to the run it continues, runs are
+	//! created on demand.
+	Run *findRun(const Record *rec, Run *run, size_t &index, double tolerance);
+
+	//! Draws a pending span from the pyramid of its run
+	void drawSpan(QPolygon *poly, Span &span, double yscl, float amplOffset);
+
+	//! Removes the records and runs not part of the sequence anymore
+	void pruneRuns(RecordSequence const *);
+
   private:
 	int _tx, _ty;
 	int _baseline;
+	Runs _runs;
 };
 
 
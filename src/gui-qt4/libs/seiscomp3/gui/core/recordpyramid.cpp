@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+
+#include <seiscomp3/gui/core/recordpyramid.h>
+
+namespace Seiscomp {
+namespace Gui {
+
+
+RecordPyramid::RecordPyramid() : _count(0) {}
+
+
+RecordPyramid::RecordPyramid(const float *data, int count) : _count(0) {
+	append(data, count);
+}
+
+
+void RecordPyramid::append(const float *data, int count) {
+	if ( count <= 0 ) return;
+
+	if ( _levels.empty() ) _levels.resize(1);
+
+	// The first bucket of each level that covers appended samples
+	int from = _count / MinBucketSize;
+
+	// First level from the samples, an incomplete last bucket is continued
+	Buckets &first = _levels[0];
+
+	for ( int i = 0; i < count; ) {
+		int end = i + MinBucketSize - (_count + i) % MinBucketSize;
+		if ( end > count ) end = count;
+
+		float vmin = data[i], vmax = data[i];
+		for ( int j = i+1; j < end; ++j ) {
+			if ( data[j] < vmin ) vmin = data[j];
+			else if ( data[j] > vmax ) vmax = data[j];
+		}
+
+		if ( (_count + i) % MinBucketSize ) {
+			if ( vmin < first[first.size()-2] ) first[first.size()-2] = vmin;
+			if ( vmax > first[first.size()-1] ) first[first.size()-1] = vmax;
+		}
+		else {
+			first.push_back(vmin);
+			first.push_back(vmax);
+		}
+
+		i = end;
+	}
+
+	_count += count;
+
+	// Each following level merges two buckets of the previous one
+	for ( size_t l = 1; _levels[l-1].size() > 2; ++l ) {
+		if ( l == _levels.size() ) _levels.resize(l+1);
+
+		const Buckets &prev = _levels[l-1];
+		Buckets &buckets = _levels[l];
+		int prevCount = (int)prev.size() / 2;
+		int n = (prevCount + 1) / 2;
+
+		from /= 2;
+		buckets.resize(2*n);
+
+		for ( int i = from; i < n; ++i ) {
+			float vmin = prev[4*i];
+			float vmax = prev[4*i + 1];
+
+			if ( 2*i+1 < prevCount ) {
+				if ( prev[4*i + 2] < vmin ) vmin = prev[4*i + 2];
+				if ( prev[4*i + 3] > vmax ) vmax = prev[4*i + 3];
+			}
+
+			buckets[2*i] = vmin;
+			buckets[2*i + 1] = vmax;
+		}
+	}
+}
+
+
+int RecordPyramid::sampleCount() const {
+	return _count;
+}
+
+
+int RecordPyramid::levels() const {
+	return (int)_levels.size();
+}
+
+
+int RecordPyramid::bucketSize(int level) const {
+	return MinBucketSize << level;
+}
+
+
+int RecordPyramid::bucketCount(int level) const {
+	return (int)_levels[level].size() / 2;
+}
+
+
+const float *RecordPyramid::buckets(int level) const {
+	return &_levels[level][0];
+}
+
+
+int RecordPyramid::findLevel(double maxBucketSize) const {
+	int level = -1;
+
+	for ( int i = 0; i < levels(); ++i ) {
+		if ( bucketSize(i) > maxBucketSize ) break;
+		level = i;
+	}
+
+	return level;
+}
+
+
+}
+}
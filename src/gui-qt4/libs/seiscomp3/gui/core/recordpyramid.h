@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+
+#ifndef __SEISCOMP_GUI_CORE_RECORDPYRAMID_H__
+#define __SEISCOMP_GUI_CORE_RECORDPYRAMID_H__
+
+#include <vector>
+
+#ifndef Q_MOC_RUN
+#include <seiscomp3/core/baseobject.h>
+#endif
+#include <seiscomp3/gui/qt4.h>
+
+
+namespace Seiscomp {
+namespace Gui {
+
+
+DEFINE_SMARTPOINTER(RecordPyramid);
+
+/**
+ * Minimum and maximum values of a continuous series of samples in buckets
+ * of power-of-two size. Level 0 holds buckets of MinBucketSize samples,
+ * each following level doubles the bucket size until a single bucket
+ * covers all samples. The last bucket of each level may be incomplete.
+ * Samples can be appended, e.g. those of the next record of a trace,
+ * which only updates the buckets they fall into.
+ */
+class SC_GUI_API RecordPyramid : public Core::BaseObject {
+	public:
+		enum { MinBucketSize = 16 };
+
+	public:
+		RecordPyramid();
+		RecordPyramid(const float *data, int count);
+
+	public:
+		//! Appends samples
+		void append(const float *data, int count);
+
+		//! Returns the number of samples
+		int sampleCount() const;
+
+		//! Returns the number of levels
+		int levels() const;
+
+		//! Returns the number of samples per bucket of a level
+		int bucketSize(int level) const;
+
+		//! Returns the number of buckets of a level
+		int bucketCount(int level) const;
+
+		//! Returns the interleaved minimum and maximum values of the
+		//! buckets of a level
+		const float *buckets(int level) const;
+
+		//! Returns the level with the largest bucket size not exceeding
+		//! maxBucketSize or -1 if even the first level exceeds it
+		int findLevel(double maxBucketSize) const;
+
+	private:
+		typedef std::vector<float> Buckets;
+
+		std::vector<Buckets> _levels;
+		int                  _count;
+};
+
+
+}
+}
+
+
+#endif
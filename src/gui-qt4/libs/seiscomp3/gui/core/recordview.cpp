@@ -855,23 +855,35 @@ bool RecordView::feed(const Seiscomp::Record *rec) {
 		return false;
 	}
 
-	DataModel::WaveformStreamID streamID(rec->networkCode(), rec->stationCode(),
-	                                     rec->locationCode(), rec->channelCode(), "");
-	QString stationCode = rec->stationCode().c_str();
+	int handle = rec->streamHandle();
+	RecordViewItem* child = handle < _itemIndex.size() ? _itemIndex[handle] : NULL;
 
-	RecordViewItem* child = item(streamID);
 	if ( !child ) {
-		if ( _autoInsertItems ) {
-			child = addItem(streamID, stationCode);
-			if ( !child ) return false;
-			/*
-			std::cout << " starting at " << rec->startTime().toString("%F %T")
-			          << std::endl;
-			*/
-			emit addedItem(rec, child);
+		DataModel::WaveformStreamID streamID(rec->networkCode(), rec->stationCode(),
+		                                     rec->locationCode(), rec->channelCode(), "");
+
+		child = item(streamID);
+		if ( !child ) {
+			if ( _autoInsertItems ) {
+				QString stationCode = rec->stationCode().c_str();
+				child = addItem(streamID, stationCode);
+				if ( !child ) return false;
+				/*
+				std::cout << " starting at " << rec->startTime().toString("%F %T")
+				          << std::endl;
+				*/
+				emit addedItem(rec, child);
+			}
+			else
+				return false;
+		}
+
+		// Slots connected to addedItem could have removed the item again
+		if ( child->recordView() == this ) {
+			if ( handle >= _itemIndex.size() )
+				_itemIndex.resize(handle+1);
+			_itemIndex[handle] = child;
 		}
-		else
-			return false;
 	}
 
 	if ( child->feed(rec) ) {
@@ -1170,6 +1182,10 @@ bool RecordView::takeItem(RecordViewItem* item) {
 	if ( row < _rows.size()-1 )
 		offset = _rows[row+1]->pos().y() - item->pos().y();
 
+	// Drop all handles resolved to this item
+	for ( ItemIndex::iterator it = _itemIndex.begin(); it != _itemIndex.end(); ++it )
+		if ( *it == item ) *it = NULL;
+
 	if ( !_items.remove(item->streamID()) ) {
 		SEISCOMP_ERROR("Could not remove item '%s.%s.%s.%s' from ItemMap", item->streamID().networkCode().c_str(),
 		                                                                   item->streamID().stationCode().c_str(),
@@ -1253,6 +1269,9 @@ bool RecordView::addItem(RecordViewItem* item) {
 	item->show();
 	item->_row = rowCount();
 	_items[item->_widget->streamID()] = item;
+	// A new item can take precedence over a wildcard item a handle has
+	// been resolved to before
+	_itemIndex.clear();
 	_rows.push_back(item);
 	item->_parent = this;
 
@@ -1298,6 +1317,7 @@ void RecordView::clear() {
 		delete item;
 
 	_items.clear();
+	_itemIndex.clear();
 	_rows.clear();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -508,6 +508,7 @@ class SC_GUI_API RecordView : public QWidget {
 		};
 
 		typedef QMap<DataModel::WaveformStreamID, RecordViewItem*> Items;
+		typedef QVector<RecordViewItem*> ItemIndex;
 		typedef QVector<RecordViewItem*> Rows;
 		typedef QSet<RecordViewItem*> SelectionList;
 
@@ -533,6 +534,8 @@ class SC_GUI_API RecordView : public QWidget {
 		Seiscomp::Core::TimeSpan _timeSpan;
 
 		Items _items;
+		//! Items indexed by stream handle to dispatch fed records
+		ItemIndex _itemIndex;
 		Rows _rows;
 		Core::Time _alignment;
 
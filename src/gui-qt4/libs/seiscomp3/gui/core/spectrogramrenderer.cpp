@@ -14,6 +14,9 @@
 
 #include <seiscomp3/gui/core/spectrogramrenderer.h>
 
+#include <QRunnable>
+#include <QWidget>
+
 
 namespace Seiscomp {
 namespace Gui {
@@ -22,6 +25,21 @@ namespace Gui {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+struct SpectrogramRenderer::Worker : public QRunnable {
+	Worker(SpectrogramRenderer *r) : renderer(r) {}
+
+	void run() {
+		renderer->process();
+	}
+
+	SpectrogramRenderer *renderer;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 SpectrogramRenderer::SpectrogramRenderer() {
 	_tmin = _tmax = 0;
@@ -45,6 +63,24 @@ SpectrogramRenderer::SpectrogramRenderer() {
 	_dirty = false;
 
 	_renderedFmin = _renderedFmax = -1;
+
+	_sequence = NULL;
+	_updateWidget = NULL;
+	_busy = false;
+	_abort = false;
+
+	// Not the global pool which is used by blocking renderers, e.g. the
+	// map projections. A renderer only runs one worker at a time.
+	_workers.setMaxThreadCount(1);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SpectrogramRenderer::~SpectrogramRenderer() {
+	stop();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -77,12 +113,12 @@ void SpectrogramRenderer::setGradient(const Gradient &gradient) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool SpectrogramRenderer::setOptions(const IO::Spectralizer::Options &opts) {
-	if ( !_spectralizer )
-		_spectralizer = new IO::Spectralizer;
-
 	// Reset data
 	reset();
 
+	if ( !_spectralizer )
+		_spectralizer = new IO::Spectralizer;
+
 	_options = opts;
 	return _spectralizer->setOptions(_options);
 }
@@ -120,8 +156,13 @@ void SpectrogramRenderer::setGradientRange(double lowerBound, double upperBound)
 void SpectrogramRenderer::reset() {
 	if ( !_spectralizer ) return;
 
+	// The spectralizer must not be replaced while the worker uses it
+	stop();
+
 	_spectra.clear();
 	_images.clear();
+	_sequence = NULL;
+	_lastEndTime = Core::Time();
 
 	_spectralizer = new IO::Spectralizer;
 	_spectralizer->setOptions(_options);
@@ -147,24 +188,17 @@ bool SpectrogramRenderer::feed(const Record *rec) {
 	if ( _timeWindow.endTime().valid() && rec->startTime() >= _timeWindow.endTime() )
 		return false;
 
-	if ( _spectralizer->push(rec) ) {
-		IO::SpectrumPtr spec;
+	const Array *data = rec->data();
+	if ( data == NULL ) return false;
 
-		while ( (spec = _spectralizer->pop()) ) {
-			if ( !spec->isValid() ) continue;
+	// Reference counts are not thread-safe, the worker gets its own copy
+	GenericRecord *copy = new GenericRecord(*rec);
+	copy->setData(data->clone());
 
-			// Deconvolution
-			if ( _transferFunction ) {
-				Seiscomp::ComplexDoubleArray *data = spec->data();
-				double df = spec->maximumFrequency() / (data->size()-1);
-				_transferFunction->deconvolve(data->size()-1, data->typedData()+1, df, df);
-			}
+	if ( !_lastEndTime.valid() || rec->endTime() > _lastEndTime )
+		_lastEndTime = rec->endTime();
 
-			_spectra.push_back(spec);
-			addSpectrum(spec.get());
-			setDirty();
-		}
-	}
+	schedule(copy);
 
 	return true;
 }
@@ -182,8 +216,6 @@ bool SpectrogramRenderer::feedSequence(const RecordSequence *seq) {
 	for ( it = seq->begin(); it != seq->end(); ++it )
 		if ( feed(it->get()) ) result = true;
 
-	setDirty();
-
 	return result;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -193,8 +225,31 @@ bool SpectrogramRenderer::feedSequence(const RecordSequence *seq) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SpectrogramRenderer::setRecords(const RecordSequence *seq) {
+	if ( (seq == NULL) || seq->empty() ) {
+		reset();
+		return;
+	}
+
+	Core::Time startTime = seq->front()->startTime();
+
+	// Continue with the records that have not yet been fed
+	if ( (seq == _sequence) && (startTime == _sequenceStartTime) &&
+	     _lastEndTime.valid() ) {
+		Core::Time lastEndTime = _lastEndTime;
+		RecordSequence::const_iterator it;
+		for ( it = seq->begin(); it != seq->end(); ++it ) {
+			if ( (*it)->endTime() > lastEndTime )
+				feed(it->get());
+		}
+
+		return;
+	}
+
 	reset();
 	feedSequence(seq);
+
+	_sequence = seq;
+	_sequenceStartTime = startTime;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -227,6 +282,8 @@ void SpectrogramRenderer::setTimeRange(double tmin, double tmax) {
 void SpectrogramRenderer::setTimeWindow(const Core::TimeWindow& tw) {
 	_timeWindow = tw;
 
+	collect();
+
 	// Trim spectra
 	if ( _timeWindow.startTime().valid() || _timeWindow.endTime().valid() ) {
 		Spectra::iterator it;
@@ -296,6 +353,8 @@ void SpectrogramRenderer::setLogScale(bool f) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SpectrogramRenderer::setTransferFunction(Math::Restitution::FFT::TransferFunction *tf) {
+	// The worker deconvolves with the current transfer function
+	wait();
 	_transferFunction = tf;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -303,6 +362,27 @@ void SpectrogramRenderer::setTransferFunction(Math::Restitution::FFT::TransferFu
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::setUpdateWidget(QWidget *widget) {
+	_updateWidget = widget;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SpectrogramRenderer::isDirty() const {
+	if ( _dirty ) return true;
+
+	QMutexLocker locker(&_mutex);
+	return !_computed.empty();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SpectrogramRenderer::setDirty() {
 	_dirty = true;
@@ -312,10 +392,149 @@ void SpectrogramRenderer::setDirty() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::schedule(Record *rec) {
+	QMutexLocker locker(&_mutex);
+
+	_pending.push_back(rec);
+
+	if ( !_busy ) {
+		_busy = true;
+		_workers.start(new Worker(this));
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::stop() {
+	QMutexLocker locker(&_mutex);
+
+	_abort = true;
+	while ( _busy )
+		_idle.wait(&_mutex);
+	_abort = false;
+
+	for ( Records::iterator it = _pending.begin(); it != _pending.end(); ++it )
+		delete *it;
+	_pending.clear();
+
+	for ( ComputedSpectra::iterator it = _computed.begin(); it != _computed.end(); ++it )
+		delete *it;
+	_computed.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::wait() {
+	QMutexLocker locker(&_mutex);
+	while ( _busy )
+		_idle.wait(&_mutex);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::process() {
+	_mutex.lock();
+
+	while ( !_abort && !_pending.empty() ) {
+		RecordPtr rec = _pending.front();
+		_pending.pop_front();
+		_mutex.unlock();
+
+		ComputedSpectra spectra;
+
+		if ( _spectralizer->push(rec.get()) ) {
+			IO::Spectrum *spec;
+
+			while ( (spec = _spectralizer->pop()) ) {
+				if ( !spec->isValid() ) {
+					delete spec;
+					continue;
+				}
+
+				// Deconvolution
+				if ( _transferFunction ) {
+					Seiscomp::ComplexDoubleArray *data = spec->data();
+					double df = spec->maximumFrequency() / (data->size()-1);
+					_transferFunction->deconvolve(data->size()-1, data->typedData()+1, df, df);
+				}
+
+				spectra.push_back(spec);
+			}
+		}
+
+		rec = NULL;
+
+		_mutex.lock();
+
+		if ( spectra.empty() ) continue;
+
+		// Only the first pending spectra trigger an update, the following
+		// ones are collected by the same render call
+		bool notify = _computed.empty();
+		_computed.insert(_computed.end(), spectra.begin(), spectra.end());
+
+		if ( notify && (_updateWidget != NULL) )
+			QMetaObject::invokeMethod(_updateWidget, "update", Qt::QueuedConnection);
+	}
+
+	_busy = false;
+	_idle.wakeAll();
+	_mutex.unlock();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SpectrogramRenderer::collect() {
+	ComputedSpectra spectra;
+
+	_mutex.lock();
+	spectra.swap(_computed);
+	_mutex.unlock();
+
+	for ( ComputedSpectra::iterator it = spectra.begin(); it != spectra.end(); ++it ) {
+		IO::Spectrum *spec = *it;
+
+		// Clipped by a time window set while the spectrum was computed
+		if ( _timeWindow.startTime().valid() && spec->endTime() <= _timeWindow.startTime() ) {
+			delete spec;
+			continue;
+		}
+
+		if ( _timeWindow.endTime().valid() && spec->startTime() >= _timeWindow.endTime() ) {
+			delete spec;
+			continue;
+		}
+
+		_spectra.push_back(spec);
+
+		// A dirty spectrogram is rebuilt from all spectra anyway
+		if ( !_dirty ) addSpectrum(spec);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SpectrogramRenderer::renderSpectrogram() {
 	Spectra::iterator it;
 
+	collect();
+
 	_images.clear();
 
 	for ( it = _spectra.begin(); it != _spectra.end(); ++it )
@@ -340,6 +559,7 @@ void SpectrogramRenderer::addSpectrum(IO::Spectrum *spec) {
 		img.dt = spec->dt();
 
 		img.data = QImage(1, data->size(), _imageFormat);
+		img.columns = 1;
 
 		fillRow(img.data, data, spec->maximumFrequency(), 0);
 
@@ -352,7 +572,7 @@ void SpectrogramRenderer::addSpectrum(IO::Spectrum *spec) {
 		// Do more checks on gaps and so on
 
 		double dt = (double)img.dt;
-		Core::Time currentEndTime = img.startTime + Core::TimeSpan(img.data.width()*dt);
+		Core::Time currentEndTime = img.startTime + Core::TimeSpan(img.columns*dt);
 
 		bool needNewImage = (fabs((double)(newTime - currentEndTime)) > dt*0.5)
 		                 || (img.data.height() != data->size())
@@ -369,17 +589,21 @@ void SpectrogramRenderer::addSpectrum(IO::Spectrum *spec) {
 			newImg.dt = spec->dt();
 
 			newImg.data = QImage(1, data->size(), _imageFormat);
+			newImg.columns = 1;
 			fillRow(newImg.data, data, spec->maximumFrequency(), 0);
 
 			_images.append(newImg);
 		}
 		else {
-			// Extent image by one column
-			int col = img.data.width();
-			img.data = img.data.copy(0,0,col+1,img.data.height());
+			// Extent image by one column. The image is reallocated with
+			// twice the width if full to keep appending linear.
+			int col = img.columns;
+			if ( col >= img.data.width() )
+				img.data = img.data.copy(0,0,col*2,img.data.height());
 
 			// Fill colors for column
 			fillRow(img.data, data, spec->maximumFrequency(), col);
+			++img.columns;
 		}
 	}
 }
@@ -546,6 +770,8 @@ void SpectrogramRenderer::render(QPainter &p, const QRect &rect,
 	if ( (h <= 0) || (w <= 0) ) return;
 
 	if ( _dirty ) renderSpectrogram();
+	else collect();
+
 	if ( _images.empty() ) return;
 
 	if ( !_fmax ) {
@@ -606,7 +832,7 @@ void SpectrogramRenderer::render(QPainter &p, const QRect &rect,
 		if ( img.maximumFrequency <= fmin ) continue;
 
 		Core::Time startTime = img.startTime - Core::TimeSpan((double)img.dt*0.5);
-		Core::Time endTime   = startTime + Core::TimeSpan((double)img.dt * img.data.width());
+		Core::Time endTime   = startTime + Core::TimeSpan((double)img.dt * img.columns);
 
 		// Clip by start time
 		if ( startTime >= t1 ) continue;
@@ -653,7 +879,7 @@ void SpectrogramRenderer::render(QPainter &p, const QRect &rect,
 				sy1 = (int)((1.0-(img.maximumFrequency-fmax)/ifw) * img.data.height());
 		}
 
-		QRect sourceRect(0,img.data.height()-sy1,img.data.width(),sy1-sy0),
+		QRect sourceRect(0,img.data.height()-sy1,img.columns,sy1-sy0),
 		      targetRect(rect.left()+ix0,rect.top()+h-ty1,ix1-ix0,ty1-ty0);
 
 		p.drawImage(targetRect, img.data, sourceRect);
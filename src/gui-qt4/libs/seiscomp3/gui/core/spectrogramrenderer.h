@@ -23,19 +23,32 @@
 #endif
 #include <seiscomp3/gui/core/lut.h>
 
+#include <QMutex>
 #include <QPainter>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <deque>
 
 
 namespace Seiscomp {
 namespace Gui {
 
 
+/**
+ * \brief Renders the spectrogram of a stream.
+ *
+ * Fed records are copied and the spectra are computed in the background
+ * by the global thread pool. Computed spectra are kept as long as the
+ * options do not change and are picked up by the next call to render.
+ */
 class SC_GUI_API SpectrogramRenderer {
 	// ----------------------------------------------------------------------
 	//  Public types
 	// ----------------------------------------------------------------------
 	public:
 		SpectrogramRenderer();
+		~SpectrogramRenderer();
 
 
 	// ----------------------------------------------------------------------
@@ -67,7 +80,9 @@ class SC_GUI_API SpectrogramRenderer {
 		bool feed(const Record *rec);
 		bool feedSequence(const RecordSequence *seq);
 
-		//! Resets the view and feeds the sequence
+		//! Resets the view and feeds the sequence. If the sequence has
+		//! already been fed since the last reset only the records that
+		//! were added since then are fed.
 		void setRecords(const RecordSequence *seq);
 
 		void setAlignment(const Core::Time &align);
@@ -93,7 +108,12 @@ class SC_GUI_API SpectrogramRenderer {
 		//! Sets the transfer function for deconvolution
 		void setTransferFunction(Math::Restitution::FFT::TransferFunction *tf);
 
-		bool isDirty() const { return _dirty; }
+		//! Sets the widget that is updated when spectra that have been
+		//! computed in the background become available
+		void setUpdateWidget(QWidget *widget);
+
+		//! Returns whether the spectrogram needs to be rendered again
+		bool isDirty() const;
 
 		//! Creates the spectrogram. This is usually done in render if the
 		//! spectrogram is dirty but can called from outside.
@@ -112,8 +132,26 @@ class SC_GUI_API SpectrogramRenderer {
 	//  Private Interface
 	// ----------------------------------------------------------------------
 	private:
+		struct Worker;
+
 		void setDirty();
 		void addSpectrum(IO::Spectrum *);
+
+		//! Queues a record for the worker and starts it if required
+		void schedule(Record *rec);
+
+		//! Aborts the worker, waits for it and drops all queued records
+		//! and spectra
+		void stop();
+
+		//! Waits until all queued records have been processed
+		void wait();
+
+		//! Called from the worker thread to process all queued records
+		void process();
+
+		//! Appends all spectra computed by the worker
+		void collect();
 		void fillRow(QImage &img, Seiscomp::ComplexDoubleArray *spec,
 		             double maxFreq, int column);
 
@@ -125,7 +163,10 @@ class SC_GUI_API SpectrogramRenderer {
 		typedef QList<IO::SpectrumPtr> Spectra;
 
 		struct SpecImage {
+			//! The image is extended by doubling its width, columns is
+			//! the number of columns in use
 			QImage         data;
+			int            columns;
 			Core::Time     startTime;
 			Core::TimeSpan dt;
 			double         minimumFrequency;
@@ -133,6 +174,8 @@ class SC_GUI_API SpectrogramRenderer {
 		};
 
 		typedef QList<SpecImage> SpecImageList;
+		typedef std::deque<Record*> Records;
+		typedef std::deque<IO::Spectrum*> ComputedSpectra;
 		typedef StaticColorLUT<512> Gradient512;
 		typedef Math::Restitution::FFT::TransferFunctionPtr TransferFunctionPtr;
 
@@ -154,6 +197,22 @@ class SC_GUI_API SpectrogramRenderer {
 		bool                      _dirty;
 		double                    _renderedFmin;
 		double                    _renderedFmax;
+
+		const RecordSequence     *_sequence;
+		Core::Time                _sequenceStartTime;
+		Core::Time                _lastEndTime;
+		QWidget                  *_updateWidget;
+
+		mutable QMutex            _mutex;
+		QWaitCondition            _idle;
+		Records                   _pending;
+		ComputedSpectra           _computed;
+		bool                      _busy;
+		bool                      _abort;
+
+		// Declared last to wait for a running worker before the other
+		// members are destroyed
+		QThreadPool               _workers;
 };
 
 
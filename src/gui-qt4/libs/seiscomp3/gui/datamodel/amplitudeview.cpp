@@ -5520,7 +5520,7 @@ void AmplitudeView::acquisitionFinished() {
 void AmplitudeView::acquireStreams() {
 	if ( _nextStreams.empty() ) return;
 
-	RecordStreamThread *t = new RecordStreamThread(_config.recordURL.toStdString());
+	RecordStreamThread *t = new RecordStreamThread(SCApp->cachedRecordStreamURL(_config.recordURL.toStdString()));
 
 	if ( !t->connect() ) {
 		if ( _config.recordURL != _lastRecordURL ) {
@@ -110,7 +110,7 @@ void CalculateAmplitudes::setStreamURL(const string& streamURL) {
 
 	_ui.source->setText(streamURL.c_str());
 
-	_thread = new RecordStreamThread(streamURL);
+	_thread = new RecordStreamThread(SCApp->cachedRecordStreamURL(streamURL));
 	connect(_thread, SIGNAL(receivedRecord(Seiscomp::Record*)),
 	        this, SLOT(receivedRecord(Seiscomp::Record*)));
 	connect(_thread, SIGNAL(finished()),
@@ -42,6 +42,8 @@
 #include <seiscomp3/io/archive/binarchive.h>
 #include <seiscomp3/seismology/regions.h>
 
+#include <algorithm>
+
 
 using namespace Seiscomp::Core;
 using namespace Seiscomp::Client;
@@ -1864,6 +1866,458 @@ struct ConfigProcessColumn {
 };
 
 
+//! Registers objects which have been created while the registration
+//! was disabled, e.g. in the EventLoader thread.
+class ObjectRegistrar : public Visitor {
+	public:
+		ObjectRegistrar() : Visitor(TM_TOPDOWN) {}
+
+		bool visit(PublicObject *po) {
+			// Setting the publicID again registers the object unless
+			// another object with the same publicID exists already
+			if ( !po->registered() )
+				po->setPublicID(po->publicID());
+			return true;
+		}
+
+		void visit(Object *) {}
+};
+
+
+//! The objects read by the EventLoader for one time slice
+struct EventBatch {
+	std::vector<EventPtr>          events;
+	std::vector<OriginPtr>         origins;
+	std::vector<OriginPtr>         unassociatedOrigins;
+	std::vector<FocalMechanismPtr> focalMechanisms;
+	std::vector<MagnitudePtr>      magnitudes;
+
+	bool empty() const {
+		return events.empty() && unassociatedOrigins.empty();
+	}
+
+	//! Registers all objects. This must be called from the thread
+	//! that uses the objects afterwards.
+	void registerObjects() {
+		ObjectRegistrar registrar;
+		for ( size_t i = 0; i < events.size(); ++i )
+			events[i]->accept(&registrar);
+		for ( size_t i = 0; i < origins.size(); ++i )
+			origins[i]->accept(&registrar);
+		for ( size_t i = 0; i < focalMechanisms.size(); ++i )
+			focalMechanisms[i]->accept(&registrar);
+		for ( size_t i = 0; i < magnitudes.size(); ++i )
+			magnitudes[i]->accept(&registrar);
+	}
+};
+
+
+//! Sorts events by the time of their preferred origins, most recent first
+class MoreRecentEvent {
+	public:
+		MoreRecentEvent(const std::map<std::string, Origin*> &origins)
+		: _origins(origins) {}
+
+		bool operator()(const EventPtr &left, const EventPtr &right) const {
+			return time(left.get()) > time(right.get());
+		}
+
+	private:
+		Core::Time time(Event *event) const {
+			std::map<std::string, Origin*>::const_iterator it;
+			it = _origins.find(event->preferredOriginID());
+			if ( it == _origins.end() ) return Core::Time();
+			return it->second->time().value();
+		}
+
+	private:
+		const std::map<std::string, Origin*> &_origins;
+};
+
+
+/**
+ * Reads the events of a time window with set based queries. The time
+ * window is split into slices starting with the most recent events where
+ * each slice is twice as long as the previous one. Every slice is queued
+ * as EventBatch and the queued slot "start" of the receiver is invoked.
+ * When running as thread an own database connection is opened and all
+ * objects are created with disabled registration. They are registered
+ * with EventBatch::registerObjects when taken out of the queue.
+ */
+class EventLoader : public QThread {
+	public:
+		EventLoader(QObject *receiver, bool withOrigins,
+		            bool withFocalMechanisms, bool withOriginComments)
+		: _receiver(receiver), _withOrigins(withOrigins),
+		  _withFocalMechanisms(withFocalMechanisms),
+		  _withOriginComments(withOriginComments),
+		  _slices(0), _running(false), _abort(false) {}
+
+		~EventLoader() {
+			stop();
+			clear();
+		}
+
+
+	public:
+		//! Starts reading in the background
+		void start(const std::string &databaseURI,
+		           const EventListView::Filter &filter) {
+			stop();
+			clear();
+
+			_databaseURI = databaseURI;
+			_filter = filter;
+			_slices = 0;
+			_abort = false;
+			_running = true;
+
+			QThread::start();
+		}
+
+		//! Reads all events in the calling thread
+		void read(DatabaseQuery *query, const EventListView::Filter &filter) {
+			stop();
+			clear();
+
+			_slices = 0;
+			_abort = false;
+			readSlices(query, filter);
+		}
+
+		//! Aborts reading and waits for the thread to finish
+		void stop() {
+			_mutex.lock();
+			_abort = true;
+			_mutex.unlock();
+			wait();
+		}
+
+		//! Removes all queued batches
+		void clear() {
+			QMutexLocker locker(&_mutex);
+			while ( !_batches.isEmpty() )
+				delete _batches.dequeue();
+		}
+
+		//! Returns the next batch or NULL. The ownership goes to the caller.
+		EventBatch *take() {
+			QMutexLocker locker(&_mutex);
+			return _batches.isEmpty() ? NULL : _batches.dequeue();
+		}
+
+		bool hasBatches() const {
+			QMutexLocker locker(&_mutex);
+			return !_batches.isEmpty();
+		}
+
+		//! Returns whether the thread is still reading
+		bool isReading() const {
+			QMutexLocker locker(&_mutex);
+			return _running;
+		}
+
+		//! Blocks until the query of the most recent slice has finished,
+		//! even if it did not return any events, or the thread has
+		//! finished. Returns whether a batch is available.
+		bool waitForFirstSlice() {
+			QMutexLocker locker(&_mutex);
+			while ( _slices == 0 && _running )
+				_batchAvailable.wait(&_mutex);
+			return !_batches.isEmpty();
+		}
+
+
+	protected:
+		void run() {
+			// Disable object registration and notifiers only in this thread
+			PublicObject::SetRegistrationEnabled(false);
+			Notifier::Disable();
+
+			IO::DatabaseInterfacePtr db = IO::DatabaseInterface::Open(_databaseURI.c_str());
+			if ( db == NULL )
+				SEISCOMP_ERROR("[event loader] opening database %s failed",
+				               _databaseURI.c_str());
+			else {
+				DatabaseQuery query(db.get());
+				query.setPublicObjectCacheLookupEnabled(false);
+				readSlices(&query, _filter);
+			}
+
+			QMutexLocker locker(&_mutex);
+			_running = false;
+			_batchAvailable.wakeAll();
+		}
+
+
+	private:
+		bool isAborted() const {
+			QMutexLocker locker(&_mutex);
+			return _abort;
+		}
+
+		void push(EventBatch *batch) {
+			_mutex.lock();
+			_batches.enqueue(batch);
+			++_slices;
+			_batchAvailable.wakeAll();
+			_mutex.unlock();
+
+			QMetaObject::invokeMethod(_receiver, "start", Qt::QueuedConnection);
+		}
+
+		void readSlices(DatabaseQuery *query, const EventListView::Filter &filter) {
+			// Objects at the slice borders are returned twice
+			std::set<std::string> seen;
+			EventListView::Filter slice(filter);
+			Core::TimeSpan length(6*3600, 0);
+
+			while ( !isAborted() ) {
+				slice.startTime = slice.endTime - length;
+				if ( slice.startTime < filter.startTime )
+					slice.startTime = filter.startTime;
+
+				EventBatch *batch = readSlice(query, slice, seen);
+				if ( batch == NULL ) break;
+
+				if ( batch->empty() ) {
+					delete batch;
+					_mutex.lock();
+					++_slices;
+					_batchAvailable.wakeAll();
+					_mutex.unlock();
+				}
+				else
+					push(batch);
+
+				if ( slice.startTime <= filter.startTime ) break;
+
+				slice.endTime = slice.startTime;
+				length += length;
+			}
+		}
+
+		EventBatch *readSlice(DatabaseQuery *query, const EventListView::Filter &filter,
+		                      std::set<std::string> &seen) {
+			EventBatch *batch = new EventBatch;
+
+			QMap<int, EventPtr> eventIDs;
+			QMap<int, OriginPtr> originIDs;
+			QMap<int, FocalMechanismPtr> fmIDs;
+			std::map<std::string, Origin*> origins;
+
+			EventPtr event;
+			DatabaseIterator it = getEvents(query, filter);
+			while ( (event = static_cast<Event*>(*it)) != NULL ) {
+				if ( isAborted() ) break;
+
+				if ( seen.insert(event->publicID()).second ) {
+					batch->events.push_back(event);
+					eventIDs[it.oid()] = event;
+				}
+
+				++it;
+			}
+			it.close();
+
+			// Read comments
+			CommentPtr comment;
+			it = getComments4Events(query, filter);
+			while ( (comment = Comment::Cast(*it)) != NULL ) {
+				if ( isAborted() ) break;
+				EventPtr evt = eventIDs.value(it.parentOid());
+				if ( evt ) evt->add(comment.get());
+				++it;
+			}
+			it.close();
+
+			if ( _withOrigins ) {
+				OriginReferencePtr oref;
+				it = getEventOriginReferences(query, filter);
+				while ( (oref = static_cast<OriginReference*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+					EventPtr evt = eventIDs.value(it.parentOid());
+					if ( evt ) evt->add(oref.get());
+					++it;
+				}
+				it.close();
+
+				OriginPtr origin;
+				it = getEventOrigins(query, filter);
+				while ( (origin = static_cast<Origin*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+
+					if ( seen.insert(origin->publicID()).second ) {
+						batch->origins.push_back(origin);
+						originIDs[it.oid()] = origin;
+						origins[origin->publicID()] = origin.get();
+					}
+
+					++it;
+				}
+				it.close();
+
+				it = getUnassociatedOrigins(query, filter);
+				while ( (origin = static_cast<Origin*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+
+					if ( seen.insert(origin->publicID()).second ) {
+						batch->origins.push_back(origin);
+						batch->unassociatedOrigins.push_back(origin);
+						originIDs[it.oid()] = origin;
+						origins[origin->publicID()] = origin.get();
+					}
+
+					++it;
+				}
+				it.close();
+
+				// Fetch comments for relevant origins (marker for publishing)
+				it = getComments4Origins(query, filter);
+				while ( (comment = Comment::Cast(*it)) != NULL ) {
+					if ( isAborted() ) break;
+					OriginPtr org = originIDs.value(it.parentOid());
+					if ( org ) org->add(comment.get());
+					++it;
+				}
+				it.close();
+			}
+
+			if ( _withFocalMechanisms ) {
+				FocalMechanismReferencePtr fmref;
+				it = getEventFocalMechanismReferences(query, filter);
+				while ( (fmref = static_cast<FocalMechanismReference*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+					EventPtr evt = eventIDs.value(it.parentOid());
+					if ( evt ) evt->add(fmref.get());
+					++it;
+				}
+				it.close();
+
+				FocalMechanismPtr fm;
+				it = getEventFocalMechanisms(query, filter);
+				while ( (fm = static_cast<FocalMechanism*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+
+					if ( seen.insert(fm->publicID()).second ) {
+						batch->focalMechanisms.push_back(fm);
+						fmIDs[it.oid()] = fm;
+					}
+
+					++it;
+				}
+				it.close();
+
+				MomentTensorPtr mt;
+				std::set<std::string> derivedOriginIDs;
+				it = getEventMomentTensors(query, filter);
+				while ( (mt = static_cast<MomentTensor*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+
+					fm = fmIDs.value(it.parentOid());
+					if ( fm ) {
+						fm->add(mt.get());
+						derivedOriginIDs.insert(mt->derivedOriginID());
+					}
+
+					++it;
+				}
+				it.close();
+
+				// Load derived origin magnitudes
+				for ( std::set<std::string>::iterator dit = derivedOriginIDs.begin();
+				      dit != derivedOriginIDs.end(); ++dit ) {
+					if ( isAborted() ) break;
+
+					OriginPtr org;
+					std::map<std::string, Origin*>::iterator oit = origins.find(*dit);
+					if ( oit != origins.end() )
+						org = oit->second;
+					else {
+						org = Origin::Cast(query->getObject(Origin::TypeInfo(), *dit));
+						if ( org ) batch->origins.push_back(org);
+					}
+
+					if ( org && org->magnitudeCount() == 0 )
+						query->loadMagnitudes(org.get());
+				}
+			}
+
+			EventDescriptionPtr description;
+			it = getDescriptions4Events(query, filter);
+			while ( (description = EventDescription::Cast(*it)) != NULL ) {
+				if ( isAborted() ) break;
+				EventPtr evt = eventIDs.value(it.parentOid());
+				if ( evt ) evt->add(description.get());
+				++it;
+			}
+			it.close();
+
+			MagnitudePtr mag;
+			it = query->getPreferredMagnitudes(filter.startTime, filter.endTime, "");
+			while ( (mag = static_cast<Magnitude*>(*it)) != NULL ) {
+				if ( isAborted() ) break;
+				batch->magnitudes.push_back(mag);
+				++it;
+			}
+			it.close();
+
+			if ( !_withOrigins ) {
+				OriginPtr org;
+				it = query->getPreferredOrigins(filter.startTime, filter.endTime, "");
+				while ( (org = static_cast<Origin*>(*it)) != NULL ) {
+					if ( isAborted() ) break;
+
+					if ( seen.insert(org->publicID()).second ) {
+						batch->origins.push_back(org);
+						originIDs[it.oid()] = org;
+						origins[org->publicID()] = org.get();
+					}
+
+					++it;
+				}
+				it.close();
+
+				if ( _withOriginComments ) {
+					it = getComments4PrefOrigins(query, filter);
+					while ( (comment = Comment::Cast(*it)) != NULL ) {
+						if ( isAborted() ) break;
+						OriginPtr org = originIDs.value(it.parentOid());
+						if ( org ) org->add(comment.get());
+						++it;
+					}
+					it.close();
+				}
+			}
+
+			if ( isAborted() ) {
+				delete batch;
+				return NULL;
+			}
+
+			std::stable_sort(batch->events.begin(), batch->events.end(),
+			                 MoreRecentEvent(origins));
+
+			return batch;
+		}
+
+
+	private:
+		typedef QQueue<EventBatch*> BatchQueue;
+
+		QObject               *_receiver;
+		bool                   _withOrigins;
+		bool                   _withFocalMechanisms;
+		bool                   _withOriginComments;
+		std::string            _databaseURI;
+		EventListView::Filter  _filter;
+		BatchQueue             _batches;
+		int                    _slices;
+		bool                   _running;
+		bool                   _abort;
+		mutable QMutex         _mutex;
+		QWaitCondition         _batchAvailable;
+};
 
 
 }
@@ -1876,7 +2330,9 @@ EventListView::EventListView(Seiscomp::DataModel::DatabaseQuery* reader, bool wi
                              bool withFocalMechanisms, QWidget * parent, Qt::WFlags f)
  : QWidget(parent, f), _reader(reader),
    _withOrigins(withOrigins), _withFocalMechanisms(withFocalMechanisms),
-   _blockSelection(false), _blockRemovingOfExpiredEvents(false) {
+   _blockSelection(false), _blockRemovingOfExpiredEvents(false),
+   _loader(NULL), _loadingBatch(NULL), _loadingIndex(0), _loadingTimer(NULL),
+   _loading(false) {
 	_ui.setupUi(this);
 
 	_regionIndex = 0;
@@ -2462,6 +2918,8 @@ void EventListView::updateHideState(QTreeWidgetItem *item) {
 
 
 EventListView::~EventListView() {
+	if ( _loader ) delete _loader;
+	if ( _loadingBatch ) delete _loadingBatch;
 	PublicObjectEvaluator::Instance().clear(this);
 }
 
@@ -2585,6 +3043,8 @@ void EventListView::setEventModificationsEnabled(bool e) {
 
 
 void EventListView::initTree() {
+	stopLoading();
+
 	_treeWidget->clear();
 	if ( _withOrigins )
 		_unassociatedEventItem = addEvent(NULL);
@@ -2785,282 +3245,124 @@ void EventListView::readFromDatabase() {
 void EventListView::readFromDatabase(const Filter& filter) {
 	if ( _reader == NULL ) return;
 
+	// Stops a running loader
 	initTree();
 
-	EventParameters ep;
-
-	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-	_blockSelection = true;
-	_blockRemovingOfExpiredEvents = true;
-
-	EventPtr event;
-	size_t numberOfEvents = _reader->getObjectCount(&ep, Event::TypeInfo());
-	size_t numberOfOrigins = numberOfEvents*20;
-	size_t numberOfSteps = numberOfEvents*2;
-	size_t currentStep = 0;
-
-	if ( _withOrigins )
-		numberOfSteps += numberOfOrigins;
-
-	if ( _withFocalMechanisms )
-		numberOfSteps += numberOfOrigins;
-
-	QProgressDialog progress(this);
-	//progress.setWindowModality(Qt::WindowModal);
-	progress.setWindowTitle(tr("Please wait..."));
-	progress.setRange(0, numberOfSteps);
-	progress.setLabelText(tr("Reading data..."));
-
-	QMap<int, EventPtr>  eventIDs;
-	QMap<int, OriginPtr> originIDs;
-	QMap<int, FocalMechanismPtr> fmIDs;
-
-	//Core::TimeWindow timeWindow(Core::Time::GMT() - _timeAgo, Core::Time::GMT());
-
 	_timeAgo = Core::Time::GMT() - filter.startTime;
-	progress.setLabelText(tr("Reading events..."));
-	DatabaseIterator it = getEvents(_reader, filter);
-	while ( (event = static_cast<Event*>(*it)) != NULL ) {
-		if ( progress.wasCanceled() )
-			break;
-
-		ep.add(event.get());
-		eventIDs[it.oid()] = event.get();
-		++it;
-		progress.setValue(++currentStep);
-	}
-	it.close();
-
-	int eventDiff = numberOfEvents - it.count();
-	numberOfSteps -= eventDiff*2;
 
-	if ( _withOrigins ) numberOfSteps -= eventDiff*20;
-	if ( _withFocalMechanisms ) numberOfSteps -= eventDiff*20;
+	if ( _loader == NULL ) {
+		_loadingTimer = new QTimer(this);
+		_loadingTimer->setSingleShot(true);
+		connect(_loadingTimer, SIGNAL(timeout()), this, SLOT(readBatchesAvailable()));
 
-	progress.setRange(0, numberOfSteps);
-
-	// Read comments
-	CommentPtr comment;
-	it = getComments4Events( _reader, filter);
-	while ( (comment = Comment::Cast(*it)) != NULL ) {
-		if( progress.wasCanceled() )
-			break;
-		EventPtr evt = eventIDs[it.parentOid()];
-		if ( evt ) evt->add(comment.get());
-		++it;
+		_loader = new EventLoader(_loadingTimer, _withOrigins, _withFocalMechanisms,
+		                          _itemConfig.customColumn != -1);
+		connect(_loader, SIGNAL(finished()), _loadingTimer, SLOT(start()));
 	}
-	it.close();
-
-	if ( _withOrigins ) {
-		progress.setLabelText(tr("Reading origins..."));
-
-		it = getEventOriginReferences(_reader, filter);
-
-		OriginReferencePtr oref;
-
-		while ( (oref = static_cast<OriginReference*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
-
-			QMap<int, EventPtr>::iterator mit = eventIDs.find(it.parentOid());
-			if ( mit == eventIDs.end() ) continue;
-
-			EventPtr ev = mit.value();
-
-			ev->add(oref.get());
-
-			++it;
-		}
-		it.close();
-
-		currentStep += numberOfEvents*10;
-		progress.setValue(currentStep);
-
-		it = getEventOrigins(_reader, filter);
 
-		OriginPtr origin;
+	_loading = true;
 
-		while ( (origin = static_cast<Origin*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
-
-			ep.add(origin.get());
-			//if( _withComments )	originIDs[it.oid()] = origin.get();
-			originIDs[it.oid()] = origin.get();
-			//pubIDs[ origin->publicID() ] = it.oid();
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-			++it;
-		}
-		it.close();
+	if ( SCApp->databaseURI().empty() ) {
+		// A second connection cannot be opened, read everything
+		// through the query of the view
+		_loader->read(_reader, filter);
+		insertLoadedEvents(-1);
+	}
+	else {
+		_busyIndicatorLabel->show();
+		_busyIndicator->start();
 
-		it = getUnassociatedOrigins(_reader, filter);
+		_loader->start(SCApp->databaseURI(), filter);
 
-		while ( (origin = static_cast<Origin*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
+		// Wait only for the most recent slice which allows the caller to
+		// select its events right after this call. All remaining events
+		// are inserted from the event loop.
+		if ( _loader->waitForFirstSlice() )
+			insertLoadedEvents(-1);
+	}
 
-			ep.add(origin.get());
-			//if( _withComments )	originIDs[it.oid()] = origin.get();
-			originIDs[it.oid()] = origin.get();
-			//pubIDs[ origin->publicID() ] = it.oid();
+	QApplication::restoreOverrideCursor();
 
-			++it;
-		}
-		it.close();
+	readBatchesAvailable();
+}
 
-		currentStep += numberOfEvents*10;
-		progress.setValue(currentStep);
 
-		//fetch comments for relevant origins (marker for publishing)
+void EventListView::readBatchesAvailable() {
+	if ( !_loading ) return;
 
-		it = getComments4Origins(_reader, filter);
+	insertLoadedEvents(50);
 
-		while ( (comment = Comment::Cast(*it)) != NULL ){
-			if( progress.wasCanceled() )
-				break;
-			OriginPtr org = originIDs[it.parentOid()];
-			if ( org ) org->add(comment.get());
-			++it;
-		}
-		it.close();
+	if ( _loadingBatch != NULL || _loader->hasBatches() ) {
+		// Continue after pending user input has been handled
+		_loadingTimer->start(0);
+		return;
 	}
 
-	if ( _withFocalMechanisms ) {
-		progress.setLabelText(tr("Reading focal mechanisms..."));
-
-		it = getEventFocalMechanismReferences(_reader, filter);
-
-		FocalMechanismReferencePtr fmref;
-
-		while ( (fmref = static_cast<FocalMechanismReference*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
-
-			QMap<int, EventPtr>::iterator mit = eventIDs.find(it.parentOid());
-			if ( mit == eventIDs.end() ) continue;
-
-			EventPtr ev = mit.value();
+	if ( _loader->isReading() ) return;
 
-			ev->add(fmref.get());
+	_loading = false;
 
-			++it;
-		}
-		it.close();
+	for ( int i = 0; i < _treeWidget->columnCount(); ++i )
+		_treeWidget->resizeColumnToContents(i);
 
-		currentStep += numberOfEvents*10;
-		progress.setValue(currentStep);
+	if ( !PublicObjectEvaluator::Instance().isRunning() ) {
+		_busyIndicatorLabel->hide();
+		_busyIndicator->stop();
+	}
+}
 
-		it = getEventFocalMechanisms(_reader, filter);
 
-		FocalMechanismPtr fm;
+int EventListView::insertLoadedEvents(int timeLimit) {
+	QTime timer;
+	timer.start();
 
-		while ( (fm = static_cast<FocalMechanism*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
+	int count = 0;
+	bool blockRemovingOfExpiredEvents = _blockRemovingOfExpiredEvents;
+	_blockRemovingOfExpiredEvents = true;
 
-			fmIDs[it.oid()] = fm;
-			ep.add(fm.get());
+	_treeWidget->setUpdatesEnabled(false);
 
-			++it;
+	// Each batch is older than all events read before, therefore the
+	// events are appended in front of the unassociated origins item
+	int pos = _treeWidget->topLevelItemCount();
+	if ( pos > 0 && _treeWidget->topLevelItem(pos-1) == _unassociatedEventItem )
+		--pos;
+
+	while ( timeLimit < 0 || timer.elapsed() < timeLimit ) {
+		if ( _loadingBatch == NULL ) {
+			_loadingBatch = _loader->take();
+			if ( _loadingBatch == NULL ) break;
+			_loadingBatch->registerObjects();
+			_loadingIndex = 0;
 		}
-		it.close();
-
-		it = getEventMomentTensors(_reader, filter);
-
-		MomentTensorPtr mt;
-		std::set<std::string> derivedOriginIDs;
-
-		while ( (mt = static_cast<MomentTensor*>(*it)) != NULL ) {
-			if ( progress.wasCanceled() )
-				break;
-
-			fm = fmIDs[it.parentOid()];
-			if ( fm ) {
-				fm->add(mt.get());
-				derivedOriginIDs.insert(mt->derivedOriginID());
-			}
 
-			++it;
-		}
-		it.close();
-
-		// Load derived origin magnitudes
-		for ( std::set<std::string>::iterator it = derivedOriginIDs.begin();
-		      it != derivedOriginIDs.end(); ++it ) {
-			OriginPtr org = Origin::Find(*it);
-			if ( org == NULL ) {
-				org = Origin::Cast(_reader->getObject(Origin::TypeInfo(), *it));
-				if ( org ) ep.add(org.get());
+		if ( _loadingIndex >= _loadingBatch->events.size() ) {
+			if ( _withOrigins ) {
+				for ( size_t i = 0; i < _loadingBatch->unassociatedOrigins.size(); ++i ) {
+					Origin *o = Origin::Find(_loadingBatch->unassociatedOrigins[i]->publicID());
+					if ( o ) addOrigin(o, NULL, false);
+				}
 			}
 
-			if ( org && org->magnitudeCount() == 0 )
-				_reader->loadMagnitudes(org.get());
-		}
-	}
-
-	EventDescriptionPtr description;
-	it = getDescriptions4Events(_reader, filter);
-	while ( (description = EventDescription::Cast(*it)) != NULL ) {
-		if( progress.wasCanceled() )
-			break;
-
-		EventPtr evt = eventIDs[it.parentOid()];
-		if ( evt ) evt->add(description.get());
-		++it;
-	}
-	it.close();
-
-	QSet<void*> associatedOrigins;
-
-	_treeWidget->setUpdatesEnabled (false);
-
-	progress.setLabelText(tr("Reading magnitudes..."));
-	std::vector<MagnitudePtr> prefMags;
-	std::vector<OriginPtr> prefOrigins;
-	prefMags.reserve(numberOfEvents);
-	prefOrigins.reserve(numberOfEvents);
-
-	it = _reader->getPreferredMagnitudes(filter.startTime, filter.endTime, "");
-	MagnitudePtr mag;
-	while ( (mag = static_cast<Magnitude*>(*it)) != NULL ) {
-		prefMags.push_back(mag);
-		progress.setValue(++currentStep);
-		++it;
-	}
-	it.close();
-
-	if ( !_withOrigins ) {
-		it = _reader->getPreferredOrigins(filter.startTime, filter.endTime, "");
-		OriginPtr org;
-		while ( (org = static_cast<Origin*>(*it)) != NULL ) {
-			prefOrigins.push_back(org);
-			originIDs[it.oid()] = org;
-			++it;
+			delete _loadingBatch;
+			_loadingBatch = NULL;
+			continue;
 		}
-		it.close();
 
-		if ( _itemConfig.customColumn != -1 ) {
-			it = getComments4PrefOrigins(_reader, filter);
-			CommentPtr comment;
-
-			while ( (comment = Comment::Cast(*it)) != NULL ) {
-				if( progress.wasCanceled() )
-					break;
-
-				OriginPtr org = originIDs[it.parentOid()];
-				if ( org ) org->add(comment.get());
-				++it;
-			}
-			it.close();
+		Event *event = _loadingBatch->events[_loadingIndex++].get();
+		if ( !event->registered() ) {
+			// The event is known already, e.g. received through messaging
+			Event *registeredEvent = Event::Find(event->publicID());
+			if ( registeredEvent == NULL || findEvent(event->publicID()) != NULL )
+				continue;
+			event = registeredEvent;
 		}
-	}
-
-
-	for ( size_t i = 0; i < ep.eventCount(); ++i ) {
-		Event* event = ep.event(i);
 
-		EventTreeItem* eventItem = addEvent(event);
+		EventTreeItem* eventItem = addEvent(event, pos++);
 		bool update = false;
+		++count;
 
 		for ( size_t c = 0; c < event->commentCount(); ++c ) {
 			if ( event->comment(c)->text() == "published" ) {
@@ -3085,8 +3387,6 @@ void EventListView::readFromDatabase(const Filter& filter) {
 							break;
 						}
 					}
-
-					associatedOrigins.insert(o);
 				}
 			}
 		}
@@ -3108,23 +3408,32 @@ void EventListView::readFromDatabase(const Filter& filter) {
 		}
 	}
 
-	if ( _withOrigins ) {
-		// Switch loading of all origin information on
-		for ( size_t i = 0; i < ep.originCount(); ++i ) {
-			if ( !associatedOrigins.contains(ep.origin(i)) ) {
-				addOrigin(ep.origin(i), NULL, false);
-			}
-		}
-	}
+	_treeWidget->setUpdatesEnabled(true);
 
-	for (int i = 0; i < _treeWidget->columnCount(); i++)
-		_treeWidget->resizeColumnToContents(i);
+	_blockRemovingOfExpiredEvents = blockRemovingOfExpiredEvents;
 
-	_treeWidget->setUpdatesEnabled (true);
+	return count;
+}
 
-	QApplication::restoreOverrideCursor();
-	_blockSelection = false;
-	_blockRemovingOfExpiredEvents = false;
+
+void EventListView::stopLoading() {
+	if ( _loader ) {
+		_loader->stop();
+		_loader->clear();
+	}
+
+	if ( _loadingBatch ) {
+		delete _loadingBatch;
+		_loadingBatch = NULL;
+	}
+
+	if ( _loading ) {
+		_loading = false;
+		if ( !PublicObjectEvaluator::Instance().isRunning() ) {
+			_busyIndicatorLabel->hide();
+			_busyIndicator->stop();
+		}
+	}
 }
 
 
@@ -3196,7 +3505,7 @@ void EventListView::removeExpiredEvents() {
 }
 
 
-EventTreeItem* EventListView::addEvent(Seiscomp::DataModel::Event* event) {
+EventTreeItem* EventListView::addEvent(Seiscomp::DataModel::Event* event, int index) {
 	removeExpiredEvents();
 
 	// Read preferred origin for display purpose
@@ -3229,7 +3538,9 @@ EventTreeItem* EventListView::addEvent(Seiscomp::DataModel::Event* event) {
 	EventTreeItem *item = new EventTreeItem(event, _itemConfig);
 	item->setShowOneItemPerAgency(_showOnlyLatestPerAgency);
 
-	if ( _treeWidget->topLevelItemCount() == 0 )
+	if ( index >= 0 )
+		_treeWidget->insertTopLevelItem(index, item);
+	else if ( _treeWidget->topLevelItemCount() == 0 )
 		_treeWidget->insertTopLevelItem(0, item);
 	else {
 		int pos = _treeWidget->topLevelItemCount();
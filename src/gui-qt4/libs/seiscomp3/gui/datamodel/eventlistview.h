@@ -56,6 +56,8 @@ namespace Private {
 class EventTreeItem;
 class OriginTreeItem;
 class FocalMechanismTreeItem;
+class EventLoader;
+struct EventBatch;
 
 }
 
@@ -185,6 +187,7 @@ class SC_GUI_API EventListView : public QWidget {
 		void changeRegion();
 
 		void itemExpanded(QTreeWidgetItem * item);
+		void readBatchesAvailable();
 		void currentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous);
 		void indicatorResized(const QSize &size);
 
@@ -205,7 +208,7 @@ class SC_GUI_API EventListView : public QWidget {
 	private:
 		void initTree();
 
-		Private::EventTreeItem* addEvent(Seiscomp::DataModel::Event*);
+		Private::EventTreeItem* addEvent(Seiscomp::DataModel::Event*, int index = -1);
 		Private::OriginTreeItem* addOrigin(Seiscomp::DataModel::Origin*, QTreeWidgetItem* parent, bool highPriority);
 		Private::FocalMechanismTreeItem* addFocalMechanism(Seiscomp::DataModel::FocalMechanism*, QTreeWidgetItem* parent);
 
@@ -226,6 +229,12 @@ class SC_GUI_API EventListView : public QWidget {
 
 		void loadItem(QTreeWidgetItem*);
 
+		//! Inserts events read by the loader until timeLimit milliseconds
+		//! have passed. A negative limit inserts all queued events. Returns
+		//! the number of inserted events.
+		int insertLoadedEvents(int timeLimit);
+		void stopLoading();
+
 
 	public:
 		struct ProcessColumn {
@@ -290,6 +299,11 @@ class SC_GUI_API EventListView : public QWidget {
 		bool                                _checkEventAgency;
 		bool                                _showOnlyLatestPerAgency;
 		int                                 _regionIndex;
+		Private::EventLoader               *_loader;
+		Private::EventBatch                *_loadingBatch;
+		size_t                              _loadingIndex;
+		QTimer                             *_loadingTimer;
+		bool                                _loading;
 };
 
 
@@ -129,6 +129,7 @@ class ZoomRecordWidget : public RecordWidget {
 			for ( int i = 0; i < 3; ++i ) {
 				spectrogram[i].setOptions(spectrogram[i].options());
 				spectrogram[i].setGradient(gradient);
+				spectrogram[i].setUpdateWidget(this);
 			}
 		}
 
@@ -216,15 +217,14 @@ class ZoomRecordWidget : public RecordWidget {
 	private:
 		void resetSpectrogram() {
 			if ( showSpectrogram ) {
-				qApp->setOverrideCursor(Qt::WaitCursor);
+				// The spectra are computed in the background and the widget
+				// is updated as soon as they become available
 				for ( int i = 0; i < 3; ++i ) {
 					const double *scale = recordScale(i);
 					// Scale is is nm and needs to be converted to m
 					if ( scale != NULL ) spectrogram[i].setScale(*scale * 1E-9);
 					spectrogram[i].setRecords(traces != NULL ? traces[i].raw : NULL);
-					spectrogram[i].renderSpectrogram();
 				}
-				qApp->restoreOverrideCursor();
 			}
 		}
 
@@ -7077,7 +7077,7 @@ void PickerView::acquisitionFinished() {
 void PickerView::acquireStreams() {
 	if ( _nextStreams.empty() ) return;
 
-	RecordStreamThread *t = new RecordStreamThread(_config.recordURL.toStdString());
+	RecordStreamThread *t = new RecordStreamThread(SCApp->cachedRecordStreamURL(_config.recordURL.toStdString()));
 
 	if ( !t->connect() ) {
 		if ( _config.recordURL != _lastRecordURL ) {
@@ -94,6 +94,7 @@ void MapWidget::init() {
 
 	_isDragging = false;
 	_isMeasuring = false;
+	_isZooming = false;
 	_filterMap = SCScheme.map.bilinearFilter;
 	_canvas.setBilinearFilter(_filterMap);
 
@@ -119,6 +120,12 @@ void MapWidget::init() {
 
 	connect(zoomIn, SIGNAL(pressed()), this, SLOT(zoomIn()));
 	connect(zoomOut, SIGNAL(pressed()), this, SLOT(zoomOut()));
+
+	// Zooming with the mouse wheel draws a preview that is refined
+	// once the wheel stopped
+	_zoomTimer.setSingleShot(true);
+	_zoomTimer.setInterval(250);
+	connect(&_zoomTimer, SIGNAL(timeout()), this, SLOT(zoomFinished()));
 }
 
 
@@ -161,7 +168,7 @@ void MapWidget::setDrawCities(bool e) {
 
 
 void MapWidget::draw(QPainter &painter) {
-	_canvas.setPreviewMode(_isDragging || _isMeasuring);
+	_canvas.setPreviewMode(_isDragging || _isMeasuring || _isZooming);
 	_canvas.setGrayScale(!isEnabled());
 	_canvas.draw(painter);
 
@@ -455,8 +462,17 @@ void MapWidget::keyPressEvent(QKeyEvent* e) {
 
 void MapWidget::wheelEvent(QWheelEvent *e) {
 	double zoomDelta = (double)e->delta() * (1.0/120.0);
-	if ( _canvas.setZoomLevel(_canvas.zoomLevel() * pow(2.0, zoomDelta*_zoomSensitivity)) )
+	if ( _canvas.setZoomLevel(_canvas.zoomLevel() * pow(2.0, zoomDelta*_zoomSensitivity)) ) {
+		_isZooming = true;
+		_zoomTimer.start();
 		update();
+	}
+}
+
+
+void MapWidget::zoomFinished() {
+	_isZooming = false;
+	update();
 }
 
 
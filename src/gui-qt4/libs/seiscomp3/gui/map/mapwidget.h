@@ -63,6 +63,7 @@ class SC_GUI_API MapWidget : public QWidget {
 		void projectionChanged(Seiscomp::Gui::Map::Projection*);
 		void zoomIn();
 		void zoomOut();
+		void zoomFinished();
 
 
 	signals:
@@ -97,6 +98,7 @@ class SC_GUI_API MapWidget : public QWidget {
 		bool     _firstDrag;
 		bool     _isDragging;
 		bool     _isMeasuring;
+		bool     _isZooming;
 		bool     _filterMap;
 
 		QPointF  _measureStart;
@@ -108,6 +110,7 @@ class SC_GUI_API MapWidget : public QWidget {
 		QMenu   *_contextLayerMenu;
 
 		double   _zoomSensitivity;
+		QTimer   _zoomTimer;
 
 		QWidget *_zoomControls;
 };
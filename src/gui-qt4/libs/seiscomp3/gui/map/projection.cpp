@@ -213,6 +213,8 @@ void Projection::draw(QImage &img, bool filter, TextureCache *cache) {
 
 	render(img, filter, cache);
 
+	if ( cache ) cache->endPaint();
+
 	/*
 	Core::Time now = Core::Time::GMT();
 	Core::TimeSpan ts = now - cache->startTime();
@@ -136,6 +136,10 @@ struct NearestFilter {
 	static void fetch(TextureCache *cache, QRgb &c, Coord u, Coord v, int level) {
 		cache->getTexel(c,u,v,level);
 	}
+
+	static void fetch(TextureReader *reader, QRgb &c, Coord u, Coord v, int level) {
+		reader->getTexel(c,u,v,level);
+	}
 };
 
 
@@ -143,6 +147,10 @@ struct BilinearFilter {
 	static void fetch(TextureCache *cache, QRgb &c, Coord u, Coord v, int level) {
 		cache->getTexelBilinear(c,u,v,level);
 	}
+
+	static void fetch(TextureReader *reader, QRgb &c, Coord u, Coord v, int level) {
+		reader->getTexelBilinear(c,u,v,level);
+	}
 };
 
 
@@ -17,6 +17,11 @@
 
 #include <seiscomp3/math/geo.h>
 
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
 #include <math.h>
 #include <iostream>
 
@@ -83,6 +88,110 @@ QString lon2String(qreal lon) {
 }
 
 
+// Number of image rows a render thread takes at once
+const int StripHeight = 32;
+
+
+// Everything the render threads need to know to fill image rows
+struct RenderSetup {
+	TextureCache *cache;
+	QRgb         *data;
+	int           width;
+	int           rows;
+	int           fromX;
+	int           toX;
+	qreal         upY;
+	qreal         dt;
+	Coord         leftTu;
+	Coord         rightTu;
+	int           level;
+};
+
+
+Coord textureV(const RenderSetup &setup, int row) {
+	qreal y = setup.upY - row * setup.dt;
+	if ( y <= -1.0 ) y = -1.0 + setup.dt;
+
+	Coord tv;
+
+	if ( setup.cache->isMercatorProjected() ) {
+		qreal lat = y;
+
+		if ( lat > 0.94 ) lat = 0.94;
+		else if ( lat < -0.94 ) lat = -0.94;
+		lat = ooPi*asinh(tan(lat*HALF_PI));
+
+		tv.value = (1.0f-lat) * Coord::value_type(Coord::fraction_half_max);
+	}
+	else
+		tv.value = (1.0-y) * Coord::value_type(Coord::fraction_half_max);
+
+	return tv;
+}
+
+
+template <typename PROC>
+void renderRows(const RenderSetup &setup, TextureReader &reader, int from, int to) {
+	QRgb *data = setup.data + from * setup.width;
+	int pixels = setup.toX - setup.fromX + 1;
+
+	// Shift only by 30 bits to keep the sign bit in the lower 32 bit
+	Coord::value_type xDelta = setup.rightTu.value - setup.leftTu.value;
+	qint64 stepU = (qint64(xDelta) << 30) / pixels;
+
+	for ( int i = from; i < to; ++i ) {
+		Coord tv = textureV(setup, i);
+
+		PROC::fetch(&reader, data[setup.fromX], setup.leftTu, tv, setup.level);
+		PROC::fetch(&reader, data[setup.toX], setup.rightTu, tv, setup.level);
+
+		qint64 stepper;
+		Coord lon;
+		stepper = qint64(setup.leftTu.value) << 30;
+		stepper += stepU;
+
+		for ( int k = 1; k < pixels; ++k ) {
+			lon.value = stepper >> 30;
+			PROC::fetch(&reader, data[setup.fromX + k], lon, tv, setup.level);
+			stepper += stepU;
+		}
+
+		data += setup.width;
+	}
+}
+
+
+// Renders strips of rows until no strip is left
+template <typename PROC>
+void renderStrips(const RenderSetup &setup, QAtomicInt &nextStrip) {
+	TextureReader reader(setup.cache);
+
+	while ( true ) {
+		int from = nextStrip.fetchAndAddOrdered(1) * StripHeight;
+		if ( from >= setup.rows ) break;
+		renderRows<PROC>(setup, reader, from, std::min(from + StripHeight, setup.rows));
+	}
+}
+
+
+template <typename PROC>
+class RenderTask : public QRunnable {
+	public:
+		RenderTask(const RenderSetup &setup, QAtomicInt &nextStrip, QSemaphore &done)
+		: _setup(setup), _nextStrip(nextStrip), _done(done) {}
+
+		void run() {
+			renderStrips<PROC>(_setup, _nextStrip);
+			_done.release();
+		}
+
+	private:
+		const RenderSetup &_setup;
+		QAtomicInt        &_nextStrip;
+		QSemaphore        &_done;
+};
+
+
 }
 
 
@@ -169,8 +278,6 @@ void RectangularProjection::render(QImage &img, TextureCache *cache) {
 
 	data += fromY * img.width();
 
-	qreal y = upY;
-
 	//qreal ixf = (qreal)centerX / radius;
 	qreal ixf = 2.0;
 	qint64 pxf = qint64(ixf*radius);
@@ -207,74 +314,46 @@ void RectangularProjection::render(QImage &img, TextureCache *cache) {
 	qreal leftX = 2.0*_center.x() - ixf;
 	qreal rightX = 2.0*_center.x() + ixf;
 
-	int pixels = toX - fromX + 1;
-
-	Coord leftTu;
-	Coord rightTu;
-
-	leftTu.value = (leftX*0.5+1.0) * Coord::value_type(Coord::fraction_half_max);
-	rightTu.value = (rightX*0.5+1.0) * Coord::value_type(Coord::fraction_half_max);
-
-	if ( cache->isMercatorProjected() ) {
-		for ( int i = fromY; i < toY; ++i, y -= dt ) {
-			if ( y <= -1.0 ) y = -1.0 + dt;
-
-			Coord tv;
-			qreal lat = y;
-
-			if ( lat > 0.94 ) lat = 0.94;
-			else if ( lat < -0.94 ) lat = -0.94;
-			lat = ooPi*asinh(tan(lat*HALF_PI));
-
-			tv.value = (1.0f-lat) * Coord::value_type(Coord::fraction_half_max);
-
-			PROC::fetch(cache, data[fromX], leftTu, tv, level);
-			PROC::fetch(cache, data[toX], rightTu, tv, level);
-
-			// Shift only by 30 bits to keep the sign bit in the lower 32 bit
-			Coord::value_type xDelta = rightTu.value - leftTu.value;
-			qint64 stepU = (qint64(xDelta) << 30) / pixels;
-			qint64 stepper;
-			Coord lon;
-			stepper = qint64(leftTu.value) << 30;
-			stepper += stepU;
+	RenderSetup setup;
+	setup.cache = cache;
+	setup.data = data;
+	setup.width = size.width();
+	setup.rows = toY - fromY;
+	setup.fromX = fromX;
+	setup.toX = toX;
+	setup.upY = upY;
+	setup.dt = dt;
+	setup.level = level;
+	setup.leftTu.value = (leftX*0.5+1.0) * Coord::value_type(Coord::fraction_half_max);
+	setup.rightTu.value = (rightX*0.5+1.0) * Coord::value_type(Coord::fraction_half_max);
+
+	if ( setup.rows <= 0 ) return;
+
+	// Rows are split into strips rendered by the threads of the global
+	// pool and the calling thread
+	QThreadPool *pool = QThreadPool::globalInstance();
+	int strips = (setup.rows + StripHeight - 1) / StripHeight;
+	int workers = std::min(pool->maxThreadCount(), strips) - 1;
+
+	if ( workers <= 0 ) {
+		TextureReader reader(cache);
+		renderRows<PROC>(setup, reader, 0, setup.rows);
+		return;
+	}
 
-			for ( int k = 1; k < pixels; ++k ) {
-				lon.value = stepper >> 30;
-				PROC::fetch(cache, data[fromX + k], lon, tv, level);
-				stepper += stepU;
-			}
+	// Load the visible tiles on this thread, tile stores need not be
+	// thread-safe
+	cache->prefetch(level, setup.leftTu, setup.rightTu,
+	                textureV(setup, 0), textureV(setup, setup.rows-1));
 
-			data += size.width();
-		}
-	}
-	else {
-		for ( int i = fromY; i < toY; ++i, y -= dt ) {
-			if ( y <= -1.0 ) y = -1.0 + dt;
-
-			Coord tv;
-			tv.value = (1.0-y) * Coord::value_type(Coord::fraction_half_max);
-
-			PROC::fetch(cache, data[fromX], leftTu, tv, level);
-			PROC::fetch(cache, data[toX], rightTu, tv, level);
-
-			// Shift only by 30 bits to keep the sign bit in the lower 32 bit
-			Coord::value_type xDelta = rightTu.value - leftTu.value;
-			qint64 stepU = (qint64(xDelta) << 30) / pixels;
-			qint64 stepper;
-			Coord lon;
-			stepper = qint64(leftTu.value) << 30;
-			stepper += stepU;
+	QAtomicInt nextStrip(0);
+	QSemaphore done;
 
-			for ( int k = 1; k < pixels; ++k ) {
-				lon.value = stepper >> 30;
-				PROC::fetch(cache, data[fromX + k], lon, tv, level);
-				stepper += stepU;
-			}
+	for ( int i = 0; i < workers; ++i )
+		pool->start(new RenderTask<PROC>(setup, nextStrip, done));
 
-			data += size.width();
-		}
-	}
+	renderStrips<PROC>(setup, nextStrip);
+	done.acquire(workers);
 }
 
 
@@ -14,6 +14,7 @@
 
 #include <QHash>
 #include <QMutex>
+#include <algorithm>
 #include <iostream>
 
 #include <seiscomp3/gui/map/texturecache.h>
@@ -80,14 +81,25 @@ void Texture::setImage(QImage &img) {
 }
 
 
-TextureCache::TextureCache(TileStore *tree, bool mercatorProjected) {
+TextureReader::TextureReader(TextureCache *cache) : _cache(cache) {
+	reset();
+}
+
+
+void TextureReader::reset() {
+	_lastTile[0] = _lastTile[1] = NULL;
+	_currentIndex = 0;
+}
+
+
+TextureCache::TextureCache(TileStore *tree, bool mercatorProjected)
+: _reader(this) {
 	_mapTree = tree;
 	_isMercatorProjected = mercatorProjected;
 	_storedBytes = 0;
 	_textureCacheLimit = 32*1024*1024; // 32mb cache limit
-	_lastTile[0] = _lastTile[1] = NULL;
-	_currentIndex = 0;
 	_currentTick = 0;
+	_painting = false;
 }
 
 
@@ -104,6 +116,21 @@ TextureCache::~TextureCache() {
 
 
 void TextureCache::beginPaint() {
+	QMutexLocker lock(&_mutex);
+	_painting = true;
+}
+
+
+void TextureCache::endPaint() {
+	QMutexLocker lock(&_mutex);
+	_painting = false;
+
+	// Remove the textures that exceeded the limit while painting
+	while ( _storedBytes > _textureCacheLimit ) {
+		int count = _storage.size();
+		checkResources();
+		if ( _storage.size() == count ) break;
+	}
 }
 
 
@@ -196,11 +223,7 @@ void TextureCache::checkResources(Texture *tex) {
 				++lit;
 		}
 
-		if ( _lastTile[0] == min_tex.get() )
-			_lastTile[0] = NULL;
-
-		if ( _lastTile[1] == min_tex.get() )
-			_lastTile[1] = NULL;
+		_reader.reset();
 	}
 }
 
@@ -222,6 +245,8 @@ void TextureCache::setTexture(QImage &img, Alg::MapTreeNode *node) {
 
 	// Update texture cache
 	{
+		QMutexLocker lock(&_mutex);
+
 		Storage::iterator it = _storage.find(node);
 		if ( it != _storage.end() ) {
 			Texture *tex = it.value().get();
@@ -238,6 +263,8 @@ void TextureCache::setTexture(QImage &img, Alg::MapTreeNode *node) {
 
 
 void TextureCache::invalidateTexture(Alg::MapTreeNode *node) {
+	QMutexLocker lock(&_mutex);
+
 	QString id = _mapTree->getID(node);
 	remove(id);
 
@@ -251,11 +278,7 @@ void TextureCache::invalidateTexture(Alg::MapTreeNode *node) {
 		// Remove node from texture cache
 		Storage::iterator it = _storage.find(node);
 		if ( it != _storage.end() ) {
-			if ( _lastTile[0] == it.value().get() )
-				_lastTile[0] = NULL;
-
-			if ( _lastTile[1] == it.value().get() )
-				_lastTile[1] = NULL;
+			_reader.reset();
 
 			Texture *tex = it.value().get();
 			// Update storage size
@@ -267,18 +290,46 @@ void TextureCache::invalidateTexture(Alg::MapTreeNode *node) {
 
 
 void TextureCache::clear() {
+	QMutexLocker storageLock(&_mutex);
 	QMutexLocker lock(&imageCacheMutex);
 
 	_firstLevel.clear();
 	_storage.clear();
 	_images.clear();
 	_storedBytes = 0;
-	_lastTile[0] = _lastTile[1] = NULL;
-	_currentIndex = 0;
+	_reader.reset();
 	_currentTick = 0;
 }
 
 
+void TextureCache::prefetch(int level, Coord u0, Coord u1, Coord v0, Coord v1) {
+	int tiles = 1 << level;
+
+	// Columns are not clipped, u wraps around
+	Coord::value_type firstColumn = (u0.value << level) >> Coord::fraction_shift;
+	Coord::value_type lastColumn = (u1.value << level) >> Coord::fraction_shift;
+	if ( firstColumn > lastColumn ) std::swap(firstColumn, lastColumn);
+	if ( lastColumn - firstColumn >= tiles ) {
+		firstColumn = 0;
+		lastColumn = tiles-1;
+	}
+
+	v0.parts.hi = v1.parts.hi = 0;
+	int firstRow = (v0.value << level) >> Coord::fraction_shift;
+	int lastRow = (v1.value << level) >> Coord::fraction_shift;
+	if ( firstRow > lastRow ) std::swap(firstRow, lastRow);
+
+	for ( int row = firstRow; row <= lastRow; ++row ) {
+		for ( Coord::value_type c = firstColumn; c <= lastColumn; ++c ) {
+			int column = (int)(c % tiles);
+			if ( column < 0 ) column += tiles;
+			get(TextureID(level, row, column));
+		}
+	}
+}
+
+
+
 void TextureCache::remove(const QString &name) {
 	QMutexLocker lock(&imageCacheMutex);
 	ImageCache::iterator it;
@@ -334,6 +385,8 @@ uint qHash(const TextureID &id) {
 
 
 Texture *TextureCache::get(const TextureID &id) {
+	QMutexLocker lock(&_mutex);
+
 	Texture *tex;
 	Storage::iterator it;
 
@@ -366,7 +419,10 @@ Texture *TextureCache::get(const TextureID &id) {
 		_storage[node] = tex;
 		_storedBytes += tex->numBytes();
 
-		checkResources(tex);
+		// Textures must not be removed while readers may still
+		// refer to them
+		if ( !_painting )
+			checkResources(tex);
 	}
 
 	tex->lastUsed = _currentTick;
@@ -19,6 +19,7 @@
 #include <QHash>
 #include <QMap>
 #include <QImage>
+#include <QMutex>
 #include <QPair>
 
 #ifndef Q_MOC_RUN
@@ -106,6 +107,34 @@ struct SC_GUI_API Texture : public Core::BaseObject {
 };
 
 
+/**
+ * Texel access to a TextureCache that remembers the last two tiles
+ * accessed. Each thread rendering from the same cache must use its own
+ * reader, see TextureCache::beginPaint.
+ */
+class SC_GUI_API TextureReader {
+	public:
+		TextureReader(TextureCache *cache);
+
+		void getTexel(QRgb &c, Coord u, Coord v, int level);
+		void getTexelBilinear(QRgb &c, Coord u, Coord v, int level);
+
+		//! Forgets the remembered tiles
+		void reset();
+
+
+	private:
+		Texture *tile(Coord u, Coord v, int level);
+
+
+	private:
+		TextureCache *_cache;
+		Texture      *_lastTile[2];
+		TextureID     _lastId[2];
+		int           _currentIndex;
+};
+
+
 DEFINE_SMARTPOINTER(TextureCache);
 
 class SC_GUI_API TextureCache : public Core::BaseObject {
@@ -113,8 +142,14 @@ class SC_GUI_API TextureCache : public Core::BaseObject {
 		TextureCache(TileStore *mapTree, bool mercatorProjected);
 		~TextureCache();
 
+		//! Starts painting. Until endPaint is called, textures are not
+		//! removed from the cache and TextureReader instances may be used
+		//! from several threads.
 		void beginPaint();
 
+		//! Finishes painting and removes textures exceeding the cache limit
+		void endPaint();
+
 		void setCacheLimit(int limit);
 		void setCurrentTime(const Core::Time &t);
 
@@ -127,8 +162,15 @@ class SC_GUI_API TextureCache : public Core::BaseObject {
 		void getTexel(QRgb &c, Coord u, Coord v, int level);
 		void getTexelBilinear(QRgb &c, Coord u, Coord v, int level);
 
+		//! Returns the texture for a tile or its nearest available parent.
+		//! This function is thread-safe.
 		Texture *get(const TextureID &id);
 
+		//! Loads all tiles of a level covering the texture coordinates
+		//! u0 to u1 and v0 to v1 where u wraps around. This allows to load
+		//! the tiles on the calling thread before rendering concurrently.
+		void prefetch(int level, Coord u0, Coord u1, Coord v0, Coord v1);
+
 		const quint64 &startTick() const { return _currentTick; }
 
 		bool load(QImage &img, Alg::MapTreeNode *node);
@@ -164,10 +206,10 @@ class SC_GUI_API TextureCache : public Core::BaseObject {
 		int               _storedBytes;
 		int               _textureCacheLimit;
 		quint64           _currentTick;
+		bool              _painting;
+		QMutex            _mutex;
 
-		Texture          *_lastTile[2];
-		TextureID         _lastId[2];
-		int               _currentIndex;
+		TextureReader     _reader;
 
 		typedef QPair<QImage, int> CacheEntry;
 		typedef QMap<QString, CacheEntry> ImageCache;
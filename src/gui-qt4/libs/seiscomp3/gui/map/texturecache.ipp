@@ -15,30 +15,33 @@ namespace Gui {
 namespace Map {
 
 
-inline void TextureCache::getTexel(QRgb &c, Coord u, Coord v, int level) {
-	u.parts.hi = 0;
-	v.parts.hi = 0;
-
+inline Texture *TextureReader::tile(Coord u, Coord v, int level) {
 	TextureID id;
 	id.level = level;
 	id.row = (v.value << level) >> Coord::fraction_shift;
 	id.column = (u.value << level) >> Coord::fraction_shift;
 
-	Texture *tex;
-
 	if ( !_lastTile[0] || _lastId[0] != id ) {
 		if ( !_lastTile[1] || _lastId[1] != id ) {
-			tex = get(id);
+			Texture *tex = _cache->get(id);
 			_lastTile[_currentIndex] = tex;
 			_lastId[_currentIndex] = id;
 			_currentIndex = 1-_currentIndex;
+			return tex;
 		}
-		else {
-			tex = _lastTile[1];
-		}
+		else
+			return _lastTile[1];
 	}
 	else
-		tex = _lastTile[0];
+		return _lastTile[0];
+}
+
+
+inline void TextureReader::getTexel(QRgb &c, Coord u, Coord v, int level) {
+	u.parts.hi = 0;
+	v.parts.hi = 0;
+
+	Texture *tex = tile(u, v, level);
 
 	u.value <<= tex->id.level;
 	v.value <<= tex->id.level;
@@ -50,30 +53,11 @@ inline void TextureCache::getTexel(QRgb &c, Coord u, Coord v, int level) {
 }
 
 
-inline void TextureCache::getTexelBilinear(QRgb &c, Coord u, Coord v, int level) {
+inline void TextureReader::getTexelBilinear(QRgb &c, Coord u, Coord v, int level) {
 	u.parts.hi = 0;
 	v.parts.hi = 0;
 
-	TextureID id;
-	id.level = level;
-	id.row = (v.value << level) >> Coord::fraction_shift;
-	id.column = (u.value << level) >> Coord::fraction_shift;
-
-	Texture *tex;
-
-	if ( !_lastTile[0] || _lastId[0] != id ) {
-		if ( !_lastTile[1] || _lastId[1] != id ) {
-			tex = get(id);
-			_lastTile[_currentIndex] = tex;
-			_lastId[_currentIndex] = id;
-			_currentIndex = 1-_currentIndex;
-		}
-		else {
-			tex = _lastTile[1];
-		}
-	}
-	else
-		tex = _lastTile[0];
+	Texture *tex = tile(u, v, level);
 
 	u.value <<= tex->id.level;
 	v.value <<= tex->id.level;
@@ -145,6 +129,16 @@ inline void TextureCache::getTexelBilinear(QRgb &c, Coord u, Coord v, int level)
 
 
 
+inline void TextureCache::getTexel(QRgb &c, Coord u, Coord v, int level) {
+	_reader.getTexel(c, u, v, level);
+}
+
+
+inline void TextureCache::getTexelBilinear(QRgb &c, Coord u, Coord v, int level) {
+	_reader.getTexelBilinear(c, u, v, level);
+}
+
+
 inline void getTexel(QRgb &c, const QRgb *data, int w, int, Coord u, Coord v) {
 	c = data[v.parts.hi*w + u.parts.hi];
 }
@@ -151,6 +151,7 @@ class InfoGenerator
       list<rc_ptr<InfoBuffer> > &buffer_list);
     ~InfoGenerator();
      void write_doc(xmlDocPtr doc);
+     void write_text(const string &text);
   };
 
 void InfoGenerator::iowrite(const char *buf, int len)
@@ -204,6 +205,13 @@ void InfoGenerator::write_doc(xmlDocPtr doc)
     xmlSaveFileTo(obuf, doc, NULL);
   }
 
+void InfoGenerator::write_text(const string &text)
+  {
+    it = get_real_time();
+    iowrite(text.data(), text.length());
+    ioclose();
+  }
+
 //*****************************************************************************
 // MessageStore
 //*****************************************************************************
@@ -492,6 +500,22 @@ StreamDescriptor make_stream_descriptor(const sl_fsdh_s *fsdh, int size)
     return StreamDescriptor(location_id, channel_id, type);
   }
 
+// Identifies a stream by the raw location and channel codes of the fixed
+// header and the packet type, which is much cheaper than creating a
+// StreamDescriptor
+
+uint64_t stream_key(const sl_fsdh_s *fsdh, int type)
+  {
+    uint64_t key = 0;
+    for(int n = 0; n < LOCLEN; ++n)
+        key = (key << 8) | (unsigned char) fsdh->location[n];
+
+    for(int n = 0; n < CHLEN; ++n)
+        key = (key << 8) | (unsigned char) fsdh->channel[n];
+
+    return (key << 8) | (unsigned char) type;
+  }
+
 bool convert_time(INT_TIME &it, int year, int month,
   int day, int hour, int minute, int second, int usec)
   {
@@ -559,6 +583,69 @@ void xml_new_prop(xmlNodePtr node, const char *name, const char *value)
         throw bad_alloc();
   }
 
+//*****************************************************************************
+// XMLFragment
+//*****************************************************************************
+
+// Scratch parent for building INFO elements that are serialized and cached
+// separately. Serialization is the same as when the elements are part of
+// the complete document. An element without children is serialized as
+// "<name .../>", which makes it easy to reopen when content is appended.
+
+class XMLFragment
+  {
+  private:
+    xmlDocPtr doc;
+    xmlBufferPtr buf;
+
+  public:
+    XMLFragment(): doc(NULL), buf(NULL) {}
+    ~XMLFragment();
+
+    xmlNodePtr parent();
+    void take(string &text);
+  };
+
+XMLFragment::~XMLFragment()
+  {
+    if(buf != NULL) xmlBufferFree(buf);
+    if(doc != NULL) xmlFreeDoc(doc);
+  }
+
+xmlNodePtr XMLFragment::parent()
+  {
+    if(doc == NULL)
+      {
+        if((doc = xmlNewDoc((const xmlChar *) "1.0")) == NULL)
+            throw bad_alloc();
+
+        if((doc->children = xmlNewDocNode(doc, NULL, (const xmlChar *) "fragment", NULL)) == NULL)
+            throw bad_alloc();
+
+        if((buf = xmlBufferCreate()) == NULL)
+            throw bad_alloc();
+      }
+
+    return doc->children;
+  }
+
+void XMLFragment::take(string &text)
+  {
+    xmlNodePtr node = parent()->children;
+    xmlBufferEmpty(buf);
+    
+    while(node != NULL)
+      {
+        xmlNodePtr next = node->next;
+        xmlNodeDump(buf, doc, node, 0, 0);
+        xmlUnlinkNode(node);
+        xmlFreeNode(node);
+        node = next;
+      }
+
+    text.assign((const char *) xmlBufferContent(buf), xmlBufferLength(buf));
+  }
+
 //*****************************************************************************
 // StreamSelector
 //*****************************************************************************
@@ -661,12 +748,17 @@ class StreamFilter
   {
   private:
     list<StreamSelector> sels;
+
+    // Selectors compiled to a match result per stream, filled as streams
+    // appear (see stream_key())
+    mutable map<uint64_t, bool> stream_table;
   
   public:
     bool add_selector(const string &selstr);
     bool have_selectors() const;
     void clear_selectors();
     bool match(const StreamDescriptor &str_desc) const;
+    bool match(const sl_fsdh_s *fsdh, int size, int type) const;
     void getinfo(xmlNodePtr parent, int info_level) const;
   };
 
@@ -676,6 +768,7 @@ bool StreamFilter::add_selector(const string &selstr)
 
     if((int) sels.size() >= MAXSEL || !sel.init(selstr.c_str())) return false;
     sels.push_back(sel);
+    stream_table.clear();
     return true;
   }
 
@@ -687,6 +780,7 @@ bool StreamFilter::have_selectors() const
 void StreamFilter::clear_selectors()
   {
     sels.clear();
+    stream_table.clear();
   }
 
 bool StreamFilter::match(const StreamDescriptor &str_desc) const
@@ -712,6 +806,20 @@ bool StreamFilter::match(const StreamDescriptor &str_desc) const
     return (default_rule || result);
   }
 
+bool StreamFilter::match(const sl_fsdh_s *fsdh, int size, int type) const
+  {
+    if(sels.empty()) return true;
+
+    uint64_t key = stream_key(fsdh, type);
+    map<uint64_t, bool>::const_iterator p;
+    if((p = stream_table.find(key)) != stream_table.end())
+        return p->second;
+
+    bool result = match(make_stream_descriptor(fsdh, size));
+    stream_table.insert(make_pair(key, result));
+    return result;
+  }
+
 void StreamFilter::getinfo(xmlNodePtr parent, int info_level) const
   {
     xmlNodePtr child;
@@ -742,6 +850,11 @@ class TimeWindow
     bool valid();
     int time_cmp(INT_TIME it);
     void getinfo(xmlNodePtr parent, int info_level) const;
+
+    bool limited() const
+      {
+        return begin_time_initialized;
+      }
     
     void set_begin_time(INT_TIME it)
       {
@@ -969,16 +1082,24 @@ bool ConnectionMonitorImpl::match_packet(const void *head, int size)
         return false;
 
     const sl_fsdh_s* fsdh = static_cast<const sl_fsdh_s *>(head);
-    StreamDescriptor str_desc = make_stream_descriptor(fsdh, size);
+    int type;
+    if((type = packet_type(fsdh, size)) < 0)
+      {
+        logs(LOG_ERR) << "could not determine packet type" << endl;
+        return false;
+      }
 
-    if(str_desc.type < 0)
+    if(!filter.match(fsdh, size, type))
         return false;
-    
-    if(!filter.match(str_desc) || win.time_cmp(packet_end_time(fsdh)) < 0)
+
+    // Without a time window every packet is within it
+    if(win.limited() && win.time_cmp(packet_end_time(fsdh)) < 0)
         return false;
 
     if(check_eod && !eod)
       {
+        StreamDescriptor str_desc = make_stream_descriptor(fsdh, size);
+
         if(win.time_cmp(packet_begin_time(fsdh)) <= 0)
           {
             stream_set.insert(str_desc);
@@ -1065,6 +1186,13 @@ class StreamMonitor
     list<DataSegment> segments;
     list<DataSegment>::iterator current_segment;
     int segment_count;
+    mutable string info_text_cache[2];
+    mutable bool info_text_valid[2];
+
+    void invalidate_info()
+      {
+        info_text_valid[0] = info_text_valid[1] = false;
+      }
 
   public:
     const StreamDescriptor name;
@@ -1076,6 +1204,7 @@ class StreamMonitor
       gap_check(gap_check_init), gap_treshold(gap_treshold_init),
       begin_seq(begin_seq_init), segment_count(1), name(name_init)
       {
+        invalidate_info();
         current_segment = segments.insert(segments.end(), DataSegment());
         current_segment->end_time = end_time;
         current_segment->end_recno = end_recno;
@@ -1087,6 +1216,7 @@ class StreamMonitor
       gap_check(gap_check_init), gap_treshold(gap_treshold_init),
       begin_seq(-1), segment_count(1), name(name_init)
       {
+        invalidate_info();
         memset(&begin_time, 0, sizeof(INT_TIME));
 
         current_segment = segments.insert(segments.end(), DataSegment());
@@ -1104,6 +1234,7 @@ class StreamMonitor
     void delete_oldest_segment(int station_segment_count);
     bool empty() const;
     void getinfo(xmlNodePtr parent, int info_level) const;
+    const string &info_text(XMLFragment &frag, int info_level) const;
     void getstate(xmlNodePtr parent) const;
   };
 
@@ -1119,11 +1250,13 @@ void StreamMonitor::init_segment(INT_TIME end_time, int end_recno, int end_seq)
     current_segment->end_seq = end_seq;
     current_segment = p;
     ++segment_count;
+    invalidate_info();
   }
   
 void StreamMonitor::init_gap(INT_TIME begin_time, INT_TIME end_time)
   {
     current_segment->gaps.push_back(DataGap(begin_time, end_time));
+    invalidate_info();
   }
 
 void StreamMonitor::add_packet(INT_TIME start_time, int samples, double rate,
@@ -1152,6 +1285,7 @@ void StreamMonitor::add_packet(INT_TIME start_time, int samples, double rate,
 
     current_segment->end_recno = (recno + 1) % 1000000;
     current_segment->end_seq = (seq + 1) & SEQ_MASK;
+    invalidate_info();
   }
 
 int StreamMonitor::time_to_seq(INT_TIME it) const
@@ -1187,6 +1321,7 @@ void StreamMonitor::new_segment()
     p->end_seq = current_segment->end_seq;
     current_segment = p;
     ++segment_count;
+    invalidate_info();
   }
 
 void StreamMonitor::delete_oldest_segment(int station_segment_count)
@@ -1200,6 +1335,7 @@ void StreamMonitor::delete_oldest_segment(int station_segment_count)
     begin_seq = segments.front().end_seq;
     segments.pop_front();
     --segment_count;
+    invalidate_info();
   }
 
 bool StreamMonitor::empty() const
@@ -1247,6 +1383,21 @@ void StreamMonitor::getinfo(xmlNodePtr parent, int info_level) const
       }
   }
 
+// The serialized element is kept until the stream changes; one variant
+// without and one with gaps.
+const string &StreamMonitor::info_text(XMLFragment &frag, int info_level) const
+  {
+    int i = (info_level >= GapInfo);
+    if(!info_text_valid[i])
+      {
+        getinfo(frag.parent(), info_level);
+        frag.take(info_text_cache[i]);
+        info_text_valid[i] = true;
+      }
+
+    return info_text_cache[i];
+  }
+
 void StreamMonitor::getstate(xmlNodePtr parent) const
   {
     char buf[20];
@@ -1670,6 +1821,7 @@ class StationMonitorPartner
   public:
     virtual list<StationMonitor *>::iterator attach(StationMonitor *cw) =0;
     virtual void detach(list<StationMonitor *>::iterator ptr) =0;
+    virtual void changed() =0;
     virtual ~StationMonitorPartner() {}
   };
 
@@ -1691,6 +1843,14 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
     list<ConnectionMonitor *> cws;
     StationMonitorPartner &partner;
     list<StationMonitor *>::iterator sw_link;
+    mutable string info_head;
+    mutable bool info_head_valid;
+
+    void changed()
+      {
+        info_head_valid = false;
+        partner.changed();
+      }
 
     list<ConnectionMonitor *>::iterator attach(ConnectionMonitor *cw);
     void detach(list<ConnectionMonitor *>::iterator ptr);
@@ -1705,7 +1865,7 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
       name(name_init), network(network_init), description(description_init),
       ip_access(ip_access_init), begin_seq(0), end_seq(0), segment_count(1),
       stream_check(false), gap_check_rx_initialized(false),
-      partner(partner_init)
+      partner(partner_init), info_head_valid(false)
       {
         sw_link = partner.attach(this);
       }
@@ -1721,7 +1881,7 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
     rc_ptr<ConnectionMonitor> add_connection(const string &address, int port);
 
     void getmsg(ostream &mout, unsigned int ipaddr) const;
-    void getinfo(xmlNodePtr parent, int info_level, unsigned int ipaddr) const;
+    void getinfo(string &info, int info_level, unsigned int ipaddr) const;
     void save_state(const string &filename) const;
     void restore_state(const string &filename);
 
@@ -1733,11 +1893,13 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
     void set_begin_seq(int seq)
       {
         begin_seq = (seq & SEQ_MASK);
+        changed();
       }
 
     void set_end_seq(int seq)
       {
         end_seq = (seq & SEQ_MASK);
+        changed();
       }
 
     void reset()
@@ -1747,6 +1909,7 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
         segment_count = 1;
         // stream_check = false;
         stream_map.clear();
+        changed();
       }
   };
 
@@ -1829,6 +1992,8 @@ int StationMonitorImpl::time_cmp(INT_TIME it, const StreamFilter &filter) const
 void StationMonitorImpl::configure_stream_check(bool enabled,
   const string &regex, int treshold)
   {
+    changed();
+
     if(gap_check_rx_initialized)
       {
         regfree(&gap_check_rx);
@@ -1890,6 +2055,8 @@ void StationMonitorImpl::add_packet(int seq, const void *head, int size)
     p->second->add_packet(packet_begin_time(fsdh), ntohs(fsdh->num_samples),
       packet_sample_rate(fsdh), rate_defined, recno, seq);
 
+    partner.changed();
+
     // if(seq != end_seq)
     //     logs(LOG_ERR) << "sequence gap: end_seq = " << end_seq << ", "
     //       "seq = " << seq << endl;
@@ -1904,6 +2071,7 @@ void StationMonitorImpl::new_segment()
         p->second->new_segment();
 
     ++segment_count;
+    partner.changed();
   }
 
 void StationMonitorImpl::delete_oldest_segment()
@@ -1920,6 +2088,7 @@ void StationMonitorImpl::delete_oldest_segment()
       }
 
     --segment_count;
+    partner.changed();
   }
 
 rc_ptr<ConnectionMonitor> StationMonitorImpl::add_connection(const string &address,
@@ -1937,41 +2106,70 @@ void StationMonitorImpl::getmsg(ostream &mout, unsigned int ipaddr) const
          << description << endl;
   }
  
-void StationMonitorImpl::getinfo(xmlNodePtr parent, int info_level,
+void StationMonitorImpl::getinfo(string &info, int info_level,
   unsigned int ipaddr) const
   {
     if(!ipaccess(ipaddr)) return;
 
-    char buf[10];
-    xmlNodePtr child;
+    XMLFragment frag;
 
-    child = xml_new_child(parent, "station");
-    xml_new_prop(child, "name", name.c_str());
-    xml_new_prop(child, "network", network.c_str());
-    xml_new_prop(child, "description", description.c_str());
+    if(!info_head_valid)
+      {
+        char buf[10];
+        xmlNodePtr child;
 
-    snprintf(buf, 8, "%06X", begin_seq);
-    xml_new_prop(child, "begin_seq", buf);
+        child = xml_new_child(frag.parent(), "station");
+        xml_new_prop(child, "name", name.c_str());
+        xml_new_prop(child, "network", network.c_str());
+        xml_new_prop(child, "description", description.c_str());
 
-    snprintf(buf, 8, "%06X", end_seq);
-    xml_new_prop(child, "end_seq", buf);
+        snprintf(buf, 8, "%06X", begin_seq);
+        xml_new_prop(child, "begin_seq", buf);
 
-    xml_new_prop(child, "stream_check", (stream_check ? "enabled": "disabled"));
+        snprintf(buf, 8, "%06X", end_seq);
+        xml_new_prop(child, "end_seq", buf);
+
+        xml_new_prop(child, "stream_check", (stream_check ? "enabled": "disabled"));
+
+        frag.take(info_head);
+        info_head_valid = true;
+      }
+
+    bool streams = (((info_level >= StreamInfo && info_level <= GapInfo) ||
+      info_level == AllInfo) && stream_check && !stream_map.empty());
+    
+    bool connections = (info_level >= ConnectionInfo && !cws.empty());
 
-    if(((info_level >= StreamInfo && info_level <= GapInfo) ||
-      info_level == AllInfo) && stream_check)
+    if(!streams && !connections)
+      {
+        info += info_head;
+        return;
+      }
+
+    // reopen "<station .../>"
+    info.append(info_head, 0, info_head.length() - 2);
+    info += '>';
+    
+    if(streams)
       {
         map<StreamDescriptor, rc_ptr<StreamMonitor> >::const_iterator p;
         for(p = stream_map.begin(); p != stream_map.end(); ++p)
-            p->second->getinfo(child, info_level);
+            info += p->second->info_text(frag, info_level);
       }
     
-    if(info_level >= ConnectionInfo)
+    if(connections)
       {
+        // connections change with every packet sent, so they are not cached
         list<ConnectionMonitor *>::const_iterator p;
         for(p = cws.begin(); p != cws.end(); ++p)
-            (*p)->getinfo(child, info_level);
+            (*p)->getinfo(frag.parent(), info_level);
+
+        string text;
+        frag.take(text);
+        info += text;
       }
+
+    info += "</station>";
   }
 
 void StationMonitorImpl::save_state(const string &filename) const
@@ -2009,6 +2207,8 @@ void StationMonitorImpl::save_state(const string &filename) const
 
 void StationMonitorImpl::restore_state(const string &filename)
   {
+    changed();
+
     bool error = false;
 
     rc_ptr<CfgAttributeMap> atts = new CfgAttributeMap;
@@ -2048,19 +2248,33 @@ class MasterMonitorImpl: public MasterMonitor, private StationMonitorPartner
     INT_TIME start_time;
     list<Capability> caps;
     list<StationMonitor *> sws;
+    string info_root;
+    unsigned int generation;
+    mutable unsigned int info_cache_generation;
+    mutable map<unsigned int, list<rc_ptr<InfoBuffer> > > info_cache[N_InfoLevel];
+    mutable string info_text;
 
     list<StationMonitor *>::iterator attach(StationMonitor *sw);
     void detach(list<StationMonitor *>::iterator ptr);
     
+    void changed()
+      {
+        ++generation;
+      }
+
+    void make_info_root();
+    
   public:
     MasterMonitorImpl(int reclen_init, const string &info_streamname_init, 
       const string &error_streamname_init, const string &software_init,
       const string &organization_init, const IPACL &ip_trusted_init):
       reclen(reclen_init), info_streamname(info_streamname_init),
       error_streamname(error_streamname_init), software(software_init),
-      organization(organization_init), ip_trusted(ip_trusted_init)
+      organization(organization_init), ip_trusted(ip_trusted_init),
+      generation(0), info_cache_generation(0)
       {
         start_time = get_real_time();
+        make_info_root();
       }
 
     ~MasterMonitorImpl();
@@ -2097,17 +2311,48 @@ MasterMonitorImpl::~MasterMonitorImpl()
 
 list<StationMonitor *>::iterator MasterMonitorImpl::attach(StationMonitor *sw)
   {
+    changed();
     return sws.insert(sws.end(), sw);
   }
 
 void MasterMonitorImpl::detach(list<StationMonitor *>::iterator ptr)
   {
     sws.erase(ptr);
+    changed();
+  }
+
+// Serializes the empty document, "<?xml ...?>\n<seedlink .../>\n", which
+// info_out() reopens when there is content.
+void MasterMonitorImpl::make_info_root()
+  {
+    xmlSetGenericErrorFunc(NULL, xml_error);
+    
+    xmlDocPtr doc;
+    if((doc = xmlNewDoc((const xmlChar *) "1.0")) == NULL)
+        throw bad_alloc();
+        
+    if((doc->children = xmlNewDocNode(doc, NULL, (const xmlChar *) "seedlink", NULL)) == NULL)
+        throw bad_alloc();
+
+    xml_new_prop(doc->children, "software", software.c_str());
+    xml_new_prop(doc->children, "organization", organization.c_str());
+    xml_new_prop(doc->children, "started", time_to_str(start_time, MONTHS_FMT));
+
+    xmlChar *mem;
+    int size;
+    xmlDocDumpMemory(doc, &mem, &size);
+    if(mem == NULL) throw bad_alloc();
+
+    info_root.assign((const char *) mem, size);
+    xmlFree(mem);
+    xmlFreeDoc(doc);
+    xmlSetGenericErrorFunc(NULL, NULL);
   }
 
 void MasterMonitorImpl::add_capability(const string &name, bool restricted)
   {
     caps.push_back(Capability(name, restricted));
+    changed();
   }
 
 rc_ptr<StationMonitor> MasterMonitorImpl::add_station(const string &name,
@@ -2151,49 +2396,86 @@ void MasterMonitorImpl::error_out(list<rc_ptr<InfoBuffer> > &buflist) const
     xmlSetGenericErrorFunc(NULL, NULL);
   }
 
+// The document is assembled from the serialized stations, which in turn
+// only serialize streams that changed since the previous request. Documents
+// without connections are also kept per client address until anything
+// changes, so repeated requests just share the same buffers.
 void MasterMonitorImpl::info_out(list<rc_ptr<InfoBuffer> > &buflist,
   int info_level, unsigned int ipaddr) const
   {
     internal_check(info_level >= 0 && info_level < N_InfoLevel);
     
-    xmlSetGenericErrorFunc(NULL, xml_error);
+    bool cacheable = (info_level < ConnectionInfo);
     
-    xmlDocPtr doc;
-    if((doc = xmlNewDoc((const xmlChar *) "1.0")) == NULL)
-        throw bad_alloc();
-        
-    if((doc->children = xmlNewDocNode(doc, NULL, (const xmlChar *) "seedlink", NULL)) == NULL)
-        throw bad_alloc();
+    if(cacheable)
+      {
+        if(info_cache_generation != generation)
+          {
+            for(int i = 0; i < N_InfoLevel; ++i)
+                info_cache[i].clear();
 
-    xml_new_prop(doc->children, "software", software.c_str());
-    xml_new_prop(doc->children, "organization", organization.c_str());
-    xml_new_prop(doc->children, "started", time_to_str(start_time, MONTHS_FMT));
+            info_cache_generation = generation;
+          }
+
+        map<unsigned int, list<rc_ptr<InfoBuffer> > >::const_iterator p;
+        if((p = info_cache[info_level].find(ipaddr)) != info_cache[info_level].end())
+          {
+            buflist.insert(buflist.end(), p->second.begin(), p->second.end());
+            return;
+          }
+      }
+
+    xmlSetGenericErrorFunc(NULL, xml_error);
+    
+    // reopen "<seedlink .../>\n"
+    info_text.assign(info_root, 0, info_root.length() - 3);
+    info_text += '>';
+    
+    string::size_type root_length = info_text.length();
 
     if(info_level == CapabilityInfo || info_level == AllInfo)
       {
+        XMLFragment frag;
         list<Capability>::const_iterator p;
         for(p = caps.begin(); p != caps.end(); ++p)
           {
             if(p->restricted && !iptrusted(ipaddr)) continue;
             
             xmlNodePtr child;
-            child = xml_new_child(doc->children, "capability");
+            child = xml_new_child(frag.parent(), "capability");
             xml_new_prop(child, "name", p->name.c_str());
           }
+
+        string text;
+        frag.take(text);
+        info_text += text;
       }
           
     if(info_level >= StationInfo)
       {
         list<StationMonitor *>::const_iterator p;
         for(p = sws.begin(); p != sws.end(); ++p)
-            (*p)->getinfo(doc->children, info_level, ipaddr);
+            (*p)->getinfo(info_text, info_level, ipaddr);
       }
         
-    InfoGenerator xg(reclen, info_streamname, buflist);
-
-    xg.write_doc(doc);
-    xmlFreeDoc(doc);
     xmlSetGenericErrorFunc(NULL, NULL);
+
+    if(info_text.length() == root_length)
+        info_text = info_root;
+    else
+        info_text += "</seedlink>\n";
+
+    list<rc_ptr<InfoBuffer> > doc_bufs;
+    
+      {
+        InfoGenerator xg(reclen, info_streamname, doc_bufs);
+        xg.write_text(info_text);
+      }
+
+    if(cacheable)
+        info_cache[info_level][ipaddr] = doc_bufs;
+
+    buflist.splice(buflist.end(), doc_bufs);
   }
 
 //*****************************************************************************
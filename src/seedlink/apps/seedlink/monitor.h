@@ -206,7 +206,7 @@ class StationMonitor
     virtual rc_ptr<ConnectionMonitor> add_connection(const string &address,
       int port) =0;
     virtual void getmsg(ostream &mout, unsigned int ipaddr) const =0;
-    virtual void getinfo(xmlNodePtr parent, int info_level,
+    virtual void getinfo(string &info, int info_level,
       unsigned int ipaddr) const =0;
     virtual void save_state(const string &filename) const =0;
     virtual void restore_state(const string &filename) =0;
@@ -23,8 +23,17 @@ static int send_log_helper(const char *station, const struct ptime *pt,
   const char *fmt, va_list argptr);
 static int send_packet(const struct PluginPacketHeader *head,
   const void *dataptr, int data_bytes);
+static int send_batch_flush(void);
 static ssize_t writen(int fd, const void *vptr, size_t n);
 
+/* Packets sent between send_batch_begin() and send_batch_end() are
+ * collected here and written to the server with a single write() */
+#define BATCH_BUFSIZE 65536
+
+static char batch_buf[BATCH_BUFSIZE];
+static int batch_len = 0;
+static int batch_active = 0;
+
 int send_raw3(const char *station, const char *channel, const struct ptime *pt,
   int usec_correction, int timing_quality, const int32_t *dataptr,
   int number_of_samples)
@@ -266,15 +275,65 @@ int send_log_helper(const char *station, const struct ptime *pt,
     return send_packet(&head, buf, msgsize + 2);
   }
 
+void send_batch_begin(void)
+  {
+    batch_active = 1;
+  }
+
+/* Writes out the packets collected since send_batch_begin(). Returns 0 on
+ * success and -1 on error. */
+int send_batch_end(void)
+  {
+    batch_active = 0;
+    return send_batch_flush();
+  }
+
+int send_batch_flush(void)
+  {
+    int len = batch_len;
+    
+    if(len == 0)
+        return 0;
+
+    batch_len = 0;
+    
+    if(writen(PLUGIN_FD, batch_buf, len) <= 0)
+        return -1;
+
+    return 0;
+  }
+
 int send_packet(const struct PluginPacketHeader *head, const void *dataptr,
   int data_bytes)
   {
-    int r;
+    int r, size;
+    char buf[sizeof(struct PluginPacketHeader) + PLUGIN_MAX_DATA_BYTES];
+    char *ptr = buf;
+
+    if(dataptr == NULL)
+        data_bytes = 0;
     
-    if((r = writen(PLUGIN_FD, head, sizeof(struct PluginPacketHeader))) <= 0)
-        return r;
+    if(data_bytes < 0 || data_bytes > PLUGIN_MAX_DATA_BYTES)
+        return -1;
+    
+    size = sizeof(struct PluginPacketHeader) + data_bytes;
     
-    if(dataptr != NULL && (r = writen(PLUGIN_FD, dataptr, data_bytes)) <= 0)
+    if(batch_active)
+      {
+        if(batch_len + size > BATCH_BUFSIZE && send_batch_flush() < 0)
+            return -1;
+        
+        ptr = batch_buf + batch_len;
+        batch_len += size;
+      }
+
+    /* header and data go out with one write() */
+    memcpy(ptr, head, sizeof(struct PluginPacketHeader));
+    
+    if(data_bytes != 0)
+        memcpy(ptr + sizeof(struct PluginPacketHeader), dataptr, data_bytes);
+
+    if(!batch_active && (r = writen(PLUGIN_FD, buf, size)) <= 0)
         return r;
 
     return data_bytes;
@@ -75,6 +75,8 @@ int send_mseed2(const char *station, const char *channel, int seq,
 int send_raw_depoch(const char *station, const char *channel, double depoch,
   int usec_correction, int timing_quality, const int32_t *dataptr,
   int number_of_samples);
+void send_batch_begin(void);
+int send_batch_end(void);
 
 #ifdef PLUGIN_COMPATIBILITY
 int send_raw(const char *station, const char *channel, const INT_TIME *it,
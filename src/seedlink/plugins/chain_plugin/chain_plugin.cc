@@ -14,6 +14,7 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 #include <set>
 #include <cstring>
 #include <cstdio>
@@ -25,11 +26,18 @@
 #include <termios.h>
 #include <fcntl.h>
 #include <setjmp.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/ioctl.h>
 #include <netinet/in.h>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#define HAVE_EPOLL
+#endif
+
 #if defined(__GNU_LIBRARY__) || defined(__GLIBC__)
 #include <getopt.h>
 #endif
@@ -52,7 +60,7 @@
 
 #include "schedule.h"
 
-#define MYVERSION "2.0 (2010.256)"
+#define MYVERSION "2.1 (2026.291)"
 
 #ifndef CONFIG_FILE
 #define CONFIG_FILE "/home/sysop/config/chain.xml"
@@ -83,6 +91,8 @@ const int STATLEN             = 5;
 const int NETLEN              = 2;
 const int LOCLEN              = 2;
 const int CHLEN               = 3;
+const int UPLINK_BATCH        = 32;
+const int MAX_EVENTS          = 64;
 const char *const SHELL       = "/bin/bash";
 
 const char *const ident_str = "SeedLink Chain Plugin v" MYVERSION;
@@ -931,11 +941,153 @@ void Station::process_mseed(char *pseed, int packtype, int seq, int size)
 // StationGroup
 //*****************************************************************************
 
+class StationGroup;
+
+//*****************************************************************************
+// UplinkPoller
+//*****************************************************************************
+
+// Waits for data from the connections of all groups. The descriptors stay
+// registered with epoll between calls, so a wakeup costs only as much as
+// the number of connections that actually have data. Other systems use
+// poll().
+
+class UplinkPoller
+  {
+  private:
+#ifdef HAVE_EPOLL
+    int epoll_fd;
+#endif
+    map<int, StationGroup *> watched;
+    vector<pollfd> pfds;
+
+  public:
+    UplinkPoller();
+    ~UplinkPoller();
+
+    void add(int fd, StationGroup *group);
+    void remove(int fd);
+    void wait(vector<pollfd> &extra, int timeout,
+      vector<StationGroup *> &ready);
+  };
+
+UplinkPoller::UplinkPoller()
+  {
+#ifdef HAVE_EPOLL
+    N(epoll_fd = epoll_create(MAX_EVENTS));
+    N(fcntl(epoll_fd, F_SETFD, FD_CLOEXEC));
+#endif
+  }
+
+UplinkPoller::~UplinkPoller()
+  {
+#ifdef HAVE_EPOLL
+    close(epoll_fd);
+#endif
+  }
+
+void UplinkPoller::add(int fd, StationGroup *group)
+  {
+    internal_check(watched.find(fd) == watched.end());
+
+#ifdef HAVE_EPOLL
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = group;
+    N(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev));
+#endif
+
+    watched.insert(make_pair(fd, group));
+  }
+
+// Must be called before the descriptor is closed, because a copy of it
+// inherited by a child process would keep the registration alive
+
+void UplinkPoller::remove(int fd)
+  {
+    map<int, StationGroup *>::iterator p;
+    if((p = watched.find(fd)) == watched.end())
+        return;
+
+#ifdef HAVE_EPOLL
+    epoll_event ev;
+    N(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev));
+#endif
+
+    watched.erase(p);
+  }
+
+// Also polls the descriptors in "extra" and sets their revents
+
+void UplinkPoller::wait(vector<pollfd> &extra, int timeout,
+  vector<StationGroup *> &ready)
+  {
+    ready.clear();
+    pfds.clear();
+
+#ifdef HAVE_EPOLL
+    pollfd pfd;
+    pfd.fd = epoll_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    pfds.push_back(pfd);
+#else
+    map<int, StationGroup *>::iterator p;
+    for(p = watched.begin(); p != watched.end(); ++p)
+      {
+        pollfd pfd;
+        pfd.fd = p->first;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        pfds.push_back(pfd);
+      }
+#endif
+
+    int nwatched = pfds.size();
+    pfds.insert(pfds.end(), extra.begin(), extra.end());
+
+    if(poll(&pfds[0], pfds.size(), timeout) < 0)
+      {
+        if(errno == EINTR) return;
+        throw PluginLibraryError("poll error");
+      }
+
+    for(unsigned int i = 0; i < extra.size(); ++i)
+        extra[i].revents = pfds[nwatched + i].revents;
+
+#ifdef HAVE_EPOLL
+    if(pfds[0].revents == 0)
+        return;
+
+    epoll_event evs[MAX_EVENTS];
+    int n;
+    if((n = epoll_wait(epoll_fd, evs, MAX_EVENTS, 0)) < 0)
+      {
+        if(errno == EINTR) return;
+        throw PluginLibraryError("epoll_wait error");
+      }
+
+    for(int i = 0; i < n; ++i)
+        ready.push_back(static_cast<StationGroup *>(evs[i].data.ptr));
+#else
+    for(int i = 0; i < nwatched; ++i)
+        if(pfds[i].revents)
+            ready.push_back(watched[pfds[i].fd]);
+#endif
+  }
+
+//*****************************************************************************
+// StationGroup
+//*****************************************************************************
+
 class StationGroup
   {
   private:
+    UplinkPoller &poller;
     pid_t pid;
     int parent_fd;
+    bool parent_eof;
     bool sigterm_sent;
     bool sigkill_sent;
     bool shutdown_requested;
@@ -955,6 +1107,17 @@ class StationGroup
     string lockfile;
     SLCD *slcd;
 
+    char rbuf[UPLINK_BATCH * (SLHEADSIZE + SLRECSIZE)];
+    int rlen;
+    int rpos;
+
+    // statistics since the last report
+    int stat_packets;
+    int stat_reads;
+    long stat_bytes;
+    int stat_backlog;
+    int stat_backlog_max;
+
     static StationGroup *obj;
     static void term_handler(int sig);
     
@@ -967,9 +1130,10 @@ class StationGroup
     void lock_wait();
 
   public:
-    StationGroup(const string &address, bool multi_init, bool batch_init,
-      int netto, int netdly, int keepalive, int uptime, int standby, int shutdown,
-      int seqsave, const string &seqfile_init, const string &ifup_init,
+    StationGroup(UplinkPoller &poller_init, const string &address,
+      bool multi_init, bool batch_init, int netto, int netdly, int keepalive,
+      int uptime, int standby, int shutdown, int seqsave,
+      const string &seqfile_init, const string &ifup_init,
       const string &ifdown_init, const string &lockfile_init);
 
     ~StationGroup();
@@ -979,6 +1143,10 @@ class StationGroup
     void shutdown();
     void check();
     bool confirm_shutdown();
+    int receive();
+    char *next_packet();
+    void eof();
+    void report_stats(int interval);
 
     int filedes()
       {
@@ -986,15 +1154,20 @@ class StationGroup
       }
   };
 
-StationGroup::StationGroup(const string &address, bool multi_init, bool batch_init,
-  int netto, int netdly, int keepalive, int uptime, int standby, int shutdown,
-  int seqsave, const string &seqfile_init, const string &ifup_init,
+StationGroup::StationGroup(UplinkPoller &poller_init, const string &address,
+  bool multi_init, bool batch_init, int netto, int netdly, int keepalive,
+  int uptime, int standby, int shutdown, int seqsave,
+  const string &seqfile_init, const string &ifup_init,
   const string &ifdown_init, const string &lockfile_init):
-  pid(-1), parent_fd(-1), sigterm_sent(false), sigkill_sent(false),
-  shutdown_requested(false), uptime_timer(uptime, 0), standby_timer(standby, 0),
-  shutdown_timer(shutdown, 0), seqsave_timer(seqsave, 0), seqfile(seqfile_init),
-  ifup_cmd(ifup_init), ifdown_cmd(ifdown_init), multi(multi_init), batch(batch_init),
-  have_schedule(false), last_schedule_check(0), lockfile(lockfile_init)
+  poller(poller_init), pid(-1), parent_fd(-1), parent_eof(false),
+  sigterm_sent(false), sigkill_sent(false), shutdown_requested(false),
+  uptime_timer(uptime, 0), standby_timer(standby, 0),
+  shutdown_timer(shutdown, 0), seqsave_timer(seqsave, 0),
+  seqfile(seqfile_init), ifup_cmd(ifup_init), ifdown_cmd(ifdown_init),
+  multi(multi_init), batch(batch_init), have_schedule(false),
+  last_schedule_check(0), lockfile(lockfile_init),
+  rlen(0), rpos(0), stat_packets(0), stat_reads(0), stat_bytes(0),
+  stat_backlog(0), stat_backlog_max(0)
   {
     if((slcd = sl_newslcd()) == NULL)
       throw bad_alloc();
@@ -1161,6 +1334,10 @@ void StationGroup::open_connection()
         close(pipe_fd[1]);
         parent_fd = pipe_fd[0];
         fcntl(parent_fd, F_SETFD, FD_CLOEXEC);
+        N(fcntl(parent_fd, F_SETFL, O_NONBLOCK));
+        poller.add(parent_fd, this);
+        parent_eof = false;
+        rlen = rpos = 0;
 
         N(sigprocmask(SIG_SETMASK, &oldmask, NULL));
         uptime_timer.reset();
@@ -1342,8 +1519,6 @@ void StationGroup::check()
     if((completed = waitpid(pid, &status, WNOHANG)) < 0)
       {
         logs(LOG_ERR) << "waitpid: " << strerror(errno) << endl;
-        close(parent_fd);
-        parent_fd = -1;
         pid = -1;
         return;
       }
@@ -1372,12 +1547,21 @@ void StationGroup::check()
     standby_timer.reset();
   }
 
+// The connection is only closed when the child process has been collected
+// and everything it wrote has been read up to EOF, so the last packets of
+// a session are not lost.
+
 bool StationGroup::confirm_shutdown()
   {
     if(pid < 0)
       {
         if(parent_fd >= 0)
+          {
+            if(!parent_eof)
+                return false;
+
             close(parent_fd);
+          }
 
         parent_fd = -1;
 
@@ -1386,6 +1570,76 @@ bool StationGroup::confirm_shutdown()
     
     return false;
   }
+
+// Reads as many packets as are available from the connection, up to
+// UPLINK_BATCH. Return value as with read(2).
+
+int StationGroup::receive()
+  {
+    if(rpos > 0)
+      {
+        memmove(rbuf, rbuf + rpos, rlen - rpos);
+        rlen -= rpos;
+        rpos = 0;
+      }
+
+    int nleft = sizeof(rbuf) - rlen;
+    int nread;
+    if((nread = read(parent_fd, rbuf + rlen, nleft)) <= 0)
+        return nread;
+
+    rlen += nread;
+    ++stat_reads;
+    stat_bytes += nread;
+
+    // The pipe can only hold more if the buffer was filled up
+    int backlog = 0;
+    if(nread == nleft && ioctl(parent_fd, FIONREAD, &backlog) < 0)
+        backlog = 0;
+    
+    stat_backlog = backlog;
+    if(backlog > stat_backlog_max)
+        stat_backlog_max = backlog;
+    
+    return nread;
+  }
+
+char *StationGroup::next_packet()
+  {
+    if(rlen - rpos < SLHEADSIZE + SLRECSIZE)
+        return NULL;
+
+    char *p = rbuf + rpos;
+    rpos += SLHEADSIZE + SLRECSIZE;
+    ++stat_packets;
+    return p;
+  }
+
+// Called on EOF after all complete packets have been taken from the buffer.
+// The descriptor is no longer polled, but it is kept open until the child
+// process has been collected by check().
+
+void StationGroup::eof()
+  {
+    poller.remove(parent_fd);
+    parent_eof = true;
+  }
+
+void StationGroup::report_stats(int interval)
+  {
+    if(parent_fd >= 0 || stat_reads != 0)
+      {
+        logs(LOG_NOTICE) << "[" << slcd->sladdr << "] " << stat_packets <<
+          " packets (" << stat_packets / interval << "/s) in " <<
+          stat_reads << " reads, " << stat_bytes << " bytes, "
+          "backlog " << stat_backlog << " bytes (max " << stat_backlog_max <<
+          ")" << endl;
+      }
+
+    stat_packets = stat_reads = 0;
+    stat_bytes = 0;
+    stat_backlog_max = stat_backlog;
+  }
     
 //*****************************************************************************
 // Extension
@@ -1934,17 +2188,32 @@ class Chain: private Extension_Partner
     map<string, rc_ptr<Station> > station_id_map;
     list<rc_ptr<StationGroup> > groups;
     list<rc_ptr<Extension> > extensions;
+    UplinkPoller poller;
+    vector<StationGroup *> ready_groups;
+    vector<pollfd> ext_pfds;
     time_t last_ext_check;
+    time_t last_group_check;
+    time_t last_stats;
+    int stats_interval;
 
     void extension_request(const string &cmd);
-    int process_slpacket(int fd);
+    void process_slpacket(char *buf);
+    bool receive(StationGroup *group);
+    void check_groups();
     void setup_timetable(const string &timetable_loader);
 
   public:
-    Chain(): last_ext_check(0) {}
+    Chain(): last_ext_check(0), last_group_check(0), last_stats(0),
+      stats_interval(0) {}
 
     void setup(const string &timetable_loader);
 
+    void set_stats_interval(int interval)
+      {
+        stats_interval = interval;
+        last_stats = time(NULL);
+      }
+
     void new_extension(const string &name, const string &filter,
       const string &cmdline, int recv_timeout, int send_timeout,
       int start_retry, int shutdown_wait);
@@ -2113,25 +2382,18 @@ void Chain::setup_timetable(const string &timetable_loader)
         p->second->clear_timetable();
   }
 
-int Chain::process_slpacket(int fd)
+void Chain::process_slpacket(char *buf)
   {
-    char buf[SLHEADSIZE + SLRECSIZE];
     SLpacket* slpack = reinterpret_cast<SLpacket *>(buf);
     sl_fsdh_s* fsdh = reinterpret_cast<sl_fsdh_s *>(slpack->msrecord);
 
-    int bytes_read;
-    if((bytes_read = readn(fd, buf, SLHEADSIZE + SLRECSIZE)) <= 0)
-        return bytes_read;
-
-    internal_check(bytes_read == SLHEADSIZE + SLRECSIZE);
-
     int packtype = sl_packettype(slpack);
 
     if(packtype == SLNUM)
         logs(LOG_ERR) << "could not determine packet type" << endl;
       
     if(packtype >= SLNUM)
-        return bytes_read;
+        return;
     
     string net, sta, loc, chn;
     get_id(fsdh, net, sta, loc, chn);
@@ -2144,7 +2406,7 @@ int Chain::process_slpacket(int fd)
           " received, but not requested" << endl;
 
         stations.insert(make_pair(stad, new Station()));
-        return bytes_read;
+        return;
       }
 
     sp->second->process_mseed(slpack->msrecord, packtype, sl_sequence(slpack), SLRECSIZE);
@@ -2152,8 +2414,61 @@ int Chain::process_slpacket(int fd)
     list<rc_ptr<Extension> >::iterator ep;
     for(ep = extensions.begin(); ep != extensions.end(); ++ep)
         (*ep)->feed(slpack->msrecord, packtype, SLRECSIZE);
+  }
+
+// Processes one batch of packets from a group, returns false on EOF
+
+bool Chain::receive(StationGroup *group)
+  {
+    int r;
+    if((r = group->receive()) < 0)
+      {
+        if(errno == EAGAIN || errno == EINTR)
+            return true;
+
+        throw PluginCannotReadChild();
+      }
+
+    char *p;
+    while((p = group->next_packet()) != NULL)
+        process_slpacket(p);
+
+    if(r == 0)
+      {
+        group->eof();
+        return false;
+      }
+
+    return true;
+  }
+
+void Chain::check_groups()
+  {
+    time_t curtime = time(NULL);
+    bool report = (stats_interval > 0 &&
+      curtime - last_stats >= stats_interval);
+    
+    list<rc_ptr<StationGroup> >::iterator gp = groups.begin();
+    while(gp != groups.end())
+      {
+        (*gp)->check();
+        
+        if(report)
+            (*gp)->report_stats(curtime - last_stats);
+        
+        if((*gp)->confirm_shutdown())
+          {
+            groups.erase(gp++);
+            continue;
+          }
+
+        ++gp;
+      }
 
-    return bytes_read;
+    last_group_check = curtime;
+    
+    if(report)
+        last_stats = curtime;
   }
 
 void Chain::setup(const string &timetable_loader)
@@ -2167,94 +2482,76 @@ void Chain::setup(const string &timetable_loader)
 
 void Chain::check()
   {
-    fd_set read_set;
-    FD_ZERO(&read_set);
-    int fd_max = -1;
-
-    list<rc_ptr<StationGroup> >::iterator gp;
-    for(gp = groups.begin(); gp != groups.end(); ++gp)
-      {
-        (*gp)->check();
-        
-        int fd = (*gp)->filedes();
-        
-        if(fd != -1)
-            FD_SET(fd, &read_set);
-
-        if(fd > fd_max)
-            fd_max = fd;
-      }
+    ext_pfds.clear();
 
     list<rc_ptr<Extension> >::iterator ep;
     for(ep = extensions.begin(); ep != extensions.end(); ++ep)
       {
         pair<int, int> fd = (*ep)->filedes();
+        pollfd pfd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
         
-        if(fd.first  != -1)
-            FD_SET(fd.first, &read_set);
-
-        if(fd.first > fd_max)
-            fd_max = fd.first;
+        pfd.fd = fd.first;
+        ext_pfds.push_back(pfd);
         
-        if(fd.second != -1)
-            FD_SET(fd.second, &read_set);
-
-        if(fd.second > fd_max)
-            fd_max = fd.second;
+        pfd.fd = fd.second;
+        ext_pfds.push_back(pfd);
       }
-        
-    struct timeval tv;
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
 
-    if(select(fd_max + 1, &read_set, NULL, NULL, &tv) < 0)
-      {
-        if(errno == EINTR) return;
-        throw PluginLibraryError("select error");
-      }
+    // Group timers and child processes are checked once per second or
+    // when a connection has been closed
+    
+    if(last_group_check != time(NULL))
+        check_groups();
+        
+    poller.wait(ext_pfds, POLL_USEC / 1000, ready_groups);
 
-    gp = groups.begin();
-    while(gp != groups.end())
+    // Each group with data gets one batch per round, so a busy uplink
+    // cannot hold back the others. Packets sent to the server in one round
+    // are written out together.
+    
+    bool eof = false;
+    
+    send_batch_begin();
+    
+    vector<StationGroup *>::iterator rp;
+    for(rp = ready_groups.begin(); rp != ready_groups.end(); ++rp)
       {
-        int r = 0;
-        int fd = (*gp)->filedes();
-        if(fd != -1 && FD_ISSET(fd, &read_set))
-          {
-            if((r = process_slpacket(fd)) < 0)
-                throw PluginCannotReadChild();
-          }
-
-        if(r == 0 && (*gp)->confirm_shutdown())
-          {
-            groups.erase(gp++);
-            continue;
-          }
-
-        ++gp;
+        if(!receive(*rp))
+            eof = true;
       }
 
+    if(send_batch_end() < 0)
+        throw PluginBrokenLink(strerror(errno));
+    
+    if(eof)
+        check_groups();
+    
     time_t curtime = time(NULL);
     
+    int n = 0;
     ep = extensions.begin();
     while(ep != extensions.end())
       {
-        pair<int, int> fd = (*ep)->filedes();
-
-        if((fd.first == -1 || !FD_ISSET(fd.first, &read_set)) &&
-          (fd.second == -1 || !FD_ISSET(fd.second, &read_set)) &&
+        // pollfd with negative fd has revents 0
+        if(ext_pfds[n].revents == 0 && ext_pfds[n + 1].revents == 0 &&
           last_ext_check == curtime)
           {
             ++ep;
+            n += 2;
             continue;
           }
 
         if((*ep)->check())
           {
             extensions.erase(ep++);
+            n += 2;
             continue;
           }
 
         ++ep;
+        n += 2;
       }
 
     last_ext_check = curtime;
@@ -2298,9 +2595,9 @@ rc_ptr<StationGroup> Chain::new_group(const string &address,
   int standby, int shutdown, int seqsave, const string &seqfile,
   const string &ifup, const string &ifdown, const string &lockfile)
   {
-    rc_ptr<StationGroup> group = new StationGroup(address, multi, batch,
-      netto, netdly, keepalive, uptime, standby, shutdown, seqsave, seqfile,
-      ifup, ifdown, lockfile);
+    rc_ptr<StationGroup> group = new StationGroup(poller, address, multi,
+      batch, netto, netdly, keepalive, uptime, standby, shutdown, seqsave,
+      seqfile, ifup, ifdown, lockfile);
     
     groups.push_back(group);
     return group;
@@ -2831,6 +3128,7 @@ class ChainElement: public CfgElement
     int keepalive;
     int standby;
     int seqsave;
+    int stats_interval;
 
   public:
     ChainElement(string &timetable_loader_init):
@@ -2857,6 +3155,7 @@ rc_ptr<CfgAttributeMap> ChainElement::start_attributes(ostream &cfglog,
     keepalive = 0;
     standby = 0;
     seqsave = 0;
+    stats_interval = 0;
     
     rc_ptr<CfgAttributeMap> atts = new CfgAttributeMap;
     atts->add_item(StringAttribute("timetable_loader", timetable_loader));
@@ -2875,6 +3174,8 @@ rc_ptr<CfgAttributeMap> ChainElement::start_attributes(ostream &cfglog,
       IntAttribute::lower_bound));
     atts->add_item(IntAttribute("seqsave", seqsave, 10,
       IntAttribute::lower_bound));
+    atts->add_item(IntAttribute("stats_interval", stats_interval, 0,
+      IntAttribute::lower_bound));
     
     return atts;
   }
@@ -2882,6 +3183,7 @@ rc_ptr<CfgAttributeMap> ChainElement::start_attributes(ostream &cfglog,
 void ChainElement::end_attributes(ostream &cfglog)
   {
     log_setup(verbosity);
+    chain.set_stats_interval(stats_interval);
   }
 
 rc_ptr<CfgElementMap> ChainElement::start_children(ostream &cfglog,
@@ -32,6 +32,14 @@
  *
  * The directory separator is assumed to be '/'.
  *
+ * On Linux the directories are watched with inotify after the initial
+ * scan, new or appended files are read as soon as they are modified
+ * and new sub-directories are watched as they are created.  The
+ * directories are only scanned again if events were lost.  Scanning
+ * at regular intervals remains the fallback if inotify is not
+ * available or requested with -P, e.g. for network file systems
+ * where modifications on other hosts are not reported.
+ *
  * If the signal SIGUSR1 is recieved the program will print the
  * current file list to standard error.
  *
@@ -52,6 +60,12 @@
 #include <dirent.h>
 #include <regex.h>
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#define HAVE_INOTIFY 1
+#endif
+
 #ifndef TESTING
 #include <plugin.h>
 #endif
@@ -61,7 +75,7 @@
 #include "seedutil.h"
 
 #define PACKAGE "mseedscan_plugin"
-#define VERSION "2006.292"
+#define VERSION "2026.291"
 
 #define RECSIZE 512
 
@@ -97,6 +111,13 @@ typedef struct dirlink {
   char dirname[1];
 } DirLink;
 
+/* Structure used as the data for tree of watched directories keyed
+ * on the watch descriptor */
+typedef struct watchnode {
+  int level;             /* Remaining levels of recursion below this directory */
+  char dirname[1];       /* Directory name, sized appropriately */
+} WatchNode;
+
 /* Structure for directory list file */
 typedef struct dirfile {
   char filename[MAX_FILENAME_LENGTH];
@@ -121,11 +142,24 @@ static int   stateint   = 300;  /* State saving interval in seconds */
 static char *statefile  = 0;    /* State file for saving/restoring time stamps */
 static regex_t *fnmatch  = 0;   /* Filename match regex */
 static regex_t *fnreject = 0;   /* Filename reject regex */
+static char  polling    = 0;    /* Always scan, do not watch directories */
+static char  rescan     = 1;    /* Scan directories at the next interval */
+
+#ifdef HAVE_INOTIFY
+#define WATCHMASK (IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | \
+                   IN_MOVED_FROM | IN_DELETE | IN_MOVE_SELF | IN_ONLYDIR)
+
+static RBTree *watchtree = 0;   /* Watched directories */
+static int    inotifyfd  = -1;  /* inotify instance, -1 if scanning */
+static char **deleted    = 0;   /* Deleted files and directories to forget */
+static int    ndeleted   = 0;
+static int    maxdeleted = 0;
+#endif
 
 static int scanfiles (char *targetdir, char *basedir, int level, time_t scantime);
 static FileNode *findfile (FileKey *fkey);
 static FileNode *addfile (ino_t inode, char *filename, time_t modtime);
-static off_t processfile (char *filename, FileNode *fnode, off_t newsize, time_t newmodtime);
+static off_t processfile (char *filename, char *path, FileNode *fnode, off_t newsize, time_t newmodtime);
 static void  prunefiles (time_t scantime);
 static void  printfilelist (FILE *fd);
 static int   savestate (char *statefile);
@@ -135,6 +169,18 @@ static char *getoptval (int argcount, char **argvec, int argopt);
 static void  adddir (char *dirname);
 static void  processdirfile (char *filename);
 static int   keycompare (const void *a, const void *b);
+#ifdef HAVE_INOTIFY
+static void  initwatch ();
+static void  closewatch ();
+static void  addwatch (char *dirname, int level);
+static void  removewatch (char *dirname);
+static void  waitevents (int seconds);
+static void  processevent (struct inotify_event *event);
+static void  adddeleted (char *filename);
+static void  forgetfiles ();
+static int   wdcompare (const void *a, const void *b);
+static int   namecompare (const void *a, const void *b);
+#endif
 static void  term_handler();
 static void  print_handler();
 static int   lprintf (int level, const char *fmt, ...);
@@ -172,6 +218,11 @@ main (int argc, char** argv)
   if (processparam (argc, argv) < 0)
     return 1;
   
+#ifdef HAVE_INOTIFY
+  if ( ! polling )
+    initwatch ();
+#endif
+  
   treq.tv_sec = (time_t) scanint;
   treq.tv_nsec = (long) 0;
   
@@ -183,7 +234,7 @@ main (int argc, char** argv)
 
       scantime = time(NULL);
       
-      while ( dlp != 0 && stopsig == 0 )
+      while ( rescan && dlp != 0 && stopsig == 0 )
 	{
 	  scanfiles (dlp->dirname, dlp->dirname, maxrecur, scantime);
 	  
@@ -193,7 +244,13 @@ main (int argc, char** argv)
       if ( stopsig == 0 )
 	{
 	  /* Prune files that were not found from the filelist */
-	  prunefiles (scantime);
+	  if ( rescan )
+	    prunefiles (scantime);
+	  
+#ifdef HAVE_INOTIFY
+	  /* Watched directories are not scanned again unless events are lost */
+	  rescan = ( inotifyfd < 0 );
+#endif
 	  
 	  /* Save intermediate state file */
 	  if ( statefile && stateint && (scantime - statetime) > stateint )
@@ -205,8 +262,20 @@ main (int argc, char** argv)
 	  /* Re-read directory list file */
 	  if ( dirfile && dirfilecount == 0 )
 	    {
+	      time_t dirfiletime = dirfile->modtime;
+	      
 	      processdirfile (dirfile->filename);
 	      dirfilecount = DIRFILEINT;
+	      
+#ifdef HAVE_INOTIFY
+	      /* Watch the new list of directories from scratch */
+	      if ( inotifyfd >= 0 && dirfile->modtime != dirfiletime )
+		{
+		  closewatch ();
+		  initwatch ();
+		  rescan = 1;
+		}
+#endif
 	    }
 	  else
 	    {
@@ -216,8 +285,13 @@ main (int argc, char** argv)
 	  /* Reset the next new flag, the first scan is now complete */
 	  if ( nextnew ) nextnew = 0;
 	  
-	  /* Sleep for specified interval */
-	  nanosleep (&treq, &trem);
+	  /* Wait for file events or sleep for specified interval */
+#ifdef HAVE_INOTIFY
+	  if ( inotifyfd >= 0 )
+	    waitevents (scanint);
+	  else
+#endif
+	    nanosleep (&treq, &trem);
 	}
     }
   
@@ -289,6 +363,12 @@ scanfiles (char *targetdir, char *basedir, int level, time_t scantime)
       return -1;
     }
   
+#ifdef HAVE_INOTIFY
+  /* Watch the directory before reading it, nothing added in between is lost */
+  if ( inotifyfd >= 0 )
+    addwatch (basedir, level - dlevel);
+#endif
+  
   while ( (de = readdir(dir)) != NULL && stopsig == 0 )
     {
       int filenamelen;
@@ -410,12 +490,12 @@ scanfiles (char *targetdir, char *basedir, int level, time_t scantime)
 	  if ( nextnew )
 	    fnode->offset = st.st_size;
 	  else
-	    fnode->offset = processfile (fkey->filename, fnode, st.st_size, st.st_mtime);
+	    fnode->offset = processfile (fkey->filename, de->d_name, fnode, st.st_size, st.st_mtime);
 	}
       else if ( fnode->modtime < st.st_mtime &&
 		fnode->offset < st.st_size )
 	{
-	  fnode->offset = processfile (fkey->filename, fnode, st.st_size, st.st_mtime);
+	  fnode->offset = processfile (fkey->filename, de->d_name, fnode, st.st_size, st.st_mtime);
 	}
       
       if ( fnode )
@@ -519,12 +599,14 @@ addfile (ino_t inode, char *filename, time_t modtime)
 /***************************************************************************
  * processfile:
  *
- * Process a file by reading any data after the last offset.
+ * Process a file by reading any data after the last offset.  The file
+ * is opened as path, relative to the current directory, and reported
+ * as filename.
  *
  * Return the new file offset on success and -1 on error.
  ***************************************************************************/
 static off_t
-processfile (char *filename, FileNode *fnode, off_t newsize, time_t newmodtime)
+processfile (char *filename, char *path, FileNode *fnode, off_t newsize, time_t newmodtime)
 {
   int fd;
   int nread;
@@ -536,13 +618,7 @@ processfile (char *filename, FileNode *fnode, off_t newsize, time_t newmodtime)
 
   lprintf (3, "Processing file %s", filename);
 
-  /* We are already in the local directory so do a cheap basename(1) */
-  if ( ! (tptr = strrchr (filename, '/')) )
-    tptr = filename;
-  else
-    tptr++;
-  
-  if ( (fd = open(tptr, O_RDONLY, 0)) == -1 )
+  if ( (fd = open(path, O_RDONLY, 0)) == -1 )
     {
       lprintf (0, "Error opening %s: %s", filename, strerror(errno));
       return -1;
@@ -849,6 +925,10 @@ processparam (int argcount, char **argvec)
         {
           netstaid = 1;
         }
+      else if (strcmp (argvec[optind], "-P") == 0)
+        {
+          polling = 1;
+        }
       else if (strcmp (argvec[optind], "-x") == 0)
         {
           statefile = getoptval(argcount, argvec, optind++);
@@ -1173,6 +1253,459 @@ keycompare (const void *a, const void *b)
 }  /* End of keycompare() */
 
 
+#ifdef HAVE_INOTIFY
+/***************************************************************************
+ * initwatch:
+ *
+ * Create the inotify instance and the tree of watched directories.
+ * If inotify is not available the directories will be scanned.
+ ***************************************************************************/
+static void
+initwatch ()
+{
+  if ( (inotifyfd = inotify_init ()) < 0 )
+    {
+      lprintf (0, "Cannot watch directories: %s, scanning every %d seconds",
+	       strerror(errno), scanint);
+      return;
+    }
+  
+  watchtree = RBTreeCreate (wdcompare, free, free);
+}  /* End of initwatch() */
+
+
+/***************************************************************************
+ * closewatch:
+ *
+ * Remove all watches and close the inotify instance.
+ ***************************************************************************/
+static void
+closewatch ()
+{
+  int i;
+  
+  if ( inotifyfd >= 0 )
+    close (inotifyfd);
+  
+  inotifyfd = -1;
+  
+  if ( watchtree )
+    RBTreeDestroy (watchtree);
+  
+  watchtree = 0;
+  
+  for ( i = 0; i < ndeleted; i++ )
+    free (deleted[i]);
+  
+  ndeleted = 0;
+}  /* End of closewatch() */
+
+
+/***************************************************************************
+ * addwatch:
+ *
+ * Watch the current directory, known as dirname.  The level is the
+ * number of levels of sub-directories below it that will be watched.
+ *
+ * If the directory cannot be watched, e.g. because the limit of
+ * watches is reached, all watches are removed and the directories
+ * will be scanned.
+ ***************************************************************************/
+static void
+addwatch (char *dirname, int level)
+{
+  WatchNode *wnode;
+  RBNode *tnode;
+  size_t dirlen;
+  int *wd;
+  
+  wd = (int *) malloc (sizeof(int));
+  dirlen = strlen (dirname);
+  wnode = (WatchNode *) malloc (sizeof(WatchNode)+dirlen);
+  
+  if ( ! wd || ! wnode )
+    {
+      lprintf (0, "Error allocating memory for watch of %s", dirname);
+      free (wd);
+      free (wnode);
+      return;
+    }
+  
+  if ( (*wd = inotify_add_watch (inotifyfd, ".", WATCHMASK)) < 0 )
+    {
+      lprintf (0, "Cannot watch directory %s: %s, scanning every %d seconds",
+	       dirname, strerror(errno), scanint);
+      free (wd);
+      free (wnode);
+      closewatch ();
+      rescan = 1;
+      return;
+    }
+  
+  wnode->level = level;
+  memcpy (wnode->dirname, dirname, dirlen+1);
+  
+  /* The same directory may be watched again after a rescan */
+  if ( (tnode = RBFind (watchtree, wd)) )
+    {
+      free (wd);
+      free (tnode->data);
+      tnode->data = wnode;
+      return;
+    }
+  
+  lprintf (3, "Watching directory %s", dirname);
+  
+  RBTreeInsert (watchtree, wd, wnode);
+}  /* End of addwatch() */
+
+
+/***************************************************************************
+ * removewatch:
+ *
+ * Remove the watches of a directory and all directories below it.
+ * The watch nodes are deleted when the IN_IGNORED events arrive.
+ ***************************************************************************/
+static void
+removewatch (char *dirname)
+{
+  WatchNode *wnode;
+  RBNode    *tnode;
+  Stack     *stack;
+  size_t     dirlen;
+  
+  dirlen = strlen (dirname);
+  
+  stack = StackCreate();
+  RBBuildStack (watchtree, stack);
+  
+  while ( (tnode = (RBNode *) StackPop (stack)) )
+    {
+      wnode = (WatchNode *) tnode->data;
+      
+      if ( ! strncmp (wnode->dirname, dirname, dirlen) &&
+	   (wnode->dirname[dirlen] == '\0' || wnode->dirname[dirlen] == '/') )
+	inotify_rm_watch (inotifyfd, *(int *) tnode->key);
+    }
+  
+  StackDestroy (stack, free);
+}  /* End of removewatch() */
+
+
+/***************************************************************************
+ * waitevents:
+ *
+ * Wait up to the specified number of seconds for modifications in
+ * the watched directories and process them as they arrive.
+ ***************************************************************************/
+static void
+waitevents (int seconds)
+{
+  union {
+    struct inotify_event event;
+    char buf[16384];
+  } evbuf;
+  struct inotify_event *event;
+  struct pollfd pfd;
+  time_t deadline;
+  char *ptr;
+  int nread;
+  int rv;
+  
+  deadline = time(NULL) + seconds;
+  
+  while ( stopsig == 0 && inotifyfd >= 0 && time(NULL) < deadline )
+    {
+      pfd.fd = inotifyfd;
+      pfd.events = POLLIN;
+      
+      if ( (rv = poll (&pfd, 1, (int) (deadline - time(NULL)) * 1000)) == 0 )
+	break;
+      
+      if ( rv > 0 )
+	nread = read (inotifyfd, evbuf.buf, sizeof(evbuf.buf));
+      
+      if ( rv < 0 || nread < 0 )
+	{
+	  if ( errno == EINTR )
+	    continue;
+	  
+	  lprintf (0, "Error reading file events: %s, scanning every %d seconds",
+		   strerror(errno), scanint);
+	  closewatch ();
+	  rescan = 1;
+	  break;
+	}
+      
+      for ( ptr = evbuf.buf; ptr < evbuf.buf + nread && inotifyfd >= 0;
+	    ptr += sizeof(struct inotify_event) + event->len )
+	{
+	  event = (struct inotify_event *) ptr;
+	  processevent (event);
+	}
+      
+      if ( ndeleted )
+	forgetfiles ();
+    }
+}  /* End of waitevents() */
+
+
+/***************************************************************************
+ * processevent:
+ *
+ * Process a single inotify event.  Files that were created, modified
+ * or moved into a watched directory are read from the last offset,
+ * new sub-directories are scanned and watched up to the maximum
+ * recursion level.  Deleted files are removed from the file list.
+ *
+ * If events were lost all directories are scanned at the next
+ * interval.
+ ***************************************************************************/
+static void
+processevent (struct inotify_event *event)
+{
+  FileNode *fnode;
+  FileKey *fkey;
+  WatchNode *wnode;
+  RBNode *tnode;
+  char filekeybuf[sizeof(FileKey)+MAX_FILENAME_LENGTH]; /* Room for fkey */
+  struct stat st;
+  int filenamelen;
+  
+  fkey = (FileKey *) &filekeybuf;
+  
+  if ( event->mask & IN_Q_OVERFLOW )
+    {
+      lprintf (1, "File events were lost, scanning all directories");
+      rescan = 1;
+      return;
+    }
+  
+  if ( ! (tnode = RBFind (watchtree, &event->wd)) )
+    return;
+  
+  wnode = (WatchNode *) tnode->data;
+  
+  if ( event->mask & IN_IGNORED )
+    {
+      lprintf (3, "Not watching directory %s anymore", wnode->dirname);
+      RBDelete (watchtree, tnode);
+      return;
+    }
+  
+  /* The name of a moved directory is not known, a scan finds it again */
+  if ( event->mask & IN_MOVE_SELF )
+    {
+      inotify_rm_watch (inotifyfd, event->wd);
+      rescan = 1;
+      return;
+    }
+  
+  if ( event->len == 0 )
+    return;
+  
+  filenamelen = snprintf (fkey->filename, sizeof(filekeybuf) - sizeof(FileKey),
+			  "%s/%s", wnode->dirname, event->name);
+  
+  /* Make sure the filename was not truncated */
+  if ( filenamelen >= (sizeof(filekeybuf) - sizeof(FileKey) - 1) )
+    {
+      lprintf (0, "Directory entry name beyond maximum of %d characters, skipping:\n",
+	       (sizeof(filekeybuf) - sizeof(FileKey) - 1));
+      lprintf (0, "  %s\n", event->name);
+      return;
+    }
+  
+  if ( event->mask & (IN_DELETE | IN_MOVED_FROM) )
+    {
+      if ( (event->mask & IN_MOVED_FROM) && (event->mask & IN_ISDIR) )
+	removewatch (fkey->filename);
+      
+      adddeleted (fkey->filename);
+      return;
+    }
+  
+  /* Forget deleted files first in case a file of the same name appears */
+  if ( ndeleted )
+    forgetfiles ();
+  
+  if ( event->mask & IN_ISDIR )
+    {
+      if ( (event->mask & (IN_CREATE | IN_MOVED_TO)) && wnode->level > 0 )
+	{
+	  lprintf (4, "Recursing into %s", fkey->filename);
+	  scanfiles (fkey->filename, fkey->filename, wnode->level - 1, time(NULL));
+	}
+      
+      return;
+    }
+  
+  /* Do regex matching if an expression was specified */
+  if ( fnmatch != 0 )
+    if ( regexec (fnmatch, event->name, (size_t) 0, NULL, 0) != 0 )
+      return;
+  
+  /* Do regex rejecting if an expression was specified */
+  if ( fnreject != 0 )
+    if ( regexec (fnreject, event->name, (size_t) 0, NULL, 0) == 0 )
+      return;
+  
+  if ( stat (fkey->filename, &st) < 0 )
+    {
+      if ( errno != ENOENT )
+	lprintf (0, "Cannot stat %s: %s", fkey->filename, strerror(errno));
+      return;
+    }
+  
+  if ( !S_ISREG(st.st_mode) )
+    return;
+  
+  fkey->inode = st.st_ino;
+  
+  if ( ! (fnode = findfile (fkey)) )
+    {
+      if ( ! (fnode = addfile (fkey->inode, fkey->filename, st.st_mtime)) )
+	{
+	  lprintf (0, "Error adding %s to file list\n", fkey->filename);
+	  return;
+	}
+    }
+  
+  fnode->scantime = time(NULL);
+  
+  /* Check if the file is permanently skipped */
+  if ( fnode->offset == -1 )
+    return;
+  
+  /* The file was modified, so it is neither idle nor quiet */
+  fnode->idledelay = 0;
+  fnode->quiet = 0;
+  
+  if ( fnode->offset < st.st_size )
+    fnode->offset = processfile (fkey->filename, fkey->filename, fnode,
+				 st.st_size, st.st_mtime);
+}  /* End of processevent() */
+
+
+/***************************************************************************
+ * adddeleted:
+ *
+ * Add a deleted file or directory to the list of names forgotten by
+ * the next call of forgetfiles().
+ ***************************************************************************/
+static void
+adddeleted (char *filename)
+{
+  char **newdeleted;
+  
+  if ( ndeleted == maxdeleted )
+    {
+      maxdeleted = (maxdeleted) ? maxdeleted * 2 : 64;
+      
+      if ( ! (newdeleted = (char **) realloc (deleted, maxdeleted * sizeof(char *))) )
+	{
+	  lprintf (0, "Error allocating memory for deleted file list");
+	  maxdeleted = ndeleted;
+	  rescan = 1;
+	  return;
+	}
+      
+      deleted = newdeleted;
+    }
+  
+  if ( (deleted[ndeleted] = strdup (filename)) )
+    ndeleted++;
+}  /* End of adddeleted() */
+
+
+/***************************************************************************
+ * forgetfiles:
+ *
+ * Remove all files from the filetree that were deleted or are below a
+ * deleted directory.  The file list is traversed once for all names
+ * collected since the last call.
+ ***************************************************************************/
+static void
+forgetfiles ()
+{
+  FileKey  *fkey;
+  RBNode   *tnode;
+  Stack    *stack;
+  char      name[MAX_FILENAME_LENGTH];
+  char     *nameptr = name;
+  char     *cp;
+  int       i;
+  
+  qsort (deleted, ndeleted, sizeof(char *), namecompare);
+  
+  stack = StackCreate();
+  RBBuildStack (filetree, stack);
+  
+  while ( (tnode = (RBNode *) StackPop (stack)) )
+    {
+      fkey = (FileKey *) tnode->key;
+      
+      strncpy (name, fkey->filename, sizeof(name));
+      name[sizeof(name)-1] = '\0';
+      
+      /* Check the name itself and all of its parent directories */
+      do
+	{
+	  if ( bsearch (&nameptr, deleted, ndeleted, sizeof(char *), namecompare) )
+	    {
+	      lprintf (1, "Removing %s from file list", fkey->filename);
+	      RBDelete (filetree, tnode);
+	      break;
+	    }
+	  
+	  if ( (cp = strrchr (name, '/')) )
+	    *cp = '\0';
+	}
+      while ( cp );
+    }
+  
+  StackDestroy (stack, free);
+  
+  for ( i = 0; i < ndeleted; i++ )
+    free (deleted[i]);
+  
+  ndeleted = 0;
+}  /* End of forgetfiles() */
+
+
+/***************************************************************************
+ * wdcompare:
+ *
+ * Compare two watch descriptors passed as void pointers.
+ *
+ * Return 1 if a > b, -1 if a < b and 0 otherwise (e.g. equality).
+ ***************************************************************************/
+static int
+wdcompare (const void *a, const void *b)
+{
+  if ( *(int *)a > *(int *)b )
+    return 1;
+  
+  else if ( *(int *)a < *(int *)b )
+    return -1;
+  
+  return 0;
+}  /* End of wdcompare() */
+
+
+/***************************************************************************
+ * namecompare:
+ *
+ * Compare two file names passed as pointers to string pointers.
+ ***************************************************************************/
+static int
+namecompare (const void *a, const void *b)
+{
+  return strcmp (*(char **)a, *(char **)b);
+}  /* End of namecompare() */
+#endif
+
+
 /***************************************************************************
  * term_handler and print_handler:
  * Signal handler routines.
@@ -1263,6 +1796,8 @@ usage()
 	  " -R reject      Only process filenames that do not match this regular expression\n"
 	  " -N             Include the network code in the station ID sent to the\n"
 	  "                  server in the format: 'NET_STA', default: 'STA'\n"
+	  " -P             Always scan directories at the interval instead of\n"
+	  "                  watching them for modifications with inotify\n"
 	  " -x file[:int]  State file to save/restore file time stamps, optionally\n"
 	  "                  an interval, in seconds, can be specified to save the\n"
 	  "                  state file (default interval: %d seconds)\n\n"
@@ -73,6 +73,8 @@ AmpTool::AmpTool(int argc, char **argv) : StreamApplication(argc, argv) {
 	_fetchMissingAmplitudes = true;
 	_minWeight = 0.5;
 
+	_processingGraph = new ProcessingGraph;
+
 	setAutoApplyNotifierEnabled(true);
 	setInterpretNotifierEnabled(true);
 
@@ -305,6 +307,8 @@ bool AmpTool::run() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmpTool::done() {
+	_processingGraph->logStatistics();
+
 	Seiscomp::Client::StreamApplication::done();
 
 	if ( _errorChannel ) delete _errorChannel;
@@ -693,6 +697,8 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 		return -1;
 	}
 
+	proc->setProcessingGraph(_processingGraph.get());
+
 
 	if ( _processors.empty() )
 		openStream();
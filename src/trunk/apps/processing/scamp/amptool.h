@@ -130,6 +130,7 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		AmplitudeTypeList          _registeredAmplitudeTypes;
 		AmplitudeList              _amplitudeTypes;
 		ProcessorMap               _processors;
+		Seiscomp::Processing::ProcessingGraphPtr _processingGraph;
 		RequestMap                 _stationRequests;
 		ParameterMap               _parameters;
 
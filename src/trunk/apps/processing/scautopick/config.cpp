@@ -58,6 +58,8 @@ Picker::Config::Config() {
 	pickerType = "";
 	sendDetections = false;
 
+	workers = 1;
+
 	amplitudeList.insert("MLv");
 	amplitudeList.insert("mb");
 	amplitudeList.insert("mB");
@@ -141,6 +141,10 @@ class Config {
 		// Send detections as well if a picker is configured?
 		bool        sendDetections;
 
+		// The number of processes the stations are distributed
+		// over in --ep mode.
+		int         workers;
+
 	public:
 		void dump() const;
 };
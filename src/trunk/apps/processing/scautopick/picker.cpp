@@ -23,6 +23,7 @@
 #include <seiscomp3/processing/sensor.h>
 
 #include <seiscomp3/io/archive/xmlarchive.h>
+#include <seiscomp3/io/recordstream/file.h>
 
 #include <seiscomp3/math/geo.h>
 #include <seiscomp3/math/filter.h>
@@ -38,6 +39,13 @@
 #include <seiscomp3/datamodel/config_package.h>
 
 #include <iomanip>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <boost/bind.hpp>
 
 #include "picker.h"
@@ -76,6 +84,66 @@ bool contains(const Seiscomp::Core::TimeWindow &tw, const Seiscomp::Core::Time &
 }
 
 
+typedef vector<Seiscomp::DataModel::PickPtr> PickList;
+typedef vector<Seiscomp::DataModel::AmplitudePtr> AmplitudeList;
+
+
+bool pickLess(const Seiscomp::DataModel::PickPtr &a,
+              const Seiscomp::DataModel::PickPtr &b) {
+	if ( a->time().value() != b->time().value() )
+		return a->time().value() < b->time().value();
+	return a->publicID() < b->publicID();
+}
+
+
+bool amplitudeLess(const Seiscomp::DataModel::AmplitudePtr &a,
+                   const Seiscomp::DataModel::AmplitudePtr &b) {
+	if ( a->pickID() != b->pickID() )
+		return a->pickID() < b->pickID();
+	return a->publicID() < b->publicID();
+}
+
+
+// Moves picks and amplitudes out of an event parameters object which is
+// released afterwards
+void takeObjects(Seiscomp::DataModel::EventParametersPtr &ep,
+                 PickList &picks, AmplitudeList &amps) {
+	for ( size_t i = 0; i < ep->pickCount(); ++i )
+		picks.push_back(ep->pick(i));
+	for ( size_t i = 0; i < ep->amplitudeCount(); ++i )
+		amps.push_back(ep->amplitude(i));
+	ep = NULL;
+}
+
+
+// Returns whether a record stream URL or file reads standard input
+bool isStandardInput(const string &url) {
+	string source = url.substr(0, url.find('#'));
+	size_t pos = source.rfind("://");
+	if ( pos != string::npos ) source.erase(0, pos+3);
+	return source == "-";
+}
+
+
+// Orders picks by time and amplitudes by pick so that the output does
+// not depend on the order records were processed in
+void sortObjects(Seiscomp::DataModel::EventParametersPtr &ep) {
+	PickList picks;
+	AmplitudeList amps;
+
+	takeObjects(ep, picks, amps);
+
+	sort(picks.begin(), picks.end(), pickLess);
+	sort(amps.begin(), amps.end(), amplitudeLess);
+
+	ep = new Seiscomp::DataModel::EventParameters;
+	for ( size_t i = 0; i < picks.size(); ++i )
+		ep->add(picks[i].get());
+	for ( size_t i = 0; i < amps.size(); ++i )
+		ep->add(amps[i].get());
+}
+
+
 ostream& operator<<(ostream& o, const Seiscomp::Core::Time& time) {
 	o << time.toString("%Y/%m/%d %H:%M:%S.") << (time.microseconds() / 1000);
 	return o;
@@ -147,6 +215,8 @@ namespace Picker {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 App::App(int argc, char **argv) : Processing::Application(argc, argv) {
+	_workerIndex = -1;
+
 	setLoadInventoryEnabled(true);
 	setLoadConfigModuleEnabled(true);
 
@@ -176,6 +246,7 @@ void App::createCommandLineDescription() {
 	commandline().addOption("Mode", "test", "Do not send any object");
 	commandline().addOption("Mode", "playback", "Use playback mode that does not set a request time window and works best with files");
 	commandline().addOption("Mode", "ep", "Same as offline but outputs all result as an event parameters XML file");
+	commandline().addOption("Mode", "workers", "Number of processes to distribute the stations over in --ep mode", &_config.workers);
 	commandline().addOption("Mode", "dump-config", "Dump the configuration and exit");
 	commandline().addOption("Mode", "dump-records", "Dump records to ASCII when in offline mode");
 
@@ -235,6 +306,27 @@ bool App::validateParameters() {
 		return false;
 	}
 
+	if ( _config.workers < 1 ) {
+		cerr << "The number of workers must be at least 1" << endl;
+		return false;
+	}
+
+	if ( _config.workers > 1 && !commandline().hasOption("ep") ) {
+		cerr << "Multiple workers are only supported with --ep" << endl;
+		return false;
+	}
+
+	if ( _config.workers > 1 ) {
+		string source = commandline().hasOption("record-file") ?
+		                commandline().option<string>("record-file") :
+		                recordStreamURL();
+		if ( isStandardInput(source) ) {
+			cerr << "Multiple workers cannot share standard input, "
+			        "read the records from a file instead" << endl;
+			return false;
+		}
+	}
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -354,6 +446,15 @@ bool App::init() {
 		logAmplTypes += '\n';
 	}
 
+	if ( _config.workers > 1 ) {
+		if ( !startWorkers() ) return false;
+
+		// The parent only collects the results of the workers
+		if ( _workerIndex < 0 ) return true;
+
+		SEISCOMP_INFO("Worker %d of %d started", _workerIndex+1, _config.workers);
+	}
+
 	Core::Time now = Core::Time::GMT();
 
 	for ( StationConfig::const_iterator it = _stationConfig.begin();
@@ -363,6 +464,9 @@ bool App::init() {
 		if ( it->first.first == "*" ) continue;
 		if ( it->first.second == "*" ) continue;
 
+		// Ignore stations of other workers
+		if ( !isWorkerStation(it->first.first, it->first.second) ) continue;
+
 		// Ignore undefined channels
 		if ( it->second.channel.empty() ) continue;
 
@@ -427,6 +531,8 @@ bool App::init() {
 	if ( _streamIDs.empty() ) {
 		if ( _config.useAllStreams )
 			SEISCOMP_INFO("No stations added (empty module configuration?)");
+		else if ( _workerIndex >= 0 )
+			SEISCOMP_INFO("No stations assigned to this worker");
 		else {
 			SEISCOMP_ERROR("No stations added (empty module configuration?) and thus nothing to do");
 			return false;
@@ -453,9 +559,16 @@ bool App::run() {
 		return true;
 	}
 
+	if ( !_workerPids.empty() )
+		return collectWorkers();
+
 	if ( commandline().hasOption("ep") )
 		_ep = new DataModel::EventParameters;
 
+	// Nothing to do for a worker without stations
+	if ( _workerIndex >= 0 && _streamIDs.empty() && !_config.useAllStreams )
+		return true;
+
 	return Processing::Application::run();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -467,13 +580,23 @@ bool App::run() {
 void App::done() {
 	if ( _ep ) {
 		IO::XMLArchive ar;
-		ar.create("-");
+		if ( _workerIndex >= 0 )
+			ar.create(_workerFiles[_workerIndex].c_str());
+		else {
+			// Without workers the objects keep the order they were
+			// created in
+			if ( _config.workers > 1 ) sortObjects(_ep);
+			ar.create("-");
+		}
 		ar.setFormattedOutput(true);
 		ar << _ep;
 		ar.close();
 		_ep = NULL;
 	}
 
+	// Workers left behind by a failed initialization
+	stopWorkers();
+
 	Processing::Application::done();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -481,6 +604,203 @@ void App::done() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool App::storeRecord(Record *rec) {
+	if ( !isWorkerStation(rec->networkCode(), rec->stationCode()) ) {
+		delete rec;
+		return true;
+	}
+
+	return Processing::Application::storeRecord(rec);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool App::startWorkers() {
+	const char *tmpdir = getenv("TMPDIR");
+	if ( tmpdir == NULL || *tmpdir == '\0' ) tmpdir = "/tmp";
+
+	// Do not let the workers inherit buffered output
+	fflush(NULL);
+	cout.flush();
+	cerr.flush();
+
+	for ( int i = 0; i < _config.workers; ++i ) {
+		string tmpl = string(tmpdir) + "/" + name() + "-XXXXXX";
+		vector<char> path(tmpl.begin(), tmpl.end());
+		path.push_back('\0');
+
+		int fd = mkstemp(&path[0]);
+		if ( fd < 0 ) {
+			SEISCOMP_ERROR("Failed to create temporary file %s: %s",
+			               tmpl.c_str(), strerror(errno));
+			stopWorkers();
+			return false;
+		}
+
+		close(fd);
+		_workerFiles.push_back(&path[0]);
+
+		pid_t pid = fork();
+		if ( pid < 0 ) {
+			SEISCOMP_ERROR("Failed to start worker: %s", strerror(errno));
+			stopWorkers();
+			return false;
+		}
+
+		if ( pid == 0 ) {
+			_workerIndex = i;
+			_workerPids.clear();
+
+			return reopenStream();
+		}
+
+		_workerPids.push_back(pid);
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool App::reopenStream() {
+	// A stream opened by the parent, e.g. an input file, shares its
+	// state with all workers
+	if ( commandline().hasOption("record-file") ) {
+		// Not part of the record stream URL
+		RecordStream::File *file = dynamic_cast<RecordStream::File*>(recordStream());
+		if ( file == NULL || !file->setSource(file->name()) ) {
+			SEISCOMP_ERROR("Failed to open recordfile %s", file ? file->name().c_str() : "");
+			return false;
+		}
+
+		if ( commandline().hasOption("record-type") )
+			file->setRecordType(commandline().option<string>("record-type").c_str());
+	}
+	else {
+		closeStream();
+		if ( !openStream() ) {
+			SEISCOMP_ERROR("Failed to open recordstream %s", recordStreamURL().c_str());
+			return false;
+		}
+	}
+
+	if ( !commandline().hasOption("playback") )
+		recordStream()->setStartTime(Core::Time::GMT() - Core::TimeSpan(_config.leadTime));
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void App::stopWorkers() {
+	if ( _workerIndex >= 0 ) return;
+
+	for ( size_t i = 0; i < _workerPids.size(); ++i ) {
+		kill(_workerPids[i], SIGTERM);
+		waitpid(_workerPids[i], NULL, 0);
+	}
+
+	for ( size_t i = 0; i < _workerFiles.size(); ++i )
+		unlink(_workerFiles[i].c_str());
+
+	_workerPids.clear();
+	_workerFiles.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool App::collectWorkers() {
+	bool success = true;
+	PickList picks;
+	AmplitudeList amps;
+
+	for ( size_t i = 0; i < _workerPids.size(); ++i ) {
+		int status;
+		while ( waitpid(_workerPids[i], &status, 0) < 0 ) {
+			if ( errno != EINTR ) {
+				status = -1;
+				break;
+			}
+		}
+
+		if ( status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+			SEISCOMP_ERROR("Worker %d failed", (int)i+1);
+			success = false;
+			continue;
+		}
+
+		IO::XMLArchive ar;
+		if ( !ar.open(_workerFiles[i].c_str()) ) {
+			SEISCOMP_ERROR("Failed to read results of worker %d", (int)i+1);
+			success = false;
+			continue;
+		}
+
+		DataModel::EventParametersPtr ep;
+		ar >> ep;
+		ar.close();
+
+		if ( ep ) takeObjects(ep, picks, amps);
+	}
+
+	for ( size_t i = 0; i < _workerFiles.size(); ++i )
+		unlink(_workerFiles[i].c_str());
+
+	_workerPids.clear();
+	_workerFiles.clear();
+
+	if ( !success ) return false;
+
+	// Created after the results of the workers have been read and released
+	// to not clash with their publicIDs
+	_ep = new DataModel::EventParameters;
+
+	for ( size_t i = 0; i < picks.size(); ++i )
+		_ep->add(picks[i].get());
+	for ( size_t i = 0; i < amps.size(); ++i )
+		_ep->add(amps[i].get());
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool App::isWorkerStation(const string &networkCode,
+                          const string &stationCode) const {
+	if ( _config.workers <= 1 ) return true;
+	if ( _workerIndex < 0 ) return false;
+
+	// FNV-1a hash of the station code, same in all workers
+	string code = networkCode + "." + stationCode;
+	unsigned int hash = 2166136261u;
+	for ( size_t i = 0; i < code.size(); ++i ) {
+		hash ^= (unsigned char)code[i];
+		hash *= 16777619u;
+	}
+
+	return (int)(hash % _config.workers) == _workerIndex;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void App::addObject(const string& parentID, DataModel::Object* o) {
 	Processing::Application::addObject(parentID, o);
@@ -27,6 +27,8 @@
 #include <seiscomp3/datamodel/stationmagnitude.h>
 
 #include <list>
+#include <vector>
+#include <sys/types.h>
 
 #include "config.h"
 #include "stationconfig.h"
@@ -58,8 +60,26 @@ class App : public Processing::Application {
 		void removeObject(const std::string& parentID, DataModel::Object* o);
 		void updateObject(const std::string& parentID, DataModel::Object* o);
 
+		bool storeRecord(Record *rec);
+
 
 	private:
+		// Forks the worker processes. Returns in the parent and in each
+		// worker.
+		bool startWorkers();
+		void stopWorkers();
+
+		// Replaces the record stream inherited from the parent by a new
+		// one owned by the worker
+		bool reopenStream();
+
+		// Waits for the workers and collects their results
+		bool collectWorkers();
+
+		// Returns whether a station is handled by this process
+		bool isWorkerStation(const std::string &networkCode,
+		                     const std::string &stationCode) const;
+
 		// Initializes a single component of a processor.
 		bool initComponent(Processing::WaveformProcessor *proc,
 		                   Processing::WaveformProcessor::Component comp,
@@ -149,6 +169,11 @@ class App : public Processing::Application {
 
 		ObjectLog     *_logPicks;
 		ObjectLog     *_logAmps;
+
+		// Index of this worker or -1 if not a worker
+		int                      _workerIndex;
+		std::vector<pid_t>       _workerPids;
+		std::vector<std::string> _workerFiles;
 };
 
 
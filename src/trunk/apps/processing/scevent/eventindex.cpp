@@ -0,0 +1,232 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT SCEVENT
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/utils/misc.h>
+#include <seiscomp3/datamodel/pick.h>
+
+#include "eventindex.h"
+#include "eventinfo.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::DataModel;
+using namespace Seiscomp::Client;
+
+
+namespace {
+
+
+bool byEventID(EventInformation *a, EventInformation *b) {
+	return a->event->publicID() < b->event->publicID();
+}
+
+
+}
+
+
+EventIndex::EventIndex(Cache *c, Config *cfg)
+: _cache(c), _config(cfg) {}
+
+
+void EventIndex::touch(EventInformation *info) {
+	_pending.insert(info);
+}
+
+
+void EventIndex::remove(EventInformation *info) {
+	unindex(info);
+	_pending.erase(info);
+}
+
+
+void EventIndex::clear() {
+	_entries.clear();
+	_timeBuckets.clear();
+	_picks.clear();
+	_unloadedPicks.clear();
+	_pending.clear();
+}
+
+
+size_t EventIndex::size() const {
+	return _entries.size() + _pending.size();
+}
+
+
+bool EventIndex::candidates(Candidates &result, Origin *origin) {
+	result.clear();
+
+	// Every event matches by picks if no matching pick is required
+	if ( _config->minMatchingPicks == 0 ) return false;
+
+	flush();
+
+	EventSet found(_unloadedPicks);
+
+	// Time and location. The latitude difference is a lower bound of the
+	// epicentral distance.
+	try {
+		double t = (double)origin->time().value();
+		double lat = origin->latitude().value();
+		double maxTimeDiff = (double)_config->maxTimeDiff;
+
+		TimeBuckets::iterator it = _timeBuckets.lower_bound(timeBucket(t - maxTimeDiff));
+		TimeBuckets::iterator end = _timeBuckets.upper_bound(timeBucket(t + maxTimeDiff));
+
+		for ( ; it != end; ++it ) {
+			for ( EventSet::iterator eit = it->second.begin(); eit != it->second.end(); ++eit ) {
+				if ( fabs(_entries[*eit].latitude - lat) <= _config->maxDist + 1E-6 )
+					found.insert(*eit);
+			}
+		}
+	}
+	catch ( ... ) {}
+
+	// Picks
+	for ( size_t i = 0; i < origin->arrivalCount(); ++i ) {
+		Arrival *arr = origin->arrival(i);
+		if ( Private::arrivalWeight(arr) == 0 ) continue;
+
+		if ( _config->maxMatchingPicksTimeDiff < 0 ) {
+			PickMap::iterator it = _picks.find(arr->pickID());
+			if ( it != _picks.end() )
+				found.insert(it->second.begin(), it->second.end());
+			continue;
+		}
+
+		PickPtr p = _cache->get<Pick>(arr->pickID());
+		if ( !p ) continue;
+
+		string station = p->waveformID().networkCode() + "." +
+		                 p->waveformID().stationCode();
+		char phase = Util::getShortPhaseName(p->phaseHint().code());
+		int64_t bucket;
+
+		try { bucket = pickBucket((double)p->time().value()); }
+		catch ( ... ) { continue; }
+
+		for ( int64_t b = bucket-1; b <= bucket+1; ++b ) {
+			PickMap::iterator it = _picks.find(pickKey(station, phase, b));
+			if ( it != _picks.end() )
+				found.insert(it->second.begin(), it->second.end());
+		}
+	}
+
+	result.assign(found.begin(), found.end());
+
+	// Keep the order of a full scan of the event map
+	sort(result.begin(), result.end(), byEventID);
+
+	return true;
+}
+
+
+void EventIndex::flush() {
+	for ( EventSet::iterator it = _pending.begin(); it != _pending.end(); ++it )
+		index(*it);
+	_pending.clear();
+}
+
+
+void EventIndex::index(EventInformation *info) {
+	unindex(info);
+
+	Entry &entry = _entries[info];
+
+	if ( info->preferredOrigin ) {
+		try {
+			entry.timeBucket = timeBucket((double)info->preferredOrigin->time().value());
+			entry.latitude = info->preferredOrigin->latitude().value();
+			entry.located = true;
+			_timeBuckets[entry.timeBucket].insert(info);
+		}
+		catch ( ... ) {}
+	}
+
+	// The pick set is loaded on the first comparison
+	if ( info->dirtyPickSet ) {
+		_unloadedPicks.insert(info);
+		return;
+	}
+
+	if ( _config->maxMatchingPicksTimeDiff < 0 ) {
+		entry.pickKeys.assign(info->pickIDs.begin(), info->pickIDs.end());
+	}
+	else {
+		EventInformation::PickAssociation::const_iterator it;
+		for ( it = info->picks.begin(); it != info->picks.end(); ++it ) {
+			try {
+				entry.pickKeys.push_back(
+					pickKey(it->first,
+					        Util::getShortPhaseName(it->second->phaseHint().code()),
+					        pickBucket((double)it->second->time().value()))
+				);
+			}
+			catch ( ... ) {}
+		}
+	}
+
+	for ( Keys::iterator it = entry.pickKeys.begin(); it != entry.pickKeys.end(); ++it )
+		_picks[*it].insert(info);
+}
+
+
+void EventIndex::unindex(EventInformation *info) {
+	Entries::iterator it = _entries.find(info);
+	if ( it == _entries.end() ) return;
+
+	Entry &entry = it->second;
+
+	if ( entry.located ) {
+		TimeBuckets::iterator bit = _timeBuckets.find(entry.timeBucket);
+		if ( bit != _timeBuckets.end() ) {
+			bit->second.erase(info);
+			if ( bit->second.empty() ) _timeBuckets.erase(bit);
+		}
+	}
+
+	for ( Keys::iterator kit = entry.pickKeys.begin(); kit != entry.pickKeys.end(); ++kit ) {
+		PickMap::iterator pit = _picks.find(*kit);
+		if ( pit == _picks.end() ) continue;
+		pit->second.erase(info);
+		if ( pit->second.empty() ) _picks.erase(pit);
+	}
+
+	_unloadedPicks.erase(info);
+	_entries.erase(it);
+}
+
+
+int64_t EventIndex::timeBucket(double t) const {
+	return (int64_t)floor(t / max((double)_config->maxTimeDiff, 1.0));
+}
+
+
+int64_t EventIndex::pickBucket(double t) const {
+	return (int64_t)floor(t / max(_config->maxMatchingPicksTimeDiff, 1.0));
+}
+
+
+string EventIndex::pickKey(const string &station, char phase, int64_t bucket) const {
+	char tmp[32];
+	snprintf(tmp, 32, "|%c|%lld", phase, (long long)bucket);
+	return station + tmp;
+}
@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_APPLICATIONS_EVENTINDEX_H__
+#define __SEISCOMP_APPLICATIONS_EVENTINDEX_H__
+
+
+#include <seiscomp3/datamodel/origin.h>
+#include <seiscomp3/datamodel/publicobjectcache.h>
+
+#include "config.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+namespace Seiscomp {
+
+namespace Client {
+
+
+struct EventInformation;
+
+
+/**
+ * Index of the cached events used to preselect the events an origin is
+ * compared with. Events are indexed by the time bucket and latitude of
+ * their preferred origin and by their picks (pick IDs or, if pick times
+ * are compared, station, phase and time bucket).
+ *
+ * Events register themselves with touch() whenever their preferred origin
+ * or their pick set changes. Touched events are reindexed lazily on the
+ * next query. Events with a pick set that has not been loaded yet are
+ * always returned as candidates.
+ */
+class EventIndex {
+	public:
+		typedef DataModel::PublicObjectCache Cache;
+		typedef std::vector<EventInformation*> Candidates;
+
+		EventIndex(Cache *cache, Config *cfg);
+
+		//! Schedules an event for (re)indexing
+		void touch(EventInformation *info);
+
+		//! Removes an event from the index
+		void remove(EventInformation *info);
+
+		void clear();
+
+		size_t size() const;
+
+		//! Collects all events that can match the origin by location or
+		//! picks ordered by event ID. Returns false if the configuration
+		//! does not allow to preselect events and all events must be
+		//! compared.
+		bool candidates(Candidates &result, DataModel::Origin *origin);
+
+
+	private:
+		typedef std::vector<std::string> Keys;
+		typedef std::set<EventInformation*> EventSet;
+
+		struct Entry {
+			Entry() : located(false), timeBucket(0), latitude(0) {}
+
+			bool     located;
+			int64_t  timeBucket;
+			double   latitude;
+			Keys     pickKeys;
+		};
+
+		typedef std::map<EventInformation*, Entry> Entries;
+		typedef std::map<int64_t, EventSet> TimeBuckets;
+		typedef std::map<std::string, EventSet> PickMap;
+
+		void flush();
+		void index(EventInformation *info);
+		void unindex(EventInformation *info);
+
+		int64_t timeBucket(double t) const;
+		std::string pickKey(const std::string &station, char phase, int64_t bucket) const;
+		int64_t pickBucket(double t) const;
+
+
+	private:
+		Cache       *_cache;
+		Config      *_config;
+
+		Entries      _entries;
+		TimeBuckets  _timeBuckets;
+		PickMap      _picks;
+		EventSet     _unloadedPicks;
+		EventSet     _pending;
+};
+
+
+}
+
+}
+
+
+#endif
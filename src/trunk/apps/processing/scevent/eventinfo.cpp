@@ -28,20 +28,20 @@ using namespace Seiscomp::Client;
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), index(NULL), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
 }
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_,
                                    DatabaseQuery *q, const string &eventID)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), index(NULL), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
 	load(q, eventID);
 }
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_,
                                    DatabaseQuery *q, EventPtr &event)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), index(NULL), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
 	load(q, event);
 }
 
@@ -82,6 +82,8 @@ void EventInformation::load(DatabaseQuery *q, EventPtr &e) {
 			q->loadMagnitudes(preferredOrigin.get());
 	}
 
+	touch();
+
 
 	if ( !event->preferredMagnitudeID().empty() )
 		preferredMagnitude = cache->get<Magnitude>(event->preferredMagnitudeID());
@@ -139,6 +141,7 @@ size_t EventInformation::matchingPicks(DataModel::DatabaseQuery *q,
 		}
 
 		dirtyPickSet = false;
+		touch();
 	}
 
 	typedef pair<PickAssociation::const_iterator, PickAssociation::const_iterator> PickRange;
@@ -228,6 +231,8 @@ bool EventInformation::associate(DataModel::Origin *o) {
 		}
 	}
 
+	touch();
+
 	return true;
 }
 
@@ -401,3 +406,20 @@ void EventInformation::insertPick(Pick *p) {
 	string id = p->waveformID().networkCode() + "." + p->waveformID().stationCode();
 	picks.insert(PickAssociation::value_type(id, p));
 }
+
+
+void EventInformation::setPreferredOrigin(Origin *o) {
+	preferredOrigin = o;
+	touch();
+}
+
+
+void EventInformation::invalidatePicks() {
+	dirtyPickSet = true;
+	touch();
+}
+
+
+void EventInformation::touch() {
+	if ( index ) index->touch(this);
+}
@@ -25,6 +25,7 @@
 
 #include "constraints.h"
 #include "config.h"
+#include "eventindex.h"
 
 #include <list>
 #include <set>
@@ -76,8 +77,18 @@ struct EventInformation : public Seiscomp::Core::BaseObject {
 
 	void insertPick(DataModel::Pick *p);
 
+	//! Sets the preferred origin and updates the event index
+	void setPreferredOrigin(DataModel::Origin *o);
+
+	//! Forces the pick set to be reloaded on the next comparison
+	void invalidatePicks();
+
+	//! Schedules reindexing if the event is part of an index
+	void touch();
+
 	Cache                                 *cache;
 	Config                                *cfg;
+	EventIndex                            *index;
 
 	typedef std::multimap<std::string, DataModel::PickPtr> PickAssociation;
 	bool                                   created;
@@ -122,7 +122,8 @@ struct GlobalRegion : public Client::Config::Region {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-EventTool::EventTool(int argc, char **argv) : Application(argc, argv) {
+EventTool::EventTool(int argc, char **argv)
+: Application(argc, argv), _index(&_cache, &_config) {
 	_fExpiry = 1.0; // one hour cache initially
 
 	setAutoApplyNotifierEnabled(true);
@@ -698,6 +699,8 @@ void EventTool::cleanUpEventCache() {
 		if ( it->second->aboutToBeRemoved ) {
 			SEISCOMP_DEBUG("... remove event %s from cache",
 			               it->second->event->publicID().c_str());
+			_index.remove(it->second.get());
+			it->second->index = NULL;
 			_events.erase(it++);
 		}
 		else
@@ -974,12 +977,12 @@ void EventTool::removeObject(const string &parentID, Object* object) {
 			cacheEvent(info);
 		}
 		else if ( !info->event ) {
-			info->dirtyPickSet = true;
+			info->invalidatePicks();
 			SEISCOMP_ERROR("event %s for OriginReference not found", parentID.c_str());
 			return;
 		}
 
-		info->dirtyPickSet = true;
+		info->invalidatePicks();
 
 		if ( info->event->originReferenceCount() == 0 ) {
 			SEISCOMP_DEBUG("%s: last origin reference removed, remove event",
@@ -1002,7 +1005,7 @@ void EventTool::removeObject(const string &parentID, Object* object) {
 			// Reset preferred information
 			info->event->setPreferredOriginID("");
 			info->event->setPreferredMagnitudeID("");
-			info->preferredOrigin = NULL;
+			info->setPreferredOrigin(NULL);
 			info->preferredMagnitude = NULL;
 			Notifier::Enable();
 			// Select the preferred origin again among all remaining origins
@@ -1437,7 +1440,7 @@ bool EventTool::handleJournalEntry(DataModel::JournalEntry *entry) {
 						// Reset preferred information
 						sourceInfo->event->setPreferredOriginID("");
 						sourceInfo->event->setPreferredMagnitudeID("");
-						sourceInfo->preferredOrigin = NULL;
+						sourceInfo->setPreferredOrigin(NULL);
 						sourceInfo->preferredMagnitude = NULL;
 						// Select the preferred origin again among all remaining origins
 						updatePreferredOrigin(sourceInfo.get());
@@ -1528,7 +1531,7 @@ bool EventTool::handleJournalEntry(DataModel::JournalEntry *entry) {
 							// Reset preferred information
 							info->event->setPreferredOriginID("");
 							info->event->setPreferredMagnitudeID("");
-							info->preferredOrigin = NULL;
+							info->setPreferredOrigin(NULL);
 							info->preferredMagnitude = NULL;
 							// Select the preferred origin again among all remaining origins
 							updatePreferredOrigin(info.get());
@@ -1692,16 +1695,21 @@ EventInformationPtr EventTool::associateOrigin(Seiscomp::DataModel::Origin *orig
 				fetchedEvents.push_back(e);
 			}
 
+			std::vector<EventInformationPtr> candidates;
 			for ( size_t i = 0; i < fetchedEvents.size(); ++i ) {
 				// Load the eventinformation for this event
 				EventInformationPtr tmp = new EventInformation(&_cache, &_config, query(), fetchedEvents[i]);
-				if ( tmp->valid() ) {
-					tmp->loadAssocations(query());
-					MatchResult res = compare(tmp.get(), origin);
-					if ( res > bestResult ) {
-						bestResult = res;
-						info = tmp;
-					}
+				if ( tmp->valid() )
+					candidates.push_back(tmp);
+			}
+
+			loadAssociations(candidates);
+
+			for ( size_t i = 0; i < candidates.size(); ++i ) {
+				MatchResult res = compare(candidates[i].get(), origin);
+				if ( res > bestResult ) {
+					bestResult = res;
+					info = candidates[i];
 				}
 			}
 		}
@@ -1890,6 +1898,9 @@ void EventTool::updatedOrigin(DataModel::Origin *org,
 	// Cache this origin
 	_cache.feed(origin);
 
+	// The origin might have been relocated in place
+	info->touch();
+
 	Notifier::Enable();
 	if ( realOriginUpdate &&
 	     info->event->preferredOriginID() == origin->publicID() )
@@ -2205,13 +2216,29 @@ EventInformationPtr EventTool::createEvent(Origin *origin) {
 EventInformationPtr EventTool::findMatchingEvent(Origin *origin) {
 	MatchResult bestResult = Nothing;
 	EventInformationPtr bestInfo = NULL;
-	EventMap::iterator it;
+	EventIndex::Candidates candidates;
 
-	for ( it = _events.begin(); it != _events.end(); ++it ) {
-		MatchResult res = compare(it->second.get(), origin);
-		if ( res > bestResult ) {
-			bestResult = res;
-			bestInfo = it->second;
+	if ( _index.candidates(candidates, origin) ) {
+		SEISCOMP_DEBUG("... compare with %d of %d cached events",
+		               (int)candidates.size(), (int)_events.size());
+
+		EventIndex::Candidates::iterator it;
+		for ( it = candidates.begin(); it != candidates.end(); ++it ) {
+			MatchResult res = compare(*it, origin);
+			if ( res > bestResult ) {
+				bestResult = res;
+				bestInfo = *it;
+			}
+		}
+	}
+	else {
+		EventMap::iterator it;
+		for ( it = _events.begin(); it != _events.end(); ++it ) {
+			MatchResult res = compare(it->second.get(), origin);
+			if ( res > bestResult ) {
+				bestResult = res;
+				bestInfo = it->second;
+			}
 		}
 	}
 
@@ -2389,7 +2416,14 @@ void EventTool::cacheEvent(EventInformationPtr info) {
 	               info->event->publicID().c_str());
 
 	// Cache the complete event information
-	_events[info->event->publicID()] = info;
+	EventInformationPtr &cached = _events[info->event->publicID()];
+	if ( cached && cached != info ) {
+		_index.remove(cached.get());
+		cached->index = NULL;
+	}
+	cached = info;
+	info->index = &_index;
+	info->touch();
 	// Set the clean-up flag to false
 	info->aboutToBeRemoved = false;
 	// Add the event to the EventParameters
@@ -2412,6 +2446,64 @@ bool EventTool::isEventCached(const string &eventID) const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void EventTool::loadAssociations(const std::vector<EventInformationPtr> &infos) {
+	// The same children in the same order as DatabaseReader::load(Event*)
+	static const Core::RTTI *childTypes[] = {
+		&EventDescription::TypeInfo(),
+		&Comment::TypeInfo(),
+		&OriginReference::TypeInfo(),
+		&FocalMechanismReference::TypeInfo()
+	};
+	static const size_t childTypeCount = sizeof(childTypes) / sizeof(childTypes[0]);
+
+	typedef DatabaseIterator (DatabaseArchive::*GetObjects)(const std::string &,
+	                                                        const Core::RTTI &);
+
+	if ( infos.empty() ) return;
+
+	DatabaseQueryPool::Queries queries;
+	DatabaseQueryPool::Results results;
+
+	for ( size_t i = 0; i < infos.size(); ++i ) {
+		for ( size_t t = 0; t < childTypeCount; ++t )
+			queries.push_back(boost::bind(static_cast<GetObjects>(&DatabaseArchive::getObjects),
+			                              _1, infos[i]->event->publicID(),
+			                              boost::cref(*childTypes[t])));
+	}
+
+	if ( !runQueries(queries, results) ) {
+		// No pool, load the events one after another
+		for ( size_t i = 0; i < infos.size(); ++i )
+			infos[i]->loadAssocations(query());
+		return;
+	}
+
+	bool saveState = Notifier::IsEnabled();
+	Notifier::Disable();
+
+	for ( size_t i = 0; i < infos.size(); ++i ) {
+		Event *event = infos[i]->event.get();
+
+		for ( size_t t = 0; t < childTypeCount; ++t ) {
+			DatabaseQueryResult *result = results[i*childTypeCount + t].get();
+			if ( !result ) continue;
+
+			for ( size_t o = 0; o < result->objects().size(); ++o ) {
+				Object *child = result->objects()[o].get();
+				if ( child->parent() == NULL )
+					child->attachTo(event);
+			}
+		}
+	}
+
+	Notifier::SetEnabled(saveState);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 EventInformationPtr EventTool::cachedEvent(const std::string &eventID) {
 	EventMap::const_iterator it = _events.find(eventID);
@@ -2438,6 +2530,8 @@ EventInformationPtr EventTool::cachedEvent(const std::string &eventID) {
 bool EventTool::removeCachedEvent(const std::string &eventID) {
 	EventMap::iterator it = _events.find(eventID);
 	if ( it != _events.end() ) {
+		_index.remove(it->second.get());
+		it->second->index = NULL;
 		_events.erase(it);
 		return true;
 	}
@@ -2521,7 +2615,7 @@ void EventTool::choosePreferred(EventInformation *info, Origin *origin,
 
 			updateRegionName(info->event.get(), origin);
 
-			info->preferredOrigin = origin;
+			info->setPreferredOrigin(origin);
 			update = true;
 		}
 		else {
@@ -3006,7 +3100,7 @@ void EventTool::choosePreferred(EventInformation *info, Origin *origin,
 
 		updateRegionName(info->event.get(), origin);
 
-		info->preferredOrigin = origin;
+		info->setPreferredOrigin(origin);
 
 		if ( mag ) {
 			if ( info->event->preferredMagnitudeID() != mag->publicID() ) {
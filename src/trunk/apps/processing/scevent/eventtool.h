@@ -123,6 +123,10 @@ class EventTool : public Application {
 		bool removeCachedEvent(const std::string &eventID);
 		bool isEventCached(const std::string &eventID) const;
 
+		//! Loads the associations of events read from the database. The
+		//! queries run concurrently on the query pool if available.
+		void loadAssociations(const std::vector<EventInformationPtr> &infos);
+
 		void removedFromCache(DataModel::PublicObject *);
 
 		void updateEvent(DataModel::Event *ev, bool = true);
@@ -231,6 +235,7 @@ class EventTool : public Application {
 		ScoreProcessorPtr             _score;
 
 		EventMap                      _events;
+		EventIndex                    _index;
 		DataModel::EventParametersPtr _ep;
 		DataModel::JournalingPtr      _journal;
 
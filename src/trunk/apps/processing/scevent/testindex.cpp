@@ -0,0 +1,389 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Compares the event preselection of EventIndex with a full scan of all
+// cached events. Origins are placed at the edges of the time, distance and
+// pick time windows on purpose since those are the cases where bucketing
+// can go wrong. Returns 0 if the index returned every event a full scan
+// matches and both selected the same best event.
+
+
+#define SEISCOMP_COMPONENT SCEVENT
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/math/geo.h>
+#include <seiscomp3/datamodel/publicobjectcache.h>
+
+#include "eventindex.h"
+#include "eventinfo.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Core;
+using namespace Seiscomp::DataModel;
+using namespace Seiscomp::Client;
+
+
+namespace {
+
+
+enum MatchResult {
+	Nothing = 0,
+	Location,
+	Picks,
+	PicksAndLocation
+};
+
+
+typedef map<string, EventInformationPtr> EventMap;
+
+
+struct Scenario {
+	const char *name;
+	size_t      minMatchingPicks;
+	double      maxMatchingPicksTimeDiff;
+	bool        matchingPicksTimeDiffAND;
+};
+
+
+struct Stats {
+	Stats() : origins(0), events(0), fullScan(0), preselected(0), errors(0) {}
+
+	int    origins;
+	int    events;
+	size_t fullScan;
+	size_t preselected;
+	int    errors;
+};
+
+
+const int NumStations = 40;
+const int NumOrigins = 600;
+const int ArrivalsPerOrigin = 6;
+
+// Public IDs are registered globally, so all scenarios share the serial
+// numbers
+int originSerial = 0;
+int eventSerial = 0;
+
+
+// Same decision as EventTool::compare
+MatchResult compare(EventInformation *info, Origin *origin, const Client::Config &cfg) {
+	MatchResult result = Nothing;
+
+	if ( info->matchingPicks(NULL, origin) >= cfg.minMatchingPicks )
+		result = Picks;
+
+	if ( !info->preferredOrigin )
+		return Nothing;
+
+	double dist, azi1, azi2;
+	Math::Geo::delazi(origin->latitude().value(), origin->longitude().value(),
+	                  info->preferredOrigin->latitude().value(),
+	                  info->preferredOrigin->longitude().value(),
+	                  &dist, &azi1, &azi2);
+
+	if ( dist <= cfg.maxDist ) {
+		TimeSpan diffTime = info->preferredOrigin->time().value() - origin->time().value();
+		if ( diffTime.abs() <= cfg.maxTimeDiff )
+			result = result == Picks ? PicksAndLocation : Location;
+	}
+
+	return result;
+}
+
+
+double uniform(double min, double max) {
+	return min + (max - min) * rand() / RAND_MAX;
+}
+
+
+int randomInt(int n) {
+	return rand() % n;
+}
+
+
+// Returns an offset that puts a value right below, on or right above a
+// window edge
+double edge(double width, double eps) {
+	double sign = randomInt(2) ? 1 : -1;
+	return sign * (width + (randomInt(3) - 1) * eps);
+}
+
+
+PickPtr createPick(const string &id, int station, double t) {
+	char code[8];
+	snprintf(code, 8, "S%02d", station);
+
+	PickPtr pick = Pick::Create(id);
+	pick->setWaveformID(WaveformStreamID("XX", code, "", "HHZ", ""));
+	pick->setTime(TimeQuantity(Time(t)));
+	pick->setPhaseHint(Phase(randomInt(8) ? "P" : "S"));
+	return pick;
+}
+
+
+OriginPtr createOrigin(int n, EventMap &events, const Client::Config &cfg,
+                       PublicObjectCache &cache) {
+	char id[32];
+	snprintf(id, 32, "Origin#%05d", n);
+
+	OriginPtr origin = Origin::Create(id);
+	double t, lat, lon;
+	double maxTimeDiff = (double)cfg.maxTimeDiff;
+	double pickDiff = max(cfg.maxMatchingPicksTimeDiff, 1.0);
+
+	// A reference origin and its picks or a new location on a time
+	// bucket boundary
+	Origin *ref = NULL;
+	if ( !events.empty() && randomInt(4) ) {
+		EventMap::iterator it = events.begin();
+		advance(it, randomInt(events.size()));
+		ref = it->second->preferredOrigin.get();
+	}
+
+	if ( ref ) {
+		t = (double)ref->time().value();
+		lat = ref->latitude().value();
+		lon = ref->longitude().value();
+
+		switch ( randomInt(4) ) {
+			case 0:
+				t += edge(maxTimeDiff, 1E-3);
+				break;
+			case 1:
+				lat += edge(cfg.maxDist, 1E-4);
+				break;
+			case 2:
+				t += edge(maxTimeDiff, 1E-3);
+				lat += edge(cfg.maxDist, 1E-4);
+				break;
+			default:
+				t += uniform(-maxTimeDiff, maxTimeDiff);
+				lat += uniform(-cfg.maxDist, cfg.maxDist);
+				lon += uniform(-cfg.maxDist, cfg.maxDist);
+				break;
+		}
+	}
+	else {
+		t = 1E9 + randomInt(2000) * maxTimeDiff + (randomInt(3) - 1) * 1E-3;
+		lat = uniform(-20, 20);
+		lon = uniform(-20, 20);
+	}
+
+	origin->setTime(TimeQuantity(Time(t)));
+	origin->setLatitude(RealQuantity(lat));
+	origin->setLongitude(RealQuantity(lon));
+
+	for ( int i = 0; i < ArrivalsPerOrigin; ++i ) {
+		snprintf(id, 32, "Pick#%05d.%d", n, i);
+		PickPtr pick;
+
+		if ( ref && ref->arrivalCount() > 0 && randomInt(3) ) {
+			PickPtr refPick = cache.get<Pick>(ref->arrival(randomInt(ref->arrivalCount()))->pickID());
+			if ( refPick ) {
+				// Share the pick or pick the same station and phase at the
+				// edge of the pick time window
+				if ( randomInt(2) )
+					pick = refPick;
+				else {
+					pick = createPick(id, 0, (double)refPick->time().value() +
+					                  edge(pickDiff, 1E-3));
+					pick->setWaveformID(refPick->waveformID());
+					pick->setPhaseHint(refPick->phaseHint());
+				}
+			}
+		}
+
+		if ( !pick ) {
+			// Pick times on pick bucket boundaries
+			double pt = t + randomInt(100) * pickDiff + (randomInt(3) - 1) * 1E-3;
+			pick = createPick(id, randomInt(NumStations), pt);
+		}
+
+		cache.feed(pick.get());
+
+		ArrivalPtr arr = new Arrival;
+		arr->setPickID(pick->publicID());
+		arr->setPhase(pick->phaseHint());
+		if ( randomInt(10) == 0 ) arr->setWeight(0.0);
+		// Fails if a shared pick has been drawn twice
+		origin->add(arr.get());
+	}
+
+	cache.feed(origin.get());
+
+	return origin;
+}
+
+
+bool run(const Scenario &scenario, Stats &stats) {
+	Client::Config cfg;
+	cfg.minMatchingPicks = scenario.minMatchingPicks;
+	cfg.maxMatchingPicksTimeDiff = scenario.maxMatchingPicksTimeDiff;
+	cfg.matchingPicksTimeDiffAND = scenario.matchingPicksTimeDiffAND;
+	cfg.maxDist = 5.0;
+	cfg.maxTimeDiff = TimeSpan(60, 0);
+
+	PublicObjectRingBuffer cache(NULL, 100000);
+	EventIndex index(&cache, &cfg);
+	EventMap events;
+
+	srand(12345);
+
+	for ( int n = 0; n < NumOrigins; ++n ) {
+		OriginPtr origin = createOrigin(originSerial++, events, cfg, cache);
+		++stats.origins;
+
+		EventIndex::Candidates candidates;
+		bool preselected = index.candidates(candidates, origin.get());
+
+		if ( preselected != (cfg.minMatchingPicks > 0) ) {
+			cerr << scenario.name << ": " << origin->publicID()
+			     << ": unexpected fallback to the full scan" << endl;
+			++stats.errors;
+		}
+
+		// Full scan in event ID order as done without the index
+		map<EventInformation*, MatchResult> results;
+		EventInformationPtr best;
+		MatchResult bestResult = Nothing;
+
+		for ( EventMap::iterator it = events.begin(); it != events.end(); ++it ) {
+			MatchResult res = compare(it->second.get(), origin.get(), cfg);
+			results[it->second.get()] = res;
+			if ( res > bestResult ) {
+				bestResult = res;
+				best = it->second;
+			}
+		}
+
+		stats.fullScan += events.size();
+
+		EventInformation *bestCandidate = NULL;
+
+		if ( preselected ) {
+			stats.preselected += candidates.size();
+
+			MatchResult bestCandidateResult = Nothing;
+			set<EventInformation*> candidateSet(candidates.begin(), candidates.end());
+
+			for ( EventIndex::Candidates::iterator it = candidates.begin();
+			      it != candidates.end(); ++it ) {
+				MatchResult res = results[*it];
+				if ( res > bestCandidateResult ) {
+					bestCandidateResult = res;
+					bestCandidate = *it;
+				}
+			}
+
+			map<EventInformation*, MatchResult>::iterator it;
+			for ( it = results.begin(); it != results.end(); ++it ) {
+				if ( it->second == Nothing || candidateSet.count(it->first) ) continue;
+				cerr << scenario.name << ": " << origin->publicID()
+				     << " matches " << it->first->event->publicID()
+				     << " (code " << it->second << ") which was not preselected"
+				     << endl;
+				++stats.errors;
+			}
+		}
+		else
+			bestCandidate = best.get();
+
+		if ( bestCandidate != best.get() ) {
+			cerr << scenario.name << ": " << origin->publicID()
+			     << ": best event differs: "
+			     << (best ? best->event->publicID() : "none") << " vs "
+			     << (bestCandidate ? bestCandidate->event->publicID() : "none")
+			     << endl;
+			++stats.errors;
+		}
+
+		// Update the events as scevent does
+		EventInformationPtr info = best;
+		if ( !info ) {
+			char id[32];
+			snprintf(id, 32, "Event#%05d", eventSerial++);
+			++stats.events;
+
+			info = new EventInformation(&cache, &cfg);
+			info->event = Event::Create(id);
+			events[id] = info;
+			info->index = &index;
+			info->touch();
+			cache.feed(info->event.get());
+		}
+
+		info->associate(origin.get());
+		if ( !info->preferredOrigin || randomInt(2) )
+			info->setPreferredOrigin(origin.get());
+
+		// Force reloading pick sets and expire events now and then
+		if ( randomInt(20) == 0 ) {
+			EventMap::iterator it = events.begin();
+			advance(it, randomInt(events.size()));
+			it->second->invalidatePicks();
+		}
+
+		if ( randomInt(30) == 0 ) {
+			EventMap::iterator it = events.begin();
+			advance(it, randomInt(events.size()));
+			index.remove(it->second.get());
+			it->second->index = NULL;
+			events.erase(it);
+		}
+	}
+
+	index.clear();
+
+	return stats.errors == 0;
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	Scenario scenarios[] = {
+		{ "pick IDs", 3, -1, false },
+		{ "pick times (OR)", 3, 2.5, false },
+		{ "pick times (AND)", 3, 2.5, true },
+		{ "pick times < 1s", 2, 0.4, false },
+		{ "no matching picks", 0, -1, false }
+	};
+
+	int errors = 0;
+
+	for ( size_t i = 0; i < sizeof(scenarios) / sizeof(Scenario); ++i ) {
+		Stats stats;
+		run(scenarios[i], stats);
+
+		printf("%-20s %d origins, %d events, %lu full scan comparisons, "
+		       "%lu preselected, %d errors\n",
+		       scenarios[i].name, stats.origins, stats.events,
+		       (unsigned long)stats.fullScan, (unsigned long)stats.preselected,
+		       stats.errors);
+
+		errors += stats.errors;
+	}
+
+	return errors ? 1 : 0;
+}
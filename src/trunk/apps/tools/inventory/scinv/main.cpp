@@ -807,44 +807,21 @@ class InventoryManager : public Client::Application,
 						sync();
 
 						// Send notifier
-						DataModel::NotifierMessagePtr tmp = new DataModel::NotifierMessage();
-						DataModel::NotifierMessage::iterator it;
-						int count = 0;
+						size_t count = 0;
 
-						// Fetch each single notifier message. Fetching all notifiers
-						// in one message can take a long time if a huge amount of
-						// notifiers is in the queue. Due to memory fragmentation
-						// most of the time spent is in malloc.
-						while ( (nmsg = DataModel::Notifier::GetMessage(false)) != NULL ) {
+						// Send the notifiers in messages of at most 100 notifiers
+						while ( (nmsg = DataModel::Notifier::GetMessageBatch(100)) != NULL ) {
 							if ( _exitRequested ) break;
-							for ( it = nmsg->begin(); it != nmsg->end(); ++it ) {
-								DataModel::Notifier* n = DataModel::Notifier::Cast(*it);
-								if ( !n ) continue;
-
-								tmp->attach(n);
-								++count;
-
-								if ( count % 100 == 0 ) {
-									cerr << "\rSending notifiers: " << (int)(count*100/notifierCount) << "%" << flush;
 
-									if ( !send(tmp.get()) ) {
-										SEISCOMP_ERROR("Failed to send message, abort");
-										return false;
-									}
+							count += nmsg->size();
 
-									tmp->clear();
-									sync();
-								}
-							}
-						}
-
-						if ( !_exitRequested && !tmp->empty() ) {
-							if ( !send(tmp.get()) ) {
+							if ( !send(nmsg.get()) ) {
 								SEISCOMP_ERROR("Failed to send message, abort");
 								return false;
 							}
 
 							cerr << "\rSending notifiers: " << (int)(count*100/notifierCount) << "%" << flush;
+							sync();
 						}
 
 						cerr << endl;
@@ -0,0 +1,52 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/io/gfarchive/sc3gf1d.h>
+#include <seiscomp3/logging/log.h>
+
+#include <iostream>
+#include <cstdlib>
+
+
+using namespace Seiscomp;
+using namespace std;
+
+
+int main(int argc, char **argv) {
+	if ( argc < 3 ) {
+		cerr << "scgfpack directory model [output]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	Logging::enableConsoleLogging(Logging::getGlobalChannel("error"));
+	Logging::enableConsoleLogging(Logging::getGlobalChannel("warning"));
+
+	string directory = argv[1];
+	string model = argv[2];
+	string output = argc > 3 ? argv[3] : directory + "/" + model + ".gfpack";
+
+	IO::SC3GF1DArchive archive;
+	if ( !archive.setSource(directory) ) {
+		cerr << directory << ": no models found" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if ( !archive.pack(model, output) ) {
+		cerr << "Failed to pack model " << model << endl;
+		return EXIT_FAILURE;
+	}
+
+	cout << "Wrote " << output << endl;
+
+	return EXIT_SUCCESS;
+}
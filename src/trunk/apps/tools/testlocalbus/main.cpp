@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT TestLocalBus
+
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/client/application.h>
+#include <seiscomp3/datamodel/pick.h>
+#include <seiscomp3/datamodel/notifier.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+
+#include <iostream>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::DataModel;
+
+
+/**
+ * Runs two applications as threads of one process connected to the same
+ * local bus. Both create a pick with the same publicID and a pick with
+ * their own publicID and send them to the other. Each application must
+ * find its own objects by publicID, the received copy of the shared pick
+ * must not replace its own one and the received copy of the other pick
+ * must be registered for the receiver only. Returns 0 on success.
+ */
+namespace {
+
+
+const char *SharedID = "Pick#shared";
+const int Timeout = 10;
+
+
+boost::barrier connected(2);
+
+
+class Peer : public Client::Application {
+	public:
+		Peer(int argc, char **argv, const string &name, const string &other)
+		: Client::Application(argc, argv), _name(name), _other(other)
+		, _errors(0), _seconds(0), _received(false) {
+			setDatabaseEnabled(false, false);
+			setAutoApplyNotifierEnabled(false);
+			setPrimaryMessagingGroup("PICK");
+			addMessagingSubscription("PICK");
+		}
+
+		int errors() const { return _errors; }
+
+	protected:
+		bool init() {
+			bool ok = Client::Application::init();
+
+			if ( ok ) {
+				// Both applications create the same publicID
+				_shared = Pick::Create(SharedID);
+				_own = Pick::Create("Pick#" + _name);
+
+				if ( !_shared || !_own ) {
+					error("unable to create the picks");
+					ok = false;
+				}
+			}
+
+			// Sending starts when both are subscribed. Failures pass the
+			// barrier as well to not block the other.
+			connected.wait();
+
+			return ok;
+		}
+
+		bool run() {
+			NotifierMessagePtr msg = new NotifierMessage;
+			msg->attach(new Notifier("EventParameters", OP_ADD, _shared.get()));
+			// Sent last to know that all objects of the other arrived
+			msg->attach(new Notifier("EventParameters", OP_ADD, _own.get()));
+
+			if ( !connection()->send(msg.get()) ) {
+				error("unable to send the picks");
+				return false;
+			}
+
+			enableTimer(1);
+
+			return Client::Application::run();
+		}
+
+		void handleTimeout() {
+			if ( ++_seconds < Timeout ) return;
+			error("no picks received");
+			quit();
+		}
+
+		void addObject(const string &, Object *obj) {
+			Pick *pick = Pick::Cast(obj);
+			if ( pick == NULL ) return;
+
+			if ( pick->publicID() == SharedID ) {
+				if ( pick == _shared.get() || pick->registered() )
+					error("the received shared pick has been registered");
+				if ( Pick::Find(SharedID) != _shared.get() )
+					error("the shared pick has been replaced");
+			}
+			else if ( pick->publicID() == "Pick#" + _name ) {
+				// Sent to ourselves
+				if ( Pick::Find(pick->publicID()) != _own.get() )
+					error("the own pick has been replaced");
+			}
+			else if ( pick->publicID() == "Pick#" + _other ) {
+				if ( !pick->registered() || Pick::Find(pick->publicID()) != pick )
+					error("the received pick has not been registered");
+				_received = true;
+				quit();
+			}
+			else
+				error("unexpected pick " + pick->publicID());
+		}
+
+		void done() {
+			if ( !_received && !_errors )
+				error("no picks received");
+
+			// The picks of the other must not be visible
+			if ( Pick::Find("Pick#" + _other) != NULL )
+				error("the pick of the other is still registered");
+
+			Client::Application::done();
+		}
+
+	private:
+		void error(const string &text) {
+			cerr << _name << ": " << text << endl;
+			++_errors;
+		}
+
+	private:
+		string _name;
+		string _other;
+		PickPtr _shared;
+		PickPtr _own;
+		int _errors;
+		int _seconds;
+		bool _received;
+};
+
+
+void runPeer(const char *name, const char *other, int *errors) {
+	const char *argv[] = { "testlocalbus", "-H", "local://testlocalbus", "-u", name };
+	Peer app(5, const_cast<char**>(argv), name, other);
+
+	if ( app.exec() != 0 ) ++*errors;
+	*errors += app.errors();
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	int errorsA = 0, errorsB = 0;
+
+	boost::thread a(boost::bind(runPeer, "A", "B", &errorsA));
+	boost::thread b(boost::bind(runPeer, "B", "A", &errorsB));
+
+	a.join();
+	b.join();
+
+	int errors = errorsA + errorsB;
+
+	// Nothing must have been registered in the process wide registry
+	if ( PublicObject::Find(SharedID) != NULL ) {
+		cerr << "the shared pick has been registered process wide" << endl;
+		++errors;
+	}
+
+	cout << "A: " << errorsA << " errors, B: " << errorsB << " errors" << endl;
+
+	return errors ? 1 : 0;
+}
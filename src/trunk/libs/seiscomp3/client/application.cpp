@@ -35,6 +35,7 @@
 #include <seiscomp3/client/pluginregistry.h>
 #include <seiscomp3/client/inventory.h>
 #include <seiscomp3/client/configdb.h>
+#include <seiscomp3/client/snapshot.h>
 
 #include <seiscomp3/datamodel/config.h>
 #include <seiscomp3/datamodel/configmodule.h>
@@ -43,6 +44,7 @@
 #include <seiscomp3/datamodel/version.h>
 
 #include <seiscomp3/io/archive/xmlarchive.h>
+#include <seiscomp3/io/gfarchive/gfcache.h>
 #include <seiscomp3/io/recordstream.h>
 
 #include <seiscomp3/core/strings.h>
@@ -424,6 +426,8 @@ Application::Application(int argc, char** argv)
 
 	_inputMonitor = _outputMonitor = NULL;
 	_objectLogTimeWindow = 60;
+	_queryPoolSize = 2;
+	_registry = NULL;
 
 	if ( _instance != this && _instance != NULL ) {
 		SEISCOMP_WARNING("Another application object exists already. "
@@ -452,6 +456,7 @@ Application::Application(int argc, char** argv)
 	_enableInterpretNotifier = true;
 	_enableLoadCities = false;
 	_enableLoadRegions = false;
+	_enableSnapshot = false;
 	_enableStartStopMessages = false;
 	_enableAutoShutdown = false;
 	_customPublicIDPattern = false;
@@ -496,6 +501,12 @@ Application::~Application() {
 
 	// Remove all queued notifiers
 	DataModel::Notifier::Clear();
+
+	if ( _registry ) {
+		if ( DataModel::PublicObject::ThreadRegistry() == _registry )
+			DataModel::PublicObject::SetThreadRegistry(NULL);
+		delete _registry;
+	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1080,6 +1091,64 @@ DataModel::DatabaseQuery* Application::query() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Application::openQueryPool() {
+	if ( _queryPool ) return true;
+
+	if ( _db.empty() || _queryPoolSize == 0 )
+		return false;
+
+	_queryPool = new DataModel::DatabaseQueryPool;
+	if ( !_queryPool->open(_db, _queryPoolSize) ) {
+		SEISCOMP_ERROR("Failed to open the database query pool");
+		_queryPool = NULL;
+		// Do not try again with each query
+		_queryPoolSize = 0;
+		return false;
+	}
+
+	SEISCOMP_DEBUG("Opened %d pool connections to %s",
+	               (int)_queryPool->connections(), _db.c_str());
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+unsigned long Application::submitQuery(const DataModel::DatabaseQueryPool::Query &query) {
+	if ( !openQueryPool() ) return 0;
+	return _queryPool->submit(query, boost::bind(&Application::queryFinished, this, _1));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Application::runQueries(const DataModel::DatabaseQueryPool::Queries &queries,
+                             DataModel::DatabaseQueryPool::Results &results) {
+	if ( !openQueryPool() ) return false;
+	return _queryPool->execute(queries, results);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Application::queryFinished(DataModel::DatabaseQueryResult *result) {
+	// The queue is closed after done(), nobody will take over the result
+	if ( !sendNotification(Notification(Notification::QueryResult, result)) )
+		delete result;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 const std::string&  Application::recordStreamURL() const {
 	return _recordStream;
@@ -1545,6 +1614,13 @@ bool Application::init() {
 		return false;
 	}
 
+	// Clients of a local bus run in the same process and would otherwise
+	// share their objects by publicID
+	if ( _enableMessaging && _messagingHost.compare(0, 8, "local://") == 0 ) {
+		_registry = new DataModel::PublicObject::Registry;
+		DataModel::PublicObject::SetThreadRegistry(_registry);
+	}
+
 	_inputMonitor = new ObjectMonitor(_objectLogTimeWindow);
 	_outputMonitor = new ObjectMonitor(_objectLogTimeWindow);
 
@@ -1650,20 +1726,12 @@ bool Application::init() {
 		return false;
 
 	if ( _enableLoadConfigModule ) {
-		std::set<std::string> params;
-
 		if ( !_configDB.empty() ) {
 			if ( !loadConfig(_configDB) ) return false;
 		}
 		else if ( _database ) {
 			if ( _query ) {
-				SEISCOMP_INFO("Loading configuration module");
-				showMessage("Reading station config");
-				if ( !_configModuleName.empty() )
-					ConfigDB::Instance()->load(query(), _configModuleName, Core::None, Core::None, Core::None, params);
-				else
-					ConfigDB::Instance()->load(query(), Core::None, Core::None, Core::None, Core::None, params);
-				SEISCOMP_INFO("Finished loading configuration module");
+				loadConfigFromDatabase();
 			}
 			else {
 				SEISCOMP_ERROR("No database query object");
@@ -1741,8 +1809,8 @@ void Application::timeout() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void Application::sendNotification(const Notification &n) {
-	_queue.push(n);
+bool Application::sendNotification(const Notification &n) {
+	return _queue.push(n);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1829,10 +1897,7 @@ bool Application::reloadInventory() {
 		}
 		else if ( _database ) {
 			if ( _query ) {
-				SEISCOMP_INFO("Loading complete inventory");
-				showMessage("Loading inventory");
-				Inventory::Instance()->load(_query.get());
-				SEISCOMP_INFO("Finished loading complete inventory");
+				loadInventoryFromDatabase(false);
 			}
 			else {
 				SEISCOMP_ERROR("No database query object");
@@ -1851,10 +1916,7 @@ bool Application::reloadInventory() {
 		}
 		else if ( _database ) {
 			if ( _query ) {
-				SEISCOMP_INFO("Loading inventory (stations only)");
-				showMessage("Loading stations");
-				Inventory::Instance()->loadStations(_query.get());
-				SEISCOMP_INFO("Finished loading inventory (stations only)");
+				loadInventoryFromDatabase(true);
 			}
 			else {
 				SEISCOMP_ERROR("No database query object");
@@ -1942,6 +2004,10 @@ bool Application::processEvent() {
 				handleEndAcquisition();
 				break;
 
+			case Notification::QueryResult:
+				handleQueryResult(DataModel::DatabaseQueryResult::Cast(obj.get()));
+				break;
+
 			default:
 				if ( !dispatchNotification(evt.type, obj.get()) )
 					SEISCOMP_WARNING("Wrong eventtype in queue: %d", evt.type);
@@ -2058,6 +2124,11 @@ void Application::done() {
 		SEISCOMP_INFO("Message thread finished");
 	}
 
+	if ( _queryPool ) {
+		_queryPool->close();
+		_queryPool = NULL;
+	}
+
 	_connection = NULL;
 	_query = NULL;
 	_database = NULL;
@@ -2275,6 +2346,25 @@ bool Application::initConfiguration() {
 	try { _configDB = configGetString("database.config"); }
 	catch ( ... ) {}
 
+	try { _queryPoolSize = configGetInt("database.poolSize"); }
+	catch ( ... ) {}
+
+	try { _enableSnapshot = configGetBool("database.snapshot.enable"); }
+	catch ( ... ) {}
+
+	try { _snapshotDir = Environment::Instance()->absolutePath(configGetString("database.snapshot.directory")); }
+	catch ( ... ) { _snapshotDir = Environment::Instance()->installDir() + "/var/cache/snapshot"; }
+
+	try {
+		double budget = configGetDouble("gfarchive.cache.memoryBudget");
+		if ( budget < 0 ) {
+			SEISCOMP_ERROR("gfarchive.cache.memoryBudget: negative values are not allowed");
+			return false;
+		}
+		IO::GFCache::SetMemoryBudget((size_t)(budget*1024*1024));
+	}
+	catch ( ... ) {}
+
 	try { _cityDB = Environment::Instance()->absolutePath(configGetString("cityXML")); }
 	catch ( ... ) {}
 
@@ -2620,6 +2710,7 @@ bool Application::initSubscriptions() {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::runMessageThread() {
 	SEISCOMP_INFO("Starting message thread");
+	if ( _registry ) DataModel::PublicObject::SetThreadRegistry(_registry);
 	while ( readMessages() ) {}
 	SEISCOMP_INFO("Leaving message thread");
 }
@@ -2835,6 +2926,95 @@ bool Application::loadInventory(const std::string &inventoryDB) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Application::loadInventoryFromDatabase(bool stationsOnly) {
+	const char *snapshotName = stationsOnly ? "stations" : "inventory";
+	const char *what = stationsOnly ? "inventory (stations only)" : "complete inventory";
+	std::string fingerprint;
+	bool settled = false;
+	Util::StopWatch stopWatch;
+
+	SEISCOMP_INFO("Loading %s", what);
+	showMessage(stationsOnly ? "Loading stations" : "Loading inventory");
+
+	if ( _enableSnapshot ) {
+		Snapshot snapshot(_snapshotDir);
+		fingerprint = Snapshot::Fingerprint(_database.get(), Snapshot::InventoryTables(), &settled);
+		DataModel::InventoryPtr inv = DataModel::Inventory::Cast(snapshot.read(snapshotName, fingerprint));
+		if ( inv ) {
+			Inventory::Instance()->setInventory(inv.get());
+			SEISCOMP_INFO("Finished loading %s from snapshot in %fs",
+			              what, (double)stopWatch.elapsed());
+			return;
+		}
+	}
+
+	if ( stationsOnly )
+		Inventory::Instance()->loadStations(_query.get());
+	else
+		Inventory::Instance()->load(_query.get());
+
+	SEISCOMP_INFO("Finished loading %s in %fs", what, (double)stopWatch.elapsed());
+
+	if ( _enableSnapshot && !fingerprint.empty() ) {
+		if ( !settled )
+			SEISCOMP_DEBUG("Inventory has been modified within the last second, "
+			               "no %s snapshot created", snapshotName);
+		else if ( Snapshot(_snapshotDir).write(snapshotName, fingerprint, Inventory::Instance()->inventory()) )
+			SEISCOMP_INFO("Created %s snapshot in %s", snapshotName, _snapshotDir.c_str());
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Application::loadConfigFromDatabase() {
+	std::string snapshotName = "config";
+	std::string fingerprint;
+	bool settled = false;
+	Util::StopWatch stopWatch;
+
+	SEISCOMP_INFO("Loading configuration module");
+	showMessage("Reading station config");
+
+	if ( !_configModuleName.empty() )
+		snapshotName += "-" + _configModuleName;
+
+	if ( _enableSnapshot ) {
+		Snapshot snapshot(_snapshotDir);
+		fingerprint = Snapshot::Fingerprint(_database.get(), Snapshot::ConfigTables(), &settled);
+		DataModel::ConfigPtr config = DataModel::Config::Cast(snapshot.read(snapshotName, fingerprint));
+		if ( config ) {
+			ConfigDB::Instance()->setConfig(config.get());
+			SEISCOMP_INFO("Finished loading configuration module from snapshot in %fs",
+			              (double)stopWatch.elapsed());
+			return;
+		}
+	}
+
+	if ( !_configModuleName.empty() )
+		ConfigDB::Instance()->load(query(), _configModuleName);
+	else
+		ConfigDB::Instance()->load(query());
+
+	SEISCOMP_INFO("Finished loading configuration module in %fs",
+	              (double)stopWatch.elapsed());
+
+	if ( _enableSnapshot && !fingerprint.empty() ) {
+		if ( !settled )
+			SEISCOMP_DEBUG("Configuration has been modified within the last second, "
+			               "no %s snapshot created", snapshotName.c_str());
+		else if ( Snapshot(_snapshotDir).write(snapshotName, fingerprint, ConfigDB::Instance()->config()) )
+			SEISCOMP_INFO("Created %s snapshot in %s", snapshotName.c_str(), _snapshotDir.c_str());
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::logObject(ObjectMonitor::Log *log, const Core::Time &timestamp,
                             size_t count) {
@@ -3138,6 +3318,13 @@ void Application::handleTimeout() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Application::handleQueryResult(DataModel::DatabaseQueryResult *) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool Application::handleClose() {
 	return true;
@@ -28,6 +28,7 @@
 #include <seiscomp3/system/environment.h>
 #include <seiscomp3/communication/connection.h>
 #include <seiscomp3/datamodel/databasequery.h>
+#include <seiscomp3/datamodel/databasequerypool.h>
 #include <seiscomp3/datamodel/notifier.h>
 #include <seiscomp3/datamodel/configmodule.h>
 #include <seiscomp3/math/coord.h>
@@ -100,7 +101,8 @@ struct SC_SYSTEM_CLIENT_API Notification {
 		Close,
 		Timeout,
 		Sync,
-		AcquisitionFinished
+		AcquisitionFinished,
+		QueryResult
 	};
 
 	Notification() : object(NULL), type(Object) {}
@@ -283,6 +285,31 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		//! Returns the application's database query interface
 		DataModel::DatabaseQuery* query() const;
 
+		/**
+		 * Runs a query asynchronously on a pool of additional database
+		 * connections. The pool is opened with the first query and its
+		 * size is configured with database.poolSize. The result is passed
+		 * to handleQueryResult in the main thread.
+		 * @param query The query, e.g.
+		 *              boost::bind(&DataModel::DatabaseQuery::getPicks,
+		 *                          _1, startTime, endTime)
+		 * @return The id of the query or 0 if the pool is not available
+		 */
+		unsigned long submitQuery(const DataModel::DatabaseQueryPool::Query &query);
+
+		/**
+		 * Runs independent queries concurrently on the database query
+		 * pool and blocks until all of them are finished. This saves
+		 * round trips compared to running them one after another with
+		 * query(). The objects are neither registered nor cached.
+		 * @param queries The queries
+		 * @param results The results in the order of the queries
+		 * @return false if the pool is not available. Results of
+		 *         queries that have not been run are NULL.
+		 */
+		bool runQueries(const DataModel::DatabaseQueryPool::Queries &queries,
+		                DataModel::DatabaseQueryPool::Results &results);
+
 		//! Returns the configures recordstream URL to be used by
 		//! RecordStream::Open()
 		const std::string& recordStreamURL() const;
@@ -320,7 +347,9 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		//! Sends a notification to the application. If used in derived
 		//! classes to send custom notifications use negative notification
 		//! types and reimplement dispatchNotification(...).
-		void sendNotification(const Notification &);
+		//! Returns false if the notification queue has already been closed
+		//! and the notification was not queued.
+		bool sendNotification(const Notification &);
 
 		/**
 		 * If a connection is available a sync request
@@ -671,6 +700,12 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		 */
 		virtual void handleTimeout();
 
+		/**
+		 * This method gets called with the result of a query submitted
+		 * with submitQuery. The default implementation does nothing.
+		 */
+		virtual void handleQueryResult(DataModel::DatabaseQueryResult *result);
+
 		/**
 		 * This method is called when close event is sent to the application.
 		 * The default handler returns true and causes the event queue to
@@ -805,6 +840,13 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		bool loadConfig(const std::string &configDB);
 		bool loadInventory(const std::string &inventoryDB);
 
+		//! Loads the inventory or stations from the application database
+		//! and uses a snapshot if enabled.
+		void loadInventoryFromDatabase(bool stationsOnly);
+		//! Loads the configuration from the application database and uses
+		//! a snapshot if enabled.
+		void loadConfigFromDatabase();
+
 		void startMessageThread();
 		void runMessageThread();
 
@@ -814,6 +856,12 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 
 		void timeout();
 
+		//! Opens the database query pool if not yet done
+		bool openQueryPool();
+
+		//! Passes the result of a pool query to the main thread
+		void queryFinished(DataModel::DatabaseQueryResult *result);
+
 		void monitorLog(const Communication::SystemConnection*,
 		                const Core::Time &,std::ostream&);
 
@@ -843,6 +891,12 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 
 		Logging::Output* _logger;
 		DataModel::DatabaseQueryPtr _query;
+		DataModel::DatabaseQueryPoolPtr _queryPool;
+		unsigned int _queryPoolSize;
+
+		//! The registry of the main and the messaging thread if connected
+		//! to a local bus, NULL otherwise
+		DataModel::PublicObject::Registry *_registry;
 
 		std::string _configModuleName;
 		DataModel::ConfigModulePtr _configModule;
@@ -862,6 +916,7 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		bool _enableInterpretNotifier;
 		bool _enableLoadCities;
 		bool _enableLoadRegions;
+		bool _enableSnapshot;
 
 		unsigned int _retryCount;
 
@@ -904,6 +959,7 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		std::string _inventoryDB;
 		std::string _configDB;
 		std::string _cityDB;
+		std::string _snapshotDir;
 
 		std::string _dbType;
 		std::string _dbParameters;
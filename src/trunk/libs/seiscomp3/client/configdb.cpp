@@ -256,6 +256,14 @@ void ConfigDB::load(const char *xml) {
 }
 
 
+void ConfigDB::setConfig(Seiscomp::DataModel::Config *config) {
+	_configModules.clear();
+	_configStations.clear();
+	_parameterSets.clear();
+	_config = config;
+}
+
+
 Seiscomp::DataModel::Config* ConfigDB::config() {
 	return _config.get();
 }
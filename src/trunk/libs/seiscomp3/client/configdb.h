@@ -46,6 +46,10 @@ class SC_SYSTEM_CLIENT_API ConfigDB {
 
 		void load(const char *xml);
 
+		//! Replaces the current configuration, e.g. with a configuration
+		//! read from a snapshot.
+		void setConfig(Seiscomp::DataModel::Config *config);
+
 		Seiscomp::DataModel::Config* config();
 
 	private:
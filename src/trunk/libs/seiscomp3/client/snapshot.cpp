@@ -0,0 +1,326 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT Snapshot
+
+#include <seiscomp3/client/snapshot.h>
+#include <seiscomp3/io/archive/binarchive.h>
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/utils/files.h>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/stream_buffer.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+
+namespace Seiscomp {
+namespace Client {
+
+
+namespace {
+
+
+const char SnapshotMagic[8] = { 'S', 'C', '3', 'S', 'N', 'A', 'P', '\0' };
+const int SnapshotFormatVersion = 1;
+const char *SnapshotExtension = ".snapshot";
+
+
+// Comments are not part of the list since they share their table with
+// all other commentable objects and would invalidate the snapshot with
+// each new event.
+const char *inventoryTables[] = {
+	"Network", "Station", "SensorLocation", "Stream", "AuxStream",
+	"StationGroup", "StationReference", "AuxDevice", "AuxSource",
+	"Sensor", "SensorCalibration", "Datalogger", "DataloggerCalibration",
+	"Decimation", "ResponsePAZ", "ResponseFIR", "ResponsePolynomial",
+	"ResponseFAP",
+	NULL
+};
+
+const char *configTables[] = {
+	"ConfigModule", "ConfigStation", "Setup", "ParameterSet", "Parameter",
+	NULL
+};
+
+
+// Parses a timestamp column. Fractional seconds and time zone suffixes
+// (PostgreSQL) are ignored.
+Core::Time parseTime(IO::DatabaseInterface *db, const std::string &str) {
+	return db->stringToTime(str.substr(0, 19).c_str());
+}
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Snapshot::Snapshot(const std::string &directory)
+: _directory(directory) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &Snapshot::directory() const {
+	return _directory;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const char * const *Snapshot::InventoryTables() {
+	return inventoryTables;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const char * const *Snapshot::ConfigTables() {
+	return configTables;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string Snapshot::Fingerprint(IO::DatabaseInterface *db,
+                                  const char * const *tables,
+                                  bool *settled) {
+	if ( settled ) *settled = false;
+	if ( db == NULL ) return "";
+
+	std::ostringstream fp;
+	Core::Time now, lastModified;
+	bool unknownModification = false;
+
+	// The current time is taken from the database since the modification
+	// times are set by the database as well
+	if ( db->beginQuery("SELECT CURRENT_TIMESTAMP") ) {
+		if ( db->fetchRow() )
+			now = parseTime(db, db->getRowFieldString(0));
+		db->endQuery();
+	}
+
+	for ( ; *tables != NULL; ++tables ) {
+		std::string query = "SELECT COUNT(*),MAX(_oid),MAX(_last_modified) FROM ";
+		query += *tables;
+
+		fp << *tables << ':';
+
+		// Tables that are not available in older schema versions are
+		// marked and do not prevent the fingerprint to be created
+		if ( !db->beginQuery(query.c_str()) ) {
+			fp << "-;";
+			continue;
+		}
+
+		if ( db->fetchRow() ) {
+			for ( int i = 0; i < 3; ++i ) {
+				if ( i ) fp << ',';
+				fp << db->getRowFieldString(i);
+			}
+
+			// Empty tables have no modification time
+			std::string str = db->getRowFieldString(2);
+			if ( !str.empty() ) {
+				Core::Time modified = parseTime(db, str);
+				if ( !modified.valid() )
+					unknownModification = true;
+				else if ( modified > lastModified )
+					lastModified = modified;
+			}
+		}
+		else
+			fp << '?';
+
+		db->endQuery();
+
+		fp << ';';
+	}
+
+	if ( settled && now.valid() && !unknownModification )
+		*settled = now - lastModified >= Core::TimeSpan(1,0);
+
+	return fp.str();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string Snapshot::filename(const std::string &name) const {
+	return _directory + "/" + name + SnapshotExtension;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::BaseObjectPtr Snapshot::read(const std::string &name,
+                                   const std::string &fingerprint) const {
+	std::string fn = filename(name);
+	if ( !Util::fileExists(fn) ) return NULL;
+
+	boost::iostreams::mapped_file_source file;
+
+	try {
+		file.open(fn);
+	}
+	catch ( std::exception &e ) {
+		SEISCOMP_WARNING("%s: unable to map snapshot: %s", fn.c_str(), e.what());
+		return NULL;
+	}
+
+	const char *data = file.data();
+	size_t size = file.size();
+
+	// Header: magic, format version, fingerprint size and fingerprint
+	size_t headerSize = sizeof(SnapshotMagic) + 2*sizeof(int);
+	if ( size < headerSize || memcmp(data, SnapshotMagic, sizeof(SnapshotMagic)) ) {
+		SEISCOMP_WARNING("%s: invalid snapshot header", fn.c_str());
+		return NULL;
+	}
+
+	int version, fpSize;
+	memcpy(&version, data + sizeof(SnapshotMagic), sizeof(int));
+	memcpy(&fpSize, data + sizeof(SnapshotMagic) + sizeof(int), sizeof(int));
+
+	if ( version != SnapshotFormatVersion ) {
+		SEISCOMP_DEBUG("%s: snapshot format version %d does not match %d",
+		               fn.c_str(), version, SnapshotFormatVersion);
+		return NULL;
+	}
+
+	if ( fpSize < 0 || headerSize + fpSize > size ) {
+		SEISCOMP_WARNING("%s: invalid snapshot header", fn.c_str());
+		return NULL;
+	}
+
+	if ( fingerprint.compare(0, std::string::npos, data + headerSize, fpSize) ) {
+		SEISCOMP_DEBUG("%s: snapshot is outdated", fn.c_str());
+		return NULL;
+	}
+
+	headerSize += fpSize;
+
+	boost::iostreams::stream_buffer<boost::iostreams::array_source>
+		buf(data + headerSize, size - headerSize);
+
+	IO::VBinaryArchive ar;
+	if ( !ar.open(&buf) ) {
+		SEISCOMP_WARNING("%s: %s", fn.c_str(), ar.errorMsg());
+		return NULL;
+	}
+
+	Core::BaseObjectPtr obj;
+
+	try {
+		ar >> obj;
+	}
+	catch ( std::exception &e ) {
+		SEISCOMP_WARNING("%s: %s", fn.c_str(), e.what());
+		obj = NULL;
+	}
+
+	ar.close();
+
+	if ( obj == NULL || !ar.success() ) {
+		SEISCOMP_WARNING("%s: snapshot is corrupt", fn.c_str());
+		return NULL;
+	}
+
+	return obj;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Snapshot::write(const std::string &name, const std::string &fingerprint,
+                     Core::BaseObject *obj) const {
+	if ( obj == NULL || fingerprint.empty() ) return false;
+
+	if ( !Util::pathExists(_directory) && !Util::createPath(_directory) ) {
+		SEISCOMP_WARNING("%s: unable to create snapshot directory", _directory.c_str());
+		return false;
+	}
+
+	std::string fn = filename(name);
+	std::ostringstream tmp;
+	tmp << fn << '.' << getpid();
+
+	{
+		std::ofstream ofs(tmp.str().c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if ( !ofs.is_open() ) {
+			SEISCOMP_WARNING("%s: unable to create snapshot", tmp.str().c_str());
+			return false;
+		}
+
+		int version = SnapshotFormatVersion;
+		int fpSize = (int)fingerprint.size();
+
+		ofs.write(SnapshotMagic, sizeof(SnapshotMagic));
+		ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		ofs.write(reinterpret_cast<const char*>(&fpSize), sizeof(fpSize));
+		ofs.write(fingerprint.data(), fpSize);
+
+		IO::VBinaryArchive ar;
+		if ( !ar.create(ofs.rdbuf()) ) {
+			ofs.close();
+			unlink(tmp.str().c_str());
+			return false;
+		}
+
+		ar << obj;
+		ar.close();
+
+		if ( !ofs.good() ) {
+			ofs.close();
+			unlink(tmp.str().c_str());
+			SEISCOMP_WARNING("%s: failed to write snapshot", tmp.str().c_str());
+			return false;
+		}
+	}
+
+	if ( rename(tmp.str().c_str(), fn.c_str()) != 0 ) {
+		unlink(tmp.str().c_str());
+		SEISCOMP_WARNING("%s: failed to install snapshot", fn.c_str());
+		return false;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
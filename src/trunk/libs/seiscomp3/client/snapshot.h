@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_CLIENT_SNAPSHOT_H__
+#define __SEISCOMP_CLIENT_SNAPSHOT_H__
+
+
+#include <seiscomp3/core/baseobject.h>
+#include <seiscomp3/io/database.h>
+#include <seiscomp3/client.h>
+
+#include <string>
+
+
+namespace Seiscomp {
+namespace Client {
+
+
+/**
+ * @brief Binary snapshot cache of database content that is loaded at
+ *        application startup, e.g. the inventory or the configuration.
+ *
+ * Each snapshot is a single file in the snapshot directory which is
+ * shared by all modules. A snapshot file starts with a small header
+ * holding the format version and the fingerprint of the database tables
+ * it has been created from followed by the object tree serialized with
+ * a VBinaryArchive. Snapshots are read through a read-only memory
+ * mapping.
+ *
+ * The fingerprint is built from the row count, the maximum object id and
+ * the last modification time of each table contributing to a snapshot.
+ * If it does not match the current database state the snapshot is stale
+ * and will not be used. Modification times have a resolution of one second
+ * in some backends, so an update within the same second as the newest
+ * captured modification would not change the fingerprint. Snapshots are
+ * therefore only written if no table has been modified within the last
+ * second.
+ */
+class SC_SYSTEM_CLIENT_API Snapshot {
+	// ----------------------------------------------------------------------
+	//  X'truction
+	// ----------------------------------------------------------------------
+	public:
+		//! C'tor
+		Snapshot(const std::string &directory);
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		const std::string &directory() const;
+
+		/**
+		 * @brief Computes the fingerprint of a set of tables.
+		 * @param db The database connection
+		 * @param tables A NULL terminated list of table names
+		 * @param settled Optional output which is set to whether the
+		 *                newest modification of the tables is at least
+		 *                one second older than the current database time.
+		 *                Only then the fingerprint is guaranteed to change
+		 *                with the next modification.
+		 * @return The fingerprint or an empty string in case of errors
+		 */
+		static std::string Fingerprint(IO::DatabaseInterface *db,
+		                               const char * const *tables,
+		                               bool *settled = NULL);
+
+		//! Returns the NULL terminated list of inventory tables
+		static const char * const *InventoryTables();
+
+		//! Returns the NULL terminated list of configuration tables
+		static const char * const *ConfigTables();
+
+		/**
+		 * @brief Reads a snapshot
+		 * @param name The snapshot name, e.g. "inventory"
+		 * @param fingerprint The expected fingerprint
+		 * @return The object or NULL if the snapshot does not exist, is
+		 *         corrupt or stale.
+		 */
+		Core::BaseObjectPtr read(const std::string &name,
+		                         const std::string &fingerprint) const;
+
+		/**
+		 * @brief Writes a snapshot. The file is written to a temporary
+		 *        file first and renamed afterwards so concurrently
+		 *        starting modules never read partial snapshots.
+		 */
+		bool write(const std::string &name, const std::string &fingerprint,
+		           Core::BaseObject *obj) const;
+
+	// ----------------------------------------------------------------------
+	//  Private members
+	// ----------------------------------------------------------------------
+	private:
+		std::string filename(const std::string &name) const;
+
+	private:
+		std::string _directory;
+};
+
+
+}
+}
+
+
+#endif
@@ -34,8 +34,11 @@ Protocol::MSG_CONTENT_TYPES encodingLUT[MessageEncoding::Quantity] =
 
 
 NetworkMessage* encode(Core::Message *msg, const MessageEncoding &enc,
-                       int schemaVersion)
+                       int schemaVersion, bool local)
 {
+	if ( local )
+		return NetworkMessage::Encode(msg, Protocol::CONTENT_OBJECT);
+
 	return NetworkMessage::Encode(msg, encodingLUT[enc], schemaVersion);
 }
 
@@ -138,7 +141,8 @@ bool Connection::send(Seiscomp::Core::Message* msg, int *error) {
 		return false;
 	}
 
-	NetworkMessage *clientMsg = encode(msg, _encoding, _schemaVersion.packed);
+	NetworkMessage *clientMsg = encode(msg, _encoding, _schemaVersion.packed,
+	                                   _networkInterface->isLocal());
 	if ( clientMsg == NULL ) return false;
 
 	_transmittedBytes += msg->dataSize();
@@ -176,7 +180,8 @@ bool Connection::send(const std::string& groupname,
 		return false;
 	}
 
-	NetworkMessage* clientMsg = encode(msg, _encoding, _schemaVersion.packed);
+	NetworkMessage* clientMsg = encode(msg, _encoding, _schemaVersion.packed,
+	                                   _networkInterface->isLocal());
 	if ( clientMsg == NULL ) return false;
 
 	_transmittedBytes += msg->dataSize();
@@ -0,0 +1,356 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+// logging
+#define SEISCOMP_COMPONENT Communication
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/core/strings.h>
+#include <seiscomp3/core/status.h>
+#include <seiscomp3/datamodel/version.h>
+#include <seiscomp3/communication/protocol.h>
+#include <seiscomp3/communication/servicemessage.h>
+
+#include "localdriver.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace Communication {
+
+
+REGISTER_NETWORK_INTERFACE(LocalDriver, "local");
+
+
+namespace {
+
+
+const std::string GROUPS = "AMPLITUDE,PICK,LOCATION,MAGNITUDE,FOCMECH,EVENT,QC,PUBLICATION,GUI,INVENTORY,ROUTING,CONFIG,LOGGING,SERVICE_REQUEST,SERVICE_PROVIDE";
+const std::string MASTER = "#master";
+
+typedef std::vector<LocalDriver*> Clients;
+typedef std::map<std::string, Clients> Buses;
+
+boost::mutex busMutex;
+Buses buses;
+
+
+}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+LocalDriver::LocalDriver() : _isConnected(false) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+LocalDriver::~LocalDriver() {
+	disconnect();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int LocalDriver::connect(const std::string& serverAddress,
+                         const std::string& clientName) {
+	if ( isConnected() ) disconnect();
+
+	boost::mutex::scoped_lock busLock(busMutex);
+
+	std::string privateGroup = "#" + clientName;
+	Clients &clients = buses[serverAddress];
+
+	for ( Clients::iterator it = clients.begin(); it != clients.end(); ++it ) {
+		if ( (*it)->_privateGroup == privateGroup ) {
+			SEISCOMP_ERROR("client name %s is already used on local bus %s",
+			               clientName.c_str(), serverAddress.c_str());
+			return Core::Status::SEISCOMP_CLIENT_NAME_NOT_UNIQUE;
+		}
+	}
+
+	{
+		boost::mutex::scoped_lock lk(_mutex);
+		_bus = serverAddress;
+		_privateGroup = privateGroup;
+		_groups.clear();
+		_isConnected = true;
+	}
+
+	clients.push_back(this);
+
+	return Core::Status::SEISCOMP_SUCCESS;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int LocalDriver::disconnect() {
+	boost::mutex::scoped_lock busLock(busMutex);
+
+	Buses::iterator bit = buses.find(_bus);
+	if ( bit != buses.end() ) {
+		Clients::iterator it = std::find(bit->second.begin(), bit->second.end(), this);
+		if ( it != bit->second.end() ) bit->second.erase(it);
+		if ( bit->second.empty() ) buses.erase(bit);
+	}
+
+	boost::mutex::scoped_lock lk(_mutex);
+
+	while ( !_queue.empty() ) {
+		delete _queue.front();
+		_queue.pop_front();
+	}
+
+	_isConnected = false;
+
+	// Wake up a blocking receive
+	_messageAvailable.notify_all();
+
+	return Core::Status::SEISCOMP_SUCCESS;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+NetworkMessage* LocalDriver::receive(int* error) {
+	boost::mutex::scoped_lock lk(_mutex);
+
+	while ( _isConnected && _queue.empty() )
+		_messageAvailable.wait(lk);
+
+	if ( !_isConnected ) {
+		if ( error )
+			*error = Core::Status::SEISCOMP_NOT_CONNECTED_ERROR;
+
+		return NULL;
+	}
+
+	NetworkMessage *msg = _queue.front();
+	_queue.pop_front();
+
+	if ( error )
+		*error = Core::Status::SEISCOMP_SUCCESS;
+
+	return msg;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int LocalDriver::send(const std::string& group, int type, NetworkMessage* msg,
+                      bool selfDiscard) {
+	// Receiving and disconnecting can happen in another thread
+	if ( !isConnected() ) {
+		SEISCOMP_ERROR("not connected");
+		return Core::Status::SEISCOMP_NOT_CONNECTED_ERROR;
+	}
+
+	// There is no master, answer the connect request directly
+	if ( type == Protocol::CONNECT_GROUP_MSG ) {
+		ServiceMessage* sm = static_cast<ServiceMessage*>(msg);
+		ServiceMessage* ack = new ServiceMessage(Protocol::CONNECT_GROUP_OK_MSG);
+		ack->setDestination(sm->privateSenderGroup());
+		ack->setProtocolVersion(sm->protocolVersion());
+
+		if ( sm->protocolVersion() == Protocol::PROTOCOL_VERSION_V1_0 )
+			ack->setData(GROUPS);
+		else
+			ack->setData(std::string(Protocol::HEADER_SERVER_VERSION_TAG) + ": " +
+					Core::CurrentVersion.toString() + "\n" +
+					Protocol::HEADER_GROUP_TAG + ": " +
+					GROUPS + "\n" +
+					Protocol::HEADER_SCHEMA_VERSION_TAG + ": " +
+					Core::toString(DataModel::Version::Major) + "." +
+					Core::toString(DataModel::Version::Minor));
+
+		deliver(ack);
+
+		return Core::Status::SEISCOMP_SUCCESS;
+	}
+	else if ( type == Protocol::CLIENT_DISCONNECTED_MSG ) {
+		disconnect();
+		return Core::Status::SEISCOMP_SUCCESS;
+	}
+	else if ( type <= 0 ) {
+		SEISCOMP_DEBUG("discarding %s", Protocol::MsgTypeToString(type));
+		return Core::Status::SEISCOMP_SUCCESS;
+	}
+
+	// Answer sync requests like the master does. All messages sent before
+	// have already been queued for their receivers.
+	if ( msg->contentType() != Protocol::CONTENT_OBJECT ) {
+		Core::MessagePtr decoded = msg->decode();
+		SyncRequestMessage *syncRequest = SyncRequestMessage::Cast(decoded);
+		if ( syncRequest ) {
+			SyncResponseMessage syncResponse(syncRequest->ID());
+			NetworkMessage *response = NetworkMessage::Encode(&syncResponse, Protocol::CONTENT_BINARY);
+			if ( response == NULL ) return Core::Status::SEISCOMP_FAILURE;
+			response->setDestination(msg->privateSenderGroup());
+			deliver(response);
+			return Core::Status::SEISCOMP_SUCCESS;
+		}
+	}
+
+	boost::mutex::scoped_lock busLock(busMutex);
+
+	Buses::iterator bit = buses.find(_bus);
+	if ( bit == buses.end() ) return Core::Status::SEISCOMP_SUCCESS;
+
+	// The message is copied for each receiver in the senders thread, so
+	// that no object is shared between the threads of the clients
+	const std::string &destination = msg->destination();
+	for ( Clients::iterator it = bit->second.begin(); it != bit->second.end(); ++it ) {
+		if ( selfDiscard && *it == this ) continue;
+		if ( !(*it)->accepts(destination) ) continue;
+		(*it)->deliver(msg->copy());
+	}
+
+	return Core::Status::SEISCOMP_SUCCESS;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int LocalDriver::subscribe(const std::string& group) {
+	boost::mutex::scoped_lock lk(_mutex);
+
+	if ( !_isConnected ) {
+		SEISCOMP_ERROR("not connected");
+		return Core::Status::SEISCOMP_NOT_CONNECTED_ERROR;
+	}
+
+	_groups.insert(group);
+
+	return Core::Status::SEISCOMP_SUCCESS;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int LocalDriver::unsubscribe(const std::string& group) {
+	boost::mutex::scoped_lock lk(_mutex);
+
+	if ( !_isConnected ) {
+		SEISCOMP_ERROR("not connected");
+		return Core::Status::SEISCOMP_NOT_CONNECTED_ERROR;
+	}
+
+	_groups.erase(group);
+
+	return Core::Status::SEISCOMP_SUCCESS;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool LocalDriver::poll(int* error) {
+	boost::mutex::scoped_lock lk(_mutex);
+
+	if ( !_isConnected ) {
+		if ( error )
+			*error = Core::Status::SEISCOMP_NOT_CONNECTED_ERROR;
+
+		return false;
+	}
+
+	if ( error )
+		*error = Core::Status::SEISCOMP_SUCCESS;
+
+	return !_queue.empty();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool LocalDriver::isConnected() {
+	boost::mutex::scoped_lock lk(_mutex);
+	return _isConnected;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool LocalDriver::isLocal() const {
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string LocalDriver::privateGroup() const {
+	return _privateGroup;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string LocalDriver::groupOfLastSender() const {
+	return MASTER;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void LocalDriver::deliver(NetworkMessage *msg) {
+	boost::mutex::scoped_lock lk(_mutex);
+
+	if ( !_isConnected ) {
+		delete msg;
+		return;
+	}
+
+	_queue.push_back(msg);
+	_messageAvailable.notify_one();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool LocalDriver::accepts(const std::string &destination) const {
+	boost::mutex::scoped_lock lk(_mutex);
+	return destination == _privateGroup || _groups.find(destination) != _groups.end();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+} // namespace Communication
+} // namespace Seiscomp
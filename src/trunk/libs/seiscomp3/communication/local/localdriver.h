@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_COMMUNICATION_LOCALDRIVER_H__
+#define __SEISCOMP_COMMUNICATION_LOCALDRIVER_H__
+
+#include <seiscomp3/communication/networkinterface.h>
+#include <seiscomp3/communication/systemmessages.h>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <deque>
+#include <set>
+
+
+namespace Seiscomp {
+namespace Communication {
+
+
+/**
+ * In-process message bus. All clients connected to the same address,
+ * e.g. local://playback, exchange messages through in-memory queues
+ * without a master. This allows to run several applications as threads
+ * of one process, e.g. for playbacks. Notifier messages are not encoded
+ * but each receiver gets its own copy of the objects.
+ */
+class SC_SYSTEM_CLIENT_API LocalDriver : public NetworkInterface {
+	public:
+		LocalDriver();
+		virtual ~LocalDriver();
+
+	public:
+		virtual int connect(const std::string& serverAddress,
+		                    const std::string& clientName);
+		virtual int disconnect();
+
+		virtual NetworkMessage* receive(int* error = NULL);
+		virtual int send(const std::string& group, int type, NetworkMessage* msg,
+		                 bool selfDiscard = true);
+
+		virtual int subscribe(const std::string& group);
+		virtual int unsubscribe(const std::string& group);
+
+		virtual bool poll(int* error = NULL);
+
+		virtual bool isConnected();
+
+		virtual bool isLocal() const;
+
+	public:
+		virtual std::string privateGroup() const;
+
+		virtual std::string groupOfLastSender() const;
+
+	private:
+		//! Appends a message to the queue, the ownership goes to the queue
+		void deliver(NetworkMessage *msg);
+
+		//! Returns whether a message for the destination group is accepted
+		bool accepts(const std::string &destination) const;
+
+	private:
+		typedef std::deque<NetworkMessage*> MessageQueue;
+
+		std::string             _bus;
+		std::string             _privateGroup;
+		std::set<std::string>   _groups;
+		MessageQueue            _queue;
+		bool                    _isConnected;
+		mutable boost::mutex    _mutex;
+		boost::condition        _messageAvailable;
+};
+
+
+} // namespace Communication
+} // namespace Seiscomp
+
+#endif
@@ -126,6 +126,12 @@ class SC_SYSTEM_CLIENT_API NetworkInterface : public Core::BaseObject {
 		 * @return connection state
 		 */
 		virtual bool isConnected() = 0;
+
+		/** Returns true if messages are delivered within the same process.
+		 * Notifier messages are then passed as objects and not encoded.
+		 * @return true for an in-process interface
+		 */
+		virtual bool isLocal() const { return false; }
 		
 		/** Returns a client interface for the given service
 		 *  @return A pointer to the client interface
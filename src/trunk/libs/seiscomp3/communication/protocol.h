@@ -103,7 +103,9 @@ class SC_SYSTEM_CLIENT_API Protocol {
 			// JSON
 			CONTENT_JSON              = 6,
 			CONTENT_UNCOMPRESSED_JSON = 7,
-			MCT_QUANTITY              = 8
+			// Message object passed within a process, never serialized
+			CONTENT_OBJECT            = 8,
+			MCT_QUANTITY              = 9
 		};
 
 
@@ -24,6 +24,8 @@
 #include <seiscomp3/io/archive/binarchive.h>
 #include <seiscomp3/io/archive/xmlarchive.h>
 #include <seiscomp3/io/archive/bsonarchive.h>
+#include <seiscomp3/datamodel/notifier.h>
+#include <seiscomp3/datamodel/utils.h>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/categories.hpp>
 #include <boost/iostreams/device/array.hpp>
@@ -78,6 +80,56 @@ private:
 	std::streamsize* _pos;
 };
 
+
+// Deep copy of all notifier objects which is not shared with the source
+// message and can therefore be handed over to another thread
+DataModel::NotifierMessage *copyNotifiers(const DataModel::NotifierMessage *msg)
+{
+	DataModel::NotifierMessage *copy = new DataModel::NotifierMessage;
+
+	// Building the copies must not create notifiers in the callers pool
+	bool notifierEnabled = DataModel::Notifier::IsEnabled();
+	DataModel::Notifier::Disable();
+
+	for ( DataModel::NotifierMessage::const_iterator it = msg->begin();
+	      it != msg->end(); ++it ) {
+		DataModel::Object *object = (*it)->object();
+		copy->attach(new DataModel::Notifier((*it)->parentID(), (*it)->operation(),
+		                                     object ? DataModel::copy(object) : NULL));
+	}
+
+	DataModel::Notifier::SetEnabled(notifierEnabled);
+
+	return copy;
+}
+
+
+// Registers public objects in the registry of the calling thread as
+// deserialization does
+class Registrar : public DataModel::Visitor {
+	public:
+		bool visit(DataModel::PublicObject *po) {
+			po->setPublicID(po->publicID());
+			return true;
+		}
+
+		void visit(DataModel::Object *) {}
+};
+
+
+DataModel::NotifierMessage *registerNotifiers(DataModel::NotifierMessage *msg)
+{
+	Registrar registrar;
+
+	for ( DataModel::NotifierMessage::iterator it = msg->begin();
+	      it != msg->end(); ++it ) {
+		DataModel::Object *object = (*it)->object();
+		if ( object ) object->accept(&registrar);
+	}
+
+	return msg;
+}
+
 }
 
 
@@ -97,7 +149,8 @@ NetworkMessage::NetworkMessage()
 		_timeStamp(0),
 		_data(""),
 		_privateSenderGroup(""),
-		_tagged(false)
+		_tagged(false),
+		_object(NULL)
 {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -106,6 +159,7 @@ NetworkMessage::NetworkMessage()
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 NetworkMessage::NetworkMessage(const NetworkMessage& msg)
+		: _object(NULL)
 {
 	*this = msg;
 }
@@ -116,7 +170,42 @@ NetworkMessage::NetworkMessage(const NetworkMessage& msg)
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 NetworkMessage::~NetworkMessage()
-{}
+{
+	if ( _object != NULL )
+		delete _object;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+NetworkMessage& NetworkMessage::operator=(const NetworkMessage& msg)
+{
+	if ( this == &msg ) return *this;
+
+	_type = msg._type;
+	_destination = msg._destination;
+	_seqNum = msg._seqNum;
+	_size = msg._size;
+	_timeStamp = msg._timeStamp;
+	_data = msg._data;
+	_privateSenderGroup = msg._privateSenderGroup;
+	_tagged = msg._tagged;
+
+	if ( _object != NULL ) {
+		delete _object;
+		_object = NULL;
+	}
+
+	// The object is never shared to allow passing the copy to another thread
+	_sharedObject = NULL;
+	const Core::Message *object = msg._sharedObject ? msg._sharedObject.get() : msg._object;
+	if ( object != NULL )
+		_object = copyNotifiers(static_cast<const DataModel::NotifierMessage*>(object));
+
+	return *this;
+}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -130,7 +219,8 @@ NetworkMessage::NetworkMessage(int msgType) :
 		_timeStamp(0),
 		_data(""),
 		_privateSenderGroup(""),
-		_tagged(false)
+		_tagged(false),
+		_object(NULL)
 {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -429,6 +519,18 @@ NetworkMessage* NetworkMessage::Encode(Seiscomp::Core::Message* msg,
                                        Protocol::MSG_CONTENT_TYPES type,
                                        int schemaVersion)
 {
+	if ( type == Protocol::CONTENT_OBJECT ) {
+		DataModel::NotifierMessage *notifiers = DataModel::NotifierMessage::Cast(msg);
+		if ( notifiers == NULL )
+			return Encode(msg, Protocol::CONTENT_BINARY, schemaVersion);
+
+		NetworkMessage *nm = new NetworkMessage(Protocol::DATA_MSG);
+		nm->setContentType(type);
+		nm->_sharedObject = notifiers;
+		msg->setDataSize(0);
+		return nm;
+	}
+
 	NetworkMessage *nm = new NetworkMessage(Protocol::DATA_MSG);
 	std::string &data = nm->data();
 
@@ -557,6 +659,17 @@ Seiscomp::Core::Message* NetworkMessage::decode() const
 	Seiscomp::Core::Message* msg = NULL;
 	Protocol::MSG_CONTENT_TYPES cType = contentType();
 
+	// The copies are registered by the receiver since the sender
+	// might use another registry
+	if ( cType == Protocol::CONTENT_OBJECT ) {
+		if ( _object == NULL && _sharedObject )
+			return registerNotifiers(copyNotifiers(static_cast<const DataModel::NotifierMessage*>(_sharedObject.get())));
+
+		msg = _object;
+		_object = NULL;
+		return msg ? registerNotifiers(static_cast<DataModel::NotifierMessage*>(msg)) : NULL;
+	}
+
 	try {
 
 		boost::iostreams::filtering_istreambuf filtered_buf;
@@ -48,6 +48,14 @@ protected:
 	NetworkMessage(int msgType);
 
 
+	// ------------------------------------------------------------------------
+	// Operators
+	// ------------------------------------------------------------------------
+public:
+	//! Copies the message including its own copy of a carried object
+	NetworkMessage& operator=(const NetworkMessage&);
+
+
 	// ------------------------------------------------------------------------
 	// Getter / Setter
 	// ------------------------------------------------------------------------
@@ -134,9 +142,19 @@ public:
 	 */
 	virtual NetworkMessage* copy() const;
 
+	/** Encodes a message with the given content type. CONTENT_OBJECT
+	 *  does not serialize notifier messages but references them and
+	 *  copy() creates a deep copy of their objects. All other messages
+	 *  fall back to CONTENT_BINARY.
+	 */
 	static NetworkMessage* Encode(Seiscomp::Core::Message*,
 	                              Protocol::MSG_CONTENT_TYPES type,
 	                              int schemaVersion = -1);
+
+	/** Decodes the carried message. The ownership goes to the caller.
+	 *  A copy of a CONTENT_OBJECT message hands over its object and can
+	 *  only be decoded once.
+	 */
 	Seiscomp::Core::Message* decode() const;
 
 
@@ -154,6 +172,11 @@ private:
 	//! Determines if a sequence number and a timestamp has been assigned the a
 	//! articula message instance.
 	int          _tagged;
+	//! The message of the sender referenced by CONTENT_OBJECT. It must not
+	//! leave the senders thread, copies carry their own object instead.
+	Seiscomp::Core::MessagePtr       _sharedObject;
+	//! The private message carried by CONTENT_OBJECT, owned until decoded
+	mutable Seiscomp::Core::Message *_object;
 };
 
 
@@ -13,10 +13,20 @@
 
 #include <algorithm>
 #include <seiscomp3/core/arrayfactory.h>
+#include <seiscomp3/core/arraypool.h>
 #include <seiscomp3/core/typedarray.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SC_ARRAYFACTORY_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace Seiscomp;
 
+
+namespace {
+
+
 template<typename TGT, typename SRC>
 struct convert {
 	TGT operator()(SRC value) {
@@ -84,200 +94,184 @@ struct convert< std::complex<double>, std::complex<float> > {
 };
 
 
+// Generic element wise conversion
+template <typename TGT, typename SRC>
+void convertSamples(TGT *out, const SRC *in, int size) {
+	convert<TGT,SRC> conv;
+	for ( int i = 0; i < size; ++i )
+		out[i] = conv(in[i]);
+}
+
+
+// Same type: plain copy
+template <typename T>
+void convertSamples(T *out, const T *in, int size) {
+	std::copy(in, in+size, out);
+}
+
+
+// Vectorized kernels for the conversions that happen for each decoded
+// record: integer samples to floating point and vice versa.
+void convertSamples(float *out, const int *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	for ( ; i+4 <= size; i += 4 )
+		_mm_storeu_ps(out+i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i))));
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<float>(in[i]);
+}
+
+
+void convertSamples(double *out, const int *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	for ( ; i+2 <= size; i += 2 )
+		_mm_storeu_pd(out+i, _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in+i))));
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<double>(in[i]);
+}
+
+
+void convertSamples(double *out, const float *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	for ( ; i+4 <= size; i += 4 ) {
+		__m128 v = _mm_loadu_ps(in+i);
+		_mm_storeu_pd(out+i, _mm_cvtps_pd(v));
+		_mm_storeu_pd(out+i+2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+	}
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<double>(in[i]);
+}
+
+
+void convertSamples(float *out, const double *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	for ( ; i+4 <= size; i += 4 ) {
+		__m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in+i));
+		__m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in+i+2));
+		_mm_storeu_ps(out+i, _mm_movelh_ps(lo, hi));
+	}
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<float>(in[i]);
+}
+
+
+void convertSamples(int *out, const float *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	// Truncating conversion as static_cast does
+	for ( ; i+4 <= size; i += 4 )
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i), _mm_cvttps_epi32(_mm_loadu_ps(in+i)));
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<int>(in[i]);
+}
+
+
+void convertSamples(int *out, const double *in, int size) {
+	int i = 0;
+#ifdef SC_ARRAYFACTORY_SSE2
+	for ( ; i+2 <= size; i += 2 )
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out+i), _mm_cvttpd_epi32(_mm_loadu_pd(in+i)));
+#endif
+	for ( ; i < size; ++i )
+		out[i] = static_cast<int>(in[i]);
+}
+
+
+// Sizes the target container. Numeric containers take their storage from
+// the per-thread array pool, all others allocate exactly once.
+template <typename T>
+void prepareStorage(std::vector<T> &c, int size) {
+	c.reserve(size);
+	c.resize(size);
+}
+
+void prepareStorage(std::vector<char> &c, int size) {
+	ArrayPool<char>::Acquire(c, size);
+}
+
+void prepareStorage(std::vector<int> &c, int size) {
+	ArrayPool<int>::Acquire(c, size);
+}
+
+void prepareStorage(std::vector<float> &c, int size) {
+	ArrayPool<float>::Acquire(c, size);
+}
+
+void prepareStorage(std::vector<double> &c, int size) {
+	ArrayPool<double>::Acquire(c, size);
+}
+
+
 template <typename CONTAINER, typename T>
 void convertArray(CONTAINER &c, int size, const T *data) {
-	std::transform(data,data+size,std::back_inserter(c),convert<typename CONTAINER::value_type,T>());
+	if ( size <= 0 ) return;
+	prepareStorage(c, size);
+	convertSamples(&c[0], data, size);
 }
 
-Array* ArrayFactory::Create(Array::DataType toCreate, Array::DataType caller, int size, const void *data) {
-	Array *ar = NULL;
 
-	switch(toCreate) {
-	case Array::CHAR: 
-		switch (caller) {
-		case Array::CHAR:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const char *>(data));
-			break;
-		case Array::INT:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const int *>(data));
-			break;
-		case Array::FLOAT:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const float *>(data));
-			break;
-		case Array::DOUBLE:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const double *>(data));
-			break;
-		case Array::COMPLEX_FLOAT:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
-			break;
-		case Array::COMPLEX_DOUBLE:
-			ar = new CharArray();
-			convertArray(dynamic_cast<CharArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
-			break;
-		default:
-			break;
-		}
-		break;
-	case Array::INT:
-		switch (caller) {
-		case Array::CHAR:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const char *>(data));
-			break;
-		case Array::INT:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const int *>(data));
-			break;
-		case Array::FLOAT:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const float *>(data));
-			break;
-		case Array::DOUBLE:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const double *>(data));
-			break;
-		case Array::COMPLEX_FLOAT:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
-			break;
-		case Array::COMPLEX_DOUBLE:
-			ar = new IntArray();
-			convertArray(dynamic_cast<IntArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
-			break;
-		default:
-			break;
-		}
-		break;
-	case Array::FLOAT:
-		switch (caller) {
-		case Array::CHAR:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const char *>(data));
-			break;
-		case Array::INT:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const int *>(data));
-			break;
-		case Array::FLOAT:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const float *>(data));
-			break;
-		case Array::DOUBLE:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const double *>(data));
-			break;
-		case Array::COMPLEX_FLOAT:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
-			break;
-		case Array::COMPLEX_DOUBLE:
-			ar = new FloatArray();
-			convertArray(dynamic_cast<FloatArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
-			break;
-		default:
-			break;
-		}
-		break;
-	case Array::DOUBLE:
-		switch (caller) {
-		case Array::CHAR:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const char *>(data));
-			break;
-		case Array::INT:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const int *>(data));
-			break;
-		case Array::FLOAT:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const float *>(data));
-			break;
-		case Array::DOUBLE:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const double *>(data));
-			break;
-		case Array::COMPLEX_FLOAT:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
-			break;
-		case Array::COMPLEX_DOUBLE:
-			ar = new DoubleArray();
-			convertArray(dynamic_cast<DoubleArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
-			break;
-		default:
-			break;
-		}
-		break;
-	case Array::COMPLEX_FLOAT:
-		switch (caller) {
+template <typename ARRAY>
+Array *createArray(Array::DataType caller, int size, const void *data) {
+	ARRAY *ar = new ARRAY();
+
+	switch ( caller ) {
 		case Array::CHAR:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const char *>(data));
+			convertArray(ar->impl(),size,static_cast<const char *>(data));
 			break;
 		case Array::INT:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const int *>(data));
+			convertArray(ar->impl(),size,static_cast<const int *>(data));
 			break;
 		case Array::FLOAT:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const float *>(data));
+			convertArray(ar->impl(),size,static_cast<const float *>(data));
 			break;
 		case Array::DOUBLE:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const double *>(data));
+			convertArray(ar->impl(),size,static_cast<const double *>(data));
 			break;
 		case Array::COMPLEX_FLOAT:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
+			convertArray(ar->impl(),size,static_cast<const std::complex<float> *>(data));
 			break;
 		case Array::COMPLEX_DOUBLE:
-			ar = new ComplexFloatArray();
-			convertArray(dynamic_cast<ComplexFloatArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
+			convertArray(ar->impl(),size,static_cast<const std::complex<double> *>(data));
 			break;
 		default:
-			break;
-		}
-		break;
-	case Array::COMPLEX_DOUBLE:
-		switch (caller) {
+			delete ar;
+			return NULL;
+	}
+
+	return ar;
+}
+
+
+}
+
+
+Array* ArrayFactory::Create(Array::DataType toCreate, Array::DataType caller, int size, const void *data) {
+	switch ( toCreate ) {
 		case Array::CHAR:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const char *>(data));
-			break;
+			return createArray<CharArray>(caller, size, data);
 		case Array::INT:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const int *>(data));
-			break;
+			return createArray<IntArray>(caller, size, data);
 		case Array::FLOAT:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const float *>(data));
-			break;
+			return createArray<FloatArray>(caller, size, data);
 		case Array::DOUBLE:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const double *>(data));
-			break;
+			return createArray<DoubleArray>(caller, size, data);
 		case Array::COMPLEX_FLOAT:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const std::complex<float> *>(data));
-			break;
+			return createArray<ComplexFloatArray>(caller, size, data);
 		case Array::COMPLEX_DOUBLE:
-			ar = new ComplexDoubleArray();
-			convertArray(dynamic_cast<ComplexDoubleArray *>(ar)->_data,size,static_cast<const std::complex<double> *>(data));
-			break;
+			return createArray<ComplexDoubleArray>(caller, size, data);
 		default:
 			break;
-		}
-		break;
-	default:
-		ar = 0;
 	}
 
-	return ar;
+	return NULL;
 }
 
 Array* ArrayFactory::Create(Array::DataType toCreate, const Array *source) {
@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/core/arraypool.h>
+#include <boost/thread/tss.hpp>
+
+
+namespace Seiscomp {
+
+
+namespace {
+
+
+// The settings are shared by all threads and read without a lock. Each
+// call reads them once, so a concurrent change never mixes old and new
+// limits within one call.
+volatile bool poolEnabled = true;
+volatile size_t poolMaxBuffers = 32;
+volatile size_t poolMaxCapacity = 1 << 16;
+
+
+template <typename T>
+struct ThreadPool {
+	std::vector< std::vector<T> > buffers;
+
+	// Removes the buffer at index i while keeping the release order.
+	// Buffers are swapped rather than copied as vector::erase would do.
+	void remove(size_t i) {
+		for ( ; i+1 < buffers.size(); ++i )
+			buffers[i].swap(buffers[i+1]);
+		buffers.pop_back();
+	}
+};
+
+
+// The thread specific pointer is never deleted on purpose. Arrays may still
+// be released during static destruction and must not access a destroyed
+// pool registry. The pools itself are freed when a thread exits.
+template <typename T>
+ThreadPool<T> *localPool(bool create) {
+	static boost::thread_specific_ptr< ThreadPool<T> > *pools =
+		new boost::thread_specific_ptr< ThreadPool<T> >;
+
+	ThreadPool<T> *pool = pools->get();
+	if ( pool == NULL && create ) {
+		pool = new ThreadPool<T>;
+		pools->reset(pool);
+	}
+
+	return pool;
+}
+
+
+}
+
+
+template <typename T>
+void ArrayPool<T>::Acquire(Buffer &buffer, size_t size) {
+	if ( poolEnabled && buffer.capacity() < size ) {
+		ThreadPool<T> *pool = localPool<T>(false);
+		if ( pool != NULL && !pool->buffers.empty() ) {
+			// Search the most recently released buffer that fits. Buffers
+			// more than twice as large are left for larger requests so
+			// that a single large buffer is not pinned by small arrays.
+			size_t i = pool->buffers.size();
+			while ( i > 0 ) {
+				--i;
+				size_t capacity = pool->buffers[i].capacity();
+				if ( capacity >= size && capacity / 2 <= size ) {
+					buffer.swap(pool->buffers[i]);
+					pool->remove(i);
+					break;
+				}
+			}
+		}
+	}
+
+	// Reserve first to avoid geometric over-allocation
+	buffer.reserve(size);
+	buffer.resize(size);
+}
+
+
+template <typename T>
+void ArrayPool<T>::Release(Buffer &buffer) {
+	size_t maxBuffers = poolMaxBuffers;
+	size_t maxCapacity = poolMaxCapacity;
+
+	if ( !poolEnabled || buffer.capacity() == 0 ||
+	     buffer.capacity() > maxCapacity ) return;
+
+	if ( maxBuffers == 0 ) return;
+
+	ThreadPool<T> *pool = localPool<T>(true);
+	// Drop the least recently released buffers so that the pool follows
+	// the sizes currently in use. The limit may have been lowered since
+	// the last call.
+	while ( pool->buffers.size() >= maxBuffers )
+		pool->remove(0);
+
+	// Reserve all slots up front. Growing the vector would copy the
+	// pooled buffers.
+	if ( pool->buffers.capacity() < maxBuffers )
+		pool->buffers.reserve(maxBuffers);
+
+	buffer.clear();
+	pool->buffers.push_back(Buffer());
+	pool->buffers.back().swap(buffer);
+}
+
+
+template <typename T>
+void ArrayPool<T>::Clear() {
+	ThreadPool<T> *pool = localPool<T>(false);
+	if ( pool != NULL ) pool->buffers.clear();
+}
+
+
+template <typename T>
+void ArrayPool<T>::SetEnabled(bool enable) {
+	poolEnabled = enable;
+}
+
+
+template <typename T>
+bool ArrayPool<T>::IsEnabled() {
+	return poolEnabled;
+}
+
+
+template <typename T>
+void ArrayPool<T>::SetLimits(size_t maxBuffers, size_t maxCapacity) {
+	poolMaxBuffers = maxBuffers;
+	poolMaxCapacity = maxCapacity;
+}
+
+
+template class SC_SYSTEM_CORE_API ArrayPool<char>;
+template class SC_SYSTEM_CORE_API ArrayPool<int>;
+template class SC_SYSTEM_CORE_API ArrayPool<float>;
+template class SC_SYSTEM_CORE_API ArrayPool<double>;
+
+
+}
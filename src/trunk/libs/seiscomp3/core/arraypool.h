@@ -0,0 +1,75 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SC_CORE_ARRAYPOOL_H__
+#define __SC_CORE_ARRAYPOOL_H__
+
+
+#include <seiscomp3/core.h>
+#include <vector>
+#include <cstddef>
+
+
+namespace Seiscomp {
+
+
+/**
+ * Per-thread pool of sample storage used by numeric arrays.
+ *
+ * When a numeric array is destroyed its vector buffer is handed back to
+ * the pool of the destroying thread. ArrayFactory takes buffers from
+ * that pool when creating arrays so that decoding records in a steady
+ * state does not touch the heap anymore. The pool is bounded in the number
+ * of buffers and in the capacity of each buffer it accepts. A buffer is
+ * only reused for arrays of at least half its capacity.
+ * Instantiations exist for char, int, float and double.
+ *
+ * The settings are global and not synchronized. They should be changed
+ * before any other thread creates arrays. Changes made later are picked
+ * up by other threads eventually but are not ordered with other memory
+ * accesses.
+ */
+template <typename T>
+class SC_SYSTEM_CORE_API ArrayPool {
+	public:
+		typedef std::vector<T> Buffer;
+
+	public:
+		//! Replaces the content of buffer with a pooled buffer (if
+		//! available) and resizes it to size elements. At most one
+		//! allocation is made.
+		static void Acquire(Buffer &buffer, size_t size);
+
+		//! Hands the storage of buffer over to the pool of the calling
+		//! thread. The buffer is empty afterwards.
+		static void Release(Buffer &buffer);
+
+		//! Releases all buffers held by the calling thread's pool.
+		static void Clear();
+
+		//! Enables or disables pooling. It is enabled by default. The
+		//! setting applies to all element types.
+		static void SetEnabled(bool enable);
+		static bool IsEnabled();
+
+		//! Sets the maximum number of buffers kept per thread and the
+		//! maximum capacity (in elements) of a buffer to be accepted. The
+		//! limits apply to all element types.
+		static void SetLimits(size_t maxBuffers, size_t maxCapacity);
+};
+
+
+}
+
+
+#endif
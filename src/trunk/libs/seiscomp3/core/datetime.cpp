@@ -13,6 +13,7 @@
 #include <seiscomp3/core/datetime.h>
 #include <seiscomp3/core/exceptions.h>
 
+#include <algorithm>
 #include <sstream>
 #include <cmath>
 #include <ctype.h>
@@ -169,6 +170,188 @@ inline void normalize(T &sec, U &usec) {
 	}
 }
 
+
+// The fixed formats written and read by the archives and the database
+// layer. They are converted without the C library.
+const char *ISOFormat = "%FT%T.%fZ";
+const char *ISOFormatNoFraction = "%FT%TZ";
+const char *DatabaseFormat = "%Y-%m-%d %H:%M:%S";
+const char *DatabaseFormatShort = "%F %T";
+
+const long SecondsPerDay = 86400;
+
+
+// Converts the number of days since 1970-01-01 into a date of the
+// proleptic Gregorian calendar, see
+// http://howardhinnant.github.io/date_algorithms.html
+inline void civilFromDays(long days, int &year, int &month, int &day) {
+	days += 719468;
+	long era = (days >= 0 ? days : days - 146096) / 146097;
+	long doe = days - era * 146097;
+	long yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+	long doy = doe - (365*yoe + yoe/4 - yoe/100);
+	long mp = (5*doy + 2) / 153;
+
+	day = (int)(doy - (153*mp + 2)/5 + 1);
+	month = (int)(mp < 10 ? mp + 3 : mp - 9);
+	year = (int)(yoe + era*400 + (month <= 2 ? 1 : 0));
+}
+
+
+// The inverse of civilFromDays. Days out of the range of the month are
+// carried over as timegm does.
+inline long daysFromCivil(int year, int month, int day) {
+	if ( month <= 2 ) --year;
+	long era = (year >= 0 ? year : year - 399) / 400;
+	long yoe = year - era*400;
+	long doy = (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+	long doe = yoe*365 + yoe/4 - yoe/100 + doy;
+	return era*146097 + doe - 719468;
+}
+
+
+inline char *writeDigits2(char *out, int value) {
+	out[0] = (char)('0' + value / 10);
+	out[1] = (char)('0' + value % 10);
+	return out + 2;
+}
+
+
+// Writes "YYYY-MM-DD?hh:mm:ss" and returns the end of the string or NULL if
+// the year has not four digits
+char *writeDateTime(char *out, long secs, char separator) {
+	long days = secs / SecondsPerDay;
+	long rem = secs % SecondsPerDay;
+	if ( rem < 0 ) {
+		rem += SecondsPerDay;
+		--days;
+	}
+
+	int year, month, day;
+	civilFromDays(days, year, month, day);
+	if ( year < 1000 || year > 9999 ) return NULL;
+
+	out = writeDigits2(out, year / 100);
+	out = writeDigits2(out, year % 100);
+	*out++ = '-';
+	out = writeDigits2(out, month);
+	*out++ = '-';
+	out = writeDigits2(out, day);
+	*out++ = separator;
+	out = writeDigits2(out, (int)(rem / 3600));
+	*out++ = ':';
+	out = writeDigits2(out, (int)(rem / 60 % 60));
+	*out++ = ':';
+	out = writeDigits2(out, (int)(rem % 60));
+
+	return out;
+}
+
+
+// Writes a time as toString(ISOFormat) and returns the length of the
+// string or 0 if the time is out of the supported range
+size_t formatISO(char *out, long secs, long usecs) {
+	if ( usecs < 0 || usecs >= MICROS ) return 0;
+
+	char *end = writeDateTime(out, secs, 'T');
+	if ( end == NULL ) return 0;
+
+	*end++ = '.';
+
+	if ( usecs > 0 ) {
+		// Six digits without trailing zeros
+		int digits = 6;
+		while ( usecs % 10 == 0 ) {
+			usecs /= 10;
+			--digits;
+		}
+
+		for ( int i = digits; i > 0; --i ) {
+			end[i-1] = (char)('0' + usecs % 10);
+			usecs /= 10;
+		}
+
+		end += digits;
+	}
+	else {
+		memcpy(end, "0000", 4);
+		end += 4;
+	}
+
+	*end++ = 'Z';
+	*end = '\0';
+
+	return end - out;
+}
+
+
+inline bool readDigits(const char *&in, int count, int &value) {
+	value = 0;
+	for ( int i = 0; i < count; ++i, ++in ) {
+		if ( *in < '0' || *in > '9' ) return false;
+		value = value*10 + (*in - '0');
+	}
+
+	return true;
+}
+
+
+// Reads "YYYY-MM-DD?hh:mm:ss" with the ranges strptime accepts and
+// returns the end of the parsed string or NULL
+const char *readDateTime(const char *in, char separator, long &secs) {
+	int year, month, day, hour, min, sec;
+
+	if ( !readDigits(in, 4, year) || *in++ != '-' ) return NULL;
+	if ( !readDigits(in, 2, month) || *in++ != '-' ) return NULL;
+	if ( !readDigits(in, 2, day) || *in++ != separator ) return NULL;
+	if ( !readDigits(in, 2, hour) || *in++ != ':' ) return NULL;
+	if ( !readDigits(in, 2, min) || *in++ != ':' ) return NULL;
+	if ( !readDigits(in, 2, sec) ) return NULL;
+
+	if ( month < 1 || month > 12 || day < 1 || day > 31 ||
+	     hour > 23 || min > 59 || sec > 61 )
+		return NULL;
+
+	secs = daysFromCivil(year, month, day)*SecondsPerDay + hour*3600 + min*60 + sec;
+
+	return in;
+}
+
+
+// Parses the complete string according to one of the fixed formats and
+// returns false if the string or the format is not supported
+bool parseFixed(const char *str, const char *fmt, long &secs, long &usecs) {
+	const char *in;
+
+	usecs = 0;
+
+	if ( !strcmp(fmt, ISOFormat) ) {
+		in = readDateTime(str, 'T', secs);
+		if ( in == NULL || *in++ != '.' ) return false;
+
+		// Up to six digits are used, further digits are ignored
+		int digits = 0;
+		for ( ; *in >= '0' && *in <= '9'; ++in, ++digits ) {
+			if ( digits < 6 ) usecs = usecs*10 + (*in - '0');
+		}
+
+		for ( ; digits < 6; ++digits )
+			usecs *= 10;
+
+		return in[0] == 'Z' && in[1] == '\0';
+	}
+	else if ( !strcmp(fmt, ISOFormatNoFraction) ) {
+		in = readDateTime(str, 'T', secs);
+		return in != NULL && in[0] == 'Z' && in[1] == '\0';
+	}
+	else if ( !strcmp(fmt, DatabaseFormat) || !strcmp(fmt, DatabaseFormatShort) ) {
+		in = readDateTime(str, ' ', secs);
+		return in != NULL && *in == '\0';
+	}
+
+	return false;
+}
+
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -849,6 +1032,16 @@ std::string Time::toString(const char* fmt) const {
 	char data[BUFFER_SIZE];
 	char predata[BUFFER_SIZE];
 
+	// Fast path for the fixed formats
+	if ( !strcmp(fmt, ISOFormat) ) {
+		size_t length = formatISO(data, _timeval.tv_sec, _timeval.tv_usec);
+		if ( length > 0 ) return std::string(data, length);
+	}
+	else if ( !strcmp(fmt, DatabaseFormat) || !strcmp(fmt, DatabaseFormatShort) ) {
+		char *end = writeDateTime(data, _timeval.tv_sec, ' ');
+		if ( end != NULL ) return std::string(data, end - data);
+	}
+
 	time_t secs = (time_t)_timeval.tv_sec, usecs = _timeval.tv_usec;
 
 	tm t;
@@ -933,7 +1126,36 @@ std::string Time::toString(const char* fmt) const {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 std::string Time::iso() const {
-	return toString("%FT%T.%fZ");
+	char data[64];
+	size_t length = toISO(data);
+	return std::string(data, length);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t Time::toISO(char *buffer) const {
+	size_t length = formatISO(buffer, _timeval.tv_sec, _timeval.tv_usec);
+	if ( length > 0 ) return length;
+
+	// Years without four digits are left to strftime
+	std::string str = toString(ISOFormat);
+	length = std::min(str.size(), (size_t)63);
+	memcpy(buffer, str.c_str(), length);
+	buffer[length] = '\0';
+
+	return length;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Time::fromISO(const char *str) {
+	return fromString(str, ISOFormat) || fromString(str, ISOFormatNoFraction);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -947,6 +1169,17 @@ bool Time::fromString(const char* str, const char* fmt) {
 	char tmpFmt[BUFFER_SIZE];
 	long usec = 0;
 
+	// Fast path for well formed strings of the fixed formats, anything
+	// else is left to strptime
+	long secs;
+	if ( parseFixed(str, fmt, secs, usec) ) {
+		_timeval.tv_sec = secs;
+		_timeval.tv_usec = usec;
+		return true;
+	}
+
+	usec = 0;
+
 	const char* microSeconds = strstr(fmt, "%f");
 	if ( microSeconds != NULL ) {
 		const char* start = str;
@@ -225,7 +225,24 @@ class SC_SYSTEM_CORE_API Time : public TimeSpan {
 		 */
 		std::string iso() const;
 
+		/**
+		 * Writes the time as iso() does into a buffer without allocating
+		 * memory.
+		 * @param buffer The buffer which must hold at least 64 characters
+		 * @return The length of the string without the terminating null
+		 */
+		size_t toISO(char *buffer) const;
+
+		/**
+		 * Converts a string written by iso() or a string with the format
+		 * "%FT%TZ" into a time.
+		 * @return The conversion result
+		 */
+		bool fromISO(const char *str);
+
 		/** Converts a string into a time representation.
+		    The formats "%FT%T.%fZ", "%FT%TZ", "%F %T" and
+		    "%Y-%m-%d %H:%M:%S" are converted without the C library.
 		    @param str The string representation of the time
 		    @param fmt The format string containing the conversion
 		               specification (-> toString)
@@ -81,6 +81,16 @@ class GenericMessage : public ::Seiscomp::Core::Message {
 		 */
 		iterator detach(iterator it);
 
+		/**
+		 * Moves the objects of the range [first,last) of a list to the end
+		 * of the attachment list without copying them. The objects are not
+		 * checked for double insertion.
+		 * @param list The list the objects are taken from
+		 * @param first The first object to move
+		 * @param last The end of the range
+		 */
+		void splice(AttachementList &list, iterator first, iterator last);
+
 		//! Removes all attachments from the message
 		void clear();
 
@@ -138,6 +138,16 @@ inline typename GenericMessage<T>::iterator GenericMessage<T>::detach(iterator i
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+template <typename T>
+inline void GenericMessage<T>::splice(AttachementList &list, iterator first, iterator last) {
+	_attachments.splice(_attachments.end(), list, first, last);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 template <typename T>
 inline void GenericMessage<T>::clear() {
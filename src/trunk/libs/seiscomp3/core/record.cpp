@@ -15,6 +15,7 @@
 #include <math.h>
 #include <string.h>
 #include <seiscomp3/core/record.h>
+#include <seiscomp3/core/streamregistry.h>
 #include <seiscomp3/core/exceptions.h>
 #include <seiscomp3/core/interfacefactory.ipp>
 
@@ -32,7 +33,8 @@ IMPLEMENT_INTERFACE_FACTORY(Record, SC_SYSTEM_CORE_API);
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Record::Record(Array::DataType datatype, Hint h)
  : _net(""), _sta(""), _loc(""), _cha(""), _stime(Core::Time(0,0)),
-   _datatype(datatype), _hint(h), _nsamp(0), _fsamp(0), _timequal(-1) {}
+   _datatype(datatype), _hint(h), _nsamp(0), _fsamp(0), _timequal(-1),
+   _streamHandle(StreamRegistry::InvalidHandle) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -43,7 +45,8 @@ Record::Record(Array::DataType datatype, Hint h,
                std::string net, std::string sta, std::string loc, std::string cha,
                Core::Time stime, int nsamp, double fsamp, int tqual)
  : _net(net), _sta(sta), _loc(loc), _cha(cha), _stime(stime),
-   _datatype(datatype), _hint(h), _nsamp(nsamp), _fsamp(fsamp), _timequal(tqual) {}
+   _datatype(datatype), _hint(h), _nsamp(nsamp), _fsamp(fsamp), _timequal(tqual),
+   _streamHandle(StreamRegistry::InvalidHandle) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -55,7 +58,8 @@ Record::Record(const Record &rec)
    _net(rec.networkCode()), _sta(rec.stationCode()), _loc(rec.locationCode()),
    _cha(rec.channelCode()), _stime(rec.startTime()), _datatype(rec.dataType()),
    _hint(rec._hint), _nsamp(rec.sampleCount()),
-   _fsamp(rec.samplingFrequency()), _timequal(rec.timingQuality()) {}
+   _fsamp(rec.samplingFrequency()), _timequal(rec.timingQuality()),
+   _streamHandle(rec._streamHandle) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -81,6 +85,7 @@ Record& Record::operator=(const Record &rec) {
 		_nsamp = rec.sampleCount();
 		_fsamp = rec.samplingFrequency();
 		_timequal = rec.timingQuality();
+		_streamHandle = rec._streamHandle;
 	}
 
 	return (*this);
@@ -102,6 +107,7 @@ const std::string &Record::networkCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setNetworkCode(std::string net) {
 	_net = net;
+	_streamHandle = StreamRegistry::InvalidHandle;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -120,6 +126,7 @@ const std::string &Record::stationCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setStationCode(std::string sta) {
 	_sta = sta;
+	_streamHandle = StreamRegistry::InvalidHandle;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -138,6 +145,7 @@ const std::string &Record::locationCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setLocationCode(std::string loc) {
 	_loc = loc;
+	_streamHandle = StreamRegistry::InvalidHandle;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -156,6 +164,7 @@ const std::string &Record::channelCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setChannelCode(std::string cha) {
 	_cha = cha;
+	_streamHandle = StreamRegistry::InvalidHandle;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -250,6 +259,17 @@ std::string Record::streamID() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int Record::streamHandle() const {
+	if ( _streamHandle == StreamRegistry::InvalidHandle )
+		_streamHandle = StreamRegistry::Register(_net, _sta, _loc, _cha);
+	return _streamHandle;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Array::DataType Record::dataType() const {
 	return _datatype;
@@ -285,6 +305,9 @@ void Record::serialize(Archive& ar) {
 	ar & TAGGED_MEMBER(cha);
 	ar & TAGGED_MEMBER(stime);
 	ar & TAGGED_MEMBER(fsamp);
+
+	if ( ar.isReading() )
+		_streamHandle = StreamRegistry::InvalidHandle;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -134,6 +134,11 @@ class SC_SYSTEM_CORE_API Record : public Seiscomp::Core::BaseObject {
 		//! Returns the so called stream ID: <net>.<sta>.<loc>.<cha>
 		std::string streamID() const;
 
+		//! Returns the interned handle of the stream ID as assigned by
+		//! the StreamRegistry. It is resolved once and cached until one
+		//! of the stream codes changes.
+		int streamHandle() const;
+
 		//! Returns the data type specified for the data sample requests
 		Array::DataType dataType() const;
 
@@ -190,6 +195,7 @@ class SC_SYSTEM_CORE_API Record : public Seiscomp::Core::BaseObject {
 		int             _nsamp;
 		double          _fsamp;
 		int             _timequal;
+		mutable int     _streamHandle;
 };
 
 
@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/core/sampleringbuffer.h>
+#include <seiscomp3/core/arrayfactory.h>
+#include <seiscomp3/core/typedarray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace Seiscomp {
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::Time SampleRingBuffer::View::endTime() const {
+	if ( samplingFrequency <= 0 ) return startTime;
+	return startTime + Core::TimeSpan(size / samplingFrequency);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SampleRingBuffer::SampleRingBuffer(const Core::TimeSpan &span, double tolerance)
+: _span(span), _tolerance(tolerance), _fsamp(0), _head(0), _capacity(0) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SampleRingBuffer::init(double fsamp, const Core::Time &reference) {
+	if ( fsamp != _fsamp ) {
+		_fsamp = fsamp;
+		_capacity = (size_t)ceil((double)_span * _fsamp) + 1;
+		_data.assign(_capacity*2, 0.0);
+	}
+
+	_reference = reference;
+	_head = 0;
+	_gaps.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SampleRingBuffer::write(int64_t index, const double *samples, size_t n) {
+	// Only the most recent capacity samples survive anyway
+	if ( n > _capacity ) {
+		samples += n - _capacity;
+		index += n - _capacity;
+		n = _capacity;
+	}
+
+	while ( n > 0 ) {
+		size_t pos = (size_t)(index % (int64_t)_capacity);
+		size_t chunk = std::min(n, _capacity - pos);
+
+		memcpy(&_data[pos], samples, chunk*sizeof(double));
+		memcpy(&_data[pos+_capacity], samples, chunk*sizeof(double));
+
+		samples += chunk;
+		index += chunk;
+		n -= chunk;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SampleRingBuffer::feed(const Record *rec) {
+	if ( rec == NULL ) return false;
+
+	const Array *data = rec->data();
+	if ( data == NULL || data->size() == 0 ) return false;
+
+	double fsamp = rec->samplingFrequency();
+	if ( fsamp <= 0 ) return false;
+
+	ArrayPtr tmp;
+	const DoubleArray *samples = DoubleArray::ConstCast(data);
+	if ( samples == NULL ) {
+		tmp = ArrayFactory::Create(Array::DOUBLE, data);
+		samples = DoubleArray::ConstCast(tmp);
+		if ( samples == NULL ) return false;
+	}
+
+	if ( _head == 0 || fsamp != _fsamp )
+		init(fsamp, rec->startTime());
+
+	size_t n = (size_t)samples->size();
+	size_t skip = 0;
+	int64_t index = 0;
+
+	if ( _head > 0 ) {
+		double offset = (double)(rec->startTime() - _reference) * _fsamp;
+		double diff = offset - (double)_head;
+
+		if ( fabs(diff) <= _tolerance )
+			index = _head;
+		else if ( diff > 0 ) {
+			index = (int64_t)floor(offset + 0.5);
+			if ( index - _head >= (int64_t)_capacity ) {
+				// The gap removes all buffered data
+				init(_fsamp, rec->startTime());
+				index = 0;
+			}
+			else {
+				// Zero the gap and remember it
+				for ( int64_t i = _head; i < index; ++i ) {
+					size_t pos = (size_t)(i % (int64_t)_capacity);
+					_data[pos] = _data[pos+_capacity] = 0.0;
+				}
+
+				_gaps.push_back(Gap(_head, index));
+			}
+		}
+		else {
+			index = (int64_t)floor(offset + 0.5);
+			// Records older than the oldest sample or fully overlapping
+			// are ignored
+			if ( index + (int64_t)n <= _head ) return false;
+			skip = (size_t)(_head - index);
+			index = _head;
+		}
+	}
+
+	write(index, samples->typedData() + skip, n - skip);
+	_head = index + (int64_t)(n - skip);
+
+	int64_t first = firstIndex();
+	while ( !_gaps.empty() && _gaps.front().second <= first )
+		_gaps.pop_front();
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SampleRingBuffer::reset() {
+	_head = 0;
+	_gaps.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const Core::TimeSpan &SampleRingBuffer::timeSpan() const {
+	return _span;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double SampleRingBuffer::tolerance() const {
+	return _tolerance;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double SampleRingBuffer::samplingFrequency() const {
+	return _fsamp;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t SampleRingBuffer::capacity() const {
+	return _capacity;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t SampleRingBuffer::size() const {
+	return (size_t)(_head - firstIndex());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int64_t SampleRingBuffer::firstIndex() const {
+	return _head > (int64_t)_capacity ? _head - (int64_t)_capacity : 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::TimeWindow SampleRingBuffer::timeWindow() const {
+	if ( _head == 0 ) return Core::TimeWindow();
+
+	return Core::TimeWindow(
+		_reference + Core::TimeSpan(firstIndex() / _fsamp),
+		_reference + Core::TimeSpan(_head / _fsamp)
+	);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SampleRingBuffer::view(const Core::TimeWindow &tw, View &v) const {
+	if ( _head == 0 ) return false;
+
+	// The view covers all samples with time in [start,end)
+	int64_t from = (int64_t)ceil((double)(tw.startTime() - _reference) * _fsamp);
+	int64_t to = (int64_t)ceil((double)(tw.endTime() - _reference) * _fsamp);
+
+	from = std::max(from, firstIndex());
+	to = std::min(to, _head);
+	if ( from >= to ) return false;
+
+	v.data = &_data[(size_t)(from % (int64_t)_capacity)];
+	v.size = (size_t)(to - from);
+	v.startTime = _reference + Core::TimeSpan(from / _fsamp);
+	v.samplingFrequency = _fsamp;
+	v.gapFree = !hasGaps(from, to);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SampleRingBuffer::hasGaps(const Core::TimeWindow &tw) const {
+	if ( _head == 0 ) return true;
+
+	int64_t from = (int64_t)ceil((double)(tw.startTime() - _reference) * _fsamp);
+	int64_t to = (int64_t)ceil((double)(tw.endTime() - _reference) * _fsamp);
+
+	// Data outside the buffer is missing as well
+	if ( from < firstIndex() || to > _head ) return true;
+
+	return hasGaps(from, to);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SampleRingBuffer::hasGaps(int64_t from, int64_t to) const {
+	for ( Gaps::const_iterator it = _gaps.begin(); it != _gaps.end(); ++it ) {
+		if ( it->first >= to ) break;
+		if ( it->second > from ) return true;
+	}
+
+	return false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
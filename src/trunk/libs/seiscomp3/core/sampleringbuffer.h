@@ -0,0 +1,152 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_SAMPLERINGBUFFER_H__
+#define __SEISCOMP_SAMPLERINGBUFFER_H__
+
+
+#include <seiscomp3/core/record.h>
+#include <seiscomp3/core/timewindow.h>
+
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+
+namespace Seiscomp {
+
+
+DEFINE_SMARTPOINTER(SampleRingBuffer);
+
+
+/**
+ * SampleRingBuffer
+ *
+ * A continuous buffer of the samples of a single stream. Unlike a
+ * RecordSequence it does not store the records but copies their samples
+ * into a preallocated ring whose size is derived from the configured time
+ * span and the sampling frequency of the first record.
+ *
+ * Each sample is written twice, at its ring position and one capacity
+ * behind it. Any time window up to the capacity is therefore available as
+ * a single pointer and length without copying or allocating.
+ *
+ * Gaps larger than the tolerance are filled with zeros and remembered so
+ * that views can report whether they cover missing data. Overlapping
+ * samples are dropped. If the sampling frequency changes or a gap exceeds
+ * the buffer size the buffer starts over.
+ */
+class SC_SYSTEM_CORE_API SampleRingBuffer : public Core::BaseObject {
+	// ----------------------------------------------------------------------
+	//  Public types
+	// ----------------------------------------------------------------------
+	public:
+		//! A read-only view of continuous samples. The view is valid
+		//! until the next call of feed or reset.
+		struct View {
+			View() : data(NULL), size(0), samplingFrequency(0), gapFree(true) {}
+
+			//! Returns the time of the sample following the last one
+			Core::Time endTime() const;
+
+			const double *data;
+			size_t        size;
+			Core::Time    startTime;
+			double        samplingFrequency;
+			//! Whether the view does not cover any gap
+			bool          gapFree;
+		};
+
+
+	// ----------------------------------------------------------------------
+	//  X'truction
+	// ----------------------------------------------------------------------
+	public:
+		//! C'tor
+		//! @param span The time span to keep
+		//! @param tolerance The maximum gap/overlap (in samples) that does
+		//!                  not break the continuity
+		SampleRingBuffer(const Core::TimeSpan &span, double tolerance=0.5);
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		//! Copies the samples of a record into the buffer. Returns false
+		//! if the record has no data or does not add any new samples.
+		bool feed(const Record *rec);
+
+		//! Removes all samples but keeps the allocated memory
+		void reset();
+
+		const Core::TimeSpan &timeSpan() const;
+		double tolerance() const;
+
+		//! Returns the sampling frequency of the buffered samples or 0 if
+		//! nothing has been fed yet
+		double samplingFrequency() const;
+
+		//! Returns the number of samples the ring can hold
+		size_t capacity() const;
+
+		//! Returns the number of buffered samples including gaps
+		size_t size() const;
+
+		//! Returns the time window of the buffered samples
+		Core::TimeWindow timeWindow() const;
+
+		//! Returns a view of the buffered samples within tw. The window
+		//! is clipped to the available data. Returns false if tw does not
+		//! overlap with the buffer content.
+		bool view(const Core::TimeWindow &tw, View &v) const;
+
+		//! Returns whether there is missing data within tw
+		bool hasGaps(const Core::TimeWindow &tw) const;
+
+
+	// ----------------------------------------------------------------------
+	//  Private methods
+	// ----------------------------------------------------------------------
+	private:
+		void init(double fsamp, const Core::Time &reference);
+		void write(int64_t index, const double *samples, size_t n);
+		int64_t firstIndex() const;
+		bool hasGaps(int64_t from, int64_t to) const;
+
+
+	// ----------------------------------------------------------------------
+	//  Members
+	// ----------------------------------------------------------------------
+	private:
+		typedef std::pair<int64_t, int64_t> Gap;
+		typedef std::deque<Gap> Gaps;
+
+		Core::TimeSpan      _span;
+		double              _tolerance;
+		double              _fsamp;
+		//! Time of the sample with index 0
+		Core::Time          _reference;
+		//! Index of the next sample to be written
+		int64_t             _head;
+		size_t              _capacity;
+		std::vector<double> _data;
+		//! Missing sample index ranges [first,last)
+		Gaps                _gaps;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,220 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/core/streamregistry.h>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+
+namespace Seiscomp {
+
+
+namespace {
+
+
+struct Entry {
+	std::string net;
+	std::string sta;
+	std::string loc;
+	std::string cha;
+	size_t      hash;
+};
+
+
+// FNV-1a over all four codes. A separator is mixed in after each code
+// to distinguish e.g. "AB"+"C" from "A"+"BC".
+inline void hashCode(size_t &h, const std::string &code) {
+	for ( size_t i = 0; i < code.size(); ++i ) {
+		h ^= (unsigned char)code[i];
+		h *= 16777619u;
+	}
+
+	h ^= '.';
+	h *= 16777619u;
+}
+
+
+inline size_t hashStream(const std::string &net, const std::string &sta,
+                         const std::string &loc, const std::string &cha) {
+	size_t h = 2166136261u;
+	hashCode(h, net);
+	hashCode(h, sta);
+	hashCode(h, loc);
+	hashCode(h, cha);
+	return h;
+}
+
+
+class Registry {
+	public:
+		Registry() : _buckets(256) {}
+
+		int find(size_t hash, const std::string &net, const std::string &sta,
+		         const std::string &loc, const std::string &cha) const {
+			const std::vector<int> &bucket = _buckets[hash & (_buckets.size()-1)];
+			for ( size_t i = 0; i < bucket.size(); ++i ) {
+				const Entry &e = _entries[bucket[i]];
+				if ( e.hash == hash && e.cha == cha && e.sta == sta &&
+				     e.net == net && e.loc == loc )
+					return bucket[i];
+			}
+
+			return StreamRegistry::InvalidHandle;
+		}
+
+		int add(size_t hash, const std::string &net, const std::string &sta,
+		        const std::string &loc, const std::string &cha) {
+			int handle = (int)_entries.size();
+
+			_entries.push_back(Entry());
+			Entry &e = _entries.back();
+			e.net = net;
+			e.sta = sta;
+			e.loc = loc;
+			e.cha = cha;
+			e.hash = hash;
+
+			if ( _entries.size() > _buckets.size()*2 )
+				rehash(_buckets.size()*4);
+			else
+				_buckets[hash & (_buckets.size()-1)].push_back(handle);
+
+			return handle;
+		}
+
+		const Entry *entry(int handle) const {
+			if ( handle < 0 || handle >= (int)_entries.size() ) return NULL;
+			return &_entries[handle];
+		}
+
+		size_t count() const {
+			return _entries.size();
+		}
+
+		mutable boost::mutex mutex;
+
+
+	private:
+		void rehash(size_t size) {
+			std::vector< std::vector<int> > buckets(size);
+			for ( size_t i = 0; i < _entries.size(); ++i )
+				buckets[_entries[i].hash & (size-1)].push_back((int)i);
+			_buckets.swap(buckets);
+		}
+
+
+	private:
+		std::vector<Entry>              _entries;
+		std::vector< std::vector<int> > _buckets;
+};
+
+
+// Never deleted on purpose: records may still query their handles during
+// static destruction.
+Registry &registry() {
+	static Registry *instance = new Registry;
+	return *instance;
+}
+
+
+// Force initialization before main to not race on the function local
+// static when the first records are decoded by several threads
+Registry &registryInstance = registry();
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int StreamRegistry::Register(const std::string &networkCode,
+                             const std::string &stationCode,
+                             const std::string &locationCode,
+                             const std::string &channelCode) {
+	size_t hash = hashStream(networkCode, stationCode, locationCode, channelCode);
+	Registry &reg = registry();
+
+	boost::mutex::scoped_lock lock(reg.mutex);
+	int handle = reg.find(hash, networkCode, stationCode, locationCode, channelCode);
+	if ( handle != InvalidHandle ) return handle;
+
+	return reg.add(hash, networkCode, stationCode, locationCode, channelCode);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int StreamRegistry::Find(const std::string &networkCode,
+                         const std::string &stationCode,
+                         const std::string &locationCode,
+                         const std::string &channelCode) {
+	size_t hash = hashStream(networkCode, stationCode, locationCode, channelCode);
+	Registry &reg = registry();
+
+	boost::mutex::scoped_lock lock(reg.mutex);
+	return reg.find(hash, networkCode, stationCode, locationCode, channelCode);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int StreamRegistry::Find(const std::string &streamID) {
+	size_t p1 = streamID.find('.');
+	if ( p1 == std::string::npos ) return InvalidHandle;
+	size_t p2 = streamID.find('.', p1+1);
+	if ( p2 == std::string::npos ) return InvalidHandle;
+	size_t p3 = streamID.find('.', p2+1);
+	if ( p3 == std::string::npos ) return InvalidHandle;
+	if ( streamID.find('.', p3+1) != std::string::npos ) return InvalidHandle;
+
+	return Find(streamID.substr(0, p1), streamID.substr(p1+1, p2-p1-1),
+	            streamID.substr(p2+1, p3-p2-1), streamID.substr(p3+1));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string StreamRegistry::StreamID(int handle) {
+	Registry &reg = registry();
+
+	boost::mutex::scoped_lock lock(reg.mutex);
+	const Entry *e = reg.entry(handle);
+	if ( e == NULL ) return "";
+
+	return e->net + "." + e->sta + "." + e->loc + "." + e->cha;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t StreamRegistry::Count() {
+	Registry &reg = registry();
+
+	boost::mutex::scoped_lock lock(reg.mutex);
+	return reg.count();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
@@ -0,0 +1,75 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SC_CORE_STREAMREGISTRY_H__
+#define __SC_CORE_STREAMREGISTRY_H__
+
+
+#include <seiscomp3/core.h>
+#include <string>
+#include <cstddef>
+
+
+namespace Seiscomp {
+
+
+/**
+ * Process wide registry that interns stream identifiers
+ * (network, station, location and channel code) to compact integer handles.
+ *
+ * Handles are assigned in ascending order starting with 0 and are never
+ * released during the lifetime of a process. They are meant to be used as
+ * index into flat dispatch tables instead of looking up string keys for
+ * each record. Looking up an already registered stream does not allocate
+ * memory. All methods are thread-safe.
+ */
+class SC_SYSTEM_CORE_API StreamRegistry {
+	public:
+		//! The handle of an unknown stream
+		enum { InvalidHandle = -1 };
+
+
+	public:
+		//! Returns the handle of a stream and registers the stream if it
+		//! is not yet known.
+		static int Register(const std::string &networkCode,
+		                    const std::string &stationCode,
+		                    const std::string &locationCode,
+		                    const std::string &channelCode);
+
+		//! Returns the handle of a stream or InvalidHandle if the stream
+		//! has not been registered.
+		static int Find(const std::string &networkCode,
+		                const std::string &stationCode,
+		                const std::string &locationCode,
+		                const std::string &channelCode);
+
+		//! Returns the handle of a stream given as stream ID
+		//! <net>.<sta>.<loc>.<cha> or InvalidHandle if the stream has not
+		//! been registered or the ID is malformed.
+		static int Find(const std::string &streamID);
+
+		//! Returns the stream ID <net>.<sta>.<loc>.<cha> of a handle or an
+		//! empty string if the handle is invalid.
+		static std::string StreamID(int handle);
+
+		//! Returns the number of registered streams which is also the upper
+		//! bound (exclusive) of all valid handles.
+		static size_t Count();
+};
+
+
+}
+
+
+#endif
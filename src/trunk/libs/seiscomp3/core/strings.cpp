@@ -29,7 +29,6 @@ namespace Core {
 namespace {
 
 const char* timeFormat = "%FT%T.0000Z";
-const char* timeFormatPrecise = "%FT%T.%fZ";
 const char* timeFormat2 = "%FT%TZ";
 
 }
@@ -52,7 +51,7 @@ std::string toString(time_t v) {
 
 
 std::string toString(const Seiscomp::Core::Time& v) {
-	return v.toString(timeFormatPrecise);
+	return v.iso();
 }
 
 
@@ -293,12 +292,7 @@ bool fromString(time_t& value, const std::string& str) {
 
 
 bool fromString(Time& value, const std::string& str) {
-	if ( !value.fromString(str.c_str(), timeFormatPrecise) ) {
-		if ( !value.fromString(str.c_str(), timeFormat2) )
-			return false;
-	}
-
-	return true;
+	return value.fromISO(str.c_str());
 }
 
 
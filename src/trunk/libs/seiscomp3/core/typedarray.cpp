@@ -18,6 +18,7 @@
 #include <numeric>
 #include <math.h>
 #include <seiscomp3/core/typedarray.h>
+#include <seiscomp3/core/arraypool.h>
 
 
 namespace Seiscomp {
@@ -69,6 +70,26 @@ Array::DataType dispatchType< std::complex<double> >() {
 }
 
 
+// Numeric sample buffers are handed back to the array pool on destruction
+template<typename T>
+void releaseStorage(std::vector<T> &) {}
+
+void releaseStorage(std::vector<char> &data) {
+	ArrayPool<char>::Release(data);
+}
+
+void releaseStorage(std::vector<int> &data) {
+	ArrayPool<int>::Release(data);
+}
+
+void releaseStorage(std::vector<float> &data) {
+	ArrayPool<float>::Release(data);
+}
+
+void releaseStorage(std::vector<double> &data) {
+	ArrayPool<double>::Release(data);
+}
+
 
 }
 
@@ -95,7 +116,9 @@ TypedArray<T>::TypedArray(const TypedArray &array): Array(dispatchType<T>()) {
 }
 
 template<typename T>
-TypedArray<T>::~TypedArray() {}
+TypedArray<T>::~TypedArray() {
+	releaseStorage(_data);
+}
 
 template<typename T>
 TypedArray<T>& TypedArray<T>::operator=(const TypedArray &array) {
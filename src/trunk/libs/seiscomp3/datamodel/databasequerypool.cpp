@@ -0,0 +1,273 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT DatabaseQueryPool
+#include <seiscomp3/datamodel/databasequerypool.h>
+#include <seiscomp3/datamodel/notifier.h>
+#include <seiscomp3/logging/log.h>
+
+#include <boost/bind.hpp>
+
+
+namespace Seiscomp {
+namespace DataModel {
+
+
+namespace {
+
+
+// Collects the results of DatabaseQueryPool::execute
+struct Batch {
+	Batch(size_t size) : results(size), remaining(size) {}
+
+	void store(size_t index, DatabaseQueryResult *result) {
+		boost::mutex::scoped_lock lock(mutex);
+		results[index] = result;
+		if ( --remaining == 0 )
+			finished.notify_all();
+	}
+
+	boost::mutex                   mutex;
+	boost::condition               finished;
+	DatabaseQueryPool::Results     results;
+	size_t                         remaining;
+};
+
+
+}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+DatabaseQueryResult::DatabaseQueryResult(unsigned long id) : _id(id) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+unsigned long DatabaseQueryResult::id() const {
+	return _id;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const DatabaseQueryResult::Objects &DatabaseQueryResult::objects() const {
+	return _objects;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+DatabaseQueryPool::DatabaseQueryPool()
+: _lastId(0), _pending(0), _closing(false) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+DatabaseQueryPool::~DatabaseQueryPool() {
+	close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool DatabaseQueryPool::open(const std::string &uri, size_t connections) {
+	close();
+
+	for ( size_t i = 0; i < connections; ++i ) {
+		IO::DatabaseInterfacePtr db = IO::DatabaseInterface::Open(uri.c_str());
+		if ( !db ) {
+			SEISCOMP_WARNING("Could only open %d of %d pool connections",
+			                 (int)_connections.size(), (int)connections);
+			break;
+		}
+
+		_connections.push_back(db);
+	}
+
+	if ( _connections.empty() )
+		return false;
+
+	_closing = false;
+
+	for ( size_t i = 0; i < _connections.size(); ++i )
+		_threads.push_back(new boost::thread(boost::bind(&DatabaseQueryPool::run, this,
+		                                                 _connections[i].get())));
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DatabaseQueryPool::close() {
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_closing = true;
+		_pending -= _requests.size();
+		_requests.clear();
+		_requestAvailable.notify_all();
+	}
+
+	for ( size_t i = 0; i < _threads.size(); ++i ) {
+		_threads[i]->join();
+		delete _threads[i];
+	}
+
+	_threads.clear();
+
+	boost::mutex::scoped_lock lock(_mutex);
+	_connections.clear();
+	_finished.notify_all();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t DatabaseQueryPool::connections() const {
+	boost::mutex::scoped_lock lock(_mutex);
+	return _connections.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+unsigned long DatabaseQueryPool::submit(const Query &query,
+                                        const Handler &handler) {
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if ( _connections.empty() || _closing )
+		return 0;
+
+	Request req;
+	req.id = ++_lastId;
+	req.query = query;
+	req.handler = handler;
+
+	_requests.push_back(req);
+	++_pending;
+	_requestAvailable.notify_one();
+
+	return req.id;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DatabaseQueryPool::wait() {
+	boost::mutex::scoped_lock lock(_mutex);
+	while ( _pending > 0 )
+		_finished.wait(lock);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool DatabaseQueryPool::execute(const Queries &queries, Results &results) {
+	Batch batch(queries.size());
+	size_t submitted = 0;
+
+	for ( ; submitted < queries.size(); ++submitted ) {
+		if ( !submit(queries[submitted], boost::bind(&Batch::store, &batch, submitted, _1)) )
+			break;
+	}
+
+	boost::mutex::scoped_lock lock(batch.mutex);
+
+	// Queries that could not be submitted will never finish
+	batch.remaining -= queries.size() - submitted;
+	while ( batch.remaining > 0 )
+		batch.finished.wait(lock);
+
+	results = batch.results;
+
+	return submitted == queries.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DatabaseQueryPool::run(IO::DatabaseInterface *db) {
+	// Objects read by this thread must not show up in the global public
+	// object registry nor create notifiers
+	PublicObject::SetRegistrationEnabled(false);
+	Notifier::Disable();
+
+	DatabaseQueryPtr query = new DatabaseQuery(db);
+	query->setPublicObjectCacheLookupEnabled(false);
+
+	while ( true ) {
+		Request req;
+
+		{
+			boost::mutex::scoped_lock lock(_mutex);
+			while ( _requests.empty() && !_closing )
+				_requestAvailable.wait(lock);
+
+			if ( _closing ) break;
+
+			req = _requests.front();
+			_requests.pop_front();
+		}
+
+		DatabaseQueryResult *result = new DatabaseQueryResult(req.id);
+
+		// The iterator keeps a reference to the current object which
+		// must be released before the result is handed over
+		{
+			DatabaseIterator it = req.query(query.get());
+			for ( ; *it; ++it )
+				result->_objects.push_back(*it);
+			it.close();
+		}
+
+		if ( req.handler )
+			req.handler(result);
+		else
+			delete result;
+
+		boost::mutex::scoped_lock lock(_mutex);
+		--_pending;
+		if ( _pending == 0 )
+			_finished.notify_all();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+}
+}
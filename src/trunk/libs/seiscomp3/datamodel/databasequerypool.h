@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+#ifndef __SEISCOMP_DATAMODEL_DATABASEQUERYPOOL_H__
+#define __SEISCOMP_DATAMODEL_DATABASEQUERYPOOL_H__
+
+#include <seiscomp3/core/baseobject.h>
+#include <seiscomp3/datamodel/databasequery.h>
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace DataModel {
+
+
+DEFINE_SMARTPOINTER(DatabaseQueryResult);
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+/**
+ * \brief The objects read by a query of a DatabaseQueryPool
+ */
+class SC_SYSTEM_CORE_API DatabaseQueryResult : public Core::BaseObject {
+	DECLARE_CASTS(DatabaseQueryResult);
+
+	// ----------------------------------------------------------------------
+	//  Types
+	// ----------------------------------------------------------------------
+	public:
+		typedef std::vector<ObjectPtr> Objects;
+
+
+	// ----------------------------------------------------------------------
+	//  Xstruction
+	// ----------------------------------------------------------------------
+	public:
+		DatabaseQueryResult(unsigned long id);
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		//! Returns the id that DatabaseQueryPool::submit returned for
+		//! the query
+		unsigned long id() const;
+
+		//! Returns the objects in the order of the result set
+		const Objects &objects() const;
+
+
+	private:
+		unsigned long _id;
+		Objects       _objects;
+
+	friend class DatabaseQueryPool;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+DEFINE_SMARTPOINTER(DatabaseQueryPool);
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+/**
+ * \brief Runs database queries asynchronously on a pool of connections.
+ *
+ * Every connection is served by its own thread with its own DatabaseQuery.
+ * Queries are taken in the order of submission by the next idle
+ * connection, so independent queries run concurrently and do not block
+ * the submitting thread.
+ * The objects are read with public object registration and the public
+ * object cache lookup disabled. They are not shared with any other thread
+ * and the receiver of a result may register them.
+ */
+class SC_SYSTEM_CORE_API DatabaseQueryPool : public Core::BaseObject {
+	// ----------------------------------------------------------------------
+	//  Types
+	// ----------------------------------------------------------------------
+	public:
+		//! A query to run on a connection of the pool, e.g.
+		//! boost::bind(&DatabaseQuery::getPicks, _1, startTime, endTime)
+		typedef boost::function<DatabaseIterator (DatabaseQuery*)> Query;
+
+		//! Receives the result of a query. It is called from the thread
+		//! of the connection that ran the query and takes over the
+		//! ownership of the result.
+		typedef boost::function<void (DatabaseQueryResult*)> Handler;
+
+		typedef std::vector<Query> Queries;
+		typedef std::vector<DatabaseQueryResultPtr> Results;
+
+
+	// ----------------------------------------------------------------------
+	//  Xstruction
+	// ----------------------------------------------------------------------
+	public:
+		DatabaseQueryPool();
+		~DatabaseQueryPool();
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		//! Opens a number of connections to a database and starts their
+		//! threads. Returns false if no connection could be opened.
+		bool open(const std::string &uri, size_t connections);
+
+		//! Discards all queued queries, waits for the running ones and
+		//! closes the connections.
+		void close();
+
+		//! Returns the number of open connections
+		size_t connections() const;
+
+		//! Queues a query.
+		//! @return The id of the query or 0 if the pool is not open
+		unsigned long submit(const Query &query, const Handler &handler);
+
+		//! Blocks until all submitted queries are finished
+		void wait();
+
+		/**
+		 * Runs independent queries concurrently and blocks until all of
+		 * them are finished. Must neither be called from a handler nor
+		 * concurrently with close().
+		 * @param queries The queries to run
+		 * @param results The results in the order of the queries
+		 * @return false if the pool is not open. The results of the
+		 *         queries that could not be submitted are NULL.
+		 */
+		bool execute(const Queries &queries, Results &results);
+
+
+	// ----------------------------------------------------------------------
+	//  Private interface
+	// ----------------------------------------------------------------------
+	private:
+		struct Request {
+			unsigned long id;
+			Query         query;
+			Handler       handler;
+		};
+
+		typedef std::deque<Request> Requests;
+		typedef std::vector<IO::DatabaseInterfacePtr> Connections;
+		typedef std::vector<boost::thread*> Threads;
+
+		void run(IO::DatabaseInterface *db);
+
+
+	private:
+		Connections               _connections;
+		Threads                   _threads;
+		mutable boost::mutex      _mutex;
+		boost::condition          _requestAvailable;
+		boost::condition          _finished;
+		Requests                  _requests;
+		unsigned long             _lastId;
+		size_t                    _pending;
+		bool                      _closing;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+}
+}
+
+
+#endif
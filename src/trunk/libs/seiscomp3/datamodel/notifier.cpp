@@ -18,6 +18,7 @@
 #include <seiscomp3/datamodel/publicobject.h>
 #include <seiscomp3/datamodel/metadata.h>
 #include <string>
+#include <map>
 
 
 namespace Seiscomp {
@@ -101,8 +102,34 @@ Notifier::MetaObject::MetaObject(const Core::RTTI* rtti) : Seiscomp::Core::MetaO
 IMPLEMENT_METAOBJECT(Notifier)
 
 IMPLEMENT_MESSAGE_FOR(Notifier, NotifierMessage, "notifier_message");
-Notifier::Pool Notifier::_notifiers;
-boost::thread_specific_ptr<bool> Notifier::_lock;
+
+
+struct Notifier::LocalPool {
+	// Notifiers can only be equal or opposite if they refer to the same
+	// object. The index maps the objects to the notifiers in the pool to
+	// avoid comparing each new notifier against the whole pool.
+	typedef std::multimap<Object*, PoolIterator> Index;
+	typedef std::pair<Index::iterator, Index::iterator> IndexRange;
+
+	LocalPool() : enabled(false) {}
+
+	void unindex(PoolIterator it) {
+		IndexRange range = index.equal_range((*it)->object());
+		for ( ; range.first != range.second; ++range.first ) {
+			if ( range.first->second == it ) {
+				index.erase(range.first);
+				return;
+			}
+		}
+	}
+
+	bool  enabled;
+	Pool  notifiers;
+	Index index;
+};
+
+
+boost::thread_specific_ptr<Notifier::LocalPool> Notifier::_pool;
 bool Notifier::_checkOnCreate = true;
 
 
@@ -134,27 +161,27 @@ Notifier::~Notifier() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-Notifier* Notifier::Create(const std::string& parentId,
-                           Operation op,
-	                       Object* object) {
-	if ( !IsEnabled() ) return NULL;
-
-	if ( parentId.empty() ) {
-		SEISCOMP_ERROR("cannot create a notifier without a publicId");
-		return NULL;
+Notifier::LocalPool &Notifier::Local() {
+	LocalPool *pool = _pool.get();
+	if ( pool == NULL ) {
+		pool = new LocalPool;
+		_pool.reset(pool);
 	}
 
-	if ( object == NULL ) {
-		SEISCOMP_ERROR("cannot create a notifier without an object");
-		return NULL;
-	}
+	return *pool;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
 
-	NotifierPtr notifier = new Notifier(parentId, op, object);
 
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Notifier::Queue(LocalPool &pool, Notifier *notifier) {
 	if ( _checkOnCreate ) {
-		PoolIterator it = _notifiers.begin();
-		for ( ; it != _notifiers.end(); ++it ) {
-			CompareResult res = (*it)->cmp(notifier.get());
+		LocalPool::IndexRange range = pool.index.equal_range(notifier->object());
+		for ( ; range.first != range.second; ++range.first ) {
+			PoolIterator it = range.first->second;
+			CompareResult res = (*it)->cmp(notifier);
 			// If there is already an equal notifier stored, discard the
 			// current one
 			if ( res == CR_EQUAL ) {
@@ -165,19 +192,74 @@ Notifier* Notifier::Create(const std::string& parentId,
 				               notifier->parentID().c_str(),
 				               notifier->operation().toString(),
 				               notifier->object()->className());
-				return NULL;
+				return false;
 			}
 			// If the notifier neutralize each other, remove the stored
 			// and discard the current one
 			else if ( res == CR_OPPOSITE ) {
 				SEISCOMP_DEBUG("opposite notifier found => removing the stored one");
-				_notifiers.erase(it);
-				return NULL;
+				pool.index.erase(range.first);
+				pool.notifiers.erase(it);
+				return false;
 			}
 		}
 	}
 
-	_notifiers.push_back(notifier);
+	PoolIterator it = pool.notifiers.insert(pool.notifiers.end(), notifier);
+	pool.index.insert(LocalPool::Index::value_type(notifier->object(), it));
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+NotifierMessage* Notifier::Take(LocalPool &pool, size_t maxNotifiers) {
+	if ( pool.notifiers.empty() || maxNotifiers == 0 )
+		return NULL;
+
+	PoolIterator last = pool.notifiers.begin();
+	for ( size_t i = 0; i < maxNotifiers && last != pool.notifiers.end(); ++i )
+		++last;
+
+	if ( last == pool.notifiers.end() )
+		pool.index.clear();
+	else {
+		for ( PoolIterator it = pool.notifiers.begin(); it != last; ++it )
+			pool.unindex(it);
+	}
+
+	NotifierMessage* msg = new NotifierMessage;
+	msg->splice(pool.notifiers, pool.notifiers.begin(), last);
+	return msg;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Notifier* Notifier::Create(const std::string& parentId,
+                           Operation op,
+	                       Object* object) {
+	LocalPool &pool = Local();
+	if ( !pool.enabled ) return NULL;
+
+	if ( parentId.empty() ) {
+		SEISCOMP_ERROR("cannot create a notifier without a publicId");
+		return NULL;
+	}
+
+	if ( object == NULL ) {
+		SEISCOMP_ERROR("cannot create a notifier without an object");
+		return NULL;
+	}
+
+	NotifierPtr notifier = new Notifier(parentId, op, object);
+	if ( !Queue(pool, notifier.get()) )
+		return NULL;
+
 	return notifier.get();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -203,23 +285,30 @@ Notifier* Notifier::Create(PublicObject* parent,
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 NotifierMessage* Notifier::GetMessage(bool allNotifier) {
-	if ( _notifiers.empty() )
-		return NULL;
+	LocalPool &pool = Local();
+	return Take(pool, allNotifier ? pool.notifiers.size() : 1);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	NotifierMessage* msg = new NotifierMessage;
-	PoolIterator it = _notifiers.begin();
 
-	if ( allNotifier ) {
-		for ( ; it != _notifiers.end(); ++it )
-			msg->attach((*it).get());
-		_notifiers.clear();
-	}
-	else {
-		msg->attach((*it).get());
-		_notifiers.erase(it);
-	}
 
-	return msg;
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+NotifierMessage* Notifier::GetMessageBatch(size_t maxNotifiers) {
+	return Take(Local(), maxNotifiers);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Notifier::Merge(NotifierMessage *msg) {
+	if ( msg == NULL ) return;
+
+	LocalPool &pool = Local();
+	for ( NotifierMessage::iterator it = msg->begin(); it != msg->end(); ++it )
+		Queue(pool, it->get());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -228,7 +317,7 @@ NotifierMessage* Notifier::GetMessage(bool allNotifier) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t Notifier::Size() {
-	return _notifiers.size();
+	return Local().notifiers.size();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -237,7 +326,9 @@ size_t Notifier::Size() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Notifier::Clear() {
-	_notifiers.clear();
+	LocalPool &pool = Local();
+	pool.index.clear();
+	pool.notifiers.clear();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -264,11 +355,7 @@ void Notifier::Enable() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Notifier::SetEnabled(bool e) {
-	if ( _lock.get() == NULL )
-		// Store a new thread specific pointer value with 'enable'
-		_lock.reset(new bool(!e));
-	else
-		*_lock.get() = !e;
+	Local().enabled = e;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -277,13 +364,7 @@ void Notifier::SetEnabled(bool e) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool Notifier::IsEnabled() {
-	if ( _lock.get() == NULL ) {
-		// Store a new thread specific pointer value with default: true
-		bool *value = new bool(true);
-		_lock.reset(value);
-	}
-
-	return *_lock.get() == false;
+	return Local().enabled;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -31,6 +31,19 @@ DEFINE_SMARTPOINTER(Notifier);
 // Full namespace specifier needed due to a bug (?) in SWIG >1.3.27
 DEFINE_MESSAGE_FOR(Seiscomp::DataModel::Notifier, NotifierMessage, SC_SYSTEM_CORE_API);
 
+/**
+ * A notifier describes a change of the object tree. Changes made while the
+ * notifier pool is enabled are collected as notifiers in the pool.
+ *
+ * Each thread has its own notifier pool and enable state. The static
+ * methods only act on the pool of the calling thread and the pool is
+ * disabled in each new thread. Notifiers are not shared between threads:
+ * notifiers created by a worker thread are not returned by GetMessage of
+ * another thread. A worker that creates notifiers has to take them with
+ * GetMessage and pass the message to the collecting thread which appends
+ * them to its pool with Merge, or sends them itself. Objects should be
+ * modified by one thread at a time.
+ */
 class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 	DECLARE_SC_CLASS(Notifier);
 	DECLARE_SERIALIZATION;
@@ -57,6 +70,9 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 		typedef Pool::iterator PoolIterator;
 		typedef Pool::const_iterator PoolConstIterator;
 
+		//! The notifier pool of a thread
+		struct LocalPool;
+
 
 	// ----------------------------------------------------------------------
 	//  Xstruction
@@ -82,7 +98,9 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 	//  Interface
 	// ----------------------------------------------------------------------
 	public:
-		//! Enables the notifier pool.
+		//! Enables the notifier pool. Each thread has its own notifier
+		//! pool and all static methods refer to the pool of the
+		//! calling thread.
 		static void Enable();
 
 		//! Disables the notifier pool. No notifications will be
@@ -92,8 +110,8 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 		//! Sets the state of the notifier pool
 		static void SetEnabled(bool);
 
-		//! Returns the notification pool state.
-		//! The default is TRUE.
+		//! Returns the notification pool state of the calling thread.
+		//! The pool is disabled by default.
 		static bool IsEnabled();
 
 		//! Enables/disables checking previous inserted notifiers
@@ -119,6 +137,27 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 		 */
 		static NotifierMessage* GetMessage(bool allNotifier = true);
 
+		/**
+		 * Returns a message holding the oldest notifications up to a
+		 * maximum number. The notifiers are moved from the notification
+		 * pool into the message without copying.
+		 * @param maxNotifiers The maximum number of notifiers in the
+		 *                     message
+		 * @return The message object or NULL if the pool is empty. One
+		 *         should call this method until it returns NULL.
+		 */
+		static NotifierMessage* GetMessageBatch(size_t maxNotifiers);
+
+		/**
+		 * Appends all notifiers of a message to the notification pool,
+		 * e.g. to collect notifiers that have been created by other
+		 * threads. If checking is enabled, equal and opposite notifiers
+		 * are handled as in Create. The notifiers are appended even if
+		 * the notifier pool is disabled.
+		 * @param msg The message holding the notifiers to append
+		 */
+		static void Merge(NotifierMessage *msg);
+
 		//! Returns the size of the notifier objects currently stored.
 		static size_t Size();
 
@@ -126,7 +165,8 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 		static void Clear();
 
 		/**
-		 * Creates a notifier object managed by the global notifier pool.
+		 * Creates a notifier object managed by the notifier pool of the
+		 * calling thread.
 		 * If the notifier pool is disabled no notifier instance will
 		 * be created.
 		 * @param parentID The publicId of the parent object that is target
@@ -142,7 +182,8 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 		                        Object* object);
 
 		/**
-		 * Creates a notifier object managed by the global notifier pool.
+		 * Creates a notifier object managed by the notifier pool of the
+		 * calling thread.
 		 * If the notifier pool is disabled no notifier instance will
 		 * be created.
 		 * @param parent The parent object that is target of the operation
@@ -197,13 +238,24 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 	// ----------------------------------------------------------------------
 	//  Implementation
 	// ----------------------------------------------------------------------
+	private:
+		//! Returns the notifier pool of the calling thread
+		static LocalPool &Local();
+
+		//! Appends a notifier to a pool and returns whether it has been
+		//! appended or discarded by the check against the stored ones
+		static bool Queue(LocalPool &pool, Notifier *notifier);
+
+		//! Moves up to maxNotifiers notifiers from a pool into a message
+		static NotifierMessage* Take(LocalPool &pool, size_t maxNotifiers);
+
+
 	private:
 		std::string _parentID;
 		Operation _operation;
 		ObjectPtr _object;
 
-		static boost::thread_specific_ptr<bool> _lock;
-		static Pool _notifiers;
+		static boost::thread_specific_ptr<LocalPool> _pool;
 		static bool _checkOnCreate;
 
 	DECLARE_SC_CLASSFACTORY_FRIEND(Notifier);
@@ -212,7 +264,7 @@ class SC_SYSTEM_CORE_API Notifier : public Seiscomp::Core::BaseObject {
 
 /**
  * \brief A visitor that creates notifiers for a given subtree
- * \brief and appends them to the global notifier pool.
+ * \brief and appends them to the notifier pool of the calling thread.
  */
 class NotifierCreator : public Visitor {
 	// ----------------------------------------------------------------------
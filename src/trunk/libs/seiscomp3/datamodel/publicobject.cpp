@@ -24,6 +24,9 @@ namespace {
 
 boost::mutex cacheMutex;
 
+// Thread registries are owned by the caller of SetThreadRegistry
+void keepRegistry(Seiscomp::DataModel::PublicObject::Registry *) {}
+
 }
 
 
@@ -73,7 +76,8 @@ IMPLEMENT_SC_ABSTRACT_CLASS_DERIVED(PublicObject,
                                     Object,
                                     "PublicObject");
 
-PublicObject::PublicObjectMap PublicObject::_publicObjects;
+PublicObject::Registry PublicObject::_processRegistry;
+boost::thread_specific_ptr<PublicObject::Registry> PublicObject::_threadRegistry(keepRegistry);
 bool PublicObject::_generateIds = false;
 std::string PublicObject::_idPattern = "@classname@#@time/%Y%m%d%H%M%S.%f@.@id@";
 unsigned long PublicObject::_publicObjectId = 0;
@@ -83,9 +87,30 @@ boost::thread_specific_ptr<bool> PublicObject::_registerObjects;
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PublicObject::Registry::Registry() {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PublicObject::Registry::~Registry() {
+	boost::mutex::scoped_lock lk(cacheMutex);
+
+	for ( PublicObjectMap::iterator it = _objects.begin(); it != _objects.end(); ++it )
+		it->second->_registry = NULL;
+
+	_objects.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PublicObject::PublicObject()
- : _registered(false) {
+ : _registry(NULL) {
 	++_publicObjectId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -95,7 +120,7 @@ PublicObject::PublicObject()
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PublicObject::PublicObject(const std::string& publicID)
- : Object(), _publicID(publicID), _registered(false) {
+ : Object(), _publicID(publicID), _registry(NULL) {
 	++_publicObjectId;
 	registerMe();
 }
@@ -151,12 +176,14 @@ bool PublicObject::registerMe() {
 
 	if ( _publicID.empty() ) return false;
 
+	Registry &registry = CurrentRegistry();
+
 	boost::mutex::scoped_lock lk(cacheMutex);
 
-	PublicObjectMap::iterator it = _publicObjects.find(_publicID);
-	if ( it == _publicObjects.end() ) {
-		_publicObjects[_publicID] = this;
-		_registered = true;
+	PublicObjectMap::iterator it = registry._objects.find(_publicID);
+	if ( it == registry._objects.end() ) {
+		registry._objects[_publicID] = this;
+		_registry = &registry;
 		return true;
 	}
 
@@ -177,18 +204,24 @@ bool PublicObject::registerMe() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool PublicObject::unregisterMe() {
-	if ( _publicID.empty() || !_registered )
+	if ( _publicID.empty() )
 		return false;
 
 	boost::mutex::scoped_lock lk(cacheMutex);
 
-	PublicObjectMap::iterator it = _publicObjects.find(_publicID);
-	if ( it != _publicObjects.end() ) {
-		_publicObjects.erase(it);
-		_registered = false;
+	// Checked under the lock since the registry might be destroyed
+	// in another thread
+	if ( _registry == NULL )
+		return false;
+
+	PublicObjectMap::iterator it = _registry->_objects.find(_publicID);
+	if ( it != _registry->_objects.end() && it->second == this ) {
+		_registry->_objects.erase(it);
+		_registry = NULL;
 		return true;
 	}
 
+	_registry = NULL;
 	return false;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -198,7 +231,7 @@ bool PublicObject::unregisterMe() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool PublicObject::registered() const {
-	return _registered;
+	return _registry != NULL;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -236,8 +269,14 @@ bool PublicObject::validId() const {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PublicObject* PublicObject::Find(const std::string& publicID) {
-	PublicObjectMap::iterator it = _publicObjects.find(publicID);
-	if ( it == _publicObjects.end() ) return NULL;
+	Registry &registry = CurrentRegistry();
+
+	// Objects can be registered and unregistered by other threads, e.g.
+	// the messaging thread of an application
+	boost::mutex::scoped_lock lk(cacheMutex);
+
+	PublicObjectMap::iterator it = registry._objects.find(publicID);
+	if ( it == registry._objects.end() ) return NULL;
 	return (*it).second;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -247,7 +286,7 @@ PublicObject* PublicObject::Find(const std::string& publicID) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t PublicObject::ObjectCount() {
-	return _publicObjects.size();
+	return CurrentRegistry()._objects.size();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -256,7 +295,7 @@ size_t PublicObject::ObjectCount() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PublicObject::Iterator PublicObject::Begin() {
-	return _publicObjects.begin();
+	return CurrentRegistry()._objects.begin();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -265,7 +304,7 @@ PublicObject::Iterator PublicObject::Begin() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PublicObject::Iterator PublicObject::End() {
-	return _publicObjects.end();
+	return CurrentRegistry()._objects.end();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -345,6 +384,34 @@ bool PublicObject::IsRegistrationEnabled() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void PublicObject::SetThreadRegistry(Registry *registry) {
+	_threadRegistry.reset(registry);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PublicObject::Registry *PublicObject::ThreadRegistry() {
+	return _threadRegistry.get();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PublicObject::Registry &PublicObject::CurrentRegistry() {
+	Registry *registry = _threadRegistry.get();
+	return registry ? *registry : _processRegistry;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void PublicObject::generateId(const std::string &pattern) {
 	_publicID = Util::replace(pattern, _private::Resolver(this));
@@ -42,6 +42,27 @@ class SC_SYSTEM_CORE_API PublicObject : public Object {
 		typedef std::map<std::string, PublicObject*> PublicObjectMap;
 		typedef PublicObjectMap::const_iterator Iterator;
 
+		/**
+		 * A set of registered objects. All threads share the process wide
+		 * registry unless they select their own with SetThreadRegistry,
+		 * e.g. if several applications run as threads of one process.
+		 * Objects that are still registered when the registry is destroyed
+		 * are unregistered.
+		 */
+		class SC_SYSTEM_CORE_API Registry {
+			public:
+				Registry();
+				~Registry();
+
+			private:
+				Registry(const Registry &);
+				Registry &operator=(const Registry &);
+
+				PublicObjectMap _objects;
+
+			friend class PublicObject;
+		};
+
 
 	// ------------------------------------------------------------------
 	//  Xstruction
@@ -115,19 +136,19 @@ class SC_SYSTEM_CORE_API PublicObject : public Object {
 		static PublicObject* Find(const std::string& publicID);
 
 		/**
-		 * Returns the size of the static PublicObject registration map
+		 * Returns the size of the registration map of the calling thread
 		 */
 		static size_t ObjectCount();
 
 		/**
 		 * Returns an iterator to the first element of
-		 * the static PublicObject registration map
+		 * the registration map of the calling thread
 		 */
 		static Iterator Begin();
 
 		/**
 		 * Returns an iterator behind the last element of
-		 * the static PublicObject registration map
+		 * the registration map of the calling thread
 		 */
 		static Iterator End();
 
@@ -190,6 +211,17 @@ class SC_SYSTEM_CORE_API PublicObject : public Object {
 		static void SetRegistrationEnabled(bool enable);
 		static bool IsRegistrationEnabled();
 
+		/**
+		 * Selects the registry used by the calling thread to register and
+		 * find objects. NULL selects the process wide registry which is
+		 * also the default. The registry must outlive its use by the
+		 * thread. Objects are always unregistered from the registry they
+		 * were registered in, regardless of the thread that destroys them.
+		 * @param registry The registry or NULL
+		 */
+		static void SetThreadRegistry(Registry *registry);
+		static Registry *ThreadRegistry();
+
 		//! Updates a child object
 		//! a parent, the method returns false.
 		virtual bool updateChild(Object*) = 0;
@@ -207,12 +239,15 @@ class SC_SYSTEM_CORE_API PublicObject : public Object {
 
 		void generateId(const std::string &pattern);
 
+		static Registry &CurrentRegistry();
+
 
 	private:
 		std::string _publicID;
-		bool _registered;
+		Registry *_registry;
 
-		static PublicObjectMap _publicObjects;
+		static Registry _processRegistry;
+		static boost::thread_specific_ptr<Registry> _threadRegistry;
 
 		static bool _generateIds;
 		static std::string _idPattern;
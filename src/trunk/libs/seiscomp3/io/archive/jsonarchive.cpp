@@ -58,15 +58,18 @@ struct jsonstring {
 };
 
 
-ostream &operator<<(ostream &os, const jsontime_t &js) {
-	//os << js.ref << "000";
-	os << Core::Time(js.ref).toString("\""DATE_FORMAT"\"");
+ostream &operator<<(ostream &os, const jsontime &js) {
+	char buffer[64];
+	size_t length = js.ref.toISO(buffer);
+	os.put('"');
+	os.write(buffer, length);
+	os.put('"');
 	return os;
 }
 
-ostream &operator<<(ostream &os, const jsontime &js) {
-	os << js.ref.toString("\""DATE_FORMAT"\"");
-	return os;
+ostream &operator<<(ostream &os, const jsontime_t &js) {
+	//os << js.ref << "000";
+	return os << jsontime(Core::Time(js.ref));
 }
 
 ostream &operator<<(ostream &os, const jsonstring &js) {
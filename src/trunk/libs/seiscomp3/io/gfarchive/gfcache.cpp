@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/io/gfarchive/gfcache.h>
+#include <boost/thread/mutex.hpp>
+
+#include <list>
+#include <map>
+
+
+namespace Seiscomp {
+namespace IO {
+
+
+namespace {
+
+
+struct CacheItem {
+	std::string                 key;
+	Core::GreensFunctionCPtr    gf;
+	size_t                      bytes;
+};
+
+
+typedef std::list<CacheItem> LRUList;
+typedef std::map<std::string, LRUList::iterator> CacheMap;
+
+
+struct Cache {
+	Cache() : budget(64*1024*1024), usage(0) {}
+
+	void trim() {
+		while ( usage > budget && !items.empty() ) {
+			usage -= items.back().bytes;
+			lookup.erase(items.back().key);
+			items.pop_back();
+		}
+	}
+
+	boost::mutex mutex;
+	size_t       budget;
+	size_t       usage;
+	// Most recently used items first
+	LRUList      items;
+	CacheMap     lookup;
+};
+
+
+Cache &cache() {
+	static Cache *instance = new Cache;
+	return *instance;
+}
+
+
+Cache &cacheInstance = cache();
+
+
+size_t sampleBytes(const Core::GreensFunction *gf) {
+	size_t bytes = 0;
+	for ( int i = 0; i < Core::GreensFunctionComponent::Quantity; ++i ) {
+		const Array *ar = gf->data(i);
+		if ( ar ) bytes += (size_t)ar->size() * ar->bytes();
+	}
+	return bytes;
+}
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void GFCache::SetMemoryBudget(size_t bytes) {
+	Cache &c = cache();
+	boost::mutex::scoped_lock lock(c.mutex);
+	c.budget = bytes;
+	c.trim();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t GFCache::MemoryBudget() {
+	Cache &c = cache();
+	boost::mutex::scoped_lock lock(c.mutex);
+	return c.budget;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t GFCache::MemoryUsage() {
+	Cache &c = cache();
+	boost::mutex::scoped_lock lock(c.mutex);
+	return c.usage;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void GFCache::Clear() {
+	Cache &c = cache();
+	boost::mutex::scoped_lock lock(c.mutex);
+	c.items.clear();
+	c.lookup.clear();
+	c.usage = 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction *GFCache::Get(const std::string &key) {
+	Cache &c = cache();
+	boost::mutex::scoped_lock lock(c.mutex);
+
+	CacheMap::iterator it = c.lookup.find(key);
+	if ( it == c.lookup.end() ) return NULL;
+
+	// Move to front
+	c.items.splice(c.items.begin(), c.items, it->second);
+
+	// Reference counts are not atomic. The cached function must not be
+	// referenced outside the lock, so the copy is made while holding it.
+	return Copy(it->second->gf.get());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void GFCache::Put(const std::string &key, const Core::GreensFunction *gf) {
+	if ( gf == NULL ) return;
+
+	size_t bytes = sampleBytes(gf);
+
+	Cache &c = cache();
+
+	{
+		boost::mutex::scoped_lock lock(c.mutex);
+		if ( bytes > c.budget ) return;
+		if ( c.lookup.find(key) != c.lookup.end() ) return;
+	}
+
+	// The copy is only referenced by the cache. It is handed over while
+	// holding the lock because reference counts are not atomic.
+	Core::GreensFunction *copy = Copy(gf);
+
+	boost::mutex::scoped_lock lock(c.mutex);
+
+	// Another thread could have stored the same key meanwhile
+	if ( c.lookup.find(key) != c.lookup.end() ) {
+		delete copy;
+		return;
+	}
+
+	c.items.push_front(CacheItem());
+	c.items.front().key = key;
+	c.items.front().gf = copy;
+	c.items.front().bytes = bytes;
+	c.lookup[key] = c.items.begin();
+	c.usage += bytes;
+
+	c.trim();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction *GFCache::Copy(const Core::GreensFunction *gf) {
+	Core::GreensFunction *copy =
+		new Core::GreensFunction(gf->model(), gf->distance(), gf->depth(),
+		                         gf->samplingFrequency(), gf->timeOffset());
+	copy->setId(gf->id());
+
+	for ( int i = 0; i < Core::GreensFunctionComponent::Quantity; ++i ) {
+		const Array *ar = gf->data(i);
+		if ( ar ) copy->setData(i, ar->copy(ar->dataType()));
+	}
+
+	return copy;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_IO_GFARCHIVE_GFCACHE_H__
+#define __SEISCOMP_IO_GFARCHIVE_GFCACHE_H__
+
+
+#include <seiscomp3/core/greensfunction.h>
+#include <string>
+
+
+namespace Seiscomp {
+namespace IO {
+
+
+/**
+ * Process wide LRU cache of decoded Green's functions shared by all
+ * GFArchive implementations.
+ *
+ * Archives store the functions as read from their backend under a key that
+ * identifies the source and the requested time span. Callers always get a
+ * deep copy back because the archives modify the returned functions
+ * (interpolation, id, depth). The cache evicts the least recently used
+ * functions if the sample memory exceeds the configured budget.
+ * All methods are thread-safe.
+ */
+class SC_SYSTEM_CORE_API GFCache {
+	public:
+		//! Sets the memory budget in bytes. A budget of 0 disables the
+		//! cache. The default is 64 MiB. Client applications set it from
+		//! gfarchive.cache.memoryBudget.
+		static void SetMemoryBudget(size_t bytes);
+		static size_t MemoryBudget();
+
+		//! Returns the number of bytes occupied by cached samples
+		static size_t MemoryUsage();
+
+		//! Removes all cached functions
+		static void Clear();
+
+		//! Returns a copy of the cached function or NULL if not cached.
+		//! The caller takes ownership.
+		static Core::GreensFunction *Get(const std::string &key);
+
+		//! Stores a copy of gf under key
+		static void Put(const std::string &key, const Core::GreensFunction *gf);
+
+		//! Returns a deep copy of a Green's function
+		static Core::GreensFunction *Copy(const Core::GreensFunction *gf);
+};
+
+
+}
+}
+
+
+#endif
@@ -0,0 +1,358 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT GFPack
+
+#include <seiscomp3/io/gfarchive/gfpack.h>
+#include <seiscomp3/core/typedarray.h>
+#include <seiscomp3/logging/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace Seiscomp {
+namespace IO {
+
+
+namespace {
+
+
+const char PackMagic[8] = { 'S', 'C', '3', 'G', 'F', 'P', 'K', '\0' };
+const int32_t PackFormatVersion = 1;
+const int Components = Core::GreensFunctionComponent::Quantity;
+
+
+struct Header {
+	char    magic[8];
+	int32_t version;
+	int32_t depthCount;
+	int32_t distanceCount;
+	int32_t reserved;
+};
+
+
+int findNode(const std::vector<double> &values, double v) {
+	std::vector<double>::const_iterator it =
+		std::lower_bound(values.begin(), values.end(), v - 1E-6);
+	if ( it == values.end() || fabs(*it - v) > 1E-6 ) return -1;
+	return (int)(it - values.begin());
+}
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+GFPack::Writer::Writer() : _indexOffset(0) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+GFPack::Writer::~Writer() {
+	if ( _ofs.is_open() ) close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool GFPack::Writer::create(const std::string &file,
+                            const std::vector<double> &depths,
+                            const std::vector<double> &distances) {
+	if ( _ofs.is_open() ) return false;
+
+	_depths = depths;
+	_distances = distances;
+	std::sort(_depths.begin(), _depths.end());
+	std::sort(_distances.begin(), _distances.end());
+
+	_ofs.open(file.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if ( !_ofs.is_open() ) return false;
+
+	Header header;
+	memcpy(header.magic, PackMagic, sizeof(PackMagic));
+	header.version = PackFormatVersion;
+	header.depthCount = (int32_t)_depths.size();
+	header.distanceCount = (int32_t)_distances.size();
+	header.reserved = 0;
+
+	_ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if ( !_depths.empty() )
+		_ofs.write(reinterpret_cast<const char*>(&_depths[0]), _depths.size()*sizeof(double));
+	if ( !_distances.empty() )
+		_ofs.write(reinterpret_cast<const char*>(&_distances[0]), _distances.size()*sizeof(double));
+
+	// Reserve space for the index which is written on close
+	Entry empty;
+	memset(&empty, 0, sizeof(empty));
+	_index.assign(_depths.size()*_distances.size(), empty);
+	_indexOffset = (int64_t)_ofs.tellp();
+	_ofs.write(reinterpret_cast<const char*>(&_index[0]), _index.size()*sizeof(Entry));
+
+	return _ofs.good();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool GFPack::Writer::add(double depth, double distance,
+                         const Core::GreensFunction *gf) {
+	if ( !_ofs.is_open() || gf == NULL ) return false;
+
+	int iDepth = findNode(_depths, depth);
+	int iDist = findNode(_distances, distance);
+	if ( iDepth < 0 || iDist < 0 ) {
+		SEISCOMP_ERROR("%f/%f is not a grid node", depth, distance);
+		return false;
+	}
+
+	Entry &entry = _index[iDepth*_distances.size() + iDist];
+	entry.offset = (int64_t)_ofs.tellp();
+	entry.samplingFrequency = gf->samplingFrequency();
+	entry.timeOffset = gf->timeOffset();
+
+	for ( int i = 0; i < Components; ++i ) {
+		const Array *data = gf->data(i);
+		if ( data == NULL ) {
+			entry.counts[i] = 0;
+			continue;
+		}
+
+		FloatArrayPtr tmp;
+		const FloatArray *samples = FloatArray::ConstCast(data);
+		if ( samples == NULL ) {
+			tmp = (FloatArray*)data->copy(Array::FLOAT);
+			samples = tmp.get();
+		}
+
+		entry.counts[i] = samples->size();
+		_ofs.write(reinterpret_cast<const char*>(samples->typedData()),
+		           samples->size()*sizeof(float));
+	}
+
+	return _ofs.good();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool GFPack::Writer::close() {
+	if ( !_ofs.is_open() ) return false;
+
+	_ofs.seekp(_indexOffset);
+	_ofs.write(reinterpret_cast<const char*>(&_index[0]), _index.size()*sizeof(Entry));
+
+	bool success = _ofs.good();
+	_ofs.close();
+	_index.clear();
+
+	return success;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+GFPack::GFPack() : _index(NULL) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+GFPack::~GFPack() {
+	close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool GFPack::open(const std::string &file) {
+	close();
+
+	try {
+		_file.open(file);
+	}
+	catch ( std::exception &e ) {
+		SEISCOMP_ERROR("%s: %s", file.c_str(), e.what());
+		return false;
+	}
+
+	const char *data = _file.data();
+	size_t size = _file.size();
+
+	Header header;
+	if ( size < sizeof(header) ) {
+		SEISCOMP_ERROR("%s: invalid pack header", file.c_str());
+		close();
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+	if ( memcmp(header.magic, PackMagic, sizeof(PackMagic)) ||
+	     header.depthCount < 0 || header.distanceCount < 0 ) {
+		SEISCOMP_ERROR("%s: invalid pack header", file.c_str());
+		close();
+		return false;
+	}
+
+	if ( header.version != PackFormatVersion ) {
+		SEISCOMP_ERROR("%s: unsupported pack version %d", file.c_str(), header.version);
+		close();
+		return false;
+	}
+
+	size_t nodes = (size_t)header.depthCount * header.distanceCount;
+	size_t indexOffset = sizeof(header) +
+	                     (header.depthCount + header.distanceCount)*sizeof(double);
+
+	if ( indexOffset + nodes*sizeof(Entry) > size ) {
+		SEISCOMP_ERROR("%s: truncated pack index", file.c_str());
+		close();
+		return false;
+	}
+
+	_depths.resize(header.depthCount);
+	_distances.resize(header.distanceCount);
+	if ( !_depths.empty() )
+		memcpy(&_depths[0], data + sizeof(header), header.depthCount*sizeof(double));
+	if ( !_distances.empty() )
+		memcpy(&_distances[0], data + sizeof(header) + header.depthCount*sizeof(double),
+		       header.distanceCount*sizeof(double));
+
+	_index = reinterpret_cast<const Entry*>(data + indexOffset);
+
+	// Validate all sample ranges once so that read does not need to
+	for ( size_t i = 0; i < nodes; ++i ) {
+		if ( _index[i].offset == 0 ) continue;
+		size_t samples = 0;
+		for ( int c = 0; c < Components; ++c ) {
+			if ( _index[i].counts[c] < 0 ) samples = size;
+			else samples += _index[i].counts[c];
+		}
+
+		if ( _index[i].offset < 0 ||
+		     (size_t)_index[i].offset + samples*sizeof(float) > size ) {
+			SEISCOMP_ERROR("%s: truncated pack data", file.c_str());
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void GFPack::close() {
+	if ( _file.is_open() ) _file.close();
+	_index = NULL;
+	_depths.clear();
+	_distances.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool GFPack::isOpen() const {
+	return _index != NULL;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::vector<double> &GFPack::depths() const {
+	return _depths;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::vector<double> &GFPack::distances() const {
+	return _distances;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction *GFPack::read(double depth, double distance,
+                                   const Core::TimeSpan &ts) const {
+	if ( _index == NULL ) return NULL;
+
+	int iDepth = findNode(_depths, depth);
+	int iDist = findNode(_distances, distance);
+	if ( iDepth < 0 || iDist < 0 ) return NULL;
+
+	const Entry &entry = _index[iDepth*_distances.size() + iDist];
+	if ( entry.offset == 0 ) return NULL;
+
+	if ( entry.timeOffset >= (double)ts ) {
+		SEISCOMP_ERROR("%f/%f: requested timespan not within range",
+		               depth, distance);
+		return NULL;
+	}
+
+	int maxSamples = (int)(((double)ts - entry.timeOffset) * entry.samplingFrequency);
+
+	Core::GreensFunction *gf = new Core::GreensFunction();
+	gf->setSamplingFrequency(entry.samplingFrequency);
+	gf->setTimeOffset(entry.timeOffset);
+
+	const float *samples = reinterpret_cast<const float*>(_file.data() + entry.offset);
+
+	for ( int i = 0; i < Components; ++i ) {
+		int count = std::min(entry.counts[i], maxSamples);
+		if ( count <= 0 ) {
+			SEISCOMP_WARNING("%f/%f: skipping empty result", depth, distance);
+			delete gf;
+			return NULL;
+		}
+
+		gf->setData(i, new FloatArray(count, samples));
+		samples += entry.counts[i];
+	}
+
+	return gf;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
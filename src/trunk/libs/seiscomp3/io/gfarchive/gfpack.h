@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_IO_GFARCHIVE_GFPACK_H__
+#define __SEISCOMP_IO_GFARCHIVE_GFPACK_H__
+
+
+#include <seiscomp3/core/greensfunction.h>
+#include <seiscomp3/core/datetime.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+
+namespace Seiscomp {
+namespace IO {
+
+
+DEFINE_SMARTPOINTER(GFPack);
+
+
+/**
+ * A packed Green's function archive holding all functions of one model
+ * on a regular depth/distance grid in a single file.
+ *
+ * The file starts with a header and the depth and distance grid followed
+ * by an index with one entry per grid node and the float samples of all
+ * components. The file is memory mapped for reading so a lookup is an
+ * index access and a copy of the samples without any file system access.
+ *
+ * Packs are created with GFPack::Writer, e.g. by the scgfpack tool which
+ * converts sc3gf1d model directories.
+ */
+class SC_SYSTEM_CORE_API GFPack : public Core::BaseObject {
+	// ----------------------------------------------------------------------
+	//  Public types
+	// ----------------------------------------------------------------------
+	public:
+		//! Index entry of a grid node as stored in the file
+		struct Entry {
+			//! File offset of the samples, 0 if the node is not available
+			int64_t offset;
+			double  samplingFrequency;
+			double  timeOffset;
+			//! Number of samples per component
+			int32_t counts[Core::GreensFunctionComponent::Quantity];
+		};
+
+		/**
+		 * Creates a pack file. All nodes must be added between create and
+		 * close. Nodes that have not been added are marked unavailable.
+		 */
+		class SC_SYSTEM_CORE_API Writer {
+			public:
+				Writer();
+				~Writer();
+
+			public:
+				bool create(const std::string &file,
+				            const std::vector<double> &depths,
+				            const std::vector<double> &distances);
+
+				//! Adds the function of a grid node
+				bool add(double depth, double distance,
+				         const Core::GreensFunction *gf);
+
+				//! Writes the index and closes the file
+				bool close();
+
+			private:
+				std::ofstream       _ofs;
+				std::vector<double> _depths;
+				std::vector<double> _distances;
+				std::vector<Entry>  _index;
+				int64_t             _indexOffset;
+		};
+
+
+	// ----------------------------------------------------------------------
+	//  X'truction
+	// ----------------------------------------------------------------------
+	public:
+		GFPack();
+		~GFPack();
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		bool open(const std::string &file);
+		void close();
+
+		bool isOpen() const;
+
+		const std::vector<double> &depths() const;
+		const std::vector<double> &distances() const;
+
+		//! Returns the function of a grid node cut to the given time span
+		//! or NULL if the node is not available. The caller takes
+		//! ownership.
+		Core::GreensFunction *read(double depth, double distance,
+		                           const Core::TimeSpan &ts) const;
+
+
+	// ----------------------------------------------------------------------
+	//  Private members
+	// ----------------------------------------------------------------------
+	private:
+		boost::iostreams::mapped_file_source _file;
+		std::vector<double>                  _depths;
+		std::vector<double>                  _distances;
+		const Entry                         *_index;
+};
+
+
+}
+}
+
+
+#endif
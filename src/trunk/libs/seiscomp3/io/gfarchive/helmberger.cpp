@@ -21,6 +21,7 @@
 #include <seiscomp3/core/greensfunction.h>
 #include <seiscomp3/core/system.h>
 #include <seiscomp3/io/gfarchive/helmberger.h>
+#include <seiscomp3/io/gfarchive/gfcache.h>
 #include <seiscomp3/math/geo.h>
 
 #include <iostream>
@@ -471,6 +472,26 @@ Core::GreensFunction* HelmbergerArchive::get() {
 Core::GreensFunction* HelmbergerArchive::read(const std::string &file,
                                               const Core::TimeSpan &ts,
                                               double timeOfs) {
+	std::string key = "helmberger:" + file + ":" + Core::toString((double)ts) +
+	                  ":" + Core::toString(timeOfs);
+
+	Core::GreensFunction *gf = GFCache::Get(key);
+	if ( gf ) return gf;
+
+	gf = readFile(file, ts, timeOfs);
+	if ( gf ) GFCache::Put(key, gf);
+
+	return gf;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction* HelmbergerArchive::readFile(const std::string &file,
+                                                  const Core::TimeSpan &ts,
+                                                  double timeOfs) {
 	if ( timeOfs >= (double)ts )
 		return NULL;
 
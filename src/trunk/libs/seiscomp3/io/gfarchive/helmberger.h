@@ -75,6 +75,8 @@ class SC_SYSTEM_CORE_API HelmbergerArchive : public GFArchive {
 		bool hasModel(const std::string &) const;
 		Core::GreensFunction* read(const std::string &file,
 		                           const Core::TimeSpan &ts, double timeOfs);
+		Core::GreensFunction* readFile(const std::string &file,
+		                               const Core::TimeSpan &ts, double timeOfs);
 
 
 	// ----------------------------------------------------------------------
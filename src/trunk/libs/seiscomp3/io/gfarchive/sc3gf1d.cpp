@@ -21,6 +21,7 @@
 #include <seiscomp3/core/system.h>
 #include <seiscomp3/math/geo.h>
 #include <seiscomp3/io/gfarchive/sc3gf1d.h>
+#include <seiscomp3/io/gfarchive/gfcache.h>
 #include <seiscomp3/io/records/sacrecord.h>
 
 #include <iostream>
@@ -263,6 +264,38 @@ bool SC3GF1DArchive::setSource(std::string source) {
 	}
 	catch ( ... ) {}
 
+	// Packed models override model directories with the same name
+	try {
+		for ( fs::directory_iterator itr(directory); itr != end_itr; ++itr ) {
+			if ( !fs::is_regular_file(*itr) ) continue;
+
+			std::string name = SC_FS_IT_LEAF(itr);
+			size_t pos = name.rfind(".gfpack");
+			if ( pos == std::string::npos || pos + 7 != name.size() ) continue;
+
+			std::string model = name.substr(0, pos);
+
+			GFPackPtr pack = new GFPack;
+			if ( !pack->open(_baseDirectory + "/" + name) ) {
+				SEISCOMP_WARNING("Unable to open model pack, skipping: %s",
+				                 name.c_str());
+				continue;
+			}
+
+			if ( pack->depths().empty() || pack->distances().empty() ) {
+				SEISCOMP_WARNING("Empty distances or depths in model pack: %s",
+				                 name.c_str());
+				continue;
+			}
+
+			ModelConfig &config = _models[model];
+			config.depths = DoubleList(pack->depths().begin(), pack->depths().end());
+			config.distances = DoubleList(pack->distances().begin(), pack->distances().end());
+			config.pack = pack;
+		}
+	}
+	catch ( ... ) {}
+
 	return !_models.empty();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -392,8 +425,6 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 		Request req = _requests.front();
 		_requests.pop_front();
 
-		std::string pathprefix = _baseDirectory + "/" + req.model + "/";
-
 		int distKm = (int)req.distance;
 		int iDepth = (int)req.depth;
 
@@ -509,18 +540,13 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 		Core::GreensFunction *gf_22;
 
 		if ( (dist == dist1) || (dist == dist2) || (dist1 == dist2) ) {
-			char dep_str[10], dist_str[10];
-			snprintf(dep_str, 10, "%04d", (int)dep*10);
-			snprintf(dist_str, 10, "%05d", (int)dist);
-			std::string file = pathprefix + dep_str + "/" + dist_str + "/" + dep_str + "." + dist_str + ".";
-
 			Core::TimeSpan ts = _defaultTimespan;
 			if ( req.timeSpan ) ts = req.timeSpan;
 
 			//double ofs = dist / _models[req.model].velocity;
 			double ofs = 0;
 
-			Core::GreensFunction *gf = read(file, ts, ofs);
+			Core::GreensFunction *gf = load(req.model, dep, dist, ts, ofs);
 			if ( gf ) {
 				gf->setId(req.id);
 				gf->setModel(req.model);
@@ -529,26 +555,20 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 				gf_11 = gf_12 = gf;
 			}
 			else {
-				SEISCOMP_ERROR("Unable to read %s", file.c_str());
+				SEISCOMP_ERROR("Unable to read %s",
+				               nodeFile(req.model, dep, dist).c_str());
 				continue;
 			}
 		}
 		else {
-			char dep_str[10], dist1_str[10], dist2_str[10];
-			snprintf(dep_str, 10, "%04d", (int)dep*10);
-			snprintf(dist1_str, 10, "%05d", (int)dist1);
-			snprintf(dist2_str, 10, "%05d", (int)dist2);
-			std::string file1 = pathprefix + dep_str + "/" + dist1_str + "/" + dep_str + "." + dist1_str + ".";
-			std::string file2 = pathprefix + dep_str + "/" + dist2_str + "/" + dep_str + "." + dist2_str + ".";
-
 			Core::TimeSpan ts = _defaultTimespan;
 			if ( req.timeSpan ) ts = req.timeSpan;
 
 			//double ofs = dist / _models[req.model].velocity;
 			double ofs = 0;
 
-			Core::GreensFunction *gf1 = read(file1, ts, ofs);
-			Core::GreensFunction *gf2 = read(file2, ts, ofs);
+			Core::GreensFunction *gf1 = load(req.model, dep, dist1, ts, ofs);
+			Core::GreensFunction *gf2 = load(req.model, dep, dist2, ts, ofs);
 			if ( gf1 && gf2 ) {
 				gf1->setId(req.id);
 				gf1->setModel(req.model);
@@ -560,7 +580,8 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 			}
 			else {
 				SEISCOMP_ERROR("Unable to read %s or %s",
-				               file1.c_str(), file2.c_str());
+				               nodeFile(req.model, dep, dist1).c_str(),
+				               nodeFile(req.model, dep, dist2).c_str());
 				if ( gf1 ) delete gf1;
 				if ( gf2 ) delete gf2;
 
@@ -581,18 +602,13 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 		}
 		else {
 			if ( (dist == dist1) || (dist == dist2) || (dist1 == dist2) ) {
-				char dep_str[10], dist_str[10];
-				snprintf(dep_str, 10, "%04d", (int)alt_dep*10);
-				snprintf(dist_str, 10, "%05d", (int)dist);
-				std::string file = pathprefix + dep_str + "/" + dist_str + "/" + dep_str + "." + dist_str + ".";
-
 				Core::TimeSpan ts = _defaultTimespan;
 				if ( req.timeSpan ) ts = req.timeSpan;
 
 				//double ofs = dist / _models[req.model].velocity;
 				double ofs = 0;
 
-				Core::GreensFunction *gf = read(file, ts, ofs);
+				Core::GreensFunction *gf = load(req.model, alt_dep, dist, ts, ofs);
 				if ( gf ) {
 					gf_21 = gf_22 = gf;
 				}
@@ -600,33 +616,28 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 					if ( gf_11 ) delete gf_11;
 					if ( gf_12 && (gf_11 != gf_12) ) delete gf_12;
 
-					SEISCOMP_ERROR("Unable to read %s", file.c_str());
+					SEISCOMP_ERROR("Unable to read %s",
+					               nodeFile(req.model, alt_dep, dist).c_str());
 					continue;
 				}
 			}
 			else {
-				char dep_str[10], dist1_str[10], dist2_str[10];
-				snprintf(dep_str, 10, "%04d", (int)alt_dep*10);
-				snprintf(dist1_str, 10, "%05d", (int)dist1);
-				snprintf(dist2_str, 10, "%05d", (int)dist2);
-				std::string file1 = pathprefix + dep_str + "/" + dist1_str + "/" + dep_str + "." + dist1_str + ".";
-				std::string file2 = pathprefix + dep_str + "/" + dist2_str + "/" + dep_str + "." + dist2_str + ".";
-
 				Core::TimeSpan ts = _defaultTimespan;
 				if ( req.timeSpan ) ts = req.timeSpan;
 
 				//double ofs = dist / _models[req.model].velocity;
 				double ofs = 0;
 
-				Core::GreensFunction *gf1 = read(file1, ts, ofs);
-				Core::GreensFunction *gf2 = read(file2, ts, ofs);
+				Core::GreensFunction *gf1 = load(req.model, alt_dep, dist1, ts, ofs);
+				Core::GreensFunction *gf2 = load(req.model, alt_dep, dist2, ts, ofs);
 				if ( gf1 && gf2 ) {
 					gf_21 = gf1;
 					gf_22 = gf2;
 				}
 				else {
 					SEISCOMP_ERROR("Unable to read %s or %s",
-					               file1.c_str(), file2.c_str());
+					               nodeFile(req.model, alt_dep, dist1).c_str(),
+					               nodeFile(req.model, alt_dep, dist2).c_str());
 					if ( gf1 ) delete gf1;
 					if ( gf2 ) delete gf2;
 
@@ -668,10 +679,115 @@ Core::GreensFunction* SC3GF1DArchive::get() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SC3GF1DArchive::pack(const std::string &model, const std::string &file) {
+	ModelMap::iterator mit = _models.find(model);
+	if ( mit == _models.end() ) {
+		SEISCOMP_ERROR("Unknown model: %s", model.c_str());
+		return false;
+	}
+
+	if ( mit->second.pack ) {
+		SEISCOMP_ERROR("%s: model is already packed", model.c_str());
+		return false;
+	}
+
+	std::vector<double> depths(mit->second.depths.begin(), mit->second.depths.end());
+	std::vector<double> dists(mit->second.distances.begin(), mit->second.distances.end());
+
+	GFPack::Writer writer;
+	if ( !writer.create(file, depths, dists) ) {
+		SEISCOMP_ERROR("%s: unable to create file", file.c_str());
+		return false;
+	}
+
+	// Store the complete traces, requests cut them on load
+	Core::TimeSpan ts(1E6);
+	int missing = 0;
+
+	for ( size_t i = 0; i < depths.size(); ++i ) {
+		for ( size_t j = 0; j < dists.size(); ++j ) {
+			Core::GreensFunction *gf = readSAC(nodeFile(model, depths[i], dists[j]), ts, 0);
+			if ( gf == NULL ) {
+				++missing;
+				continue;
+			}
+
+			bool success = writer.add(depths[i], dists[j], gf);
+			delete gf;
+
+			if ( !success ) {
+				SEISCOMP_ERROR("%s: write error", file.c_str());
+				writer.close();
+				return false;
+			}
+		}
+	}
+
+	if ( missing > 0 )
+		SEISCOMP_WARNING("%s: %d of %d nodes not available", model.c_str(),
+		                 missing, (int)(depths.size()*dists.size()));
+
+	return writer.close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string SC3GF1DArchive::nodeFile(const std::string &model,
+                                     double depth, double distance) const {
+	char dep_str[10], dist_str[10];
+	snprintf(dep_str, 10, "%04d", (int)depth*10);
+	snprintf(dist_str, 10, "%05d", (int)distance);
+	return _baseDirectory + "/" + model + "/" + dep_str + "/" + dist_str + "/" + dep_str + "." + dist_str + ".";
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction* SC3GF1DArchive::load(const std::string &model,
+                                           double depth, double distance,
+                                           const Core::TimeSpan &ts,
+                                           double timeOfs) {
+	ModelMap::iterator mit = _models.find(model);
+	if ( mit != _models.end() && mit->second.pack )
+		return mit->second.pack->read(depth, distance, ts);
+
+	return read(nodeFile(model, depth, distance), ts, timeOfs);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Core::GreensFunction* SC3GF1DArchive::read(const std::string &file,
-                                        const Core::TimeSpan &ts,
-                                        double timeOfs) {
+                                           const Core::TimeSpan &ts,
+                                           double timeOfs) {
+	std::string key = "sc3gf1d:" + file + ":" + Core::toString((double)ts) +
+	                  ":" + Core::toString(timeOfs);
+
+	Core::GreensFunction *gf = GFCache::Get(key);
+	if ( gf ) return gf;
+
+	gf = readSAC(file, ts, timeOfs);
+	if ( gf ) GFCache::Put(key, gf);
+
+	return gf;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::GreensFunction* SC3GF1DArchive::readSAC(const std::string &file,
+                                              const Core::TimeSpan &ts,
+                                              double timeOfs) {
 	Core::GreensFunctionComponent comps[8] = {
 		Core::TSS,
 		Core::TDS,
@@ -16,6 +16,7 @@
 
 
 #include <seiscomp3/io/gfarchive.h>
+#include <seiscomp3/io/gfarchive/gfpack.h>
 
 #include <string>
 #include <map>
@@ -66,14 +67,26 @@ class SC_SYSTEM_CORE_API SC3GF1DArchive : public GFArchive {
 
 		Core::GreensFunction* get();
 
+		//! Converts all functions of a model directory into a single
+		//! packed file which can be placed as <model>.gfpack into the
+		//! base directory.
+		bool pack(const std::string &model, const std::string &file);
+
 
 	// ----------------------------------------------------------------------
 	//  Private member
 	// ----------------------------------------------------------------------
 	private:
 		bool hasModel(const std::string &) const;
+		std::string nodeFile(const std::string &model,
+		                     double depth, double distance) const;
+		Core::GreensFunction* load(const std::string &model,
+		                           double depth, double distance,
+		                           const Core::TimeSpan &ts, double timeOfs);
 		Core::GreensFunction* read(const std::string &file,
 		                           const Core::TimeSpan &ts, double timeOfs);
+		Core::GreensFunction* readSAC(const std::string &file,
+		                              const Core::TimeSpan &ts, double timeOfs);
 
 
 	// ----------------------------------------------------------------------
@@ -94,6 +107,7 @@ class SC_SYSTEM_CORE_API SC3GF1DArchive : public GFArchive {
 		struct ModelConfig {
 			DoubleList distances;
 			DoubleList depths;
+			GFPackPtr  pack;
 		};
 
 		typedef std::map<std::string, ModelConfig> ModelMap;
@@ -0,0 +1,225 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT FIR
+
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/io/recordstream/remez/remez.h>
+#include <seiscomp3/io/recordfilter/fir.h>
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SC_FIR_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace Seiscomp {
+namespace IO {
+namespace FIR {
+
+
+namespace {
+
+
+struct Design {
+	Design(int n, double p, double s, int sc) : N(n), fp(p), fs(s), scale(sc) {}
+
+	bool operator<(const Design &other) const {
+		if ( N != other.N ) return N < other.N;
+		if ( fp != other.fp ) return fp < other.fp;
+		if ( fs != other.fs ) return fs < other.fs;
+		return scale < other.scale;
+	}
+
+	int    N;
+	double fp;
+	double fs;
+	int    scale;
+};
+
+
+typedef std::map<Design, const Coefficients*> DesignMap;
+
+
+struct Cache {
+	boost::mutex mutex;
+	DesignMap    designs;
+};
+
+
+Cache &cache() {
+	static Cache *instance = new Cache;
+	return *instance;
+}
+
+
+Cache &cacheInstance = cache();
+
+
+template <typename T>
+double symmetricDot(const double *h, const T *x, size_t n) {
+	const T *r = x + n - 1;
+	size_t half = n / 2;
+	double s0 = 0, s1 = 0;
+	size_t k = 0;
+
+	for ( ; k+2 <= half; k += 2 ) {
+		s0 += h[k] * ((double)x[k] + (double)r[-(ptrdiff_t)k]);
+		s1 += h[k+1] * ((double)x[k+1] + (double)r[-(ptrdiff_t)k-1]);
+	}
+
+	for ( ; k < half; ++k )
+		s0 += h[k] * ((double)x[k] + (double)r[-(ptrdiff_t)k]);
+
+	if ( n % 2 ) s0 += h[half] * (double)x[half];
+
+	return s0 + s1;
+}
+
+
+#ifdef SC_FIR_SSE2
+template <>
+double symmetricDot<double>(const double *h, const double *x, size_t n) {
+	const double *r = x + n - 2;
+	size_t half = n / 2;
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+	size_t k = 0;
+
+	for ( ; k+4 <= half; k += 4 ) {
+		__m128d rev0 = _mm_loadu_pd(r-k);
+		__m128d rev1 = _mm_loadu_pd(r-k-2);
+		rev0 = _mm_shuffle_pd(rev0, rev0, 1);
+		rev1 = _mm_shuffle_pd(rev1, rev1, 1);
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(h+k), _mm_add_pd(_mm_loadu_pd(x+k), rev0)));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(h+k+2), _mm_add_pd(_mm_loadu_pd(x+k+2), rev1)));
+	}
+
+	double tmp[2];
+	_mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+	double s = tmp[0] + tmp[1];
+
+	for ( ; k < half; ++k )
+		s += h[k] * (x[k] + x[n-1-k]);
+
+	if ( n % 2 ) s += h[half] * x[half];
+
+	return s;
+}
+
+
+template <>
+double symmetricDot<float>(const double *h, const float *x, size_t n) {
+	const float *r = x + n - 4;
+	size_t half = n / 2;
+	__m128d acc0 = _mm_setzero_pd();
+	__m128d acc1 = _mm_setzero_pd();
+	size_t k = 0;
+
+	for ( ; k+4 <= half; k += 4 ) {
+		__m128 fwd = _mm_loadu_ps(x+k);
+		__m128 rev = _mm_loadu_ps(r-k);
+		// Reverse the order of the mirrored samples
+		rev = _mm_shuffle_ps(rev, rev, _MM_SHUFFLE(0,1,2,3));
+		// Add in double precision as the scalar version does
+		__m128d lo = _mm_add_pd(_mm_cvtps_pd(fwd), _mm_cvtps_pd(rev));
+		__m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(fwd, fwd)),
+		                        _mm_cvtps_pd(_mm_movehl_ps(rev, rev)));
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(h+k), lo));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(h+k+2), hi));
+	}
+
+	double tmp[2];
+	_mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+	double s = tmp[0] + tmp[1];
+
+	for ( ; k < half; ++k )
+		s += h[k] * ((double)x[k] + (double)x[n-1-k]);
+
+	if ( n % 2 ) s += h[half] * (double)x[half];
+
+	return s;
+}
+#endif
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const Coefficients *lowpass(int N, double fp, double fs, int scale) {
+	Cache &c = cache();
+	Design design(N, fp, fs, scale);
+
+	boost::mutex::scoped_lock lock(c.mutex);
+
+	DesignMap::iterator it = c.designs.find(design);
+	if ( it != c.designs.end() ) return it->second;
+
+	// Create and cache coefficients for N
+	int Ncoeff = N*scale*2+1;
+
+	Coefficients *coeff = new Coefficients(Ncoeff);
+
+	SEISCOMP_DEBUG("[dec] caching %d coefficents for N=%d", Ncoeff, N);
+
+	double bands[4] = {0,0.5*(fp/N),0.5*(fs/N),0.5};
+	double weights[2] = {1,1};
+	double desired[2] = {1,0};
+
+	remez(&((*coeff)[0]), Ncoeff, 2, bands, desired, weights, BANDPASS);
+
+	c.designs[design] = coeff;
+
+	return coeff;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double apply(const Coefficients &coefficients, const double *samples) {
+	return symmetricDot(&coefficients[0], samples, coefficients.size());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double apply(const Coefficients &coefficients, const float *samples) {
+	return symmetricDot(&coefficients[0], samples, coefficients.size());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double apply(const Coefficients &coefficients, const int *samples) {
+	return symmetricDot(&coefficients[0], samples, coefficients.size());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
+}
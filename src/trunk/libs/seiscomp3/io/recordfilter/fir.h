@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_IO_RECORDFILTER_FIR_H__
+#define __SEISCOMP_IO_RECORDFILTER_FIR_H__
+
+
+#include <seiscomp3/core.h>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace IO {
+namespace FIR {
+
+
+typedef std::vector<double> Coefficients;
+
+
+/**
+ * Returns the lowpass coefficients used to decimate by factor N. The
+ * coefficients are designed with the Remez exchange algorithm once per
+ * parameter set and cached for the lifetime of the process. The returned
+ * coefficients are never modified or released and can be shared between
+ * threads without further locking.
+ * @param N The decimation factor
+ * @param fp The end of the passband relative to the target Nyquist frequency
+ * @param fs The start of the stopband relative to the target Nyquist frequency
+ * @param scale The number of coefficients per side and unit of N
+ */
+SC_SYSTEM_CORE_API
+const Coefficients *lowpass(int N, double fp, double fs, int scale);
+
+
+/**
+ * Computes the output sample of a linear phase (symmetric) filter. The
+ * symmetry is used to halve the number of multiplications and the
+ * float and double versions are vectorized with SSE2 if available.
+ * @param coefficients The filter coefficients
+ * @param samples Contiguous samples, at least coefficients.size()
+ */
+SC_SYSTEM_CORE_API
+double apply(const Coefficients &coefficients, const double *samples);
+
+SC_SYSTEM_CORE_API
+double apply(const Coefficients &coefficients, const float *samples);
+
+SC_SYSTEM_CORE_API
+double apply(const Coefficients &coefficients, const int *samples);
+
+
+}
+}
+}
+
+
+#endif
@@ -16,7 +16,6 @@
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/core/typedarray.h>
 #include <seiscomp3/math/math.h>
-#include <seiscomp3/io/recordstream/remez/remez.h>
 #include <seiscomp3/io/recordfilter/resample.h>
 
 #include <limits.h>
@@ -131,6 +130,31 @@ bool getFraction(int &num, int &den, double value, double epsilon = 1E-5, int ma
 
 
 
+// Appends samples to a mirrored ring buffer and returns the new front
+template <typename T>
+size_t push(T *buffer, size_t length, size_t front, const T *data, size_t count) {
+	if ( count > length ) {
+		front = (front + count - length) % length;
+		data += count - length;
+		count = length;
+	}
+
+	size_t chunk = std::min(count, length - front);
+	memcpy(buffer + front, data, chunk*sizeof(T));
+	memcpy(buffer + front + length, data, chunk*sizeof(T));
+
+	if ( chunk < count ) {
+		memcpy(buffer, data + chunk, (count-chunk)*sizeof(T));
+		memcpy(buffer + length, data + chunk, (count-chunk)*sizeof(T));
+	}
+
+	front += count;
+	if ( front >= length ) front -= length;
+
+	return front;
+}
+
+
 GenericRecord *createRecord(const Record *rec) {
 	return new GenericRecord(rec->networkCode(), rec->stationCode(),
 	                         rec->locationCode(), rec->channelCode(),
@@ -192,38 +216,14 @@ Array::DataType dataType<int>() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-int RecordResamplerBase::_instanceCount = 0;
-RecordResamplerBase::CoefficientMap RecordResamplerBase::_coefficients;
-Util::mutex RecordResamplerBase::_coefficientMutex;
+RecordResamplerBase::RecordResamplerBase() {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-RecordResamplerBase::RecordResamplerBase() {
-	_coefficientMutex.lock();
-	++_instanceCount;
-	_coefficientMutex.unlock();
-}
-// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-
-
-
-
-// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-RecordResamplerBase::~RecordResamplerBase() {
-	// If the last instance is deleted clean the coefficients table
-	_coefficientMutex.lock();
-	--_instanceCount;
-	if ( _instanceCount == 0 ) {
-		 CoefficientMap::iterator it;
-		 for ( it = _coefficients.begin(); it != _coefficients.end(); ++it )
-				 delete it->second;
-		 _coefficients.clear();
-	}
-	_coefficientMutex.unlock();
-}
+RecordResamplerBase::~RecordResamplerBase() {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -304,8 +304,20 @@ void RecordResampler<T>::init(UpsampleStage *stage, const Record *rec, int N) {
 	stage->N2 = stage->width;
 	// The sample itself, the width to the right and to the left and a buffer
 	// on the left side
-	stage->buffer.resize(stage->width*2+1+1);
+	stage->length = stage->width*2+1+1;
+	stage->buffer.resize(stage->length*2);
 	stage->dt = 1.0 / stage->sampleRate;
+
+	// Precompute the kernel weights of all output phases
+	int taps = stage->width*2+1;
+	double xi = 0.0;
+	stage->weights.resize(stage->N*taps);
+	for ( int n = 0; n < stage->N; ++n ) {
+		for ( int a = -stage->width; a <= stage->width; ++a )
+			stage->weights[n*taps+a+stage->width] = Lanczos(xi-a,stage->width);
+		xi += stage->downRatio;
+	}
+
 	stage->reset();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -382,7 +394,9 @@ GenericRecord *RecordResampler<T>::resample(DownsampleStage *stage, const Record
 		}
 
 		size_t toCopy = std::min(stage->missingSamples, data_len);
-		memcpy(buffer + stage->buffer.size() - stage->missingSamples,
+		memcpy(buffer + stage->length - stage->missingSamples,
+		       data, toCopy*sizeof(T));
+		memcpy(buffer + 2*stage->length - stage->missingSamples,
 		       data, toCopy*sizeof(T));
 		data += toCopy;
 		data_len -= toCopy;
@@ -402,13 +416,7 @@ GenericRecord *RecordResampler<T>::resample(DownsampleStage *stage, const Record
 	do {
 		if ( stage->samplesToSkip == 0 ) {
 			// Calculate scalar product of coefficients and ring buffer
-			double *coeff = &((*stage->coefficients)[0]);
-			double weightedSum = 0;
-
-			for ( size_t i = stage->front; i < stage->buffer.size(); ++i )
-				weightedSum += buffer[i] * *(coeff++);
-			for ( size_t i = 0; i < stage->front; ++i )
-				weightedSum += buffer[i] * *(coeff++);
+			double weightedSum = FIR::apply(*stage->coefficients, buffer + stage->front);
 
 			if ( !resampled_data ) {
 				startTime = stage->startTime + Core::TimeSpan(stage->dt*stage->N2);
@@ -426,26 +434,8 @@ GenericRecord *RecordResampler<T>::resample(DownsampleStage *stage, const Record
 
 		size_t num_samples = std::min(stage->samplesToSkip, data_len);
 
-		size_t chunk_size = std::min(num_samples, stage->buffer.size()-stage->front);
-		memcpy(buffer + stage->front, data, chunk_size*sizeof(T));
-
-		data += chunk_size;
-
-		// Split chunks
-		if ( chunk_size < num_samples ) {
-			chunk_size = num_samples - chunk_size;
-
-			memcpy(buffer, data, chunk_size*sizeof(T));
-
-			stage->front = chunk_size;
-
-			data += chunk_size;
-		}
-		else {
-			stage->front += chunk_size;
-			if ( stage->front >= stage->buffer.size() )
-				stage->front -= stage->buffer.size();
-		}
+		stage->front = push(buffer, stage->length, stage->front, data, num_samples);
+		data += num_samples;
 
 		stage->startTime += Core::TimeSpan(stage->dt*num_samples);
 		stage->samplesToSkip -= num_samples;
@@ -524,7 +514,9 @@ GenericRecord *RecordResampler<T>::resample(UpsampleStage *stage, const Record *
 
 	if ( stage->missingSamples > 0 ) {
 		size_t toCopy = std::min(stage->missingSamples, data_len);
-		memcpy(buffer + stage->buffer.size() - stage->missingSamples,
+		memcpy(buffer + stage->length - stage->missingSamples,
+		       data, toCopy*sizeof(T));
+		memcpy(buffer + 2*stage->length - stage->missingSamples,
 		       data, toCopy*sizeof(T));
 		data += toCopy;
 		data_len -= toCopy;
@@ -541,50 +533,32 @@ GenericRecord *RecordResampler<T>::resample(UpsampleStage *stage, const Record *
 	typename Core::SmartPointer< TypedArray<T> >::Impl resampled_data;
 	Core::Time startTime;
 
-	while ( data_len > 0 ) {
-		double xi = 0.0;
+	int taps = stage->width*2+1;
 
-		if ( !resampled_data ) {
-			startTime = stage->startTime + Core::TimeSpan(stage->dt*stage->N2);
-			resampled_data = new TypedArray<T>;
-		}
+	if ( data_len > 0 ) {
+		startTime = stage->startTime + Core::TimeSpan(stage->dt*stage->N2);
+		resampled_data = new TypedArray<T>(data_len*stage->N);
+	}
 
-		// Generate N new samples (upsampling)
-		for ( int n = 0; n < stage->N; ++n ) {
-			// Calculate Lanzcos kernel
-			double weightedSum = 0;
-			int a = -stage->width;
-			size_t bi = stage->front;
+	T *out = resampled_data ? resampled_data->typedData() : NULL;
 
-			for ( ; a <= stage->width; ++a, ++bi ) {
-				if ( bi == stage->buffer.size() ) bi -= stage->buffer.size();
-				weightedSum += buffer[bi]*Lanczos(xi-a,stage->width);
-			}
+	while ( data_len > 0 ) {
+		const T *window = buffer + stage->front;
+		const double *weights = &stage->weights[0];
 
-			xi += stage->downRatio;
+		// Generate N new samples (upsampling) with the precomputed
+		// Lanczos kernel of each phase
+		for ( int n = 0; n < stage->N; ++n, weights += taps ) {
+			double weightedSum = 0;
+			for ( int a = 0; a < taps; ++a )
+				weightedSum += window[a]*weights[a];
 
-			T sample = (T)weightedSum;
-			resampled_data->append(1, &sample);
+			*out++ = (T)weightedSum;
 		}
 
 		// Push the sample to the ring buffer
-		size_t chunk_size = std::min((size_t)1, stage->buffer.size()-stage->front);
-		memcpy(buffer + stage->front, data, chunk_size*sizeof(T));
-
-		data += chunk_size;
-
-		// Split chunks
-		if ( chunk_size < 1 ) {
-			chunk_size = 1 - chunk_size;
-			memcpy(buffer, data, chunk_size*sizeof(T));
-			stage->front = chunk_size;
-			data += chunk_size;
-		}
-		else {
-			stage->front += chunk_size;
-			if ( stage->front >= stage->buffer.size() )
-				stage->front -= stage->buffer.size();
-		}
+		buffer[stage->front] = buffer[stage->front + stage->length] = *data++;
+		if ( ++stage->front >= stage->length ) stage->front = 0;
 
 		stage->startTime += Core::TimeSpan(stage->dt);
 		--data_len;
@@ -713,70 +687,38 @@ Record *RecordResampler<T>::feed(const Record *record) {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 template <typename T>
 void RecordResampler<T>::initCoefficients(DownsampleStage *stage) {
-	_coefficientMutex.lock();
+	if ( stage->N > _maxN ) {
+		for ( int i = _maxN; i > 1; --i ) {
+			if ( stage->N % i == 0 ) {
+				int nextStageN = stage->N / i;
 
-	CoefficientMap::iterator it = _coefficients.find(stage->N);
-	if ( it != _coefficients.end() )
-		stage->coefficients = it->second;
-	else {
-		stage->coefficients = NULL;
-
-		if ( stage->N > _maxN ) {
-			for ( int i = _maxN; i > 1; --i ) {
-				if ( stage->N % i == 0 ) {
-					int nextStageN = stage->N / i;
-
-					//SEISCOMP_DEBUG("[dec] clipping N=%d to %d and create sub stage",
-					//               stage->N, i);
-
-					stage->N = i;
-					stage->targetRate = stage->sampleRate / stage->N;
+				//SEISCOMP_DEBUG("[dec] clipping N=%d to %d and create sub stage",
+				//               stage->N, i);
 
-					DownsampleStage *nextStage = new DownsampleStage;
-					nextStage->sampleRate = stage->targetRate;
-					nextStage->targetRate = _targetRate;
-					nextStage->N = nextStageN;
+				stage->N = i;
+				stage->targetRate = stage->sampleRate / stage->N;
 
-					_coefficientMutex.unlock();
-					initCoefficients(nextStage);
-					_coefficientMutex.lock();
+				DownsampleStage *nextStage = new DownsampleStage;
+				nextStage->sampleRate = stage->targetRate;
+				nextStage->targetRate = _targetRate;
+				nextStage->N = nextStageN;
+				initCoefficients(nextStage);
 
-					stage->nextStage = nextStage;
+				stage->nextStage = nextStage;
 
-					break;
-				}
+				break;
 			}
-
-			CoefficientMap::iterator it = _coefficients.find(stage->N);
-			if ( it != _coefficients.end() )
-				stage->coefficients = it->second;
-		}
-
-		if ( stage->coefficients == NULL ) {
-			// Create and cache coefficients for N
-			int Ncoeff = stage->N*_coeffScale*2+1;
-
-			Coefficients *coeff = new Coefficients(Ncoeff);
-
-			SEISCOMP_DEBUG("[dec] caching %d coefficents for N=%d", Ncoeff, stage->N);
-
-			double bands[4] = {0,0.5*(_fp/stage->N),0.5*(_fs/stage->N),0.5};
-			double weights[2] = {1,1};
-			double desired[2] = {1,0};
-
-			remez(&((*coeff)[0]), Ncoeff, 2, bands, desired, weights, BANDPASS);
-
-			_coefficients[stage->N] = coeff;
-			stage->coefficients = coeff;
 		}
 	}
 
+	// The coefficients are shared read-only between all instances
+	stage->coefficients = FIR::lowpass(stage->N, _fp, _fs, _coeffScale);
+
 	stage->dt = 1.0 / stage->sampleRate;
 	stage->N2 = stage->coefficients->size() / 2;
-	stage->buffer.resize(stage->coefficients->size());
+	stage->length = stage->coefficients->size();
+	stage->buffer.resize(stage->length*2);
 	stage->reset();
-
-	_coefficientMutex.unlock();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -18,10 +18,9 @@
 
 #include <seiscomp3/io/recordfilter.h>
 #include <seiscomp3/core/genericrecord.h>
-#include <seiscomp3/utils/mutex.h>
+#include <seiscomp3/io/recordfilter/fir.h>
 
 #include <deque>
-#include <map>
 
 
 namespace Seiscomp {
@@ -40,12 +39,7 @@ class SC_SYSTEM_CORE_API RecordResamplerBase : public RecordFilterInterface {
 		virtual void reset();
 
 	protected:
-		typedef std::vector<double> Coefficients;
-		typedef std::map<int, Coefficients*> CoefficientMap;
-
-		static int                   _instanceCount;
-		static CoefficientMap        _coefficients;
-		static Util::mutex           _coefficientMutex;
+		typedef FIR::Coefficients Coefficients;
 
 		double                       _currentRate;
 		double                       _targetRate;
@@ -106,7 +100,13 @@ class SC_SYSTEM_CORE_API RecordResampler : public RecordResamplerBase {
 			int N;
 			int N2;
 
+			// The number of samples in the ring buffer
+			size_t length;
+
 			// The ring buffer that holds the last samples for downsampling.
+			// It is allocated twice as large and each sample is stored
+			// at its position and at position+length so that the samples
+			// starting at front are always contiguous.
 			std::vector<T> buffer;
 
 			// The number of samples still missing in the buffer before
@@ -123,7 +123,7 @@ class SC_SYSTEM_CORE_API RecordResampler : public RecordResamplerBase {
 			Seiscomp::Core::Time lastEndTime;
 
 			void reset() {
-				missingSamples = buffer.size();
+				missingSamples = length;
 				front = 0;
 				startTime = Seiscomp::Core::Time();
 				lastEndTime = Seiscomp::Core::Time();
@@ -140,7 +140,7 @@ class SC_SYSTEM_CORE_API RecordResampler : public RecordResamplerBase {
 
 			size_t samplesToSkip;
 
-			Coefficients *coefficients;
+			const Coefficients *coefficients;
 
 			DownsampleStage *nextStage;
 
@@ -154,6 +154,9 @@ class SC_SYSTEM_CORE_API RecordResampler : public RecordResamplerBase {
 		struct UpsampleStage : Stage {
 			double downRatio;
 			int width;
+
+			// The Lanczos kernel weights for each of the N output phases
+			std::vector<double> weights;
 		};
 
 		void initCoefficients(DownsampleStage *stage);
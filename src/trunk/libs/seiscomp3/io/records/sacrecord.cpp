@@ -19,6 +19,7 @@
 #include <seiscomp3/io/records/sac.h>
 #include <seiscomp3/core/arrayfactory.h>
 #include <seiscomp3/core/typedarray.h>
+#include <seiscomp3/core/streamregistry.h>
 
 
 namespace Seiscomp {
@@ -253,6 +254,7 @@ void SACRecord::read(std::istream &in) throw(Core::StreamException) {
 	copy_buf(_sta, 8, header.kstnm);
 	copy_buf(_loc, 8, header.khole);
 	copy_buf(_cha, 8, header.kcmpnm);
+	_streamHandle = StreamRegistry::InvalidHandle;
 
 	_fsamp = 1.0 / header.delta;
 
@@ -0,0 +1,767 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT CACHE
+
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/core/strings.h>
+#include <seiscomp3/io/records/mseedrecord.h>
+#include <seiscomp3/system/environment.h>
+#include <seiscomp3/utils/files.h>
+
+#include <algorithm>
+#include <fstream>
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include "cache.h"
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::IO;
+using namespace Seiscomp::RecordStream;
+
+
+REGISTER_RECORDSTREAM(Cache, "cache");
+
+
+namespace {
+
+
+// The default cache size in megabytes
+const size_t DefaultSize = 512;
+
+
+bool hasWildcards(const string &code) {
+	return code.find_first_of("*?") != string::npos;
+}
+
+
+bool byStartTime(const Core::TimeWindow &a, const Core::TimeWindow &b) {
+	return a.startTime() < b.startTime();
+}
+
+
+bool byLastAccess(const pair<Core::Time, size_t> &a,
+                  const pair<Core::Time, size_t> &b) {
+	return a.first < b.first;
+}
+
+
+// Names chunks by their content (64 bit FNV-1a)
+string contentName(const string &data) {
+	uint64_t hash = 14695981039346656037ULL;
+	for ( size_t i = 0; i < data.size(); ++i ) {
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	char buf[24];
+	snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+	return buf;
+}
+
+
+}
+
+
+Cache::Cache()
+: _stream(stringstream::in|stringstream::out|stringstream::binary) {
+	_maxSize = DefaultSize*1024*1024;
+	_lockFd = -1;
+	_prepared = false;
+	_fetching = false;
+	_failed = false;
+	_closed = false;
+}
+
+
+Cache::~Cache() {
+	close();
+	unlock();
+}
+
+
+bool Cache::setSource(string name) {
+	close();
+
+	_source = NULL;
+	_requests.clear();
+	_routes.clear();
+	_usedChunks.clear();
+	_queue.clear();
+	_prepared = false;
+	_fetching = false;
+	_failed = false;
+	_closed = false;
+	_directory = Environment::Instance()->configDir() + "/cache/waveforms";
+	_maxSize = DefaultSize*1024*1024;
+
+	size_t pos = name.find("??");
+	if ( pos != string::npos ) {
+		string params = name.substr(pos+2);
+		name.erase(pos);
+
+		vector<string> toks;
+		Core::split(toks, params.c_str(), "&");
+		for ( vector<string>::iterator it = toks.begin();
+		      it != toks.end(); ++it ) {
+			string key, value;
+
+			pos = it->find('=');
+			if ( pos != string::npos ) {
+				key = it->substr(0, pos);
+				value = it->substr(pos+1);
+			}
+			else
+				key = *it;
+
+			if ( key == "dir" ) {
+				if ( value.empty() ) {
+					SEISCOMP_ERROR("Invalid cache value for '%s': expected a directory",
+					               key.c_str());
+					throw RecordStreamException("invalid dir parameter value");
+				}
+
+				_directory = Environment::Instance()->absolutePath(value);
+			}
+			else if ( key == "size" ) {
+				int size;
+				if ( !Core::fromString(size, value) || size < 0 ) {
+					SEISCOMP_ERROR("Invalid cache value for '%s': expected a positive number of megabytes",
+					               key.c_str());
+					throw RecordStreamException("invalid size parameter value");
+				}
+
+				_maxSize = size_t(size)*1024*1024;
+			}
+			else {
+				SEISCOMP_ERROR("Invalid cache parameter: %s", key.c_str());
+				throw RecordStreamException("invalid cache parameter");
+			}
+		}
+	}
+
+	pos = name.find('/');
+	if ( pos == string::npos ) {
+		SEISCOMP_ERROR("Invalid address, expected '/'");
+		return false;
+	}
+
+	string addr = name.substr(pos+1);
+	name.erase(pos);
+
+	_source = Create(name.c_str());
+	if ( !_source ) {
+		SEISCOMP_ERROR("Unable to create proxy service: %s", name.c_str());
+		return false;
+	}
+
+	if ( !_source->setSource(addr) ) {
+		_source = NULL;
+		return false;
+	}
+
+	if ( !Util::pathExists(_directory) && !Util::createPath(_directory) ) {
+		SEISCOMP_WARNING("Unable to create cache directory %s: caching disabled",
+		                 _directory.c_str());
+		_directory = "";
+	}
+
+	return true;
+}
+
+
+bool Cache::setRecordType(const char *type) {
+	if ( _source ) return _source->setRecordType(type);
+	return false;
+}
+
+
+bool Cache::addStream(string net, string sta,
+                      string loc, string cha) {
+	if ( !_source || _prepared ) return false;
+
+	Request req;
+	req.net = net; req.sta = sta; req.loc = loc; req.cha = cha;
+	req.hasTimeWindow = false;
+	req.cached = req.merge = false;
+	_requests.push_back(req);
+	return true;
+}
+
+
+bool Cache::addStream(string net, string sta,
+                      string loc, string cha,
+                      const Seiscomp::Core::Time &stime,
+                      const Seiscomp::Core::Time &etime) {
+	if ( !_source || _prepared ) return false;
+
+	Request req;
+	req.net = net; req.sta = sta; req.loc = loc; req.cha = cha;
+	req.startTime = stime;
+	req.endTime = etime;
+	req.hasTimeWindow = true;
+	req.cached = req.merge = false;
+	_requests.push_back(req);
+	return true;
+}
+
+
+bool Cache::setStartTime(const Seiscomp::Core::Time &stime) {
+	if ( !_source ) return false;
+	_startTime = stime;
+	return _source->setStartTime(stime);
+}
+
+
+bool Cache::setEndTime(const Seiscomp::Core::Time &etime) {
+	if ( !_source ) return false;
+	_endTime = etime;
+	return _source->setEndTime(etime);
+}
+
+
+bool Cache::setTimeWindow(const Seiscomp::Core::TimeWindow &w) {
+	if ( !_source ) return false;
+	_startTime = w.startTime();
+	_endTime = w.endTime();
+	return _source->setTimeWindow(w);
+}
+
+
+bool Cache::setTimeout(int seconds) {
+	if ( !_source ) return false;
+	return _source->setTimeout(seconds);
+}
+
+
+void Cache::close() {
+	// Data of an interrupted acquisition must not be stored
+	_closed = true;
+
+	if ( _source ) {
+		SEISCOMP_DEBUG("Closing proxy source");
+		_source->close();
+	}
+}
+
+
+Record *Cache::createRecord(Array::DataType dt, Record::Hint hint) {
+	return new MSeedRecord(dt, hint);
+}
+
+
+void Cache::recordStored(Record *rec) {}
+
+
+istream &Cache::stream() {
+	if ( !_source ) {
+		SEISCOMP_ERROR("[cache] no source defined");
+		_stream.clear(ios::eofbit);
+		return _stream;
+	}
+
+	if ( !_prepared ) prepare();
+
+	while ( _queue.empty() && _fetching ) {
+		std::istream *istr;
+
+		try {
+			istr = &_source->stream();
+		}
+		catch ( ... ) {
+			// Errors and timeouts of the source leave the gaps incomplete
+			_failed = true;
+			finish();
+			throw;
+		}
+
+		if ( !istr->good() ) {
+			if ( istr->bad() || istr->fail() ) _failed = true;
+			finish();
+			break;
+		}
+
+		RecordPtr rec = _source->createRecord(Array::INT, Record::SAVE_RAW);
+		if ( !rec ) continue;
+
+		try {
+			rec->read(*istr);
+		}
+		catch ( Core::EndOfStreamException & ) {
+			SEISCOMP_INFO("End of stream detected");
+			finish();
+			break;
+		}
+		catch ( Core::StreamException &e ) {
+			SEISCOMP_ERROR("RecordStream read exception: %s", e.what());
+			_failed = true;
+			continue;
+		}
+
+		_source->recordStored(rec.get());
+		if ( _source->filterRecord(rec.get()) ) continue;
+
+		feed(rec.get());
+	}
+
+	if ( _queue.empty() ) {
+		_stream.clear(ios::eofbit);
+		return _stream;
+	}
+
+	_stream.str(_queue.front());
+	_stream.clear();
+	_queue.pop_front();
+
+	return _stream;
+}
+
+
+void Cache::prepare() {
+	_prepared = true;
+	_fetchTime = Core::Time::GMT();
+
+	Index index;
+	bool useCache = !_directory.empty() && lock();
+	if ( useCache ) readIndex(index);
+
+	for ( size_t i = 0; i < _requests.size(); ++i ) {
+		Request &req = _requests[i];
+
+		Core::Time stime = req.hasTimeWindow ? req.startTime : _startTime;
+		Core::Time etime = req.hasTimeWindow ? req.endTime : _endTime;
+		string streamID = req.net + "." + req.sta + "." + req.loc + "." + req.cha;
+
+		req.cached = useCache && stime.valid() && etime.valid() && stime < etime &&
+		             !hasWildcards(streamID) && _routes.find(streamID) == _routes.end();
+
+		if ( !req.cached ) {
+			if ( req.hasTimeWindow )
+				_source->addStream(req.net, req.sta, req.loc, req.cha, req.startTime, req.endTime);
+			else
+				_source->addStream(req.net, req.sta, req.loc, req.cha);
+			_fetching = true;
+			continue;
+		}
+
+		_routes[streamID] = i;
+
+		Core::TimeWindow tw(stime, etime);
+		vector<Core::TimeWindow> covered;
+		set<string> loaded;
+
+		for ( Index::iterator it = index.begin(); it != index.end(); ++it ) {
+			if ( it->streamID != streamID ) continue;
+			if ( it->endTime <= stime || it->startTime >= etime ) continue;
+
+			if ( !it->chunk.empty() && loaded.find(it->chunk) == loaded.end() ) {
+				if ( !readChunk(it->chunk, tw, req.records) ) continue;
+				loaded.insert(it->chunk);
+			}
+
+			_usedChunks.insert(it->chunk);
+			covered.push_back(Core::TimeWindow(it->startTime, it->endTime));
+		}
+
+		// Collect the gaps of the request window that are not covered
+		std::sort(covered.begin(), covered.end(), byStartTime);
+		Core::Time t = stime;
+		for ( size_t c = 0; c < covered.size() && t < etime; ++c ) {
+			if ( covered[c].startTime() > t )
+				req.gaps.push_back(Core::TimeWindow(t, std::min(covered[c].startTime(), etime)));
+			if ( covered[c].endTime() > t )
+				t = covered[c].endTime();
+		}
+
+		if ( t < etime )
+			req.gaps.push_back(Core::TimeWindow(t, etime));
+
+		req.received.resize(req.gaps.size());
+
+		for ( size_t g = 0; g < req.gaps.size(); ++g ) {
+			_source->addStream(req.net, req.sta, req.loc, req.cha,
+			                   req.gaps[g].startTime(), req.gaps[g].endTime());
+			_fetching = true;
+		}
+
+		SEISCOMP_DEBUG("[cache] %s: %d cached records, %d gaps",
+		               streamID.c_str(), (int)req.records.size(), (int)req.gaps.size());
+
+		// Records of streams that are cached only partly are sent sorted
+		// together with the fetched records when the source has finished
+		if ( !req.gaps.empty() && !req.records.empty() )
+			req.merge = true;
+		else {
+			for ( Records::iterator it = req.records.begin(); it != req.records.end(); ++it )
+				_queue.push_back(it->second);
+			req.records.clear();
+		}
+	}
+
+	if ( useCache ) unlock();
+
+	if ( !_fetching ) finish();
+}
+
+
+void Cache::feed(Record *rec) {
+	const MSeedRecord *msrec = MSeedRecord::ConstCast(rec);
+	const Array *raw = msrec ? msrec->raw() : NULL;
+	if ( raw == NULL || raw->size() <= 0 ) {
+		SEISCOMP_WARNING("[cache] %s: skipping record that is not raw miniSEED",
+		                 rec->streamID().c_str());
+		return;
+	}
+
+	string bytes(static_cast<const char*>(raw->data()), raw->size());
+
+	Routes::iterator it = _routes.find(rec->streamID());
+	if ( it == _routes.end() ) {
+		_queue.push_back(bytes);
+		return;
+	}
+
+	Request &req = _requests[it->second];
+	req.data += bytes;
+
+	for ( size_t g = 0; g < req.gaps.size(); ++g ) {
+		if ( rec->endTime() <= req.gaps[g].startTime() ||
+		     rec->startTime() >= req.gaps[g].endTime() )
+			continue;
+
+		Core::Time end = std::min(rec->endTime(), req.gaps[g].endTime());
+		if ( !req.received[g].valid() || end > req.received[g] )
+			req.received[g] = end;
+	}
+
+	if ( req.merge )
+		req.records.insert(Records::value_type(rec->startTime(), bytes));
+	else
+		_queue.push_back(bytes);
+}
+
+
+void Cache::finish() {
+	_fetching = false;
+
+	for ( Requests::iterator it = _requests.begin(); it != _requests.end(); ++it ) {
+		if ( !it->merge ) continue;
+		for ( Records::iterator rit = it->records.begin(); rit != it->records.end(); ++rit )
+			_queue.push_back(rit->second);
+		it->records.clear();
+	}
+
+	if ( _closed || _directory.empty() ) return;
+
+	if ( _failed ) {
+		SEISCOMP_WARNING("[cache] source did not finish cleanly: fetched data is not stored");
+		return;
+	}
+
+	commit();
+}
+
+
+void Cache::commit() {
+	if ( !lock() ) return;
+
+	Index index;
+	readIndex(index);
+
+	Core::Time now = Core::Time::GMT();
+
+	for ( Index::iterator it = index.begin(); it != index.end(); ++it ) {
+		if ( _usedChunks.find(it->chunk) != _usedChunks.end() )
+			it->lastAccess = now;
+	}
+
+	for ( Requests::iterator it = _requests.begin(); it != _requests.end(); ++it ) {
+		// Gaps without any data are not stored but requested again
+		if ( !it->cached || it->data.empty() ) continue;
+
+		string chunk = writeChunk(it->data);
+		if ( chunk.empty() ) continue;
+
+		Entry entry;
+		entry.streamID = it->net + "." + it->sta + "." + it->loc + "." + it->cha;
+		entry.chunk = chunk;
+		entry.bytes = it->data.size();
+		entry.lastAccess = now;
+
+		for ( size_t g = 0; g < it->gaps.size(); ++g ) {
+			if ( !it->received[g].valid() ) continue;
+
+			// Data after the last received record, e.g. not yet available
+			// at the time of the request, must be requested again
+			entry.startTime = it->gaps[g].startTime();
+			entry.endTime = std::min(it->received[g], _fetchTime);
+			if ( entry.endTime <= entry.startTime ) continue;
+			index.push_back(entry);
+		}
+
+		it->data.clear();
+	}
+
+	compact(index);
+	evict(index);
+	writeIndex(index);
+
+	unlock();
+}
+
+
+bool Cache::lock() {
+	if ( _lockFd >= 0 ) return true;
+
+	string filename = _directory + "/lock";
+	_lockFd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if ( _lockFd < 0 ) {
+		SEISCOMP_WARNING("[cache] unable to open %s", filename.c_str());
+		return false;
+	}
+
+	if ( flock(_lockFd, LOCK_EX) != 0 ) {
+		SEISCOMP_WARNING("[cache] unable to lock %s", filename.c_str());
+		::close(_lockFd);
+		_lockFd = -1;
+		return false;
+	}
+
+	return true;
+}
+
+
+void Cache::unlock() {
+	if ( _lockFd < 0 ) return;
+	flock(_lockFd, LOCK_UN);
+	::close(_lockFd);
+	_lockFd = -1;
+}
+
+
+void Cache::readIndex(Index &index) const {
+	ifstream ifs((_directory + "/index").c_str());
+	string line;
+
+	while ( getline(ifs, line) ) {
+		istringstream iss(line);
+		string stime, etime, chunk, atime;
+		Entry entry;
+
+		if ( !(iss >> entry.streamID >> stime >> etime >> chunk >> entry.bytes >> atime) )
+			continue;
+
+		if ( !Core::fromString(entry.startTime, stime) ||
+		     !Core::fromString(entry.endTime, etime) ||
+		     !Core::fromString(entry.lastAccess, atime) )
+			continue;
+
+		if ( chunk != "-" ) entry.chunk = chunk;
+		index.push_back(entry);
+	}
+}
+
+
+bool Cache::writeIndex(const Index &index) const {
+	string filename = _directory + "/index";
+	string tmpFilename = filename + ".tmp";
+
+	{
+		ofstream ofs(tmpFilename.c_str());
+		for ( Index::const_iterator it = index.begin(); it != index.end(); ++it ) {
+			ofs << it->streamID << " " << it->startTime.iso() << " "
+			    << it->endTime.iso() << " "
+			    << (it->chunk.empty() ? "-" : it->chunk) << " "
+			    << it->bytes << " " << it->lastAccess.iso() << "\n";
+		}
+
+		if ( !ofs.good() ) {
+			SEISCOMP_WARNING("[cache] unable to write %s", tmpFilename.c_str());
+			return false;
+		}
+	}
+
+	if ( rename(tmpFilename.c_str(), filename.c_str()) != 0 ) {
+		SEISCOMP_WARNING("[cache] unable to write %s", filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+void Cache::compact(Index &index) const {
+	set<string> chunks;
+	for ( Index::iterator it = index.begin(); it != index.end(); ++it )
+		if ( !it->chunk.empty() ) chunks.insert(it->chunk);
+
+	// Sort the entries by stream and start time, longer windows first
+	vector< pair< pair<string, Core::Time>, pair<double, size_t> > > order;
+	for ( size_t i = 0; i < index.size(); ++i ) {
+		// Entries without data have been written by older versions
+		if ( index[i].chunk.empty() || index[i].endTime <= index[i].startTime )
+			continue;
+
+		order.push_back(make_pair(make_pair(index[i].streamID, index[i].startTime),
+		                          make_pair(-(double)(index[i].endTime - index[i].startTime), i)));
+	}
+
+	std::sort(order.begin(), order.end());
+
+	// Drop the entries that lie within the window of another entry of the
+	// same stream and merge overlapping entries of the same chunk
+	Index compacted;
+	size_t last = 0;
+	for ( size_t i = 0; i < order.size(); ++i ) {
+		const Entry &entry = index[order[i].second.second];
+
+		if ( !compacted.empty() && compacted[last].streamID == entry.streamID ) {
+			Entry &prev = compacted[last];
+			if ( entry.endTime <= prev.endTime ||
+			     (entry.chunk == prev.chunk && entry.startTime <= prev.endTime) ) {
+				if ( entry.endTime > prev.endTime ) prev.endTime = entry.endTime;
+				if ( entry.lastAccess > prev.lastAccess ) prev.lastAccess = entry.lastAccess;
+				continue;
+			}
+		}
+
+		compacted.push_back(entry);
+		if ( compacted.size() == 1 ||
+		     compacted[last].streamID != entry.streamID ||
+		     entry.endTime > compacted[last].endTime )
+			last = compacted.size()-1;
+	}
+
+	for ( Index::iterator it = compacted.begin(); it != compacted.end(); ++it )
+		chunks.erase(it->chunk);
+
+	// Remove the chunks that are no longer referenced
+	for ( set<string>::iterator it = chunks.begin(); it != chunks.end(); ++it ) {
+		unlink((_directory + "/" + *it + ".mseed").c_str());
+		SEISCOMP_DEBUG("[cache] removed unreferenced chunk %s", it->c_str());
+	}
+
+	index.swap(compacted);
+}
+
+
+void Cache::evict(Index &index) const {
+	// Chunks are shared by all entries that refer to them
+	map<string, size_t> references;
+	map<string, size_t> sizes;
+	size_t total = 0;
+
+	for ( Index::iterator it = index.begin(); it != index.end(); ++it ) {
+		if ( it->chunk.empty() ) continue;
+		if ( references[it->chunk]++ == 0 ) {
+			sizes[it->chunk] = it->bytes;
+			total += it->bytes;
+		}
+	}
+
+	if ( total <= _maxSize ) return;
+
+	vector< pair<Core::Time, size_t> > order;
+	for ( size_t i = 0; i < index.size(); ++i )
+		order.push_back(make_pair(index[i].lastAccess, i));
+	std::stable_sort(order.begin(), order.end(), byLastAccess);
+
+	vector<bool> removed(index.size(), false);
+	for ( size_t i = 0; i < order.size() && total > _maxSize; ++i ) {
+		Entry &entry = index[order[i].second];
+		removed[order[i].second] = true;
+		if ( entry.chunk.empty() ) continue;
+
+		if ( --references[entry.chunk] == 0 ) {
+			unlink((_directory + "/" + entry.chunk + ".mseed").c_str());
+			total -= sizes[entry.chunk];
+			SEISCOMP_DEBUG("[cache] removed chunk %s", entry.chunk.c_str());
+		}
+	}
+
+	// Also drop the entries that refer to removed chunks
+	Index remaining;
+	for ( size_t i = 0; i < index.size(); ++i ) {
+		if ( removed[i] ) continue;
+		if ( !index[i].chunk.empty() && references[index[i].chunk] == 0 ) continue;
+		remaining.push_back(index[i]);
+	}
+
+	index.swap(remaining);
+}
+
+
+bool Cache::readChunk(const string &chunk, const Core::TimeWindow &tw,
+                      Records &records) const {
+	ifstream ifs((_directory + "/" + chunk + ".mseed").c_str(), ios::binary);
+	if ( !ifs.is_open() ) return false;
+
+	while ( ifs.good() ) {
+		MSeedRecord rec(Array::INT, Record::SAVE_RAW);
+
+		try {
+			rec.read(ifs);
+		}
+		catch ( Core::EndOfStreamException & ) {
+			break;
+		}
+		catch ( Core::GeneralException &e ) {
+			SEISCOMP_WARNING("[cache] invalid chunk %s: %s", chunk.c_str(), e.what());
+			return false;
+		}
+
+		if ( rec.endTime() <= tw.startTime() || rec.startTime() >= tw.endTime() )
+			continue;
+
+		const Array *raw = rec.raw();
+		records.insert(Records::value_type(rec.startTime(),
+		               string(static_cast<const char*>(raw->data()), raw->size())));
+	}
+
+	return true;
+}
+
+
+string Cache::writeChunk(const string &data) const {
+	string chunk = contentName(data);
+	string filename = _directory + "/" + chunk + ".mseed";
+
+	// The same content has been stored already
+	if ( Util::fileExists(filename) ) return chunk;
+
+	string tmpFilename = filename + ".tmp";
+
+	{
+		ofstream ofs(tmpFilename.c_str(), ios::binary);
+		ofs.write(data.data(), data.size());
+		if ( !ofs.good() ) {
+			SEISCOMP_WARNING("[cache] unable to write %s", tmpFilename.c_str());
+			unlink(tmpFilename.c_str());
+			return "";
+		}
+	}
+
+	if ( rename(tmpFilename.c_str(), filename.c_str()) != 0 ) {
+		SEISCOMP_WARNING("[cache] unable to write %s", filename.c_str());
+		unlink(tmpFilename.c_str());
+		return "";
+	}
+
+	return chunk;
+}
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_SERVICES_RECORDSTREAM_CACHE_H__
+#define __SEISCOMP_SERVICES_RECORDSTREAM_CACHE_H__
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+
+#include <seiscomp3/io/recordstream.h>
+#include <seiscomp3/core.h>
+
+namespace Seiscomp {
+namespace RecordStream {
+
+DEFINE_SMARTPOINTER(Cache);
+
+/**
+ * \brief A proxy recordstream that keeps the fetched records in a local
+ * \brief on-disk cache.
+ *
+ * The source URL has the form service/address[??parameters], e.g.
+ * cache://arclink/localhost:18001??size=1024. Supported parameters are
+ * 'dir', the cache directory which defaults to ~/.seiscomp3/cache/waveforms,
+ * and 'size', the maximum size of the cache in megabytes.
+ *
+ * The cache stores the miniSEED records of each fetched request in a
+ * chunk file named by the hash of its content and indexes the chunks by
+ * stream and time window. Requests for a single stream with a closed time
+ * window are served from the cache and only the gaps not covered by the
+ * index are requested from the proxied source. Only the part of a gap up
+ * to the last record received for it is added to the index and nothing is
+ * stored if the source failed. Requests with wildcards or open time windows
+ * are passed through. If the cache grows beyond its size the least recently
+ * used chunks are removed.
+ */
+class SC_SYSTEM_CORE_API Cache : public Seiscomp::IO::RecordStream {
+	// ----------------------------------------------------------------------
+	//  Xstruction
+	// ----------------------------------------------------------------------
+	public:
+		Cache();
+		virtual ~Cache();
+
+
+	// ----------------------------------------------------------------------
+	//  Public Interface
+	// ----------------------------------------------------------------------
+	public:
+		bool setSource(std::string);
+		bool setRecordType(const char*);
+
+		bool addStream(std::string net, std::string sta, std::string loc, std::string cha);
+		bool addStream(std::string net, std::string sta, std::string loc, std::string cha,
+		               const Seiscomp::Core::Time &stime, const Seiscomp::Core::Time &etime);
+		bool setStartTime(const Seiscomp::Core::Time &stime);
+		bool setEndTime(const Seiscomp::Core::Time &etime);
+		bool setTimeWindow(const Seiscomp::Core::TimeWindow &w);
+		bool setTimeout(int seconds);
+
+		Record* createRecord(Array::DataType, Record::Hint);
+		void recordStored(Record*);
+
+		void close();
+
+		std::istream& stream();
+
+
+	// ----------------------------------------------------------------------
+	//  Private Interface
+	// ----------------------------------------------------------------------
+	private:
+		//! Raw miniSEED records sorted by start time
+		typedef std::map<Core::Time, std::string> Records;
+
+		struct Request {
+			std::string net, sta, loc, cha;
+			Core::Time  startTime;
+			Core::Time  endTime;
+			bool        hasTimeWindow;
+
+			// Whether the request is served through the cache
+			bool        cached;
+			// Whether cached and fetched records have to be merged
+			bool        merge;
+
+			std::vector<Core::TimeWindow> gaps;
+			// The end time of the last record received for each gap
+			std::vector<Core::Time>       received;
+
+			// The records to merge
+			Records     records;
+			// The fetched records to store
+			std::string data;
+		};
+
+		//! An index entry that tells that a chunk holds all records of a
+		//! stream within a time window
+		struct Entry {
+			std::string streamID;
+			Core::Time  startTime;
+			Core::Time  endTime;
+			std::string chunk;
+			size_t      bytes;
+			Core::Time  lastAccess;
+		};
+
+		typedef std::vector<Request> Requests;
+		typedef std::vector<Entry> Index;
+		typedef std::map<std::string, size_t> Routes;
+
+		void prepare();
+		void feed(Record *rec);
+		void finish();
+		void commit();
+
+		bool lock();
+		void unlock();
+
+		void readIndex(Index &index) const;
+		bool writeIndex(const Index &index) const;
+		void compact(Index &index) const;
+		void evict(Index &index) const;
+
+		bool readChunk(const std::string &chunk, const Core::TimeWindow &tw,
+		               Records &records) const;
+		std::string writeChunk(const std::string &data) const;
+
+
+	// ----------------------------------------------------------------------
+	//  Implementation
+	// ----------------------------------------------------------------------
+	private:
+		IO::RecordStreamPtr     _source;
+		std::stringstream       _stream;
+		std::string             _directory;
+		size_t                  _maxSize;
+		Core::Time              _startTime;
+		Core::Time              _endTime;
+		Requests                _requests;
+		Routes                  _routes;
+		std::set<std::string>   _usedChunks;
+		std::deque<std::string> _queue;
+		Core::Time              _fetchTime;
+		int                     _lockFd;
+		bool                    _prepared;
+		bool                    _fetching;
+		bool                    _failed;
+		bool                    _closed;
+};
+
+}
+}
+
+#endif
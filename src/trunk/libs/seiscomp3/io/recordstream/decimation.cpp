@@ -21,7 +21,6 @@
 #include <string.h>
 
 #include "decimation.h"
-#include "remez/remez.h"
 
 
 using namespace std;
@@ -268,13 +267,6 @@ void Decimation::cleanup() {
 		_streams.clear();
 	}
 
-	{
-		CoefficientMap::iterator it;
-		for ( it = _coefficients.begin(); it != _coefficients.end(); ++it )
-			delete it->second;
-		_coefficients.clear();
-	}
-
 	_source = NULL;
 	_stream.clear(ios::eofbit);
 
@@ -357,62 +349,38 @@ int Decimation::checkSR(Record *rec) const {
 
 
 void Decimation::initCoefficients(ResampleStage *stage) {
-	CoefficientMap::iterator it = _coefficients.find(stage->N);
-	if ( it != _coefficients.end() )
-		stage->coefficients = it->second;
-	else {
-		stage->coefficients = NULL;
+	if ( stage->N > _maxN ) {
+		for ( int i = _maxN; i > 1; --i ) {
+			if ( stage->N % i == 0 ) {
+				int nextStageN = stage->N / i;
 
-		if ( stage->N > _maxN ) {
-			for ( int i = _maxN; i > 1; --i ) {
-				if ( stage->N % i == 0 ) {
-					int nextStageN = stage->N / i;
+				SEISCOMP_DEBUG("[dec] clipping N=%d to %d and create sub stage",
+				               stage->N, i);
 
-					SEISCOMP_DEBUG("[dec] clipping N=%d to %d and create sub stage",
-					               stage->N, i);
+				stage->N = i;
+				stage->targetRate = stage->sampleRate / stage->N;
 
-					stage->N = i;
-					stage->targetRate = stage->sampleRate / stage->N;
+				ResampleStage *nextStage = new ResampleStage;
+				nextStage->sampleRate = stage->targetRate;
+				nextStage->targetRate = _targetRate;
+				nextStage->N = nextStageN;
+				initCoefficients(nextStage);
 
-					ResampleStage *nextStage = new ResampleStage;
-					nextStage->sampleRate = stage->targetRate;
-					nextStage->targetRate = _targetRate;
-					nextStage->N = nextStageN;
-					initCoefficients(nextStage);
+				stage->nextStage = nextStage;
 
-					stage->nextStage = nextStage;
-
-					break;
-				}
+				break;
 			}
-
-			CoefficientMap::iterator it = _coefficients.find(stage->N);
-			if ( it != _coefficients.end() )
-				stage->coefficients = it->second;
-		}
-
-		if ( stage->coefficients == NULL ) {
-			// Create and cache coefficients for N
-			int Ncoeff = stage->N*_coeffScale*2+1;
-
-			Coefficients *coeff = new Coefficients(Ncoeff);
-
-			SEISCOMP_DEBUG("[dec] caching %d coefficents for N=%d", Ncoeff, stage->N);
-
-			double bands[4] = {0,0.5*(_fp/stage->N),0.5*(_fs/stage->N),0.5};
-			double weights[2] = {1,1};
-			double desired[2] = {1,0};
-
-			remez(&((*coeff)[0]), Ncoeff, 2, bands, desired, weights, BANDPASS);
-
-			_coefficients[stage->N] = coeff;
-			stage->coefficients = coeff;
 		}
 	}
 
+	// The coefficients are shared read-only with all other decimation
+	// stages and resamplers
+	stage->coefficients = IO::FIR::lowpass(stage->N, _fp, _fs, _coeffScale);
+
 	stage->dt = 1.0 / stage->sampleRate;
 	stage->N2 = stage->coefficients->size() / 2;
-	stage->buffer.resize(stage->coefficients->size());
+	stage->length = stage->coefficients->size();
+	stage->buffer.resize(stage->length*2);
 	stage->reset();
 }
 
@@ -545,7 +513,9 @@ Record *Decimation::resample(ResampleStage *stage, Record *rec) {
 
 	if ( stage->missingSamples > 0 ) {
 		size_t toCopy = std::min(stage->missingSamples, data_len);
-		memcpy(buffer + stage->buffer.size() - stage->missingSamples,
+		memcpy(buffer + stage->length - stage->missingSamples,
+		       data, toCopy*sizeof(double));
+		memcpy(buffer + 2*stage->length - stage->missingSamples,
 		       data, toCopy*sizeof(double));
 		data += toCopy;
 		data_len -= toCopy;
@@ -568,13 +538,7 @@ Record *Decimation::resample(ResampleStage *stage, Record *rec) {
 	do {
 		if ( stage->samplesToSkip == 0 ) {
 			// Calculate scalar product of coefficients and ring buffer
-			double *coeff = &((*stage->coefficients)[0]);
-			double sample = 0;
-
-			for ( size_t i = stage->front; i < stage->buffer.size(); ++i )
-				sample += buffer[i] * *(coeff++);
-			for ( size_t i = 0; i < stage->front; ++i )
-				sample += buffer[i] * *(coeff++);
+			double sample = IO::FIR::apply(*stage->coefficients, buffer + stage->front);
 
 			if ( !resampled_data ) {
 				startTime = stage->startTime + Core::TimeSpan(stage->dt*stage->N2);
@@ -589,8 +553,9 @@ Record *Decimation::resample(ResampleStage *stage, Record *rec) {
 
 		size_t num_samples = std::min(stage->samplesToSkip, data_len);
 
-		size_t chunk_size = std::min(num_samples, stage->buffer.size()-stage->front);
+		size_t chunk_size = std::min(num_samples, stage->length-stage->front);
 		memcpy(buffer + stage->front, data, chunk_size*sizeof(double));
+		memcpy(buffer + stage->front + stage->length, data, chunk_size*sizeof(double));
 
 		data += chunk_size;
 
@@ -599,6 +564,7 @@ Record *Decimation::resample(ResampleStage *stage, Record *rec) {
 			chunk_size = num_samples - chunk_size;
 
 			memcpy(buffer, data, chunk_size*sizeof(double));
+			memcpy(buffer + stage->length, data, chunk_size*sizeof(double));
 
 			stage->front = chunk_size;
 
@@ -606,8 +572,8 @@ Record *Decimation::resample(ResampleStage *stage, Record *rec) {
 		}
 		else {
 			stage->front += chunk_size;
-			if ( stage->front >= stage->buffer.size() )
-				stage->front -= stage->buffer.size();
+			if ( stage->front >= stage->length )
+				stage->front -= stage->length;
 		}
 
 		stage->startTime += Core::TimeSpan(stage->dt*num_samples);
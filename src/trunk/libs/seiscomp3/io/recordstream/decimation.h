@@ -18,6 +18,7 @@
 #include <map>
 
 #include <seiscomp3/io/recordstream.h>
+#include <seiscomp3/io/recordfilter/fir.h>
 #include <seiscomp3/core.h>
 
 namespace Seiscomp {
@@ -75,7 +76,7 @@ class SC_SYSTEM_CORE_API Decimation : public Seiscomp::IO::RecordStream {
 	//  Implementation
 	// ----------------------------------------------------------------------
 	private:
-		typedef std::vector<double> Coefficients;
+		typedef IO::FIR::Coefficients Coefficients;
 
 		struct ResampleStage {
 			ResampleStage() : nextStage(NULL) {}
@@ -96,9 +97,14 @@ class SC_SYSTEM_CORE_API Decimation : public Seiscomp::IO::RecordStream {
 			int N2;
 			size_t samplesToSkip;
 
-			Coefficients *coefficients;
+			const Coefficients *coefficients;
+
+			// The number of samples in the ring buffer
+			size_t length;
 
 			// The ring buffer that holds the last samples for downsampling.
+			// Each sample is stored twice (position and position+length)
+			// so that the samples starting at front are contiguous.
 			std::vector<double> buffer;
 
 			// The number of samples still missing in the buffer before
@@ -117,7 +123,7 @@ class SC_SYSTEM_CORE_API Decimation : public Seiscomp::IO::RecordStream {
 			ResampleStage *nextStage;
 
 			void reset() {
-				missingSamples = buffer.size();
+				missingSamples = length;
 				front = 0;
 				samplesToSkip = 0;
 				startTime = Core::Time();
@@ -127,7 +133,6 @@ class SC_SYSTEM_CORE_API Decimation : public Seiscomp::IO::RecordStream {
 			}
 		};
 
-		typedef std::map<int, Coefficients*> CoefficientMap;
 		typedef std::map<std::string, ResampleStage*> StreamMap;
 
 		void init(ResampleStage *stage, Record *rec);
@@ -142,7 +147,6 @@ class SC_SYSTEM_CORE_API Decimation : public Seiscomp::IO::RecordStream {
 		int                 _maxN;
 		int                 _coeffScale;
 		StreamMap           _streams;
-		CoefficientMap      _coefficients;
 		Record             *_nextRecord;
 };
 
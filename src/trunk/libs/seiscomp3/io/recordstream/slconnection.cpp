@@ -21,6 +21,7 @@
 #include "slconnection.h"
 
 #include <libmseed.h>
+#include <vector>
 /* Seedlink packets consist of an 8-byte Seedlink header ... */
 #define HEADSIZE 8
 /* ... followed by a 512-byte MiniSEED record */
@@ -308,6 +309,184 @@ bool SLConnection::setTimeout(int seconds) {
 	return true;
 }
 
+namespace {
+
+
+/* Returns the requested time window of a stream as SeedLink TIME argument
+ * or an empty string if all available data is requested. Returns false
+ * if the time window is empty. */
+bool timeWindow(const SLStreamIdx &idx, const Time &defaultStart,
+                const Time &defaultEnd, string &timestr) {
+	Time stime = (idx.startTime() != Time()) ? idx.startTime() : defaultStart;
+	Time etime = (idx.endTime() != Time()) ? idx.endTime() : defaultEnd;
+
+	// Seedlink does not support microseconds so shift the end of
+	// one second if a fraction of a seconds is requested
+	if ( etime.microseconds() > 0 )
+		etime += Time(1,0);
+
+	if ( idx.timestamp().valid() )
+		stime = idx.timestamp() + Time(1,0);
+	else if ( !stime.valid() ) {
+		if ( etime > Time::GMT() )
+			stime = Time::GMT();
+	}
+
+	// Remove microseconds
+	stime.setUSecs(0);
+	etime.setUSecs(0);
+
+	// Empty time windows are not requested
+	if ( stime.valid() && etime.valid() && stime >= etime ) {
+		SEISCOMP_DEBUG("Seedlink: ignoring empty request for %s.%s %s %s %s",
+		               idx.network().data(), idx.station().data(),
+		               idx.selector().data(),
+		               stime.toString("%Y,%m,%d,%H,%M,%S").data(),
+		               etime.toString("%Y,%m,%d,%H,%M,%S").data());
+		return false;
+	}
+
+	timestr.clear();
+
+	if ( stime.valid() ) {
+		timestr = stime.toString("%Y,%m,%d,%H,%M,%S");
+		if ( etime.valid() )
+			timestr += " " + etime.toString("%Y,%m,%d,%H,%M,%S");
+	}
+
+	return true;
+}
+
+/* The fixed section of data header is parsed in place instead of
+ * unpacking the record with libmseed which allocates the record and its
+ * blockette chain. Only the fields required to track the stream time
+ * stamps and to detect detection records are extracted. */
+struct RecordHeader {
+	char   net[3];
+	char   sta[6];
+	char   loc[3];
+	char   cha[4];
+	Time   endTime;
+	int    numSamples;
+	int    sampleRateFactor;
+};
+
+inline int u8(const char *p) {
+	return (unsigned char)*p;
+}
+
+inline int u16(const char *p, bool swap) {
+	return swap ? (u8(p+1) << 8) | u8(p) : (u8(p) << 8) | u8(p+1);
+}
+
+inline int32_t i32(const char *p, bool swap) {
+	uint32_t v = swap
+		? ((uint32_t)u8(p+3) << 24) | (u8(p+2) << 16) | (u8(p+1) << 8) | u8(p)
+		: ((uint32_t)u8(p) << 24) | (u8(p+1) << 16) | (u8(p+2) << 8) | u8(p+3);
+	return (int32_t)v;
+}
+
+inline float f32(const char *p, bool swap) {
+	union { int32_t i; float f; } v;
+	v.i = i32(p, swap);
+	return v.f;
+}
+
+void copyCode(char *dst, const char *src, int len) {
+	// Codes are left justified and padded with spaces
+	while ( len > 0 && src[len-1] == ' ' ) --len;
+	memcpy(dst, src, len);
+	dst[len] = '\0';
+}
+
+// Days from 1970-01-01 to the first day of the given year
+long daysToYear(int year) {
+	int y = year - 1;
+	return 365L * (year - 1970)
+	     + (y / 4 - 1969 / 4) - (y / 100 - 1969 / 100) + (y / 400 - 1969 / 400);
+}
+
+bool unpackHeader(const char *rec, RecordHeader &hdr) {
+	// Detect the byte order from the record start year as libmseed does
+	bool swap = false;
+	int year = u16(rec+20, false);
+	if ( year < 1900 || year > 2100 ) {
+		swap = true;
+		year = u16(rec+20, true);
+		if ( year < 1900 || year > 2100 ) return false;
+	}
+
+	int yday = u16(rec+22, swap);
+	int hour = u8(rec+24);
+	int min = u8(rec+25);
+	int sec = u8(rec+26);
+	int fract = u16(rec+28, swap);
+
+	hdr.numSamples = u16(rec+30, swap);
+	hdr.sampleRateFactor = (int16_t)u16(rec+32, swap);
+	int sampleRateMult = (int16_t)u16(rec+34, swap);
+	int actFlags = u8(rec+36);
+	int numBlockettes = u8(rec+39);
+	int32_t timeCorrection = i32(rec+40, swap);
+	int blocketteOffset = u16(rec+46, swap);
+
+	copyCode(hdr.sta, rec+8, 5);
+	copyCode(hdr.loc, rec+13, 2);
+	copyCode(hdr.cha, rec+15, 3);
+	copyCode(hdr.net, rec+18, 2);
+
+	// Nominal sample rate, see SEED manual
+	double samprate = 0;
+	int fact = hdr.sampleRateFactor;
+	if ( fact > 0 && sampleRateMult > 0 )
+		samprate = (double)fact * sampleRateMult;
+	else if ( fact > 0 && sampleRateMult < 0 )
+		samprate = -(double)fact / sampleRateMult;
+	else if ( fact < 0 && sampleRateMult > 0 )
+		samprate = -(double)sampleRateMult / fact;
+	else if ( fact < 0 && sampleRateMult < 0 )
+		samprate = 1.0 / ((double)fact * sampleRateMult);
+
+	// Blockette 100 overrides the nominal sample rate
+	for ( int i = 0; i < numBlockettes && blocketteOffset >= 48 &&
+	      blocketteOffset + 8 <= RECSIZE; ++i ) {
+		const char *blk = rec + blocketteOffset;
+		if ( u16(blk, swap) == 100 ) {
+			samprate = f32(blk+4, swap);
+			break;
+		}
+
+		int next = u16(blk+2, swap);
+		if ( next <= blocketteOffset ) break;
+		blocketteOffset = next;
+	}
+
+	double start = (double)(daysToYear(year) + yday - 1) * 86400.0
+	             + hour * 3600 + min * 60 + sec + fract * 0.0001;
+
+	// Apply the time correction if not already applied
+	if ( timeCorrection != 0 && !(actFlags & 0x02) )
+		start += timeCorrection * 0.0001;
+
+	if ( samprate > 0 )
+		start += hdr.numSamples / samprate;
+
+	hdr.endTime = Time(start);
+
+	return true;
+}
+
+void updateStreams(std::set<SLStreamIdx> &streams, const RecordHeader &hdr) {
+	SLStreamIdx idx(hdr.net, hdr.sta, hdr.loc, hdr.cha);
+	set<SLStreamIdx>::iterator it = streams.find(idx);
+	if (it != streams.end()) {
+		Time rectime = hdr.endTime;
+		it->setTimestamp(rectime);
+	}
+}
+
+}
+
 void SLConnection::handshake() {
 	Util::StopWatch aStopWatch;
 
@@ -326,91 +505,95 @@ void SLConnection::handshake() {
 	else
 		SEISCOMP_INFO("BATCH mode requests disabled");
 
-	for (set<SLStreamIdx>::iterator it = _streams.begin(); it != _streams.end(); ++it) {
-		try {
-			Time stime = (it->startTime() != Time()) ? it->startTime() : _stime;
-			Time etime = (it->endTime() != Time()) ? it->endTime() : _etime;
-
-			// Seedlink does not support microseconds so shift the end of
-			// one second if a fraction of a seconds is requested
-			if ( etime.microseconds() > 0 )
-				etime += Time(1,0);
-
-			if ( it->timestamp().valid() )
-				stime = it->timestamp() + Time(1,0);
-			else if ( !stime.valid() ) {
-				if ( etime > Time::GMT() )
-					stime = Time::GMT();
-			}
+	// In batch mode all commands are collected and sent with a single
+	// write
+	string batch;
+	int stations = 0;
+
+	set<SLStreamIdx>::iterator it = _streams.begin();
+	while ( it != _streams.end() ) {
+		string timestr;
+		if ( !timeWindow(*it, _stime, _etime, timestr) ) {
+			++it;
+			continue;
+		}
+
+		// Streams of a station with the same time window share a single
+		// STATION and DATA/TIME negotiation
+		vector<string> selectors;
+		selectors.push_back(it->selector());
 
-			// Remove microseconds
-			stime.setUSecs(0);
-			etime.setUSecs(0);
-
-			// Empty time windows are not requested
-			if ( stime.valid() && etime.valid() && stime >= etime ) {
-				SEISCOMP_DEBUG("Seedlink: ignoring empty request for %s.%s %s %s %s",
-				               it->network().data(), it->station().data(),
-				               it->selector().data(),
-				               stime.toString("%Y,%m,%d,%H,%M,%S").data(),
-				               etime.toString("%Y,%m,%d,%H,%M,%S").data());
+		set<SLStreamIdx>::iterator first = it;
+		for ( ++it; it != _streams.end(); ++it ) {
+			if ( it->network() != first->network() ||
+			     it->station() != first->station() )
+				break;
+
+			string nextTimestr;
+			if ( !timeWindow(*it, _stime, _etime, nextTimestr) )
 				continue;
-			}
 
-			string timestr;
+			if ( nextTimestr != timestr )
+				break;
 
-			if ( stime.valid() ) {
-				timestr = stime.toString("%Y,%m,%d,%H,%M,%S");
-				if ( etime.valid() )
-					timestr += " " + etime.toString("%Y,%m,%d,%H,%M,%S");
-			}
+			selectors.push_back(it->selector());
+		}
 
-			_sock.startTimer();
-			_sock.sendRequest("STATION " + it->station() + " " + it->network(), !batchmode);
-			SEISCOMP_DEBUG("Seedlink command: STATION %s %s", it->station().c_str(),it->network().c_str());
-			_sock.sendRequest("SELECT " + it->selector(), !batchmode);
-			SEISCOMP_DEBUG("Seedlink command: SELECT %s", it->selector().c_str());
-
-			if ( timestr.length() > 0 ) {
-				_sock.sendRequest("TIME " + timestr, !batchmode);
-				SEISCOMP_DEBUG("Seedlink command: TIME %s", timestr.c_str());
-			}
-			else {
-				_sock.sendRequest("DATA", !batchmode);
-				SEISCOMP_DEBUG("Seedlink command: DATA");
-			}
-		} catch (SocketCommandException) {}
-	}
-	_sock.sendRequest("END",false);
+		vector<string> commands;
+		commands.push_back("STATION " + first->station() + " " + first->network());
+		for ( size_t i = 0; i < selectors.size(); ++i )
+			commands.push_back("SELECT " + selectors[i]);
+		if ( timestr.length() > 0 )
+			commands.push_back("TIME " + timestr);
+		else
+			commands.push_back("DATA");
 
-	SEISCOMP_DEBUG("handshake done in %f seconds", (double)aStopWatch.elapsed());
-}
+		++stations;
 
-Time getEndtime(MSRecord *prec) {
-	double diff = 0;
-	Time stime = Time((hptime_t)prec->starttime / HPTMODULUS, (hptime_t)prec->starttime % HPTMODULUS);
+		if ( batchmode ) {
+			for ( size_t i = 0; i < commands.size(); ++i ) {
+				SEISCOMP_DEBUG("Seedlink command: %s", commands[i].c_str());
+				batch += commands[i] + "\r\n";
+			}
+			continue;
+		}
 
-	if (prec->samprate > 0)
-		diff = prec->samplecnt / prec->samprate;
+		// Each command is acknowledged by the server. A rejected station
+		// is skipped completely, a rejected selector only skips itself.
+		try {
+			_sock.startTimer();
+			_sock.sendRequest(commands.front(), true);
+			SEISCOMP_DEBUG("Seedlink command: %s", commands.front().c_str());
+		} catch (SocketCommandException) { continue; }
+
+		size_t selected = 0;
+		for ( size_t i = 1; i < commands.size()-1; ++i ) {
+			try {
+				_sock.startTimer();
+				_sock.sendRequest(commands[i], true);
+				SEISCOMP_DEBUG("Seedlink command: %s", commands[i].c_str());
+				++selected;
+			} catch (SocketCommandException) {}
+		}
 
-	if (diff == 0)
-		return stime;
-	return stime + Time(diff);
-}
+		// DATA or TIME without a selector would request all streams
+		// of the station
+		if ( !selected ) continue;
 
-void updateStreams(std::set<SLStreamIdx> &streams, MSRecord *prec) {
-	Time rectime = getEndtime(prec);
-	string net = prec->network;
-	string sta = prec->station;
-	string loc = prec->location;
-	string cha = prec->channel;
+		try {
+			_sock.startTimer();
+			_sock.sendRequest(commands.back(), true);
+			SEISCOMP_DEBUG("Seedlink command: %s", commands.back().c_str());
+		} catch (SocketCommandException) {}
+	}
 
-	SLStreamIdx idx(net,sta,loc,cha);
-	set<SLStreamIdx>::iterator it = streams.find(idx);
-	if (it != streams.end())
-		it->setTimestamp(rectime);
-}
+	batch += "END\r\n";
+	_sock.startTimer();
+	_sock.write(batch);
 
+	SEISCOMP_DEBUG("handshake of %d stations done in %f seconds",
+	               stations, (double)aStopWatch.elapsed());
+}
 
 istream& SLConnection::stream() {
 	if (_readingData && !_sock.isOpen()) {
@@ -465,41 +648,41 @@ istream& SLConnection::stream() {
 
 			_sock.startTimer();
 			/*** termination? ***/
-			_slrecord = _sock.read(strlen(TERMTOKEN));
-			if (!_slrecord.compare(TERMTOKEN)) {
+			const char *data = _sock.peek(strlen(TERMTOKEN));
+			if ( !strncmp(data, TERMTOKEN, strlen(TERMTOKEN)) ) {
 				_sock.close();
 				_stream.clear(std::ios::eofbit);
 				break;
 			}
 
-			_slrecord += _sock.read(strlen(ERRTOKEN)-strlen(TERMTOKEN));
-			if (!_slrecord.compare(ERRTOKEN)) {
+			data = _sock.peek(strlen(ERRTOKEN));
+			if ( !strncmp(data, ERRTOKEN, strlen(ERRTOKEN)) ) {
 				_sock.close();
 				_stream.clear(std::ios::eofbit);
 				break;
 			}
 			/********************/
 
-			_slrecord += _sock.read(HEADSIZE+RECSIZE-strlen(ERRTOKEN));
-			char * data = const_cast<char *>(_slrecord.c_str());
+			// The packet is parsed in the receive buffer of the socket. It
+			// stays valid until the next read from the socket which happens
+			// not before the record has been read from the stream.
+			data = _sock.peek(HEADSIZE+RECSIZE);
+			_sock.skip(HEADSIZE+RECSIZE);
+
 			if ( !MS_ISVALIDHEADER(data+HEADSIZE) ) {
 				SEISCOMP_WARNING("Invalid MSEED record received (MS_ISVALIDHEADER failed)");
 				continue;
 			}
 
-			MSRecord *prec = NULL;
-
-			if (msr_unpack(data+HEADSIZE,RECSIZE,&prec,0,0) == MS_NOERROR) {
-				int samprate_fact = prec->fsdh->samprate_fact;
-				int numsamples = prec->fsdh->numsamples;
+			RecordHeader hdr;
 
-				updateStreams(_streams,prec);
-				msr_free(&prec);
+			if ( unpackHeader(data+HEADSIZE, hdr) ) {
+				updateStreams(_streams, hdr);
 
 				/* Test for a so-called end-of-detection-record */
-				if (!(samprate_fact == 0 && numsamples == 0)) {
+				if (!(hdr.sampleRateFactor == 0 && hdr.numSamples == 0)) {
 					_stream.clear();
-					_stream.rdbuf()->pubsetbuf(data+HEADSIZE,RECSIZE);
+					_stream.rdbuf()->pubsetbuf(const_cast<char*>(data+HEADSIZE),RECSIZE);
 					break;
 				}
 			}
@@ -170,7 +170,6 @@ class SC_SYSTEM_CORE_API SLConnection : public Seiscomp::IO::RecordStream {
 			StreamBuffer          _streambuf;
 			std::istream          _stream;
 			std::string           _serverloc;
-			std::string           _slrecord;
 			IO::Socket            _sock;
 			std::set<SLStreamIdx> _streams;
 			Core::Time            _stime;
@@ -383,6 +383,25 @@ string Socket::read(int size) {
 	}
 }
 
+const char *Socket::peek(int size) {
+	if ( size > BUFSIZE ) {
+		SEISCOMP_ERROR("Socket peek: size > BUFSIZE");
+		size = BUFSIZE;
+	}
+
+	while ( _wp - _rp < size )
+		fillbuf();
+
+	return _buf + _rp;
+}
+
+void Socket::skip(int size) {
+	if ( size > _wp - _rp )
+		size = _wp - _rp;
+
+	_rp += size;
+}
+
 string Socket::readline() {
 	while ( 1 ) {
 		if ( _wp > _rp ) {
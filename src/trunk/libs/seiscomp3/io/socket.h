@@ -27,7 +27,7 @@
 #include <seiscomp3/io/recordstream.h>
 #include <seiscomp3/core.h>
 
-#define BUFSIZE 4096
+#define BUFSIZE 65536
 #define RECSIZE 512
 
 namespace Seiscomp {
@@ -73,6 +73,12 @@ class SC_SYSTEM_CORE_API Socket: public Seiscomp::Core::InterruptibleObject {
 		void write(const std::string& s);
 		std::string readline();
 		std::string read(int size);
+		//! Returns a pointer to the next size bytes in the receive buffer
+		//! without consuming them. The pointer is valid until the next
+		//! read, readline or peek call.
+		const char *peek(int size);
+		//! Consumes size bytes of the receive buffer
+		void skip(int size);
 		std::string sendRequest(const std::string& request, bool waitResponse);
 		bool isInterrupted();
 		void interrupt();
@@ -237,6 +237,18 @@ void fft(ComplexArray &out, int n, const T *data) {
 }
 
 
+int spectrumSize(int n) {
+	int fftn = Filtering::next_power_of_2(n);
+	if ( fftn <= 0 ) return 0;
+
+#ifdef MATH_USE_FFTW3
+	return fftn/2+1;
+#else
+	return fftn/2;
+#endif
+}
+
+
 // Explicit template instantiation for float and double types
 template SC_SYSTEM_CORE_API
 void ifft<float>(int n, float *out, ComplexArray &coeff);
@@ -41,6 +41,10 @@ void fft(ComplexArray &spec, const std::vector<T> &data) {
 template <typename T>
 void ifft(int n, T *out, ComplexArray &spec);
 
+//! Returns the number of coefficients of the spectrum that fft computes
+//! for n samples.
+SC_SYSTEM_CORE_API int spectrumSize(int n);
+
 template <typename T>
 void ifft(std::vector<T> &out, ComplexArray &spec) {
 	ifft((int)out.size(), &out[0], spec);
@@ -62,58 +62,22 @@ void costaper(int n, T *inout, int istart, int iend, int estart, int eend) {
 }
 
 
-template <typename T>
-bool transformFFT(int n, T *inout, double fsamp,
-                  const FFT::TransferFunction *tf, double cutoff,
-                  double min_freq, double max_freq) {
+bool deconvolutionOperator(std::vector<Complex> &op, int n, double fsamp,
+                           const FFT::TransferFunction *tf,
+                           double min_freq, double max_freq) {
 	if ( n <= 0 ) return false;
 
-	int fftn = n;
-	if ( fftn <= 0 )
-		return false;
-
 	if ( fsamp <= 0 )
 		return false;
 
-	// Demean time series
-	T mean = 0;
-
-	for ( int i = 0; i < n; ++i )
-		mean += inout[i];
-
-	mean /= (T)n;
+	int fftn2 = spectrumSize(n);
+	if ( fftn2 <= 0 )
+		return false;
 
-	for ( int i = 0; i < n; ++i )
-		inout[i] -= mean;
+	double nyquist_freq = fsamp * 0.5;
 
-	// Time series taper
 	int iTaperStart, iTaperEnd;
 	int eTaperStart, eTaperEnd;
-	int taperLength;
-
-	if ( cutoff > 0 ) {
-		taperLength = (int)(cutoff * fsamp);
-		if ( taperLength > n ) taperLength = n;
-
-		iTaperStart = 0;
-		iTaperEnd = taperLength;
-
-		eTaperStart = n - taperLength;
-		eTaperEnd = n;
-
-		if ( iTaperEnd > eTaperStart )
-			eTaperStart = iTaperEnd;
-
-		costaper(n, inout, iTaperStart, iTaperEnd, eTaperStart, eTaperEnd);
-	}
-
-	double nyquist_freq = fsamp * 0.5;
-
-	vector<Complex> data_coeff;
-	// len(data_coeff) = fftn/2+1
-	fft(data_coeff, n, inout);
-
-	int fftn2 = data_coeff.size();
 
 	// Initial spectra taper
 	double df = nyquist_freq / fftn2;
@@ -139,16 +103,65 @@ bool transformFFT(int n, T *inout, double fsamp,
 		if ( eTaperStart < iTaperEnd ) eTaperStart = iTaperEnd;
 	}
 	else {
-		eTaperStart = data_coeff.size();
+		eTaperStart = fftn2;
 		eTaperEnd = eTaperStart;
 	}
 
-	// Multiply by freqs
-	df = nyquist_freq/fftn2;
+	// Divide by freqs
+	op.assign(fftn2, Complex(1.0, 0.0));
+	tf->deconvolve(op, df, df);
+
+	costaper(fftn2, &op[0], iTaperStart, iTaperEnd, eTaperStart, eTaperEnd);
+
+	return true;
+}
+
+
+template <typename T>
+bool transformFFT(int n, T *inout, double fsamp, const std::vector<Complex> &op,
+                  double cutoff) {
+	if ( n <= 0 ) return false;
+
+	if ( fsamp <= 0 )
+		return false;
+
+	if ( (int)op.size() != spectrumSize(n) )
+		return false;
+
+	// Demean time series
+	T mean = 0;
+
+	for ( int i = 0; i < n; ++i )
+		mean += inout[i];
+
+	mean /= (T)n;
+
+	for ( int i = 0; i < n; ++i )
+		inout[i] -= mean;
+
+	// Time series taper
+	if ( cutoff > 0 ) {
+		int taperLength = (int)(cutoff * fsamp);
+		if ( taperLength > n ) taperLength = n;
+
+		int iTaperStart = 0;
+		int iTaperEnd = taperLength;
+
+		int eTaperStart = n - taperLength;
+		int eTaperEnd = n;
+
+		if ( iTaperEnd > eTaperStart )
+			eTaperStart = iTaperEnd;
+
+		costaper(n, inout, iTaperStart, iTaperEnd, eTaperStart, eTaperEnd);
+	}
 
-	tf->deconvolve(data_coeff, df, df);
+	vector<Complex> data_coeff;
+	// len(data_coeff) = fftn/2+1
+	fft(data_coeff, n, inout);
 
-	costaper(data_coeff.size(), &data_coeff[0], iTaperStart, iTaperEnd, eTaperStart, eTaperEnd);
+	for ( size_t i = 0; i < data_coeff.size(); ++i )
+		data_coeff[i] *= op[i];
 
 	// do the inverse FFT
 	ifft(n, inout, data_coeff);
@@ -157,6 +170,19 @@ bool transformFFT(int n, T *inout, double fsamp,
 }
 
 
+template <typename T>
+bool transformFFT(int n, T *inout, double fsamp,
+                  const FFT::TransferFunction *tf, double cutoff,
+                  double min_freq, double max_freq) {
+	vector<Complex> op;
+
+	if ( !deconvolutionOperator(op, n, fsamp, tf, min_freq, max_freq) )
+		return false;
+
+	return transformFFT(n, inout, fsamp, op, cutoff);
+}
+
+
 // Explicit template instantiation for float and double types
 template SC_SYSTEM_CORE_API
 bool transformFFT<float>(int n, float *inout, double fsamp,
@@ -168,6 +194,14 @@ bool transformFFT<double>(int n, double *inout, double fsamp,
                           const FFT::TransferFunction *tf,
                           double cutoff, double min_freq, double max_freq);
 
+template SC_SYSTEM_CORE_API
+bool transformFFT<float>(int n, float *inout, double fsamp,
+                         const std::vector<Complex> &op, double cutoff);
+
+template SC_SYSTEM_CORE_API
+bool transformFFT<double>(int n, double *inout, double fsamp,
+                          const std::vector<Complex> &op, double cutoff);
+
 }
 }
 }
@@ -44,6 +44,24 @@ bool transformFFT(std::vector<T> &inout, double fsamp, const FFT::TransferFuncti
 }
 
 
+// Evaluates the spectral operator that transformFFT applies to the spectra
+// of a time series with n samples: the inverse transfer function tapered
+// before min_freq and after max_freq. It depends only on the transfer
+// function, the sampling frequency, the FFT length and the band limits and
+// can be reused for any time series that shares those.
+SC_SYSTEM_CORE_API
+bool deconvolutionOperator(std::vector<Complex> &op, int n, double fsamp,
+                           const FFT::TransferFunction *tf,
+                           double min_freq, double max_freq);
+
+// Deconvolves a time series with a precomputed operator, see
+// deconvolutionOperator. Returns false if the size of the operator does
+// not match the spectra of the time series.
+template <typename T>
+bool transformFFT(int n, T *inout, double fsamp, const std::vector<Complex> &op,
+                  double cutoff);
+
+
 template <typename T>
 bool transformFFT(int n, T *inout, double fsamp, int n_poles, SeismometerResponse::Pole *poles,
                   int n_zeros, SeismometerResponse::Zero *zeros, double norm,
@@ -20,6 +20,7 @@
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/core/interfacefactory.ipp>
 
+#include <cstdio>
 #include <fstream>
 #include <limits>
 
@@ -539,10 +540,35 @@ void AmplitudeProcessor::prepareData(DoubleArray &data) {
 
 		_responseApplied = true;
 
+		ProcessingGraph *graph = processingGraph();
+		std::string key;
+
+		if ( graph ) {
+			// The deconvolution of derived classes may depend on the
+			// Wood-Anderson configuration as well
+			char tmp[256];
+			snprintf(tmp, sizeof(tmp), "%s|%.17g|%.17g|%.17g|%.17g|%d|%.17g,%.17g,%.17g",
+			         className(), _stream.fsamp, _config.respTaper,
+			         _config.respMinFreq, _config.respMaxFreq, intSteps,
+			         _config.woodAndersonResponse.gain,
+			         _config.woodAndersonResponse.T0,
+			         _config.woodAndersonResponse.h);
+			key = tmp;
+
+			if ( graph->reuseDeconvolution(key, sensor->response(), _data) )
+				return;
+		}
+
+		DoubleArray input;
+		if ( graph ) input = _data;
+
 		if ( !deconvolveData(sensor->response(), _data, intSteps) ) {
 			setStatus(DeconvolutionFailed, 0);
 			return;
 		}
+
+		if ( graph )
+			graph->storeDeconvolution(key, sensor->response(), input, _data);
 	}
 	else {
 		// If the sensor is known then check the unit and skip
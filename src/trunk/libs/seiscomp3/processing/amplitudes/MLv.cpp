@@ -19,6 +19,8 @@
 #include <seiscomp3/math/filter/seismometers.h>
 #include <seiscomp3/math/restitution/fft.h>
 
+#include <cstdio>
+
 
 using namespace Seiscomp::Math;
 
@@ -64,8 +66,14 @@ AmplitudeProcessor_MLv::AmplitudeProcessor_MLv(const Core::Time& trigger)
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmplitudeProcessor_MLv::initFilter(double fsamp) {
 	if ( !_enableResponses ) {
-		AmplitudeProcessor::setFilter(
-			new Filtering::IIR::WoodAndersonFilter<double>(Velocity, _config.woodAndersonResponse)
+		char key[128];
+		snprintf(key, sizeof(key), "WA(%.17g,%.17g,%.17g)",
+		         _config.woodAndersonResponse.gain,
+		         _config.woodAndersonResponse.T0,
+		         _config.woodAndersonResponse.h);
+		AmplitudeProcessor::setSharedFilter(
+			new Filtering::IIR::WoodAndersonFilter<double>(Velocity, _config.woodAndersonResponse),
+			key
 		);
 	}
 	else
@@ -133,27 +141,18 @@ bool AmplitudeProcessor_MLv::deconvolveData(Response *resp,
 	if ( numberOfIntegrations < -1 )
 		return false;
 
-	Math::Restitution::FFT::TransferFunctionPtr tf =
-		resp->getTransferFunction(numberOfIntegrations < 0 ? 0 : numberOfIntegrations);
-
-	if ( tf == NULL )
-		return false;
-
 	Math::SeismometerResponse::WoodAnderson paz(numberOfIntegrations < 0 ? Math::Displacement : Math::Velocity,
 	                                            _config.woodAndersonResponse);
-	Math::Restitution::FFT::PolesAndZeros woodAnderson(paz);
-	Math::Restitution::FFT::TransferFunctionPtr cascade =
-		*tf / woodAnderson;
 
 	// Remove linear trend
 	double m,n;
 	Math::Statistics::computeLinearTrend(data.size(), data.typedData(), m, n);
 	Math::Statistics::detrend(data.size(), data.typedData(), m, n);
 
-	return Math::Restitution::transformFFT(data.size(), data.typedData(),
-	                                       _stream.fsamp, cascade.get(),
-	                                       _config.respTaper, _config.respMinFreq,
-	                                       _config.respMaxFreq);
+	return resp->deconvolveFFT(data, _stream.fsamp, _config.respTaper,
+	                           _config.respMinFreq, _config.respMaxFreq,
+	                           numberOfIntegrations < 0 ? 0 : numberOfIntegrations,
+	                           paz);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
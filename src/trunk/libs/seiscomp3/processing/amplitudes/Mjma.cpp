@@ -63,8 +63,9 @@ AmplitudeProcessor_Mjma::AmplitudeProcessor_Mjma(const Core::Time& trigger)
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmplitudeProcessor_Mjma::initFilter(double fsamp) {
 	if ( !_enableResponses ) {
-		AmplitudeProcessor::setFilter(
-			new Filtering::IIR::Seismometer5secFilter<double>(Velocity)
+		AmplitudeProcessor::setSharedFilter(
+			new Filtering::IIR::Seismometer5secFilter<double>(Velocity),
+			"S5S(velocity)"
 		);
 	}
 	else
@@ -84,26 +85,17 @@ bool AmplitudeProcessor_Mjma::deconvolveData(Response *resp,
 	if ( numberOfIntegrations < -1 )
 		return false;
 
-	Math::Restitution::FFT::TransferFunctionPtr tf =
-		resp->getTransferFunction(numberOfIntegrations < 0 ? 0 : numberOfIntegrations);
-
-	if ( tf == NULL )
-		return false;
-
 	Math::SeismometerResponse::Seismometer5sec paz(numberOfIntegrations < 0 ? Math::Displacement : Math::Velocity);
-	Math::Restitution::FFT::PolesAndZeros seis5sec(paz);
-
-	Math::Restitution::FFT::TransferFunctionPtr cascade =
-		*tf / seis5sec;
 
 	// Remove linear trend
 	double m,n;
 	Math::Statistics::computeLinearTrend(data.size(), data.typedData(), m, n);
 	Math::Statistics::detrend(data.size(), data.typedData(), m, n);
 
-	return Math::Restitution::transformFFT(data.size(), data.typedData(),
-	                                         _stream.fsamp, cascade.get(),
-	                                         _config.respTaper, _config.respMinFreq, _config.respMaxFreq);
+	return resp->deconvolveFFT(data, _stream.fsamp, _config.respTaper,
+	                           _config.respMinFreq, _config.respMaxFreq,
+	                           numberOfIntegrations < 0 ? 0 : numberOfIntegrations,
+	                           paz);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
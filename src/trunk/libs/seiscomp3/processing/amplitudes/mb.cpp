@@ -145,8 +145,9 @@ AmplitudeProcessor_mb::AmplitudeProcessor_mb(const Core::Time& trigger)
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmplitudeProcessor_mb::initFilter(double fsamp) {
-	AmplitudeProcessor::setFilter(
-		new Filtering::IIR::WWSSN_SP_Filter<double>(Velocity)
+	AmplitudeProcessor::setSharedFilter(
+		new Filtering::IIR::WWSSN_SP_Filter<double>(Velocity),
+		"WWSSN_SP(velocity)"
 	);
 	AmplitudeProcessor::initFilter(fsamp);
 }
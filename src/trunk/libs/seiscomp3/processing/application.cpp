@@ -14,9 +14,13 @@
 #define SEISCOMP_COMPONENT ProcessingApplication
 
 #include <seiscomp3/processing/application.h>
+#include <seiscomp3/core/streamregistry.h>
+#include <seiscomp3/core/genericrecord.h>
 #include <seiscomp3/datamodel/configstation.h>
 #include <seiscomp3/logging/log.h>
 
+#include <cmath>
+
 
 namespace Seiscomp {
 
@@ -26,6 +30,8 @@ namespace Processing {
 Application::Application(int argc, char **argv)
 : Client::StreamApplication(argc, argv), _waveformBuffer(30.*60.) {
 	_registrationBlocked = false;
+	_processorCount = 0;
+	_processingGraph = new ProcessingGraph;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -107,7 +113,12 @@ void Application::registerProcessor(const std::string& networkCode,
                                     const std::string& locationCode,
                                     const std::string& channelCode,
                                     WaveformProcessor *wp) {
-	_processors.insert(ProcessorMap::value_type(networkCode + "." + stationCode + "." + locationCode + "." + channelCode, wp));
+	int handle = StreamRegistry::Register(networkCode, stationCode,
+	                                      locationCode, channelCode);
+	if ( handle >= (int)_processors.size() )
+		_processors.resize(handle+1);
+	_processors[handle].push_back(wp);
+	++_processorCount;
 
 	// Because we are dealing with a multimap we need to check if the pointer
 	// is already registered for this station. Otherwise the remove method will
@@ -127,11 +138,20 @@ void Application::registerProcessor(const std::string& networkCode,
 		_stationProcessors.insert(StationProcessors::value_type(staID, wp));
 
 	wp->setEnabled(isStationEnabled(networkCode, stationCode));
+	wp->setProcessingGraph(_processingGraph.get());
+
+	if ( wp->isSampleBufferRequested() )
+		wp->setSampleBuffer(
+			_waveformBuffer.enableSampleBuffer(
+				StreamBuffer::WaveformID(networkCode, stationCode,
+				                         locationCode, channelCode)
+			)
+		);
 
 	SEISCOMP_DEBUG("Added processor on stream %s.%s.%s.%s, current size: %lu/%lu, object count: %d",
 	              networkCode.c_str(), stationCode.c_str(),
 	              locationCode.c_str(), channelCode.c_str(),
-	              (unsigned long)_processors.size(), (unsigned long)_stationProcessors.size(),
+	              (unsigned long)_processorCount, (unsigned long)_stationProcessors.size(),
 	              Core::BaseObject::ObjectCount());
 	SEISCOMP_DEBUG("Added proc %ld", (long)wp);
 }
@@ -157,16 +177,13 @@ void Application::registerProcessor(const std::string& networkCode,
 	Core::Time startTime = twp->timeWindow().startTime() - twp->margin();
 	Core::Time endTime = twp->timeWindow().endTime() +  twp->margin();
 
+	TimeWindowProcessorPtr twp_ptr = twp;
+	RecordSequence::iterator it;
+
 	if ( startTime < seq->timeWindow().startTime() ) {
 		// TODO: Fetch historical data
 		// Actually feed as much data as possible
-		TimeWindowProcessorPtr twp_ptr = twp;
-
-		for ( RecordSequence::iterator it = seq->begin(); it != seq->end(); ++it ) {
-			if ( (*it)->startTime() > endTime )
-				break;
-			twp->feed((*it).get());
-		}
+		it = seq->begin();
 	}
 	else {
 		// find the position in the recordsequence to fill the requested timewindow
@@ -176,18 +193,21 @@ void Application::registerProcessor(const std::string& networkCode,
 				break;
 		}
 
-		RecordSequence::iterator it;
 		if ( rit == seq->rend() )
 			it = seq->begin();
 		else
 			it = --rit.base();
-
-		while ( it != seq->end() && (*it)->startTime() <= endTime ) {
-			twp->feed((*it).get());
-			++it;
-		}
 	}
 
+	RecordSequence::iterator last = it;
+	while ( last != seq->end() && (*last)->startTime() <= endTime )
+		++last;
+
+	feedSampleBuffer(twp, it, last);
+
+	for ( ; it != last; ++it )
+		twp->feed((*it).get());
+
 	if ( twp->isFinished() ) {
 		processorFinished(twp->lastRecord(), twp);
 		removeProcessor(twp);
@@ -198,35 +218,99 @@ void Application::registerProcessor(const std::string& networkCode,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Application::feedSampleBuffer(TimeWindowProcessor *twp,
+                                   RecordSequence::iterator &it,
+                                   RecordSequence::iterator end) {
+	const SampleRingBuffer *samples = twp->sampleBuffer();
+	if ( samples == NULL || it == end ) return;
+
+	// Only records that end before the time window is complete are
+	// combined. Processors do not act on them except collecting their
+	// samples, so feeding them at once yields the same result.
+	const Record *first = it->get();
+	const Record *lastRecord = NULL;
+	double fsamp = first->samplingFrequency();
+	size_t count = 0, records = 0;
+
+	RecordSequence::iterator last = it;
+	for ( ; last != end; ++last ) {
+		const Record *rec = last->get();
+		if ( rec->endTime() >= twp->timeWindow().endTime() ) break;
+
+		// Records the processor would reject are fed one by one
+		if ( rec->data() == NULL || rec->samplingFrequency() != fsamp ||
+		     !rec->timeWindow().overlaps(twp->safetyTimeWindow()) )
+			return;
+
+		count += rec->data()->size();
+		lastRecord = rec;
+		++records;
+	}
+
+	if ( records < 2 || fsamp <= 0 ) return;
+
+	// The window is shifted by half a sample to be robust against
+	// rounding of the sample times
+	double dt = 1.0 / fsamp;
+	SampleRingBuffer::View view;
+	Core::TimeWindow tw(first->startTime() - Core::TimeSpan(0.5*dt),
+	                    first->startTime() + Core::TimeSpan((count-0.5)*dt));
+
+	// The buffer must hold exactly the samples of the records, otherwise
+	// records have gaps or overlaps that the processor handles itself
+	if ( !samples->view(tw, view) || !view.gapFree || view.size != count ||
+	     fabs((double)(view.startTime - first->startTime())) > 0.5*dt )
+		return;
+
+	DoubleArrayPtr data = new DoubleArray((int)view.size, view.data);
+	GenericRecordPtr rec = new GenericRecord(first->networkCode(), first->stationCode(),
+	                                         first->locationCode(), first->channelCode(),
+	                                         first->startTime(), fsamp);
+	rec->setData(data.get());
+
+	SEISCOMP_DEBUG("Feeding %lu records (%lu samples) of %s until %s at once",
+	               (unsigned long)records, (unsigned long)count,
+	               first->streamID().c_str(), lastRecord->endTime().iso().c_str());
+
+	twp->feed(rec.get());
+	it = last;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::removeProcessors(const std::string& networkCode,
                                    const std::string& stationCode,
                                    const std::string& locationCode,
                                    const std::string& channelCode) {
 
-	bool checkPendingQueue;
-	std::pair<ProcessorMap::iterator, ProcessorMap::iterator> itq =
-		_processors.equal_range(networkCode + "." +
-		                        stationCode + "." +
-		                        locationCode + "." +
-		                        channelCode);
-
-	checkPendingQueue = itq.first == itq.second;
-
-	// Remove stations - processor association
-	for ( ProcessorMap::iterator it = itq.first; it != itq.second; ++it ) {
-		for ( StationProcessors::iterator its = _stationProcessors.begin();
-		      its != _stationProcessors.end(); )
-		{
-			if ( its->second == it->second ) {
-				SEISCOMP_DEBUG("Removed processor from station %s", its->first.c_str());
-				_stationProcessors.erase(its++);
-				break;
+	int handle = StreamRegistry::Find(networkCode, stationCode,
+	                                  locationCode, channelCode);
+	bool checkPendingQueue = true;
+
+	if ( handle >= 0 && handle < (int)_processors.size() ) {
+		ProcessorList &procs = _processors[handle];
+		checkPendingQueue = procs.empty();
+
+		// Remove stations - processor association
+		for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ++it ) {
+			for ( StationProcessors::iterator its = _stationProcessors.begin();
+			      its != _stationProcessors.end(); ++its )
+			{
+				if ( its->second == *it ) {
+					SEISCOMP_DEBUG("Removed processor from station %s", its->first.c_str());
+					_stationProcessors.erase(its);
+					break;
+				}
 			}
 		}
-	}
 
-	_processors.erase(itq.first, itq.second);
+		_processorCount -= procs.size();
+		procs.clear();
+	}
 
 	if ( !checkPendingQueue ) return;
 
@@ -261,16 +345,19 @@ void Application::removeProcessor(Processing::WaveformProcessor *wp) {
 		return;
 	}
 
-	for ( ProcessorMap::iterator it = _processors.begin();
-	      it != _processors.end(); )
-	{
-		if ( it->second.get() == wp ) {
-			SEISCOMP_DEBUG("Removed proc %ld", (long)wp);
-			SEISCOMP_DEBUG("Removed processor from stream %s", it->first.c_str());
-			_processors.erase(it++);
+	for ( size_t h = 0; h < _processors.size(); ++h ) {
+		ProcessorList &procs = _processors[h];
+		for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ) {
+			if ( it->get() == wp ) {
+				SEISCOMP_DEBUG("Removed proc %ld", (long)wp);
+				SEISCOMP_DEBUG("Removed processor from stream %s",
+				               StreamRegistry::StreamID((int)h).c_str());
+				it = procs.erase(it);
+				--_processorCount;
+			}
+			else
+				++it;
 		}
-		else
-			++it;
 	}
 
 	for ( StationProcessors::iterator it = _stationProcessors.begin();
@@ -307,7 +394,16 @@ void Application::removeProcessor(Processing::WaveformProcessor *wp) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t Application::processorCount() const {
-	return _processors.size();
+	return _processorCount;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph *Application::processingGraph() const {
+	return _processingGraph.get();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -361,8 +457,7 @@ void Application::updateObject(const std::string& parentID, DataModel::Object* o
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::handleRecord(Record *rec) {
-	std::string streamID = rec->streamID();
-	std::list<WaveformProcessor*> trashList;
+	std::vector<WaveformProcessor*> trashList;
 
 	RecordPtr tmp(rec);
 
@@ -375,15 +470,21 @@ void Application::handleRecord(Record *rec) {
 
 	_registrationBlocked = true;
 
-	std::pair<ProcessorMap::iterator, ProcessorMap::iterator> itq = _processors.equal_range(streamID);
-	for (ProcessorMap::iterator it = itq.first; it != itq.second; ++it) {
-		// Schedule the processor for deletion when finished
-		if ( it->second->isFinished() )
-			trashList.push_back(it->second.get());
-		else {
-			it->second->feed(rec);
-			if ( it->second->isFinished() )
-				trashList.push_back(it->second.get());
+	int handle = rec->streamHandle();
+	if ( handle < (int)_processors.size() ) {
+		// Registration and removal is blocked so the list is not modified
+		// while processors are fed
+		ProcessorList &procs = _processors[handle];
+		for ( size_t i = 0; i < procs.size(); ++i ) {
+			WaveformProcessor *proc = procs[i].get();
+			// Schedule the processor for deletion when finished
+			if ( proc->isFinished() )
+				trashList.push_back(proc);
+			else {
+				proc->feed(rec);
+				if ( proc->isFinished() )
+					trashList.push_back(proc);
+			}
 		}
 	}
 
@@ -416,10 +517,9 @@ void Application::handleRecord(Record *rec) {
 	}
 
 	// Delete finished processors
-	for ( std::list<WaveformProcessor*>::iterator itt = trashList.begin();
-	      itt != trashList.end(); ++itt ) {
-		processorFinished(rec, *itt);
-		removeProcessor(*itt);
+	for ( size_t i = 0; i < trashList.size(); ++i ) {
+		processorFinished(rec, trashList[i]);
+		removeProcessor(trashList[i]);
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -429,6 +529,8 @@ void Application::handleRecord(Record *rec) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::done() {
+	_processingGraph->logStatistics();
+
 	Client::StreamApplication::done();
 	//_waveformBuffer.printStreams();
 }
@@ -452,10 +554,13 @@ void Application::enableStation(const std::string& code, bool enabled) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::enableStream(const std::string& code, bool enabled) {
-	std::pair<StationProcessors::iterator, StationProcessors::iterator> itq = _processors.equal_range(code);
-	for (StationProcessors::iterator it = itq.first; it != itq.second; ++it) {
+	int handle = StreamRegistry::Find(code);
+	if ( handle < 0 || handle >= (int)_processors.size() ) return;
+
+	ProcessorList &procs = _processors[handle];
+	for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ++it ) {
 		SEISCOMP_INFO("%s stream %s", enabled?"Enabling":"Disabling", code.c_str());
-		it->second->setEnabled(enabled);
+		(*it)->setEnabled(enabled);
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -20,6 +20,7 @@
 #include <seiscomp3/processing/waveformprocessor.h>
 #include <seiscomp3/processing/timewindowprocessor.h>
 #include <seiscomp3/processing/streambuffer.h>
+#include <seiscomp3/processing/processinggraph.h>
 
 
 namespace Seiscomp {
@@ -70,6 +71,10 @@ class SC_SYSTEM_CLIENT_API Application : public Client::StreamApplication {
 
 		size_t processorCount() const;
 
+		//! Returns the graph that shares identical filter stages
+		//! between all added processors
+		ProcessingGraph *processingGraph() const;
+
 
 	// ----------------------------------------------------------------------
 	//  Protected methods
@@ -106,13 +111,22 @@ class SC_SYSTEM_CLIENT_API Application : public Client::StreamApplication {
 		                       const std::string& channelCode,
 		                       TimeWindowProcessor *twp);
 
+		//! Feeds the buffered records starting at it as one record taken
+		//! from the sample buffer of the processor if it has requested one.
+		//! it is advanced behind the combined records.
+		void feedSampleBuffer(TimeWindowProcessor *twp,
+		                      RecordSequence::iterator &it,
+		                      RecordSequence::iterator end);
+
 
 	// ----------------------------------------------------------------------
 	//  Private members
 	// ----------------------------------------------------------------------
 	private:
 		typedef std::multimap<std::string, WaveformProcessorPtr> StationProcessors;
-		typedef std::multimap<std::string, WaveformProcessorPtr> ProcessorMap;
+		typedef std::vector<WaveformProcessorPtr>                ProcessorList;
+		//! Processors indexed by stream handle (see Record::streamHandle())
+		typedef std::vector<ProcessorList>                       ProcessorMap;
 		typedef DataModel::WaveformStreamID                      WID;
 		typedef std::pair<WID, WaveformProcessorPtr>             WaveformProcessorItem;
 		typedef std::pair<WID, TimeWindowProcessorPtr>           TimeWindowProcessorItem;
@@ -121,9 +135,11 @@ class SC_SYSTEM_CLIENT_API Application : public Client::StreamApplication {
 		typedef std::list<TimeWindowProcessorItem>               TimeWindowProcessorQueue;
 
 		ProcessorMap                    _processors;
+		size_t                          _processorCount;
 		StationProcessors               _stationProcessors;
 
 		StreamBuffer                    _waveformBuffer;
+		ProcessingGraphPtr              _processingGraph;
 
 		WaveformProcessorQueue          _waveformProcessorQueue;
 		WaveformProcessorRemovalQueue   _waveformProcessorRemovalQueue;
@@ -160,7 +160,7 @@ bool GFZPicker::setup(const Settings &settings) {
 			               _usedFilter.c_str(), error.c_str());
 			return false;
 		}
-		setFilter(f);
+		setSharedFilter(f, _usedFilter);
 	}
 
 	return true;
@@ -0,0 +1,446 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT ProcessingGraph
+
+#include <seiscomp3/processing/processinggraph.h>
+#include <seiscomp3/logging/log.h>
+
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+
+namespace Seiscomp {
+
+namespace Processing {
+
+
+namespace {
+
+
+// The maximum number of samples a stage keeps. If a stage grows beyond
+// that all its consumers continue with their own filter.
+const size_t MaxStageSamples = 1 << 18;
+
+// The number of deconvolutions kept for reuse
+const size_t MaxDeconvolutions = 16;
+
+
+}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+class ProcessingGraph::Stage : public Core::BaseObject {
+	public:
+		Stage(const std::string &id, const Core::Time &startTime, Filter *filter)
+		: id(id), startTime(startTime), filter(filter), consumers(0),
+		  closed(false) {}
+
+		~Stage() {
+			delete filter;
+		}
+
+	public:
+		std::string         id;
+		Core::Time          startTime;
+		Filter             *filter;
+		//! The input and output samples since the start time
+		std::vector<double> input;
+		std::vector<double> output;
+		size_t              consumers;
+		//! A closed stage does not accept new samples
+		bool                closed;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+class ProcessingGraph::SharedFilter : public ProcessingGraph::Filter {
+	public:
+		SharedFilter(ProcessingGraph *graph, Filter *prototype,
+		             const std::string &key)
+		: _graph(graph), _prototype(prototype), _key(key), _fsamp(0),
+		  _hasSamplingFrequency(false), _hasStartTime(false),
+		  _hasStreamID(false), _position(0), _filter(NULL) {}
+
+		~SharedFilter() {
+			leave();
+			if ( _filter ) delete _filter;
+			delete _prototype;
+		}
+
+	public:
+		void setStartTime(const Core::Time &time) {
+			if ( _stage ) detach();
+			_startTime = time;
+			_hasStartTime = true;
+			if ( _filter ) _filter->setStartTime(time);
+		}
+
+		void setStreamID(const std::string &net, const std::string &sta,
+		                 const std::string &loc, const std::string &cha) {
+			if ( _stage ) detach();
+			_net = net; _sta = sta; _loc = loc; _cha = cha;
+			_hasStreamID = true;
+			if ( _filter ) _filter->setStreamID(net, sta, loc, cha);
+		}
+
+		void setSamplingFrequency(double fsamp) {
+			if ( _stage ) detach();
+			_fsamp = fsamp;
+			_hasSamplingFrequency = true;
+			if ( _filter ) _filter->setSamplingFrequency(fsamp);
+		}
+
+		int setParameters(int n, const double *params) {
+			if ( _stage ) detach();
+			int res = _prototype->setParameters(n, params);
+			if ( _filter ) res = _filter->setParameters(n, params);
+			return res;
+		}
+
+		void apply(int n, double *inout) {
+			if ( n <= 0 ) return;
+
+			if ( _filter == NULL ) {
+				if ( !_stage ) join();
+				if ( advance(n, inout) ) return;
+				detach();
+			}
+
+			_filter->apply(n, inout);
+			_graph->_statistics.filteredSamples += n;
+		}
+
+		void handleGap(int n) {
+			detach();
+			_filter->handleGap(n);
+		}
+
+		Filter *clone() const {
+			return new SharedFilter(_graph.get(), _prototype->clone(), _key);
+		}
+
+		//! Creates a filter from the prototype with the settings
+		//! passed so far
+		Filter *create() const {
+			Filter *filter = _prototype->clone();
+			if ( _hasSamplingFrequency ) filter->setSamplingFrequency(_fsamp);
+			if ( _hasStartTime ) filter->setStartTime(_startTime);
+			if ( _hasStreamID ) filter->setStreamID(_net, _sta, _loc, _cha);
+			return filter;
+		}
+
+	private:
+		void join() {
+			// The stage identifier contains everything that
+			// influences the output of the filter
+			char tmp[64];
+			std::string id = _key;
+
+			id += '|';
+			if ( _hasStreamID ) id += _net + "." + _sta + "." + _loc + "." + _cha;
+			id += '|';
+			if ( _hasSamplingFrequency ) {
+				snprintf(tmp, sizeof(tmp), "%.17g", _fsamp);
+				id += tmp;
+			}
+			id += '|';
+			if ( _hasStartTime ) {
+				snprintf(tmp, sizeof(tmp), "%ld.%06ld",
+				         _startTime.seconds(), _startTime.microseconds());
+				id += tmp;
+			}
+
+			_stage = _graph->join(id, _startTime, this);
+			_position = 0;
+		}
+
+		void leave() {
+			if ( !_stage ) return;
+			--_stage->consumers;
+			_stage = NULL;
+		}
+
+		//! Copies the output of the stage for the given input or
+		//! runs the stage filter if this filter is ahead of all
+		//! other consumers.
+		//! @return false if the input differs from the stage input
+		bool advance(int n, double *inout) {
+			Stage *stage = _stage.get();
+			if ( stage->closed ) return false;
+
+			size_t head = stage->input.size();
+			size_t count = (size_t)n;
+			size_t cached = 0;
+
+			if ( _position < head )
+				cached = std::min(head - _position, count);
+
+			if ( cached > 0 &&
+			     memcmp(&stage->input[_position], inout, cached*sizeof(double)) != 0 )
+				return false;
+
+			size_t rest = count - cached;
+			if ( rest > 0 && head + rest > MaxStageSamples ) {
+				_graph->close(stage);
+				return false;
+			}
+
+			if ( cached > 0 ) {
+				memcpy(inout, &stage->output[_position], cached*sizeof(double));
+				_graph->_statistics.sharedSamples += cached;
+			}
+
+			if ( rest > 0 ) {
+				double *data = inout + cached;
+				stage->input.insert(stage->input.end(), data, data + rest);
+				stage->filter->apply((int)rest, data);
+				stage->output.insert(stage->output.end(), data, data + rest);
+				_graph->_statistics.filteredSamples += rest;
+			}
+
+			_position += count;
+			return true;
+		}
+
+		//! Continues with an own filter that is brought into the state
+		//! of the stage at the current position
+		void detach() {
+			if ( _filter ) return;
+
+			_filter = create();
+
+			if ( !_stage ) return;
+
+			if ( _position > 0 ) {
+				std::vector<double> data(_stage->input.begin(),
+				                         _stage->input.begin() + _position);
+				_filter->apply((int)_position, &data[0]);
+				_graph->_statistics.filteredSamples += _position;
+			}
+
+			leave();
+			++_graph->_statistics.detached;
+		}
+
+	private:
+		ProcessingGraphPtr _graph;
+		Filter            *_prototype;
+		std::string        _key;
+
+		double             _fsamp;
+		Core::Time         _startTime;
+		std::string        _net, _sta, _loc, _cha;
+		bool               _hasSamplingFrequency;
+		bool               _hasStartTime;
+		bool               _hasStreamID;
+
+		StagePtr           _stage;
+		size_t             _position;
+		//! The own filter if not sharing a stage
+		Filter            *_filter;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph::Statistics::Statistics()
+: stages(0), consumers(0), detached(0), filteredSamples(0),
+  sharedSamples(0), deconvolutions(0), sharedDeconvolutions(0) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph::ProcessingGraph() : _retentionTime(30.*60.) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph::~ProcessingGraph() {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ProcessingGraph::setRetentionTime(const Core::TimeSpan &span) {
+	_retentionTime = span;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph::Filter *ProcessingGraph::share(Filter *filter,
+                                                const std::string &key) {
+	if ( filter == NULL ) return NULL;
+	return new SharedFilter(this, filter, key);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool ProcessingGraph::reuseDeconvolution(const std::string &key,
+                                         Response *resp,
+                                         DoubleArray &data) {
+	for ( Deconvolutions::iterator it = _deconvolutions.begin();
+	      it != _deconvolutions.end(); ++it ) {
+		if ( it->response.get() != resp || it->key != key ) continue;
+		if ( it->input->size() != data.size() ) continue;
+		if ( memcmp(it->input->typedData(), data.typedData(),
+		            data.size()*sizeof(double)) != 0 ) continue;
+
+		data = *it->output;
+		++_statistics.sharedDeconvolutions;
+
+		// Move the entry to the front
+		Deconvolution entry = *it;
+		_deconvolutions.erase(it);
+		_deconvolutions.push_front(entry);
+		return true;
+	}
+
+	return false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ProcessingGraph::storeDeconvolution(const std::string &key,
+                                         Response *resp,
+                                         const DoubleArray &input,
+                                         const DoubleArray &output) {
+	++_statistics.deconvolutions;
+
+	Deconvolution entry;
+	entry.key = key;
+	// Holding the response makes sure that its address is not reused
+	// by another response as long as the entry exists
+	entry.response = resp;
+	entry.input = new DoubleArray(input);
+	entry.output = new DoubleArray(output);
+
+	_deconvolutions.push_front(entry);
+	if ( _deconvolutions.size() > MaxDeconvolutions )
+		_deconvolutions.pop_back();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const ProcessingGraph::Statistics &ProcessingGraph::statistics() const {
+	return _statistics;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ProcessingGraph::logStatistics() const {
+	if ( _statistics.consumers == 0 && _statistics.deconvolutions == 0 )
+		return;
+
+	SEISCOMP_INFO("Shared processing: %lu filters joined %lu stages "
+	              "(%lu detached), %lu samples filtered, %lu reused; "
+	              "%lu deconvolutions computed, %lu reused",
+	              (unsigned long)_statistics.consumers,
+	              (unsigned long)_statistics.stages,
+	              (unsigned long)_statistics.detached,
+	              (unsigned long)_statistics.filteredSamples,
+	              (unsigned long)_statistics.sharedSamples,
+	              (unsigned long)_statistics.deconvolutions,
+	              (unsigned long)_statistics.sharedDeconvolutions);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph::StagePtr
+ProcessingGraph::join(const std::string &id, const Core::Time &startTime,
+                      const SharedFilter *consumer) {
+	purge(startTime);
+
+	StagePtr stage;
+	Stages::iterator it = _stages.find(id);
+	if ( it != _stages.end() )
+		stage = it->second;
+	else {
+		stage = new Stage(id, startTime, consumer->create());
+		_stages[id] = stage;
+		++_statistics.stages;
+		SEISCOMP_DEBUG("Created stage %s", id.c_str());
+	}
+
+	++stage->consumers;
+	++_statistics.consumers;
+	return stage;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ProcessingGraph::close(Stage *stage) {
+	stage->closed = true;
+	Stages::iterator it = _stages.find(stage->id);
+	if ( it != _stages.end() && it->second == stage )
+		_stages.erase(it);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ProcessingGraph::purge(const Core::Time &time) {
+	// Stages without consumers are only kept for processors that start
+	// at the same time later, e.g. when fed from a stream buffer
+	Stages::iterator it = _stages.begin();
+	while ( it != _stages.end() ) {
+		if ( it->second->consumers == 0 &&
+		     it->second->startTime + _retentionTime < time )
+			_stages.erase(it++);
+		else
+			++it;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+
+}
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_PROCESSING_PROCESSINGGRAPH_H__
+#define __SEISCOMP_PROCESSING_PROCESSINGGRAPH_H__
+
+
+#include <string>
+#include <deque>
+#include <map>
+
+#include <seiscomp3/core/baseobject.h>
+#include <seiscomp3/core/datetime.h>
+#include <seiscomp3/core/typedarray.h>
+#include <seiscomp3/math/filter.h>
+#include <seiscomp3/processing/response.h>
+#include <seiscomp3/client.h>
+
+
+namespace Seiscomp {
+
+namespace Processing {
+
+
+DEFINE_SMARTPOINTER(ProcessingGraph);
+
+
+/**
+ * \brief Shares identical processing stages between the processors of
+ * \brief a stream.
+ *
+ * Processors created for the same stream, e.g. the pickers and amplitude
+ * processors of scautopick, often filter the same samples with the same
+ * filter. The graph collects those stages by a key that describes their
+ * parameters. A filter returned by share() joins the stage of its key,
+ * stream, sampling frequency and start time when it is applied the first
+ * time. The first consumer of a stage runs the filter, all others copy its
+ * output. Each consumer compares its input with the input of the stage
+ * and leaves the stage with its own filter if it differs, so the results
+ * are always identical to unshared processing.
+ *
+ * Deconvolved data is shared the same way through reuseDeconvolution()
+ * and storeDeconvolution().
+ *
+ * The graph is not thread-safe. All processors sharing a graph must be
+ * fed from the same thread.
+ */
+class SC_SYSTEM_CLIENT_API ProcessingGraph : public Core::BaseObject {
+	// ----------------------------------------------------------------------
+	//  Public types
+	// ----------------------------------------------------------------------
+	public:
+		typedef Math::Filtering::InPlaceFilter<double> Filter;
+
+		struct Statistics {
+			Statistics();
+
+			//! Number of filter stages created
+			size_t stages;
+			//! Number of filters that joined a stage
+			size_t consumers;
+			//! Number of filters that left a stage because their
+			//! input differed
+			size_t detached;
+			//! Number of samples run through a filter
+			size_t filteredSamples;
+			//! Number of filter output samples copied from a stage
+			size_t sharedSamples;
+			//! Number of deconvolutions computed
+			size_t deconvolutions;
+			//! Number of deconvolutions copied from a previous run
+			size_t sharedDeconvolutions;
+		};
+
+
+	// ----------------------------------------------------------------------
+	//  X'truction
+	// ----------------------------------------------------------------------
+	public:
+		ProcessingGraph();
+		~ProcessingGraph();
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		//! Sets how long a stage without consumers is kept for
+		//! processors that start later at the same time, e.g. when
+		//! they are fed from a stream buffer. The default is 30 minutes.
+		void setRetentionTime(const Core::TimeSpan &span);
+
+		//! Returns a filter that computes the output of filter through
+		//! the shared stage of key. The key must describe all parameters
+		//! of filter, e.g. its filter string. The returned filter takes
+		//! ownership of filter.
+		Filter *share(Filter *filter, const std::string &key);
+
+		//! Replaces data with the output of a previous deconvolution of
+		//! exactly the same data with the same key and response.
+		//! @return Whether a matching deconvolution was found
+		bool reuseDeconvolution(const std::string &key, Response *resp,
+		                        DoubleArray &data);
+
+		//! Stores the output of a deconvolution for reuseDeconvolution
+		void storeDeconvolution(const std::string &key, Response *resp,
+		                        const DoubleArray &input,
+		                        const DoubleArray &output);
+
+		const Statistics &statistics() const;
+
+		//! Logs the statistics if anything was shared
+		void logStatistics() const;
+
+
+	// ----------------------------------------------------------------------
+	//  Private types and methods
+	// ----------------------------------------------------------------------
+	private:
+		class Stage;
+		class SharedFilter;
+		friend class Stage;
+		friend class SharedFilter;
+
+		typedef Core::SmartPointer<Stage>::Impl StagePtr;
+		typedef std::map<std::string, StagePtr> Stages;
+
+		struct Deconvolution {
+			std::string    key;
+			ResponsePtr    response;
+			DoubleArrayPtr input;
+			DoubleArrayPtr output;
+		};
+
+		typedef std::deque<Deconvolution> Deconvolutions;
+
+		StagePtr join(const std::string &id, const Core::Time &startTime,
+		              const SharedFilter *consumer);
+		void close(Stage *stage);
+		void purge(const Core::Time &time);
+
+
+	// ----------------------------------------------------------------------
+	//  Private members
+	// ----------------------------------------------------------------------
+	private:
+		Stages         _stages;
+		Deconvolutions _deconvolutions;
+		Core::TimeSpan _retentionTime;
+		Statistics     _statistics;
+};
+
+
+}
+
+}
+
+
+#endif
@@ -14,6 +14,13 @@
 
 #include <seiscomp3/processing/response.h>
 #include <seiscomp3/math/restitution/fft.h>
+#include <seiscomp3/math/fft.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <list>
+#include <map>
 
 
 namespace Seiscomp {
@@ -23,6 +30,134 @@ namespace Processing  {
 
 
 
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+namespace {
+
+
+typedef std::vector<Math::Complex> Operator;
+typedef boost::shared_ptr<const Operator> OperatorPtr;
+
+
+template <typename T>
+void append(std::string &key, const T &value) {
+	key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+void append(std::string &key, const Math::SeismometerResponse::FAP &fap) {
+	append(key, fap.frequency);
+	append(key, fap.amplitude);
+	append(key, fap.phaseAngle);
+}
+
+
+template <typename T>
+void append(std::string &key, const std::vector<T> &values) {
+	append(key, values.size());
+	for ( size_t i = 0; i < values.size(); ++i )
+		append(key, values[i]);
+}
+
+
+void append(std::string &key, const Math::SeismometerResponse::PolesAndZeros &paz) {
+	append(key, paz.norm);
+	append(key, paz.poles);
+	append(key, paz.zeros);
+}
+
+
+/**
+ * Keeps the most recently used deconvolution operators up to a maximum
+ * number of bytes.
+ */
+class OperatorCache {
+	public:
+		OperatorCache() : _maxBytes(64*1024*1024), _bytes(0) {}
+
+	public:
+		void setMaxBytes(size_t bytes) {
+			boost::mutex::scoped_lock lock(_mutex);
+			_maxBytes = bytes;
+			shrink();
+		}
+
+		size_t maxBytes() const {
+			boost::mutex::scoped_lock lock(_mutex);
+			return _maxBytes;
+		}
+
+		OperatorPtr get(const std::string &key) {
+			boost::mutex::scoped_lock lock(_mutex);
+			Entries::iterator it = _entries.find(key);
+			if ( it == _entries.end() )
+				return OperatorPtr();
+
+			// Move to the front of the usage list
+			_usage.splice(_usage.begin(), _usage, it->second.usage);
+			return it->second.op;
+		}
+
+		void put(const std::string &key, const OperatorPtr &op) {
+			boost::mutex::scoped_lock lock(_mutex);
+			size_t bytes = sizeOf(key, op);
+			if ( bytes > _maxBytes )
+				return;
+
+			std::pair<Entries::iterator, bool> res =
+				_entries.insert(Entries::value_type(key, Entry()));
+			if ( !res.second )
+				return;
+
+			_usage.push_front(res.first);
+			res.first->second.op = op;
+			res.first->second.usage = _usage.begin();
+			_bytes += bytes;
+
+			shrink();
+		}
+
+	private:
+		struct Entry;
+		typedef std::map<std::string, Entry> Entries;
+		typedef std::list<Entries::iterator> Usage;
+
+		struct Entry {
+			OperatorPtr     op;
+			Usage::iterator usage;
+		};
+
+		static size_t sizeOf(const std::string &key, const OperatorPtr &op) {
+			return key.size() + op->size()*sizeof(Math::Complex);
+		}
+
+		void shrink() {
+			while ( _bytes > _maxBytes && !_usage.empty() ) {
+				Entries::iterator it = _usage.back();
+				_bytes -= sizeOf(it->first, it->second.op);
+				_usage.pop_back();
+				_entries.erase(it);
+			}
+		}
+
+	private:
+		mutable boost::mutex _mutex;
+		Entries              _entries;
+		Usage                _usage;
+		size_t               _maxBytes;
+		size_t               _bytes;
+};
+
+
+OperatorCache Cache;
+
+
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Response::Response() {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -42,13 +177,8 @@ bool Response::deconvolveFFT(int n, float *inout, double fsamp,
                              double cutoff,
                              double min_freq, double max_freq,
                              int numberOfIntegrations) {
-	Math::Restitution::FFT::TransferFunctionPtr tf =
-		getTransferFunction(numberOfIntegrations);
-	if ( !tf )
-		return false;
-
-	return Math::Restitution::transformFFT(n, inout, fsamp, tf.get(),
-	                                         cutoff, min_freq, max_freq);
+	return deconvolve(n, inout, fsamp, cutoff, min_freq, max_freq,
+	                  numberOfIntegrations, NULL);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -60,13 +190,8 @@ bool Response::deconvolveFFT(int n, double *inout, double fsamp,
                              double cutoff,
                              double min_freq, double max_freq,
                              int numberOfIntegrations) {
-	Math::Restitution::FFT::TransferFunctionPtr tf =
-		getTransferFunction(numberOfIntegrations);
-	if ( !tf )
-		return false;
-
-	return Math::Restitution::transformFFT(n, inout, fsamp, tf.get(),
-	                                         cutoff, min_freq, max_freq);
+	return deconvolve(n, inout, fsamp, cutoff, min_freq, max_freq,
+	                  numberOfIntegrations, NULL);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -99,6 +224,75 @@ bool Response::deconvolveFFT(DoubleArray &inout, double fsamp,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Response::deconvolveFFT(DoubleArray &inout, double fsamp,
+                             double cutoff,
+                             double min_freq, double max_freq,
+                             int numberOfIntegrations,
+                             const Math::SeismometerResponse::PolesAndZeros &simulation) {
+	return deconvolve(inout.size(), inout.typedData(), fsamp,
+	                  cutoff, min_freq, max_freq, numberOfIntegrations,
+	                  &simulation);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+template <typename T>
+bool Response::deconvolve(int n, T *inout, double fsamp,
+                          double cutoff, double min_freq, double max_freq,
+                          int numberOfIntegrations,
+                          const Math::SeismometerResponse::PolesAndZeros *simulation) {
+	std::string key;
+
+	if ( Cache.maxBytes() > 0 ) {
+		key = cacheKey();
+		if ( !key.empty() ) {
+			append(key, numberOfIntegrations);
+			append(key, fsamp);
+			append(key, Math::spectrumSize(n));
+			append(key, min_freq);
+			append(key, max_freq);
+			if ( simulation ) append(key, *simulation);
+
+			OperatorPtr op = Cache.get(key);
+			if ( op )
+				return Math::Restitution::transformFFT(n, inout, fsamp, *op, cutoff);
+		}
+	}
+
+	Math::Restitution::FFT::TransferFunctionPtr tf =
+		getTransferFunction(numberOfIntegrations);
+	if ( !tf )
+		return false;
+
+	Math::Restitution::FFT::TransferFunctionPtr sim, cascade;
+	if ( simulation ) {
+		sim = new Math::Restitution::FFT::PolesAndZeros(*simulation);
+		cascade = *tf / *sim;
+	}
+	else
+		cascade = tf;
+
+	Operator *op = new Operator;
+	OperatorPtr managedOp(op);
+
+	if ( !Math::Restitution::deconvolutionOperator(*op, n, fsamp, cascade.get(),
+	                                               min_freq, max_freq) )
+		return false;
+
+	if ( !key.empty() )
+		Cache.put(key, managedOp);
+
+	return Math::Restitution::transformFFT(n, inout, fsamp, *op, cutoff);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Math::Restitution::FFT::TransferFunction *
 Response::getTransferFunction(int numberOfIntegrations) {
@@ -109,6 +303,33 @@ Response::getTransferFunction(int numberOfIntegrations) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Response::SetCacheSize(size_t bytes) {
+	Cache.setMaxBytes(bytes);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t Response::CacheSize() {
+	return Cache.maxBytes();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string Response::cacheKey() const {
+	return std::string();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 ResponsePAZ::ResponsePAZ() {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -237,6 +458,25 @@ ResponsePAZ::getTransferFunction(int numberOfIntegrations) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string ResponsePAZ::cacheKey() const {
+	std::string key;
+
+	if ( !_normalizationFactor )
+		return key;
+
+	key = "PAZ";
+	append(key, *_normalizationFactor);
+	append(key, _poles);
+	append(key, _zeros);
+
+	return key;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 ResponseFAP::ResponseFAP() {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -295,6 +535,17 @@ Math::Restitution::FFT::TransferFunction *ResponseFAP::getTransferFunction(int n
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string ResponseFAP::cacheKey() const {
+	std::string key = "FAP";
+	append(key, _faps);
+	return key;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
@@ -21,6 +21,7 @@
 #include <seiscomp3/math/filter/seismometers.h>
 #include <seiscomp3/client.h>
 
+#include <string>
 #include <vector>
 
 
@@ -71,6 +72,15 @@ class SC_SYSTEM_CLIENT_API Response : public Core::BaseObject {
 		                   double min_freq, double max_freq,
 		                   int numberOfIntegrations = 0);
 
+		//! Deconvolves data in the frequency domain and convolves it with
+		//! the given response, e.g. to simulate a Wood-Anderson
+		//! seismometer.
+		bool deconvolveFFT(DoubleArray &inout, double fsamp,
+		                   double cutoff,
+		                   double min_freq, double max_freq,
+		                   int numberOfIntegrations,
+		                   const Math::SeismometerResponse::PolesAndZeros &simulation);
+
 		//! Returns a transfer function that can be used to deconvolve the
 		//! data. The transfer function does not incorporate the gain.
 		//! @param numberOfIntegrations How often to integrate. In case of
@@ -78,6 +88,39 @@ class SC_SYSTEM_CLIENT_API Response : public Core::BaseObject {
 		//!                             additional zeros to 'zeros'.
 		virtual Math::Restitution::FFT::TransferFunction *
 			getTransferFunction(int numberOfIntegrations = 0);
+
+		//! Sets the maximum number of bytes of the spectral operators
+		//! cached by deconvolveFFT. The cache is shared by all responses
+		//! and the operators are evaluated once per response, sampling
+		//! frequency, FFT length and band limits. A size of 0 disables
+		//! the cache. The default is 64MB.
+		static void SetCacheSize(size_t bytes);
+
+		//! Returns the maximum number of bytes of the cached operators
+		static size_t CacheSize();
+
+
+	// ----------------------------------------------------------------------
+	//  Protected interface
+	// ----------------------------------------------------------------------
+	protected:
+		//! Returns a key that identifies the transfer function returned
+		//! by getTransferFunction, e.g. its binary encoded parameters.
+		//! Responses with equal keys share their cached operators. The
+		//! default implementation returns an empty key which disables
+		//! caching.
+		virtual std::string cacheKey() const;
+
+
+	// ----------------------------------------------------------------------
+	//  Private interface
+	// ----------------------------------------------------------------------
+	private:
+		template <typename T>
+		bool deconvolve(int n, T *inout, double fsamp,
+		                double cutoff, double min_freq, double max_freq,
+		                int numberOfIntegrations,
+		                const Math::SeismometerResponse::PolesAndZeros *simulation);
 };
 
 
@@ -133,6 +176,13 @@ class SC_SYSTEM_CLIENT_API ResponsePAZ : public Response {
 			getTransferFunction(int numberOfIntegrations = 0);
 
 
+	// ----------------------------------------------------------------------
+	//  Protected interface
+	// ----------------------------------------------------------------------
+	protected:
+		std::string cacheKey() const;
+
+
 	// ----------------------------------------------------------------------
 	//  Private interface
 	// ----------------------------------------------------------------------
@@ -179,6 +229,13 @@ class SC_SYSTEM_CLIENT_API ResponseFAP : public Response {
 			getTransferFunction(int numberOfIntegrations = 0);
 
 
+	// ----------------------------------------------------------------------
+	//  Protected interface
+	// ----------------------------------------------------------------------
+	protected:
+		std::string cacheKey() const;
+
+
 	// ----------------------------------------------------------------------
 	//  Private interface
 	// ----------------------------------------------------------------------
@@ -319,7 +319,7 @@ bool SL2Picker::applyConfig() {
 			return false;
 		}
 
-		setFilter(filter);
+		setSharedFilter(filter, _l2Config.detecFilter);
 	}
 	else
 		setFilter(NULL);
@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <seiscomp3/processing/streambuffer.h>
+#include <seiscomp3/core/streamregistry.h>
 
 
 namespace Seiscomp {
@@ -100,16 +101,28 @@ RecordSequence* StreamBuffer::sequence(const WaveformID& wid) const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+RecordSequence* StreamBuffer::sequence(int streamHandle) const {
+	if ( streamHandle < 0 || streamHandle >= (int)_sequenceIndex.size() )
+		return NULL;
+	return _sequenceIndex[streamHandle];
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 RecordSequence* StreamBuffer::feed(const Record *rec) {
 	if ( rec == NULL ) return NULL;
 
 	_newStreamAdded = false;
 
-	WaveformID wid(rec);
-	RecordSequence *seq = sequence(wid);
+	int handle = rec->streamHandle();
+	RecordSequence *seq = sequence(handle);
 
 	if ( seq == NULL ) {
+		WaveformID wid(rec);
 		switch ( _mode ) {
 			case TIME_WINDOW:
 				seq = new TimeWindowBuffer(Core::TimeWindow(_timeStart, _timeStart + _timeSpan));
@@ -121,10 +134,24 @@ RecordSequence* StreamBuffer::feed(const Record *rec) {
 
 		_sequences[wid] = seq;
 		_newStreamAdded = true;
+
+		if ( handle >= (int)_sequenceIndex.size() )
+			_sequenceIndex.resize(handle+1, NULL);
+		_sequenceIndex[handle] = seq;
 	}
 
-	if ( seq->feed(rec) )
+	if ( seq->feed(rec) ) {
+		if ( handle >= 0 && handle < (int)_sampleBuffers.size() &&
+		     _sampleBuffers[handle] ) {
+			// Release the sample buffer once no processor holds it anymore
+			if ( _sampleBuffers[handle]->referenceCount() == 1 )
+				_sampleBuffers[handle] = NULL;
+			else
+				_sampleBuffers[handle]->feed(rec);
+		}
+
 		return seq;
+	}
 
 	return NULL;
 }
@@ -133,6 +160,54 @@ RecordSequence* StreamBuffer::feed(const Record *rec) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SampleRingBuffer* StreamBuffer::enableSampleBuffer(const WaveformID& wid) {
+	int handle = StreamRegistry::Register(wid.networkCode, wid.stationCode,
+	                                      wid.locationCode, wid.channelCode);
+
+	SampleRingBuffer *samples = sampleBuffer(handle);
+	if ( samples != NULL ) return samples;
+
+	if ( handle >= (int)_sampleBuffers.size() )
+		_sampleBuffers.resize(handle+1);
+
+	samples = new SampleRingBuffer(_timeSpan);
+	_sampleBuffers[handle] = samples;
+
+	RecordSequence *seq = sequence(wid);
+	if ( seq != NULL ) {
+		for ( RecordSequence::iterator it = seq->begin(); it != seq->end(); ++it )
+			samples->feed(it->get());
+	}
+
+	return samples;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SampleRingBuffer* StreamBuffer::sampleBuffer(const WaveformID& wid) const {
+	return sampleBuffer(StreamRegistry::Find(wid.networkCode, wid.stationCode,
+	                                         wid.locationCode, wid.channelCode));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SampleRingBuffer* StreamBuffer::sampleBuffer(int streamHandle) const {
+	if ( streamHandle < 0 || streamHandle >= (int)_sampleBuffers.size() )
+		return NULL;
+	return _sampleBuffers[streamHandle].get();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool StreamBuffer::addedNewStream() const {
 	return _newStreamAdded;
@@ -191,6 +266,8 @@ void StreamBuffer::clear() {
 		if ( it->second ) delete it->second;
 
 	_sequences.clear();
+	_sequenceIndex.clear();
+	_sampleBuffers.clear();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -16,8 +16,10 @@
 
 #include<string>
 #include<list>
+#include<vector>
 
 #include <seiscomp3/core/recordsequence.h>
+#include <seiscomp3/core/sampleringbuffer.h>
 #include <seiscomp3/client.h>
 
 
@@ -93,8 +95,25 @@ class SC_SYSTEM_CLIENT_API StreamBuffer {
 		void setTimeSpan(const Seiscomp::Core::TimeSpan& timeSpan);
 
 		RecordSequence* sequence(const WaveformID& wid) const;
+
+		//! Returns the sequence of a stream given its registry handle
+		//! (see Record::streamHandle())
+		RecordSequence* sequence(int streamHandle) const;
+
 		RecordSequence* feed(const Record *rec);
 
+		//! Enables a continuous sample buffer for a stream in addition to
+		//! its record sequence. The sample buffer covers the time span of
+		//! the stream buffer and is initialized with the records already
+		//! buffered. Returns the existing buffer if already enabled.
+		//! The caller must hold a reference to the buffer, it is released
+		//! with the next record fed after the last reference is gone.
+		SampleRingBuffer* enableSampleBuffer(const WaveformID& wid);
+
+		//! Returns the sample buffer of a stream or NULL if not enabled
+		SampleRingBuffer* sampleBuffer(const WaveformID& wid) const;
+		SampleRingBuffer* sampleBuffer(int streamHandle) const;
+
 		bool addedNewStream() const;
 
 		void printStreams(std::ostream& os=std::cout) const;
@@ -119,7 +138,13 @@ class SC_SYSTEM_CLIENT_API StreamBuffer {
 		Seiscomp::Core::TimeSpan _timeSpan;
 
 		typedef std::map<WaveformID, RecordSequence*> SequenceMap;
+		typedef std::vector<RecordSequence*> SequenceIndex;
 		SequenceMap _sequences;
+		//! Sequences indexed by stream handle used to dispatch records
+		SequenceIndex _sequenceIndex;
+		typedef std::vector<SampleRingBufferPtr> SampleBufferIndex;
+		//! Optional sample buffers indexed by stream handle
+		SampleBufferIndex _sampleBuffers;
 
 		bool _newStreamAdded;
 };
@@ -59,6 +59,7 @@ WaveformProcessor::WaveformProcessor(const Core::TimeSpan &initTime,
 	_enableGapInterpolation = false;
 	_enableSaturationCheck = false;
 	_saturationThreshold = 0.9*((1 << 23)-1);
+	_sampleBufferRequested = false;
 	reset();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -97,6 +98,51 @@ const Stream &WaveformProcessor::streamConfig(Component c) const {
 void WaveformProcessor::setFilter(Filter *filter) {
 	if ( _stream.filter ) delete _stream.filter;
 	_stream.filter = filter;
+	_filterKey.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformProcessor::setSharedFilter(Filter *filter, const std::string &key) {
+	setFilter(filter);
+	if ( filter ) _filterKey = key;
+	shareFilter();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformProcessor::setProcessingGraph(ProcessingGraph *graph) {
+	_graph = graph;
+	shareFilter();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ProcessingGraph *WaveformProcessor::processingGraph() const {
+	return _graph.get();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformProcessor::shareFilter() {
+	if ( !_graph || _stream.filter == NULL || _filterKey.empty() ) return;
+
+	// The shared filter owns the filter and clones of it are shared
+	// as well, e.g. after reset()
+	_stream.filter = _graph->share(_stream.filter, _filterKey);
+	_filterKey.clear();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -109,6 +155,15 @@ void WaveformProcessor::setOperator(WaveformOperator *op) {
 
 	_operator = op;
 
+	// The sample buffer holds the raw samples of a single stream and
+	// would bypass the operator
+	if ( _operator && _sampleBufferRequested ) {
+		SEISCOMP_WARNING("Sample buffer cannot be used with an operator, "
+		                 "request cleared");
+		_sampleBufferRequested = false;
+		_sampleBuffer = NULL;
+	}
+
 	if ( _operator ) _operator->setStoreFunc(boost::bind(&WaveformProcessor::store, this, _1));
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -211,6 +266,49 @@ bool WaveformProcessor::isSaturationCheckEnabled() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformProcessor::setSampleBufferRequested(bool request) {
+	if ( request && _operator ) {
+		SEISCOMP_WARNING("Sample buffer cannot be used with an operator, "
+		                 "request ignored");
+		return;
+	}
+
+	_sampleBufferRequested = request;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool WaveformProcessor::isSampleBufferRequested() const {
+	return _sampleBufferRequested;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformProcessor::setSampleBuffer(const SampleRingBuffer *buffer) {
+	if ( buffer && _operator ) return;
+	_sampleBuffer = buffer;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const SampleRingBuffer *WaveformProcessor::sampleBuffer() const {
+	return _sampleBuffer.get();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Core::TimeWindow WaveformProcessor::dataTimeWindow() const {
 	return _stream.dataTimeWindow;
@@ -17,10 +17,12 @@
 
 #include <seiscomp3/core/record.h>
 #include <seiscomp3/core/recordsequence.h>
+#include <seiscomp3/core/sampleringbuffer.h>
 #include <seiscomp3/core/typedarray.h>
 #include <seiscomp3/core/enumeration.h>
 #include <seiscomp3/math/filter.h>
 #include <seiscomp3/processing/processor.h>
+#include <seiscomp3/processing/processinggraph.h>
 #include <seiscomp3/processing/stream.h>
 
 
@@ -190,6 +192,16 @@ class SC_SYSTEM_CLIENT_API WaveformProcessor : public Processor {
 		//! Sets the filter to apply 
 		virtual void setFilter(Filter *filter);
 
+		//! Sets the filter to apply and allows to share its output with
+		//! other processors of the same processing graph. The key must
+		//! describe all parameters of the filter, e.g. its filter string.
+		void setSharedFilter(Filter *filter, const std::string &key);
+
+		//! Sets the processing graph to share filter stages with other
+		//! processors. This must be called before the first record is fed.
+		void setProcessingGraph(ProcessingGraph *graph);
+		ProcessingGraph *processingGraph() const;
+
 		//! Sets a operator for all fed records. An operator sits between
 		//! feed and store.
 		void setOperator(WaveformOperator *pipe);
@@ -227,6 +239,28 @@ class SC_SYSTEM_CLIENT_API WaveformProcessor : public Processor {
 		//! Returns whether saturation check is enabled
 		bool isSaturationCheckEnabled() const;
 
+		//! Requests a continuous buffer of the raw samples of the processed
+		//! stream. If enabled before the processor is added to a
+		//! Processing::Application, the application maintains a
+		//! SampleRingBuffer for the stream and passes it via
+		//! setSampleBuffer. A time window processor is then fed the
+		//! buffered data before its time window as one continuous record.
+		//! The buffer holds two doubles per sample of the stream buffer
+		//! span and lives as long as the application, so only request it
+		//! if the processor gains from continuous access.
+		//! Processors with an operator cannot use the buffer, a request is
+		//! ignored and setOperator clears it.
+		//! Default: false
+		void setSampleBufferRequested(bool request);
+		bool isSampleBufferRequested() const;
+
+		//! Sets the continuous sample buffer of the processed stream
+		void setSampleBuffer(const SampleRingBuffer *buffer);
+
+		//! Returns the continuous sample buffer of the processed stream
+		//! or NULL if not available
+		const SampleRingBuffer *sampleBuffer() const;
+
 		//! Resets the processor completely. The configured init time
 		//! is going to be processed again.
 		virtual void reset();
@@ -351,12 +385,22 @@ class SC_SYSTEM_CLIENT_API WaveformProcessor : public Processor {
 		Stream                      _streamConfig[3];
 
 
+	private:
+		void shareFilter();
+
 	private:
 		Status                      _status;
 		double                      _statusValue;
 		WaveformOperatorPtr         _operator;
 
+		ProcessingGraphPtr          _graph;
+		//! The key of the filter that is not yet shared
+		std::string                 _filterKey;
+
 		mutable Core::BaseObjectPtr _userData;
+
+		bool                        _sampleBufferRequested;
+		SampleRingBufferCPtr        _sampleBuffer;
 };
 
 
@@ -14,6 +14,7 @@
 #define SEISCOMP_COMPONENT POSTGRESQL
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/core/plugin.h>
+#include <seiscomp3/core/strings.h>
 #include "postgresqldatabaseinterface.h"
 
 
@@ -21,6 +22,17 @@ namespace Seiscomp {
 namespace Database {
 
 
+namespace {
+
+
+// Maximum number of rows that are read and thrown away when a streamed
+// query is ended early. If more rows are pending the query is cancelled.
+const int MaxDiscardedRows = 10000;
+
+
+}
+
+
 IMPLEMENT_SC_CLASS_DERIVED(PostgreSQLDatabase,
                            Seiscomp::IO::DatabaseInterface,
                            "postgresql_database_interface");
@@ -29,7 +41,8 @@ REGISTER_DB_INTERFACE(PostgreSQLDatabase, "postgresql");
 ADD_SC_PLUGIN("PostgreSQL database driver", "GFZ Potsdam <seiscomp-devel@gfz-potsdam.de>", 0, 9, 1)
 
 PostgreSQLDatabase::PostgreSQLDatabase()
- : _handle(NULL), _result(NULL) {}
+ : _handle(NULL), _result(NULL), _row(-1), _nRows(-1), _fieldCount(0)
+ , _fetchSize(1000), _streaming(false), _cancelable(false) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -44,6 +57,26 @@ PostgreSQLDatabase::~PostgreSQLDatabase() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLDatabase::handleURIParameter(const std::string &name,
+                                            const std::string &value) {
+	if ( !DatabaseInterface::handleURIParameter(name, value) ) return false;
+
+	if ( name == "fetch_size" ) {
+		if ( !Core::fromString(_fetchSize, value) || _fetchSize < 0 ) {
+			SEISCOMP_ERROR("Invalid fetch_size parameter '%s' for database connection",
+			               value.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool PostgreSQLDatabase::open() {
 	std::stringstream ss;
@@ -81,6 +114,7 @@ bool PostgreSQLDatabase::connect(const char *con) {
 	_database = "seiscomp3";
 	_port = 0;
 	_columnPrefix = "m_";
+	_fetchSize = 1000;
 	return DatabaseInterface::connect(con);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -95,6 +129,8 @@ void PostgreSQLDatabase::disconnect() {
 		_result = NULL;
 	}
 
+	_streaming = false;
+
 	PQfinish(_handle);
 	_handle = NULL;
 }
@@ -184,22 +220,66 @@ bool PostgreSQLDatabase::beginQuery(const char* query) {
 
 	endQuery();
 
-	_result = PQexec(_handle, query);
-	if ( _result == NULL ) {
-		SEISCOMP_ERROR("query(\"%s\"): %s", query, PQerrorMessage(_handle));
-		return false;
+	if ( _fetchSize <= 0 ) {
+		_result = PQexec(_handle, query);
+		if ( _result == NULL ) {
+			SEISCOMP_ERROR("query(\"%s\"): %s", query, PQerrorMessage(_handle));
+			return false;
+		}
+	}
+	else {
+		// A cancel request would abort an open transaction block as well
+		_cancelable = PQtransactionStatus(_handle) == PQTRANS_IDLE;
+
+		// Stream the rows instead of buffering the whole result set in
+		// client memory before the first row can be read
+		if ( !PQsendQuery(_handle, query) ) {
+			SEISCOMP_ERROR("query(\"%s\"): %s", query, PQerrorMessage(_handle));
+			return false;
+		}
+
+		// Chunked rows mode requires libpq >= 17 which defines
+		// LIBPQ_HAS_CHUNK_MODE, older versions stream row by row
+#ifdef LIBPQ_HAS_CHUNK_MODE
+		if ( _fetchSize > 1 )
+			_streaming = PQsetChunkedRowsMode(_handle, _fetchSize) == 1;
+		else
+#endif
+		_streaming = PQsetSingleRowMode(_handle) == 1;
+
+		if ( !_streaming )
+			SEISCOMP_WARNING("query: streaming not supported, reading all rows at once");
+
+		_result = PQgetResult(_handle);
+		if ( _result == NULL ) {
+			SEISCOMP_ERROR("query(\"%s\"): %s", query, PQerrorMessage(_handle));
+			_streaming = false;
+			return false;
+		}
 	}
 
 	ExecStatusType stat = PQresultStatus(_result);
-	if ( stat != PGRES_TUPLES_OK && stat != PGRES_COMMAND_OK ) {
+	if ( stat != PGRES_TUPLES_OK && stat != PGRES_COMMAND_OK &&
+	     stat != PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	     && stat != PGRES_TUPLES_CHUNK
+#endif
+	   ) {
 		SEISCOMP_ERROR("QUERY/COMMAND failed");
 		SEISCOMP_ERROR("  %s", query);
 		SEISCOMP_ERROR("  %s", PQerrorMessage(_handle));
 		PQclear(_result);
 		_result = NULL;
+		discardResults();
 		return false;
 	}
 
+	// The last result of a query is followed by NULL which needs to
+	// be read before the connection accepts new commands
+	if ( stat == PGRES_TUPLES_OK || stat == PGRES_COMMAND_OK )
+		discardResults();
+
+	_row = -1;
 	_nRows = PQntuples(_result);
 	_fieldCount = PQnfields(_result);
 
@@ -218,6 +298,8 @@ void PostgreSQLDatabase::endQuery() {
 		PQclear(_result);
 		_result = NULL;
 	}
+
+	discardResults();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -229,11 +311,16 @@ unsigned long PostgreSQLDatabase::lastInsertId(const char* table) {
 	if ( !beginQuery((std::string("select currval('") + table + "_seq')").c_str()) )
 		return 0;
 
-	char* value = PQgetvalue(_result, 0, 0);
+	unsigned long id = 0;
+
+	if ( fetchRow() ) {
+		const char* value = PQgetvalue(_result, _row, 0);
+		if ( value ) id = atoi(value);
+	}
 
 	endQuery();
 
-	return value?atoi(value):0;
+	return id;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -246,6 +333,11 @@ bool PostgreSQLDatabase::fetchRow() {
 
 	if ( _row < _nRows ) return true;
 
+	if ( _streaming && fetchResult() ) {
+		_row = 0;
+		if ( _row < _nRows ) return true;
+	}
+
 	_row = _nRows;
 	return false;
 }
@@ -254,6 +346,75 @@ bool PostgreSQLDatabase::fetchRow() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLDatabase::fetchResult() {
+	PGresult *result = PQgetResult(_handle);
+	if ( result == NULL ) {
+		_streaming = false;
+		return false;
+	}
+
+	ExecStatusType stat = PQresultStatus(result);
+	if ( stat != PGRES_TUPLES_OK && stat != PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	     && stat != PGRES_TUPLES_CHUNK
+#endif
+	   ) {
+		SEISCOMP_ERROR("fetchRow: %s", PQresultErrorMessage(result));
+		PQclear(result);
+		discardResults();
+		return false;
+	}
+
+	// Keep the last result to provide the field names until the
+	// query is ended
+	PQclear(_result);
+	_result = result;
+	_nRows = PQntuples(_result);
+
+	if ( stat == PGRES_TUPLES_OK )
+		discardResults();
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void PostgreSQLDatabase::discardResults() {
+	PGresult *result;
+	bool cancelled = false;
+	int rows = 0;
+
+	while ( (result = PQgetResult(_handle)) != NULL ) {
+		rows += PQntuples(result);
+		PQclear(result);
+
+		// Do not transfer a large remaining result set only to throw
+		// it away. Inside a transaction block the rows are drained
+		// instead since cancelling would abort the transaction.
+		if ( !cancelled && _cancelable && rows > MaxDiscardedRows ) {
+			PGcancel *cancel = PQgetCancel(_handle);
+			if ( cancel ) {
+				char err[256];
+				if ( !PQcancel(cancel, err, sizeof(err)) )
+					SEISCOMP_WARNING("Failed to cancel query: %s", err);
+				PQfreeCancel(cancel);
+			}
+
+			cancelled = true;
+		}
+	}
+
+	_streaming = false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 int PostgreSQLDatabase::findColumn(const char* name) {
 	return PQfnumber(_result, name);
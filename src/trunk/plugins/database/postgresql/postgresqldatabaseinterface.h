@@ -64,18 +64,37 @@ class PostgreSQLDatabase : public Seiscomp::IO::DatabaseInterface {
 	//  Protected interface
 	// ------------------------------------------------------------------
 	protected:
+		bool handleURIParameter(const std::string &name,
+		                        const std::string &value);
+
 		bool open();
 
 
 	// ------------------------------------------------------------------
 	//  Implementation
 	// ------------------------------------------------------------------
+	private:
+		//! Reads the next chunk of rows of a streamed query
+		bool fetchResult();
+
+		//! Discards the remaining results of a streamed query
+		void discardResults();
+
+
 	private:
 		PGconn *_handle;
 		PGresult *_result;
 		int _row;
 		int _nRows;
 		int _fieldCount;
+		//! Number of rows to transfer at once, 0 reads the whole result
+		//! set before the first row is returned
+		int _fetchSize;
+		//! Whether the current query is streamed and not yet complete
+		bool _streaming;
+		//! Whether the current query runs outside of a transaction block
+		//! and can be cancelled without aborting the transaction
+		bool _cancelable;
 };
 
 